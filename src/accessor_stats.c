@@ -0,0 +1,82 @@
+#include "accessor_stats.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ACCESSOR_STATS_SSE2
+#endif
+
+void accessor_stats_float(const float *data, size_t count, uint32_t components, float *min, float *max) {
+    for (uint32_t c = 0; c < components; c++) {
+        min[c] = max[c] = data[c];
+    }
+    size_t i = 1;
+
+#ifdef ACCESSOR_STATS_SSE2
+    // A block is the smallest run of whole elements filling whole registers:
+    // lane k of the block always holds component k % components
+    uint32_t block_floats = components % 4 == 0 ? components : components % 2 == 0 ? components * 2 : components * 4;
+    uint32_t regs = block_floats / 4;
+    size_t per_block = block_floats / components;
+    size_t blocks = count / per_block;
+    if (regs <= 4 && blocks > 1) {
+        __m128 lo[4], hi[4];
+        for (uint32_t r = 0; r < regs; r++) {
+            lo[r] = hi[r] = _mm_loadu_ps(data + r * 4);
+        }
+        for (size_t b = 1; b < blocks; b++) {
+            const float *p = data + b * block_floats;
+            for (uint32_t r = 0; r < regs; r++) {
+                __m128 v = _mm_loadu_ps(p + r * 4);
+                lo[r] = _mm_min_ps(lo[r], v);
+                hi[r] = _mm_max_ps(hi[r], v);
+            }
+        }
+        float lanes_lo[16], lanes_hi[16];
+        for (uint32_t r = 0; r < regs; r++) {
+            _mm_storeu_ps(lanes_lo + r * 4, lo[r]);
+            _mm_storeu_ps(lanes_hi + r * 4, hi[r]);
+        }
+        for (uint32_t k = 0; k < block_floats; k++) {
+            uint32_t c = k % components;
+            if (lanes_lo[k] < min[c]) min[c] = lanes_lo[k];
+            if (lanes_hi[k] > max[c]) max[c] = lanes_hi[k];
+        }
+        i = blocks * per_block;
+    }
+#endif
+
+    for (; i < count; i++) {
+        const float *e = data + i * components;
+        for (uint32_t c = 0; c < components; c++) {
+            if (e[c] < min[c]) min[c] = e[c];
+            if (e[c] > max[c]) max[c] = e[c];
+        }
+    }
+}
+
+#define UNSIGNED_STATS(type)                                          \
+    do {                                                              \
+        const type *values = data;                                    \
+        for (size_t i = 0; i < count; i++) {                          \
+            const type *e = values + i * components;                  \
+            for (uint32_t c = 0; c < components; c++) {               \
+                if (e[c] < min[c]) min[c] = e[c];                     \
+                if (e[c] > max[c]) max[c] = e[c];                     \
+            }                                                         \
+        }                                                             \
+    } while (0)
+
+void accessor_stats_unsigned(const void *data, int component_type, size_t count, uint32_t components,
+                             uint32_t *min, uint32_t *max) {
+    for (uint32_t c = 0; c < components; c++) {
+        min[c] = UINT32_MAX;
+        max[c] = 0;
+    }
+    if (component_type == 5121) {
+        UNSIGNED_STATS(uint8_t);
+    } else if (component_type == 5123) {
+        UNSIGNED_STATS(uint16_t);
+    } else {
+        UNSIGNED_STATS(uint32_t);
+    }
+}
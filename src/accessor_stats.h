@@ -0,0 +1,22 @@
+#ifndef ACCESSOR_STATS_H
+#define ACCESSOR_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Per-component min/max of accessor data, as glTF accessor.min/max expect.
+// Elements are tightly packed (count * components values); components is at
+// most ACCESSOR_MAX_COMPONENTS (MAT4). count must be at least 1.
+
+#define ACCESSOR_MAX_COMPONENTS 16
+
+// Float streams. Uses SSE2 when the target has it: VEC2/VEC3/VEC4/MAT4
+// elements are scanned four floats at a time, lanes folded per component.
+void accessor_stats_float(const float *data, size_t count, uint32_t components, float *min, float *max);
+
+// Unsigned integer streams of glTF component_type 5121, 5123 or 5125, as
+// raw stored values (glTF min/max ignore the normalized flag)
+void accessor_stats_unsigned(const void *data, int component_type, size_t count, uint32_t components,
+                             uint32_t *min, uint32_t *max);
+
+#endif // ACCESSOR_STATS_H
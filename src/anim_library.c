@@ -0,0 +1,176 @@
+#include "anim_library.h"
+#include "hash.h"
+#include "portable_string.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void anim_library_set_init(AnimLibrarySet *set) {
+    memset(set, 0, sizeof(*set));
+}
+
+static void free_library(AnimLibrary *lib) {
+    for (uint32_t c = 0; c < lib->clip_count; c++) {
+        free(lib->clips[c].name);
+        free(lib->clips[c].times);
+        free(lib->clips[c].translations);
+        free(lib->clips[c].rotations);
+    }
+    free(lib->clips);
+    free(lib->stem);
+    free(lib->rest);
+    free(lib);
+}
+
+void anim_library_set_free(AnimLibrarySet *set) {
+    for (uint32_t i = 0; i < set->count; i++) {
+        free_library(set->libraries[i]);
+    }
+    free(set->libraries);
+    memset(set, 0, sizeof(*set));
+}
+
+static int stem_taken(const AnimLibrarySet *set, const char *stem) {
+    for (uint32_t i = 0; i < set->count; i++) {
+        if (strcmp(set->libraries[i]->stem, stem) == 0) return 1;
+    }
+    return 0;
+}
+
+// File name from the skeleton title, made safe for paths and unique
+static char* library_stem(const AnimLibrarySet *set, const SkeletonDef *skel) {
+    char base[sizeof(skel->title)];
+    size_t len = 0;
+    for (const char *c = skel->title; *c && len < sizeof(base) - 1; c++) {
+        int safe = (*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z') || (*c >= '0' && *c <= '9') ||
+                   *c == '_' || *c == '-';
+        base[len++] = safe ? *c : '_';
+    }
+    base[len] = '\0';
+    if (len == 0) my_strncpy(base, "skeleton", sizeof(base));
+
+    char stem[sizeof(base) + 16];
+    snprintf(stem, sizeof(stem), "%s", base);
+    for (uint32_t n = 2; stem_taken(set, stem); n++) {
+        snprintf(stem, sizeof(stem), "%s_%u", base, n);
+    }
+    return my_strdup(stem);
+}
+
+AnimLibrary* anim_library_set_get(AnimLibrarySet *set, const SkeletonDef *skel) {
+    for (uint32_t i = 0; i < set->count; i++) {
+        if (set->libraries[i]->skel == skel) return set->libraries[i];
+    }
+    if (set->count >= set->capacity) {
+        uint32_t capacity = set->capacity ? set->capacity * 2 : 8;
+        AnimLibrary **libraries = realloc(set->libraries, capacity * sizeof(AnimLibrary*));
+        if (!libraries) return NULL;
+        set->libraries = libraries;
+        set->capacity = capacity;
+    }
+    AnimLibrary *lib = calloc(1, sizeof(AnimLibrary));
+    if (!lib) return NULL;
+    lib->skel = skel;
+    lib->stem = library_stem(set, skel);
+    lib->rest = calloc(skel->bone_count > 0 ? (size_t)skel->bone_count : 1, sizeof(BoneState));
+    if (!lib->stem || !lib->rest) {
+        free_library(lib);
+        return NULL;
+    }
+    for (int b = 0; b < skel->bone_count; b++) {
+        lib->rest[b].rotation.w = 1.0f;
+    }
+    set->libraries[set->count++] = lib;
+    return lib;
+}
+
+void anim_library_set_rest(AnimLibrary *lib, const BoneState *rest, uint32_t rest_count) {
+    if (lib->model_count++ > 0) return;
+    uint32_t count = rest_count < (uint32_t)lib->skel->bone_count ? rest_count : (uint32_t)lib->skel->bone_count;
+    memcpy(lib->rest, rest, count * sizeof(BoneState));
+}
+
+static const AnimLibraryClip* find_clip(const AnimLibrary *lib, const char *name) {
+    for (uint32_t c = 0; c < lib->clip_count; c++) {
+        if (strcmp(lib->clips[c].name, name) == 0) return &lib->clips[c];
+    }
+    return NULL;
+}
+
+static int same_keys(const AnimLibraryClip *a, const AnimLibraryClip *b) {
+    size_t keys = (size_t)a->frame_count * a->bone_count;
+    return a->hash == b->hash && a->frame_count == b->frame_count && a->bone_count == b->bone_count &&
+           memcmp(a->times, b->times, a->frame_count * sizeof(float)) == 0 &&
+           memcmp(a->translations, b->translations, keys * 3 * sizeof(float)) == 0 &&
+           memcmp(a->rotations, b->rotations, keys * 4 * sizeof(float)) == 0;
+}
+
+const char* anim_library_add_clip(AnimLibrary *lib, const char *name, const char *model_name,
+                                  uint32_t frame_count, uint32_t bone_count, const float *times,
+                                  float *const *translations, float *const *rotations) {
+    if (!name) name = "Animation";
+    if (!model_name) model_name = "model";
+    if (lib->clip_count >= lib->clip_capacity) {
+        uint32_t capacity = lib->clip_capacity ? lib->clip_capacity * 2 : 16;
+        AnimLibraryClip *clips = realloc(lib->clips, capacity * sizeof(AnimLibraryClip));
+        if (!clips) return NULL;
+        lib->clips = clips;
+        lib->clip_capacity = capacity;
+    }
+
+    // Build the candidate in the next slot, then keep it or drop it
+    AnimLibraryClip *clip = &lib->clips[lib->clip_count];
+    memset(clip, 0, sizeof(*clip));
+    size_t track = (size_t)frame_count;
+    clip->frame_count = frame_count;
+    clip->bone_count = bone_count;
+    clip->times = malloc((track + 1) * sizeof(float));
+    clip->translations = malloc((track * bone_count * 3 + 1) * sizeof(float));
+    clip->rotations = malloc((track * bone_count * 4 + 1) * sizeof(float));
+    if (!clip->times || !clip->translations || !clip->rotations) {
+        free(clip->times);
+        free(clip->translations);
+        free(clip->rotations);
+        return NULL;
+    }
+    memcpy(clip->times, times, track * sizeof(float));
+    for (uint32_t b = 0; b < bone_count; b++) {
+        memcpy(&clip->translations[b * track * 3], translations[b], track * 3 * sizeof(float));
+        memcpy(&clip->rotations[b * track * 4], rotations[b], track * 4 * sizeof(float));
+    }
+    uint64_t hash = hash_fnv1a64_update(HASH_FNV64_OFFSET, &frame_count, sizeof(frame_count));
+    hash = hash_fnv1a64_update(hash, &bone_count, sizeof(bone_count));
+    hash = hash_fnv1a64_update(hash, clip->times, track * sizeof(float));
+    hash = hash_fnv1a64_update(hash, clip->translations, track * bone_count * 3 * sizeof(float));
+    clip->hash = hash_fnv1a64_update(hash, clip->rotations, track * bone_count * 4 * sizeof(float));
+
+    // The clip's own name, then "<model>:<clip>", then numbered variants
+    char candidate[256];
+    for (uint32_t attempt = 0;; attempt++) {
+        if (attempt == 0) {
+            snprintf(candidate, sizeof(candidate), "%s", name);
+        } else if (attempt == 1) {
+            snprintf(candidate, sizeof(candidate), "%s:%s", model_name, name);
+        } else {
+            snprintf(candidate, sizeof(candidate), "%s:%s_%u", model_name, name, attempt);
+        }
+        const AnimLibraryClip *existing = find_clip(lib, candidate);
+        if (!existing) break;
+        if (same_keys(existing, clip)) {
+            free(clip->times);
+            free(clip->translations);
+            free(clip->rotations);
+            lib->reused++;
+            return existing->name;
+        }
+    }
+    clip->name = my_strdup(candidate);
+    if (!clip->name) {
+        free(clip->times);
+        free(clip->translations);
+        free(clip->rotations);
+        return NULL;
+    }
+    lib->clip_count++;
+    return clip->name;
+}
@@ -0,0 +1,61 @@
+#ifndef ANIM_LIBRARY_H
+#define ANIM_LIBRARY_H
+
+#include <stdint.h>
+#include "pmd_psa_types.h"
+#include "skeleton.h"
+
+// Animation libraries: the clips of every model sharing a skeleton, written
+// once per skeleton instead of into each model's glTF. Library nodes are the
+// skeleton's bones under their JSON names, so a model glTF (whose bone nodes
+// carry the same names) can play any clip by binding channels by node name.
+// A clip already in the library under the same name with the same keys is
+// shared; a different clip under a taken name is renamed "<model>:<clip>".
+
+typedef struct {
+    char *name;                 // unique within the library
+    uint32_t frame_count;
+    uint32_t bone_count;        // tracks for bones [0, bone_count)
+    float *times;               // key times in seconds, playback speed applied
+    float *translations;        // bone-major: bone b's keys start at b * frame_count * 3
+    float *rotations;           // bone-major: bone b's keys start at b * frame_count * 4
+    uint64_t hash;
+} AnimLibraryClip;
+
+typedef struct {
+    const SkeletonDef *skel;    // owned by the config cache
+    char *stem;                 // output file name without extension, unique in the set
+    BoneState *rest;            // bone node transforms, from the first model added
+    AnimLibraryClip *clips;
+    uint32_t clip_count;
+    uint32_t clip_capacity;
+    uint32_t reused;            // clips that were already in the library
+    uint32_t model_count;
+} AnimLibrary;
+
+// One library per distinct skeleton of a batch. Skeletons are interned by
+// the config cache, so the same rig is the same pointer.
+typedef struct {
+    AnimLibrary **libraries;
+    uint32_t count;
+    uint32_t capacity;
+} AnimLibrarySet;
+
+void anim_library_set_init(AnimLibrarySet *set);
+void anim_library_set_free(AnimLibrarySet *set);
+
+// Library for skel, created on first use. NULL on allocation failure.
+AnimLibrary* anim_library_set_get(AnimLibrarySet *set, const SkeletonDef *skel);
+
+// Record the rest transforms of the first model using the library; later
+// calls keep the first ones. Bones past rest_count stay identity.
+void anim_library_set_rest(AnimLibrary *lib, const BoneState *rest, uint32_t rest_count);
+
+// Add a clip whose per-bone tracks are translations[b] (frame_count * 3)
+// and rotations[b] (frame_count * 4). Returns the clip's name in the
+// library, or NULL on allocation failure.
+const char* anim_library_add_clip(AnimLibrary *lib, const char *name, const char *model_name,
+                                  uint32_t frame_count, uint32_t bone_count, const float *times,
+                                  float *const *translations, float *const *rotations);
+
+#endif // ANIM_LIBRARY_H
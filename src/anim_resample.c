@@ -0,0 +1,85 @@
+#include "anim_resample.h"
+#include "pose.h"
+#include "portable_string.h"
+#include "transform.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+PSAAnimation* resample_psa(const PSAAnimation *anim, float source_fps, float target_fps,
+                           const SkeletonDef *skel, const BoneState *rest, uint32_t rest_count) {
+    if (!anim || source_fps <= 0.0f || target_fps <= 0.0f) return NULL;
+    // Streamed clips keep their frames in the file
+    if (!anim->boneStates && anim->numFrames > 0) return NULL;
+
+    PSAAnimation *out = calloc(1, sizeof(PSAAnimation));
+    if (!out) return NULL;
+    out->name = anim->name ? my_strdup(anim->name) : NULL;
+    out->numBones = anim->numBones;
+
+    // Intervals in the source, scaled to the target rate and rounded up;
+    // the epsilon keeps exact multiples (30 -> 15 fps) from gaining a key
+    uint32_t source_intervals = anim->numFrames > 0 ? anim->numFrames - 1 : 0;
+    float duration = (float)source_intervals / source_fps;
+    uint32_t intervals = (uint32_t)ceilf(duration * target_fps - 1e-4f);
+    if (source_intervals > 0 && intervals == 0) intervals = 1;
+    out->numFrames = anim->numFrames > 0 ? intervals + 1 : 0;
+    out->frameLength = intervals > 0 ? duration / (float)intervals : 1.0f / target_fps;
+
+    size_t state_count = (size_t)out->numFrames * out->numBones;
+    out->boneStates = calloc(state_count ? state_count : 1, sizeof(BoneState));
+
+    // Parent-relative states of every source frame, and of the key being built
+    uint32_t pose_bones = anim->numBones > rest_count ? anim->numBones : rest_count;
+    BoneState *locals = malloc(((size_t)anim->numFrames * pose_bones + 1) * sizeof(BoneState));
+    BoneState *key = malloc(((size_t)pose_bones + 1) * sizeof(BoneState));
+    SkeletonPose pose;
+    int pose_ready = locals && key && pose_init(&pose, skel, pose_bones);
+    if (!out->boneStates || (anim->name && !out->name) || !pose_ready) {
+        if (pose_ready) pose_free(&pose);
+        free(locals);
+        free(key);
+        free_psa(out);
+        return NULL;
+    }
+    for (uint32_t f = 0; f < anim->numFrames; f++) {
+        pose_evaluate_world(&pose, &anim->boneStates[(size_t)f * anim->numBones], anim->numBones, rest, rest_count);
+        memcpy(&locals[(size_t)f * pose_bones], pose.local, pose_bones * sizeof(BoneState));
+    }
+
+    for (uint32_t k = 0; k < out->numFrames; k++) {
+        // Position in source frames; the last key is the last source frame exactly
+        uint32_t f0, f1;
+        float t;
+        if (k == out->numFrames - 1) {
+            f0 = f1 = source_intervals;
+            t = 0.0f;
+        } else {
+            float pos = (float)k * (float)source_intervals / (float)intervals;
+            f0 = (uint32_t)pos;
+            if (f0 >= source_intervals) f0 = source_intervals;
+            f1 = f0 < source_intervals ? f0 + 1 : f0;
+            t = pos - (float)f0;
+        }
+
+        BoneState *dst = &out->boneStates[(size_t)k * out->numBones];
+        if (t == 0.0f) {
+            memcpy(dst, &anim->boneStates[(size_t)f0 * anim->numBones], anim->numBones * sizeof(BoneState));
+            continue;
+        }
+        const BoneState *a = &locals[(size_t)f0 * pose_bones];
+        const BoneState *b = &locals[(size_t)f1 * pose_bones];
+        for (uint32_t bone = 0; bone < pose_bones; bone++) {
+            key[bone].translation.x = a[bone].translation.x + (b[bone].translation.x - a[bone].translation.x) * t;
+            key[bone].translation.y = a[bone].translation.y + (b[bone].translation.y - a[bone].translation.y) * t;
+            key[bone].translation.z = a[bone].translation.z + (b[bone].translation.z - a[bone].translation.z) * t;
+            key[bone].rotation = quat_slerp(a[bone].rotation, b[bone].rotation, t);
+        }
+        pose_evaluate_local(&pose, key, pose_bones);
+        memcpy(dst, pose.world, anim->numBones * sizeof(BoneState));
+    }
+    pose_free(&pose);
+    free(locals);
+    free(key);
+    return out;
+}
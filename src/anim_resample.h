@@ -0,0 +1,21 @@
+#ifndef ANIM_RESAMPLE_H
+#define ANIM_RESAMPLE_H
+
+#include "pmd_psa_types.h"
+#include "skeleton.h"
+
+// Frame rate of PSA keys as the engine plays them
+#define PSA_FRAME_RATE 30.0f
+
+// Resample a PSA onto evenly spaced keys at target_fps or slightly above:
+// the key count is rounded up so that the last key lands exactly on the
+// last source frame. Keys on a source frame copy it; keys in between slerp
+// rotations and lerp translations of the parent-relative transforms (skel
+// hierarchy, bones past the PSA posed as rest) and are stored back in world
+// space, so children keep their offsets to their parents. The result's
+// frameLength is the new key spacing in seconds. skel may be NULL (every
+// bone a root). Returns NULL on allocation failure or for a streamed clip.
+PSAAnimation* resample_psa(const PSAAnimation *anim, float source_fps, float target_fps,
+                           const SkeletonDef *skel, const BoneState *rest, uint32_t rest_count);
+
+#endif // ANIM_RESAMPLE_H
@@ -0,0 +1,103 @@
+#include "anim_store.h"
+#include "hash.h"
+#include "portable_string.h"
+#include <stdlib.h>
+#include <string.h>
+
+int anim_store_open(AnimStore *store, const char *path) {
+    memset(store, 0, sizeof(*store));
+    const char *name = strrchr(path, '/');
+    const char *alt = strrchr(path, '\\');
+    if (alt && (!name || alt > name)) name = alt;
+    store->uri = my_strdup(name ? name + 1 : path);
+    store->file = fopen(path, "w+b");
+    if (!store->uri || !store->file) {
+        fprintf(stderr, "Error: Cannot create shared animation file %s\n", path);
+        anim_store_close(store);
+        return 0;
+    }
+    return 1;
+}
+
+// Compare data with the bytes stored at offset
+static int stored_equals(AnimStore *store, uint64_t offset, const void *data, size_t size) {
+    unsigned char chunk[4096];
+    const unsigned char *bytes = data;
+    if (fseek(store->file, (long)offset, SEEK_SET) != 0) return 0;
+    for (size_t done = 0; done < size;) {
+        size_t n = size - done < sizeof(chunk) ? size - done : sizeof(chunk);
+        if (fread(chunk, 1, n, store->file) != n || memcmp(chunk, bytes + done, n) != 0) return 0;
+        done += n;
+    }
+    return 1;
+}
+
+static int grow(AnimStore *store) {
+    uint32_t capacity = store->capacity ? store->capacity * 2 : 256;
+    AnimStoreEntry *slots = calloc(capacity, sizeof(AnimStoreEntry));
+    if (!slots) return 0;
+    for (uint32_t i = 0; i < store->capacity; i++) {
+        const AnimStoreEntry *entry = &store->slots[i];
+        if (entry->size == 0) continue;
+        uint32_t slot = (uint32_t)entry->hash & (capacity - 1);
+        while (slots[slot].size != 0) slot = (slot + 1) & (capacity - 1);
+        slots[slot] = *entry;
+    }
+    free(store->slots);
+    store->slots = slots;
+    store->capacity = capacity;
+    return 1;
+}
+
+int anim_store_add(AnimStore *store, const void *data, size_t size, uint64_t *offset) {
+    if (!store->file) return 0;
+    store->added_bytes += size;
+    if (size == 0) {
+        *offset = 0;
+        return 1;
+    }
+    if ((store->count + 1) * 4 > store->capacity * 3 && !grow(store)) return 0;
+
+    // Hash first, then confirm with the stored bytes: a collision must
+    // never make two models share different tracks
+    uint64_t hash = hash_fnv1a64(data, size);
+    uint32_t slot = (uint32_t)hash & (store->capacity - 1);
+    for (; store->slots[slot].size != 0; slot = (slot + 1) & (store->capacity - 1)) {
+        const AnimStoreEntry *entry = &store->slots[slot];
+        if (entry->hash == hash && entry->size == size && stored_equals(store, entry->offset, data, size)) {
+            store->hits++;
+            *offset = entry->offset;
+            return 1;
+        }
+    }
+
+    static const unsigned char padding[4] = {0};
+    size_t pad = (size_t)((4 - store->size % 4) % 4);
+    if (fseek(store->file, 0, SEEK_END) != 0 ||
+        fwrite(padding, 1, pad, store->file) != pad ||
+        fwrite(data, 1, size, store->file) != size) {
+        fprintf(stderr, "Error: Cannot write shared animation data\n");
+        return 0;
+    }
+    store->slots[slot] = (AnimStoreEntry){hash, store->size + pad, size};
+    store->count++;
+    *offset = store->size + pad;
+    store->size += pad + size;
+    return 1;
+}
+
+int anim_store_close(AnimStore *store) {
+    int ok = 1;
+    if (store->file) {
+        // Keep the file length a multiple of 4 like any glTF buffer
+        static const unsigned char padding[4] = {0};
+        size_t pad = (size_t)((4 - store->size % 4) % 4);
+        ok = fseek(store->file, 0, SEEK_END) == 0 && fwrite(padding, 1, pad, store->file) == pad;
+        store->size += pad;
+        ok = fclose(store->file) == 0 && ok;
+    }
+    free(store->uri);
+    free(store->slots);
+    memset(store, 0, sizeof(*store));
+    return ok;
+}
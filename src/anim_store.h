@@ -0,0 +1,40 @@
+#ifndef ANIM_STORE_H
+#define ANIM_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Content-addressed store for animation buffer data shared by the models of
+// one batch. Each block (key times, a track's outputs) is hashed and written
+// to the shared .bin once; identical blocks from other models or copied PSAs
+// get the offset of the first copy, so their bufferViews all point at it.
+
+typedef struct {
+    uint64_t hash;
+    uint64_t offset;
+    size_t size;
+} AnimStoreEntry;
+
+typedef struct {
+    FILE *file;
+    char *uri;                 // file name as glTFs next to it reference it
+    uint64_t size;             // bytes written so far
+    AnimStoreEntry *slots;     // open addressing, capacity is a power of two
+    uint32_t capacity;
+    uint32_t count;
+    uint32_t hits;             // blocks served from an earlier copy
+    uint64_t added_bytes;      // bytes passed to anim_store_add, before deduplication
+} AnimStore;
+
+// Create (or truncate) the shared file at path. Returns 0 on failure.
+int anim_store_open(AnimStore *store, const char *path);
+
+// Store a block, or find an identical one already stored, and return its
+// 4-byte aligned offset in the shared file. Returns 0 on I/O or allocation failure.
+int anim_store_add(AnimStore *store, const void *data, size_t size, uint64_t *offset);
+
+// Flush and close the file and free the index
+int anim_store_close(AnimStore *store);
+
+#endif // ANIM_STORE_H
@@ -0,0 +1,60 @@
+#include "binary_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+void byte_writer_init(ByteWriter *w, size_t initial_capacity) {
+    w->data = initial_capacity ? malloc(initial_capacity) : NULL;
+    w->size = 0;
+    w->capacity = w->data ? initial_capacity : 0;
+    w->error = 0;
+}
+
+void byte_writer_free(ByteWriter *w) {
+    free(w->data);
+    w->data = NULL;
+    w->size = 0;
+    w->capacity = 0;
+}
+
+int byte_writer_reserve(ByteWriter *w, size_t n) {
+    if (w->error) return 0;
+    if (n <= w->capacity - w->size) return 1;
+
+    size_t new_capacity = w->capacity ? w->capacity : 256;
+    while (new_capacity - w->size < n) {
+        if (new_capacity > ((size_t)-1) / 2) {
+            w->error = 1;
+            return 0;
+        }
+        new_capacity *= 2;
+    }
+    uint8_t *data = realloc(w->data, new_capacity);
+    if (!data) {
+        w->error = 1;
+        return 0;
+    }
+    w->data = data;
+    w->capacity = new_capacity;
+    return 1;
+}
+
+void byte_writer_bytes(ByteWriter *w, const void *data, size_t n) {
+    if (!n || !byte_writer_reserve(w, n)) return;
+    memcpy(w->data + w->size, data, n);
+    w->size += n;
+}
+
+void byte_writer_align(ByteWriter *w, size_t alignment, uint8_t fill) {
+    while (alignment > 1 && w->size % alignment != 0 && !w->error) {
+        byte_writer_u8(w, fill);
+    }
+}
+
+int byte_writer_save(const ByteWriter *w, const char *path) {
+    if (w->error) return 0;
+    FILE *f = fopen(path, "wb");
+    if (!f) return 0;
+    int ok = fwrite(w->data, 1, w->size, f) == w->size;
+    if (fclose(f) != 0) ok = 0;
+    return ok;
+}
@@ -0,0 +1,149 @@
+#ifndef BINARY_IO_H
+#define BINARY_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "pmd_psa_types.h"
+
+// Little-endian binary encoding over memory buffers.
+// Loaders read a whole file once and decode it with a ByteReader; writers
+// fill a ByteWriter and hand the result to the OS in one write. Field
+// accessors are inline so per-field cost is a bounds check and a copy.
+
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+    int error;          // set once a read runs past the end; reads then return 0
+} ByteReader;
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+    int error;          // set on allocation failure; further writes are dropped
+} ByteWriter;
+
+static inline void byte_reader_init(ByteReader *r, const void *data, size_t size) {
+    r->data = (const uint8_t *)data;
+    r->size = size;
+    r->pos = 0;
+    r->error = 0;
+}
+
+static inline size_t byte_reader_remaining(const ByteReader *r) {
+    return r->error ? 0 : r->size - r->pos;
+}
+
+// Pointer to the next n bytes and advance, NULL if fewer remain
+static inline const uint8_t* byte_reader_take(ByteReader *r, size_t n) {
+    if (r->error || n > r->size - r->pos) {
+        r->error = 1;
+        return NULL;
+    }
+    const uint8_t *p = r->data + r->pos;
+    r->pos += n;
+    return p;
+}
+
+static inline uint8_t byte_reader_u8(ByteReader *r) {
+    const uint8_t *p = byte_reader_take(r, 1);
+    return p ? p[0] : 0;
+}
+
+static inline uint16_t byte_reader_u16(ByteReader *r) {
+    const uint8_t *p = byte_reader_take(r, 2);
+    return p ? (uint16_t)(p[0] | (p[1] << 8)) : 0;
+}
+
+static inline uint32_t byte_reader_u32(ByteReader *r) {
+    const uint8_t *p = byte_reader_take(r, 4);
+    return p ? (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24) : 0;
+}
+
+static inline float byte_reader_f32(ByteReader *r) {
+    uint32_t bits = byte_reader_u32(r);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static inline Vector3D byte_reader_vec3(ByteReader *r) {
+    Vector3D v;
+    v.x = byte_reader_f32(r);
+    v.y = byte_reader_f32(r);
+    v.z = byte_reader_f32(r);
+    return v;
+}
+
+static inline Quaternion byte_reader_quat(ByteReader *r) {
+    Quaternion q;
+    q.x = byte_reader_f32(r);
+    q.y = byte_reader_f32(r);
+    q.z = byte_reader_f32(r);
+    q.w = byte_reader_f32(r);
+    return q;
+}
+
+static inline BoneState byte_reader_bone_state(ByteReader *r) {
+    BoneState s;
+    s.translation = byte_reader_vec3(r);
+    s.rotation = byte_reader_quat(r);
+    return s;
+}
+
+void byte_writer_init(ByteWriter *w, size_t initial_capacity);
+void byte_writer_free(ByteWriter *w);
+// Make room for n more bytes; returns 0 (and sets error) on failure
+int byte_writer_reserve(ByteWriter *w, size_t n);
+void byte_writer_bytes(ByteWriter *w, const void *data, size_t n);
+// Pad with fill bytes up to the next multiple of alignment
+void byte_writer_align(ByteWriter *w, size_t alignment, uint8_t fill);
+// Write the buffer to path with a single fwrite; returns 1 on success
+int byte_writer_save(const ByteWriter *w, const char *path);
+
+static inline void byte_writer_u8(ByteWriter *w, uint8_t value) {
+    if (!byte_writer_reserve(w, 1)) return;
+    w->data[w->size++] = value;
+}
+
+static inline void byte_writer_u16(ByteWriter *w, uint16_t value) {
+    if (!byte_writer_reserve(w, 2)) return;
+    w->data[w->size++] = (uint8_t)(value & 0xFF);
+    w->data[w->size++] = (uint8_t)(value >> 8);
+}
+
+static inline void byte_writer_u32(ByteWriter *w, uint32_t value) {
+    if (!byte_writer_reserve(w, 4)) return;
+    w->data[w->size++] = (uint8_t)(value & 0xFF);
+    w->data[w->size++] = (uint8_t)((value >> 8) & 0xFF);
+    w->data[w->size++] = (uint8_t)((value >> 16) & 0xFF);
+    w->data[w->size++] = (uint8_t)(value >> 24);
+}
+
+static inline void byte_writer_f32(ByteWriter *w, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    byte_writer_u32(w, bits);
+}
+
+static inline void byte_writer_vec3(ByteWriter *w, Vector3D v) {
+    byte_writer_f32(w, v.x);
+    byte_writer_f32(w, v.y);
+    byte_writer_f32(w, v.z);
+}
+
+static inline void byte_writer_quat(ByteWriter *w, Quaternion q) {
+    byte_writer_f32(w, q.x);
+    byte_writer_f32(w, q.y);
+    byte_writer_f32(w, q.z);
+    byte_writer_f32(w, q.w);
+}
+
+static inline void byte_writer_bone_state(ByteWriter *w, BoneState s) {
+    byte_writer_vec3(w, s.translation);
+    byte_writer_quat(w, s.rotation);
+}
+
+#endif // BINARY_IO_H
@@ -0,0 +1,49 @@
+#include "clip_bounds.h"
+#include "accessor_stats.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+int clip_bounds_compute(const float *palettes, uint32_t frame_count, uint32_t palette_count,
+                        const SkinInput *in, int threads, ClipBounds *out) {
+    memset(out, 0, sizeof(*out));
+    uint32_t n = in->count;
+    if (n == 0 || frame_count == 0) return 0;
+    float *skinned = malloc((size_t)n * 3 * sizeof(float));
+    if (!skinned) return 0;
+    SkinInput positions = *in;
+    positions.nx = positions.ny = positions.nz = NULL;
+    SkinOutput frame = {skinned, skinned + n, skinned + 2 * (size_t)n, NULL, NULL, NULL, NULL};
+    size_t pose_size = (size_t)palette_count * SKIN_PALETTE_STRIDE;
+
+    // Box over every frame, one SoA min/max scan per axis
+    for (uint32_t f = 0; f < frame_count; f++) {
+        skin_vertices(palettes + f * pose_size, palette_count, &positions, &frame, threads);
+        for (int axis = 0; axis < 3; axis++) {
+            float lo, hi;
+            accessor_stats_float(skinned + (size_t)axis * n, n, 1, &lo, &hi);
+            if (f == 0 || lo < out->min[axis]) out->min[axis] = lo;
+            if (f == 0 || hi > out->max[axis]) out->max[axis] = hi;
+        }
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        out->center[axis] = 0.5f * (out->min[axis] + out->max[axis]);
+    }
+
+    // Sphere about the box center: skinning again is cheaper than keeping
+    // every frame's vertices around
+    float radius2 = 0.0f;
+    for (uint32_t f = 0; f < frame_count; f++) {
+        skin_vertices(palettes + f * pose_size, palette_count, &positions, &frame, threads);
+        for (uint32_t v = 0; v < n; v++) {
+            float dx = frame.px[v] - out->center[0];
+            float dy = frame.py[v] - out->center[1];
+            float dz = frame.pz[v] - out->center[2];
+            float d2 = dx * dx + dy * dy + dz * dz;
+            if (d2 > radius2) radius2 = d2;
+        }
+    }
+    out->radius = sqrtf(radius2);
+    free(skinned);
+    return 1;
+}
@@ -0,0 +1,23 @@
+#ifndef CLIP_BOUNDS_H
+#define CLIP_BOUNDS_H
+
+#include "skinning.h"
+
+// Conservative culling volumes for an animation clip: the mesh is skinned on
+// the CPU at each sampled frame and the box and sphere cover every vertex of
+// every one of them, so a runtime can cull a playing unit without skinning.
+
+typedef struct {
+    float min[3];
+    float max[3];
+    float center[3];    // box center
+    float radius;       // sphere about center holding every skinned vertex
+} ClipBounds;
+
+// palettes holds frame_count poses of palette_count matrices each (see
+// skin_palette_build), one after the other. Returns 0 on allocation failure
+// or when there is nothing to bound.
+int clip_bounds_compute(const float *palettes, uint32_t frame_count, uint32_t palette_count,
+                        const SkinInput *in, int threads, ClipBounds *out);
+
+#endif // CLIP_BOUNDS_H
@@ -0,0 +1,251 @@
+#include "curve_fit.h"
+#include "transform.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_COMPONENTS 4
+#define TANGENT_WINDOW 5
+
+typedef struct {
+    const float *times;
+    const float *data;       // samples, sign-continuous for rotations
+    const float *tangents;   // per sample, units per second
+    uint32_t count;
+    int components;
+    int is_rotation;
+} TrackSamples;
+
+static float sample_error(const TrackSamples *track, const float *value, uint32_t i) {
+    const float *sample = &track->data[i * track->components];
+    if (track->is_rotation) {
+        float len = sqrtf(value[0] * value[0] + value[1] * value[1] + value[2] * value[2] + value[3] * value[3]);
+        if (len <= 0.0f) return 3.14159265f;
+        float d = fabsf(value[0] * sample[0] + value[1] * sample[1] + value[2] * sample[2] + value[3] * sample[3]) / len;
+        return 2.0f * acosf(d < 1.0f ? d : 1.0f);
+    }
+    float sum = 0.0f;
+    for (int c = 0; c < track->components; c++) {
+        float d = value[c] - sample[c];
+        sum += d * d;
+    }
+    return sqrtf(sum);
+}
+
+// Curve value at sample i when a and b are the keys around it
+static void evaluate_segment(const TrackSamples *track, uint32_t a, uint32_t b, uint32_t i, int cubic, float *out) {
+    int n = track->components;
+    float td = track->times[b] - track->times[a];
+    float u = td > 0.0f ? (track->times[i] - track->times[a]) / td : 0.0f;
+    const float *pa = &track->data[a * n], *pb = &track->data[b * n];
+
+    if (cubic) {
+        const float *ma = &track->tangents[a * n], *mb = &track->tangents[b * n];
+        float u2 = u * u, u3 = u2 * u;
+        float h00 = 2.0f * u3 - 3.0f * u2 + 1.0f;
+        float h10 = u3 - 2.0f * u2 + u;
+        float h01 = -2.0f * u3 + 3.0f * u2;
+        float h11 = u3 - u2;
+        for (int c = 0; c < n; c++) {
+            out[c] = h00 * pa[c] + h10 * td * ma[c] + h01 * pb[c] + h11 * td * mb[c];
+        }
+    } else if (track->is_rotation) {
+        Quaternion q = quat_slerp((Quaternion){pa[0], pa[1], pa[2], pa[3]},
+                                  (Quaternion){pb[0], pb[1], pb[2], pb[3]}, u);
+        out[0] = q.x;
+        out[1] = q.y;
+        out[2] = q.z;
+        out[3] = q.w;
+    } else {
+        for (int c = 0; c < n; c++) {
+            out[c] = pa[c] + (pb[c] - pa[c]) * u;
+        }
+    }
+}
+
+// Derivative at sample i of the polynomial through the TANGENT_WINDOW nearest
+// samples (shifted inwards at the ends), so tangents stay accurate on the
+// first and last keys too
+static void estimate_tangent(const float *times, const float *data, uint32_t count, int components,
+                             uint32_t i, float *out) {
+    uint32_t window = count < TANGENT_WINDOW ? count : TANGENT_WINDOW;
+    uint32_t first = i > window / 2 ? i - window / 2 : 0;
+    if (first + window > count) first = count - window;
+
+    for (int c = 0; c < components; c++) out[c] = 0.0f;
+    for (uint32_t k = first; k < first + window; k++) {
+        // Derivative of the Lagrange basis polynomial of sample k at times[i]
+        double weight;
+        if (k == i) {
+            weight = 0.0;
+            for (uint32_t m = first; m < first + window; m++) {
+                if (m != i && times[i] != times[m]) weight += 1.0 / ((double)times[i] - times[m]);
+            }
+        } else {
+            double num = 1.0, den = (double)times[k] - times[i];
+            for (uint32_t m = first; m < first + window; m++) {
+                if (m == k || m == i) continue;
+                num *= (double)times[i] - times[m];
+                den *= (double)times[k] - times[m];
+            }
+            if (den == 0.0) continue;
+            weight = num / den;
+        }
+        for (int c = 0; c < components; c++) {
+            out[c] += (float)(weight * data[k * components + c]);
+        }
+    }
+}
+
+// Worst sample strictly between keys a and b, or 0 if all are within max_error
+static uint32_t worst_sample(const TrackSamples *track, uint32_t a, uint32_t b, int cubic, float max_error) {
+    uint32_t worst = 0;
+    float worst_error = max_error;
+    float value[MAX_COMPONENTS];
+    for (uint32_t i = a + 1; i < b; i++) {
+        evaluate_segment(track, a, b, i, cubic, value);
+        float error = sample_error(track, value, i);
+        if (error > worst_error) {
+            worst_error = error;
+            worst = i;
+        }
+    }
+    return worst;
+}
+
+// Mark the keys needed to stay within max_error; returns their count. Each
+// segment reaches as far as it can: the span doubles until it fails, then a
+// binary search finds the last end that still passes.
+static uint32_t select_keys(const TrackSamples *track, int cubic, float max_error, uint8_t *keep) {
+    memset(keep, 0, track->count);
+    keep[0] = 1;
+    uint32_t keys = 1;
+    uint32_t last = track->count - 1;
+
+    uint32_t a = 0;
+    while (a < last) {
+        uint32_t good = a + 1, bad = 0;
+        for (uint32_t span = 2; ; span *= 2) {
+            uint32_t b = span < last - a ? a + span : last;
+            if (worst_sample(track, a, b, cubic, max_error)) {
+                bad = b;
+                break;
+            }
+            good = b;
+            if (b == last) break;
+        }
+        while (bad && bad - good > 1) {
+            uint32_t mid = good + (bad - good) / 2;
+            if (worst_sample(track, a, mid, cubic, max_error)) {
+                bad = mid;
+            } else {
+                good = mid;
+            }
+        }
+        keep[good] = 1;
+        keys++;
+        a = good;
+    }
+    return keys;
+}
+
+int fit_track(const float *times, const float *samples, uint32_t count, int components,
+              int is_rotation, float max_error, FittedTrack *out) {
+    memset(out, 0, sizeof(*out));
+    out->components = components;
+    if (count == 0 || components < 1 || components > MAX_COMPONENTS) return 1;
+
+    size_t n = (size_t)count * components;
+    float *data = malloc(n * sizeof(float));
+    float *tangents = malloc(n * sizeof(float));
+    uint8_t *keep_cubic = malloc(count);
+    uint8_t *keep_linear = malloc(count);
+    int ok = data && tangents && keep_cubic && keep_linear;
+    if (!ok) goto cleanup;
+
+    memcpy(data, samples, n * sizeof(float));
+    if (is_rotation) {
+        for (uint32_t i = 1; i < count; i++) {
+            float *q = &data[i * 4], *p = &data[(i - 1) * 4];
+            if (q[0] * p[0] + q[1] * p[1] + q[2] * p[2] + q[3] * p[3] < 0.0f) {
+                q[0] = -q[0];
+                q[1] = -q[1];
+                q[2] = -q[2];
+                q[3] = -q[3];
+            }
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        estimate_tangent(times, data, count, components, i, &tangents[i * components]);
+    }
+    TrackSamples track = {times, data, tangents, count, components, is_rotation};
+
+    // Holds still: one key
+    uint32_t still = 1;
+    for (uint32_t i = 1; i < count && still; i++) {
+        still = sample_error(&track, data, i) <= max_error;
+    }
+
+    uint32_t cubic_keys = count, linear_keys = count;
+    int cubic = 0;
+    if (still) {
+        memset(keep_linear, 0, count);
+        keep_linear[0] = 1;
+        linear_keys = 1;
+    } else {
+        cubic_keys = select_keys(&track, 1, max_error, keep_cubic);
+        linear_keys = select_keys(&track, 0, max_error, keep_linear);
+        size_t cubic_size = (size_t)cubic_keys * (1 + 3 * components);
+        size_t linear_size = (size_t)linear_keys * (1 + components);
+        cubic = cubic_size < linear_size;
+    }
+
+    const uint8_t *keep = cubic ? keep_cubic : keep_linear;
+    uint32_t keys = cubic ? cubic_keys : linear_keys;
+    int stride = cubic ? 3 * components : components;
+    out->times = malloc(keys * sizeof(float));
+    out->values = malloc((size_t)keys * stride * sizeof(float));
+    if (!out->times || !out->values) {
+        fitted_track_free(out);
+        ok = 0;
+        goto cleanup;
+    }
+    out->key_count = keys;
+    out->cubic = cubic;
+
+    uint32_t k = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (!keep[i]) continue;
+        out->times[k] = times[i];
+        float *dst = &out->values[(size_t)k * stride];
+        if (cubic) {
+            memcpy(dst, &tangents[i * components], components * sizeof(float));
+            memcpy(dst + components, &data[i * components], components * sizeof(float));
+            memcpy(dst + 2 * components, &tangents[i * components], components * sizeof(float));
+        } else {
+            memcpy(dst, &data[i * components], components * sizeof(float));
+        }
+        k++;
+    }
+
+cleanup:
+    free(data);
+    free(tangents);
+    free(keep_cubic);
+    free(keep_linear);
+    return ok;
+}
+
+void fitted_track_free(FittedTrack *track) {
+    if (!track) return;
+    free(track->times);
+    free(track->values);
+    track->times = NULL;
+    track->values = NULL;
+    track->key_count = 0;
+}
+
+size_t fitted_track_size(const FittedTrack *track) {
+    size_t stride = track->cubic ? 3 * (size_t)track->components : (size_t)track->components;
+    return (size_t)track->key_count * (1 + stride) * sizeof(float);
+}
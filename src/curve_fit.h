@@ -0,0 +1,36 @@
+#ifndef CURVE_FIT_H
+#define CURVE_FIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Key reduction for densely sampled animation tracks. Keys are picked
+// greedily, each segment reaching as far as it can while every dropped
+// sample stays within the error bound, once with glTF CUBICSPLINE
+// interpolation (Hermite, tangents from the samples around each key) and
+// once with LINEAR; the smaller encoding wins. A track that never leaves the bound
+// of its first sample collapses to a single key.
+//
+// Rotation tracks are quaternions (x, y, z, w): their error is the angle in
+// radians between the normalized curve and the sample, LINEAR segments are
+// slerped as glTF viewers do, and sign flips between samples are removed.
+
+typedef struct {
+    uint32_t key_count;
+    int components;      // 3 for translations, 4 for rotations
+    int cubic;           // 1: CUBICSPLINE, values hold in-tangent, value, out-tangent per key
+    float *times;        // key_count entries
+    float *values;       // key_count * components, times 3 when cubic
+} FittedTrack;
+
+// Fit count samples (components floats each) taken at times. Returns 0 on
+// allocation failure.
+int fit_track(const float *times, const float *samples, uint32_t count, int components,
+              int is_rotation, float max_error, FittedTrack *out);
+
+void fitted_track_free(FittedTrack *track);
+
+// Bytes the track takes in the buffer: times plus output values
+size_t fitted_track_size(const FittedTrack *track);
+
+#endif // CURVE_FIT_H
@@ -9,11 +9,23 @@
 
 #ifdef _WIN32
 #include <windows.h>
+#include <ctype.h>
 #else
 #include <dirent.h>
 #include <fnmatch.h>
 #endif
 
+#ifdef _WIN32
+#define PATH_SEPARATOR "\\"
+// Windows file names are case-insensitive
+#define name_compare _stricmp
+#define name_ncompare _strnicmp
+#else
+#define PATH_SEPARATOR "/"
+#define name_compare strcmp
+#define name_ncompare strncmp
+#endif
+
 static FileList* create_file_list(void) {
     FileList *list = malloc(sizeof(FileList));
     if (!list) return NULL;
@@ -38,46 +50,180 @@ static void add_file_to_list(FileList *list, const char *filepath) {
     list->paths[list->count++] = my_strdup(filepath);
 }
 
-FileList* find_files(const char *directory, const char *pattern) {
-    FileList *list = create_file_list();
-    if (!list) return NULL;
+static int add_name_to_index(DirIndex *index, const char *name) {
+    if (index->count >= index->capacity) {
+        uint32_t new_capacity = index->capacity ? index->capacity * 2 : 64;
+        char **names = realloc(index->names, new_capacity * sizeof(char*));
+        if (!names) return 0;
+        index->names = names;
+        index->capacity = new_capacity;
+    }
+    index->names[index->count] = my_strdup(name);
+    if (!index->names[index->count]) return 0;
+    index->count++;
+    return 1;
+}
+
+static int compare_names(const void *a, const void *b) {
+    return name_compare(*(const char *const *)a, *(const char *const *)b);
+}
+
+// Wildcard match for '*' and '?' (case-insensitive on Windows)
+static int match_pattern(const char *pattern, const char *name) {
+#ifdef _WIN32
+    const char *star = NULL;
+    const char *resume = NULL;
+    while (*name) {
+        if (*pattern == '*') {
+            star = pattern++;
+            resume = name;
+        } else if (*pattern == '?' || tolower((unsigned char)*pattern) == tolower((unsigned char)*name)) {
+            pattern++;
+            name++;
+        } else if (star) {
+            pattern = star + 1;
+            name = ++resume;
+        } else {
+            return 0;
+        }
+    }
+    while (*pattern == '*') pattern++;
+    return *pattern == '\0';
+#else
+    return fnmatch(pattern, name, 0) == 0;
+#endif
+}
 
+DirIndex* dir_index_build(const char *directory) {
+    DirIndex *index = calloc(1, sizeof(DirIndex));
+    if (!index) return NULL;
+    index->directory = my_strdup(directory);
+    if (!index->directory) {
+        free(index);
+        return NULL;
+    }
+
+    int ok = 1;
 #ifdef _WIN32
     WIN32_FIND_DATAA find_data;
     char search_path[512];
-    snprintf(search_path, sizeof(search_path), "%s\\%s", directory, pattern);
-    
+    snprintf(search_path, sizeof(search_path), "%s\\*", directory);
+
     HANDLE hFind = FindFirstFileA(search_path, &find_data);
     if (hFind != INVALID_HANDLE_VALUE) {
         do {
             if (!(find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
-                char filepath[512];
-                snprintf(filepath, sizeof(filepath), "%s\\%s", directory, find_data.cFileName);
-                add_file_to_list(list, filepath);
+                ok = add_name_to_index(index, find_data.cFileName);
             }
-        } while (FindNextFileA(hFind, &find_data));
+        } while (ok && FindNextFileA(hFind, &find_data));
         FindClose(hFind);
     }
 #else
     DIR *dir = opendir(directory);
     if (dir) {
         struct dirent *entry;
-        while ((entry = readdir(dir)) != NULL) {
+        while (ok && (entry = readdir(dir)) != NULL) {
             if (entry->d_type == DT_REG || entry->d_type == DT_UNKNOWN) {
-                if (fnmatch(pattern, entry->d_name, 0) == 0) {
-                    char filepath[512];
-                    snprintf(filepath, sizeof(filepath), "%s/%s", directory, entry->d_name);
-                    add_file_to_list(list, filepath);
-                }
+                ok = add_name_to_index(index, entry->d_name);
             }
         }
         closedir(dir);
     }
 #endif
 
+    if (!ok) {
+        dir_index_free(index);
+        return NULL;
+    }
+    if (index->count > 1) {
+        qsort(index->names, index->count, sizeof(char*), compare_names);
+    }
+    return index;
+}
+
+FileList* dir_index_find(const DirIndex *index, const char *pattern) {
+    FileList *list = create_file_list();
+    if (!list) return NULL;
+
+    // Literal prefix of the pattern bounds the range of candidate names
+    size_t prefix_len = strcspn(pattern, "*?[\\");
+
+    uint32_t lo = 0;
+    uint32_t hi = index->count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (name_ncompare(index->names[mid], pattern, prefix_len) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    char filepath[512];
+    for (uint32_t i = lo; i < index->count; i++) {
+        if (name_ncompare(index->names[i], pattern, prefix_len) != 0) break;
+        if (match_pattern(pattern, index->names[i])) {
+            snprintf(filepath, sizeof(filepath), "%s" PATH_SEPARATOR "%s", index->directory, index->names[i]);
+            add_file_to_list(list, filepath);
+        }
+    }
     return list;
 }
 
+void dir_index_free(DirIndex *index) {
+    if (!index) return;
+    for (uint32_t i = 0; i < index->count; i++) {
+        free(index->names[i]);
+    }
+    free(index->names);
+    free(index->directory);
+    free(index);
+}
+
+FileList* find_files(const char *directory, const char *pattern) {
+    DirIndex *index = dir_index_build(directory);
+    if (!index) return NULL;
+    FileList *list = dir_index_find(index, pattern);
+    dir_index_free(index);
+    return list;
+}
+
+void dir_index_cache_init(DirIndexCache *cache) {
+    cache->indices = NULL;
+    cache->count = 0;
+    cache->capacity = 0;
+}
+
+void dir_index_cache_free(DirIndexCache *cache) {
+    for (uint32_t i = 0; i < cache->count; i++) {
+        dir_index_free(cache->indices[i]);
+    }
+    free(cache->indices);
+    dir_index_cache_init(cache);
+}
+
+const DirIndex* dir_index_cache_get(DirIndexCache *cache, const char *directory) {
+    // A batch touches few directories; a linear scan over them is enough
+    for (uint32_t i = 0; i < cache->count; i++) {
+        if (strcmp(cache->indices[i]->directory, directory) == 0) return cache->indices[i];
+    }
+
+    DirIndex *index = dir_index_build(directory);
+    if (!index) return NULL;
+    if (cache->count >= cache->capacity) {
+        uint32_t new_capacity = cache->capacity ? cache->capacity * 2 : 4;
+        DirIndex **indices = realloc(cache->indices, new_capacity * sizeof(DirIndex*));
+        if (!indices) {
+            dir_index_free(index);
+            return NULL;
+        }
+        cache->indices = indices;
+        cache->capacity = new_capacity;
+    }
+    cache->indices[cache->count++] = index;
+    return index;
+}
+
 void free_file_list(FileList *list) {
     if (!list) return;
     
@@ -87,3 +233,34 @@ void free_file_list(FileList *list) {
     free(list->paths);
     free(list);
 }
+
+char* read_file(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+
+    if (fseek(f, 0, SEEK_END) != 0) {
+        fclose(f);
+        return NULL;
+    }
+    long length = ftell(f);
+    if (length < 0 || fseek(f, 0, SEEK_SET) != 0) {
+        fclose(f);
+        return NULL;
+    }
+
+    char *content = malloc((size_t)length + 1);
+    if (!content) {
+        fclose(f);
+        return NULL;
+    }
+    if (fread(content, 1, (size_t)length, f) != (size_t)length) {
+        free(content);
+        fclose(f);
+        return NULL;
+    }
+    fclose(f);
+
+    content[length] = '\0';
+    if (size) *size = (size_t)length;
+    return content;
+}
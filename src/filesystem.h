@@ -1,6 +1,7 @@
 #ifndef FILESYSTEM_H
 #define FILESYSTEM_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 // Structure to hold a list of file paths
@@ -10,14 +11,45 @@ typedef struct {
     uint32_t capacity;
 } FileList;
 
-// Find all files matching a pattern in a directory
+// Find all files matching a pattern in a directory, sorted by name
 // Pattern examples: "*.psa", "horse_*.psa"
 FileList* find_files(const char *directory, const char *pattern);
 
+// Sorted listing of the regular files of one directory, read once.
+// Patterns with a literal prefix ("horse_*.psa") are answered by binary
+// search over the names, so many queries cost one directory scan.
+typedef struct {
+    char *directory;
+    char **names;
+    uint32_t count;
+    uint32_t capacity;
+} DirIndex;
+
+DirIndex* dir_index_build(const char *directory);
+// Files of the index matching pattern, as full paths in name order
+FileList* dir_index_find(const DirIndex *index, const char *pattern);
+void dir_index_free(DirIndex *index);
+
+// One index per directory for the whole run
+typedef struct {
+    DirIndex **indices;
+    uint32_t count;
+    uint32_t capacity;
+} DirIndexCache;
+
+void dir_index_cache_init(DirIndexCache *cache);
+void dir_index_cache_free(DirIndexCache *cache);
+// Index for directory, built on first use. Owned by the cache.
+const DirIndex* dir_index_cache_get(DirIndexCache *cache, const char *directory);
+
 
 #include "portable_string.h"
 
 // Free a FileList structure
 void free_file_list(FileList *list);
 
+// Read a whole file into a NUL-terminated buffer (caller frees).
+// Returns NULL if the file cannot be opened or fully read.
+char* read_file(const char *path, size_t *size);
+
 #endif // FILESYSTEM_H
@@ -0,0 +1,267 @@
+#include "float_format.h"
+#include <stdint.h>
+#include <string.h>
+
+// Ryu for float32 (Ulf Adams, "Ryu: fast float-to-string conversion",
+// PLDI 2018): the interval of decimals that round to the float is scaled
+// by 2^e2 / 10^q with 64-bit fixed-point powers of 5, and digits are
+// removed while both interval ends still differ.
+
+#define POW5_INV_BITCOUNT 59
+#define POW5_BITCOUNT 61
+
+// ceil(2^(pow5_bits(i) - 1 + 59) / 5^i)
+static const uint64_t POW5_INV_SPLIT[31] = {
+    0x0800000000000001u, 0x0666666666666667u, 0x051eb851eb851eb9u,
+    0x04189374bc6a7efau, 0x068db8bac710cb2au, 0x053e2d6238da3c22u,
+    0x0431bde82d7b634eu, 0x06b5fca6af2bd216u, 0x055e63b88c230e78u,
+    0x044b82fa09b5a52du, 0x06df37f675ef6eaeu, 0x057f5ff85e592558u,
+    0x0465e6604b7a8447u, 0x0709709a125da071u, 0x05a126e1a84ae6c1u,
+    0x0480ebe7b9d58567u, 0x0734aca5f6226f0bu, 0x05c3bd5191b525a3u,
+    0x049c97747490eae9u, 0x0760f253edb4ab0eu, 0x05e72843249088d8u,
+    0x04b8ed0283a6d3e0u, 0x078e480405d7b966u, 0x060b6cd004ac9452u,
+    0x04d5f0a66a23a9dbu, 0x07bcb43d769f762bu, 0x063090312bb2c4efu,
+    0x04f3a68dbc8f03f3u, 0x07ec3daf94180651u, 0x065697bfa9acd1dau,
+    0x051212ffbaf0a7e2u
+};
+
+// 5^i scaled to 61 significant bits
+static const uint64_t POW5_SPLIT[47] = {
+    0x1000000000000000u, 0x1400000000000000u, 0x1900000000000000u,
+    0x1f40000000000000u, 0x1388000000000000u, 0x186a000000000000u,
+    0x1e84800000000000u, 0x1312d00000000000u, 0x17d7840000000000u,
+    0x1dcd650000000000u, 0x12a05f2000000000u, 0x174876e800000000u,
+    0x1d1a94a200000000u, 0x12309ce540000000u, 0x16bcc41e90000000u,
+    0x1c6bf52634000000u, 0x11c37937e0800000u, 0x16345785d8a00000u,
+    0x1bc16d674ec80000u, 0x1158e460913d0000u, 0x15af1d78b58c4000u,
+    0x1b1ae4d6e2ef5000u, 0x10f0cf064dd59200u, 0x152d02c7e14af680u,
+    0x1a784379d99db420u, 0x108b2a2c28029094u, 0x14adf4b7320334b9u,
+    0x19d971e4fe8401e7u, 0x1027e72f1f128130u, 0x1431e0fae6d7217cu,
+    0x193e5939a08ce9dbu, 0x1f8def8808b02452u, 0x13b8b5b5056e16b3u,
+    0x18a6e32246c99c60u, 0x1ed09bead87c0378u, 0x13426172c74d822bu,
+    0x1812f9cf7920e2b6u, 0x1e17b84357691b64u, 0x12ced32a16a1b11eu,
+    0x178287f49c4a1d66u, 0x1d6329f1c35ca4bfu, 0x125dfa371a19e6f7u,
+    0x16f578c4e0a060b5u, 0x1cb2d6f618c878e3u, 0x11efc659cf7d4b8du,
+    0x166bb7f0435c9e71u, 0x1c06a5ec5433c60du
+};
+
+// Bits of 5^e, for 0 <= e <= 3528
+static int32_t pow5_bits(int32_t e) {
+    return (int32_t)(((uint32_t)e * 1217359) >> 19) + 1;
+}
+
+// floor(log10(2^e)) and floor(log10(5^e)), for 0 <= e <= 1650
+static uint32_t log10_pow2(int32_t e) {
+    return ((uint32_t)e * 78913) >> 18;
+}
+
+static uint32_t log10_pow5(int32_t e) {
+    return ((uint32_t)e * 732923) >> 20;
+}
+
+static int multiple_of_pow5(uint32_t value, uint32_t p) {
+    uint32_t count = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        count++;
+    }
+    return count >= p;
+}
+
+static int multiple_of_pow2(uint32_t value, uint32_t p) {
+    return (value & ((1u << p) - 1)) == 0;
+}
+
+// (m * factor) >> shift, shift > 32
+static uint32_t mul_shift(uint32_t m, uint64_t factor, int32_t shift) {
+    uint64_t low = (uint64_t)m * (uint32_t)factor;
+    uint64_t high = (uint64_t)m * (uint32_t)(factor >> 32);
+    return (uint32_t)(((low >> 32) + high) >> (shift - 32));
+}
+
+static uint32_t decimal_length(uint32_t v) {
+    uint32_t length = 1;
+    while (v >= 10) {
+        v /= 10;
+        length++;
+    }
+    return length;
+}
+
+// Shortest decimal digits * 10^exponent for a finite, nonzero float
+static uint32_t shortest_decimal(uint32_t ieee_mantissa, uint32_t ieee_exponent, int32_t *exponent) {
+    int32_t e2;
+    uint32_t m2;
+    if (ieee_exponent == 0) {
+        e2 = 1 - 127 - 23 - 2;
+        m2 = ieee_mantissa;
+    } else {
+        e2 = (int32_t)ieee_exponent - 127 - 23 - 2;
+        m2 = (1u << 23) | ieee_mantissa;
+    }
+    int accept_bounds = (m2 & 1) == 0;
+
+    // Interval [mm, mp] of values rounding to the float, times 4
+    uint32_t mv = 4 * m2;
+    uint32_t mp = 4 * m2 + 2;
+    uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+    uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+    uint32_t vr, vp, vm;
+    int32_t e10;
+    int vm_trailing_zeros = 0;
+    int vr_trailing_zeros = 0;
+    uint32_t last_removed = 0;
+    if (e2 >= 0) {
+        uint32_t q = log10_pow2(e2);
+        e10 = (int32_t)q;
+        int32_t k = POW5_INV_BITCOUNT + pow5_bits((int32_t)q) - 1;
+        int32_t i = -e2 + (int32_t)q + k;
+        vr = mul_shift(mv, POW5_INV_SPLIT[q], i);
+        vp = mul_shift(mp, POW5_INV_SPLIT[q], i);
+        vm = mul_shift(mm, POW5_INV_SPLIT[q], i);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            // The loop below removes at most one digit; compute it here
+            int32_t l = POW5_INV_BITCOUNT + pow5_bits((int32_t)q - 1) - 1;
+            last_removed = mul_shift(mv, POW5_INV_SPLIT[q - 1], -e2 + (int32_t)q - 1 + l) % 10;
+        }
+        if (q <= 9) {
+            // Only one of mp, mv and mm can be a multiple of 5
+            if (mv % 5 == 0) {
+                vr_trailing_zeros = multiple_of_pow5(mv, q);
+            } else if (accept_bounds) {
+                vm_trailing_zeros = multiple_of_pow5(mm, q);
+            } else {
+                vp -= (uint32_t)multiple_of_pow5(mp, q);
+            }
+        }
+    } else {
+        uint32_t q = log10_pow5(-e2);
+        e10 = (int32_t)q + e2;
+        int32_t i = -e2 - (int32_t)q;
+        int32_t k = pow5_bits(i) - POW5_BITCOUNT;
+        int32_t j = (int32_t)q - k;
+        vr = mul_shift(mv, POW5_SPLIT[i], j);
+        vp = mul_shift(mp, POW5_SPLIT[i], j);
+        vm = mul_shift(mm, POW5_SPLIT[i], j);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            j = (int32_t)q - 1 - (pow5_bits(i + 1) - POW5_BITCOUNT);
+            last_removed = mul_shift(mv, POW5_SPLIT[i + 1], j) % 10;
+        }
+        if (q <= 1) {
+            // mv has at least q trailing zero bits; mm too unless shifted
+            vr_trailing_zeros = 1;
+            if (accept_bounds) {
+                vm_trailing_zeros = mm_shift == 1;
+            } else {
+                vp--;
+            }
+        } else if (q < 31) {
+            vr_trailing_zeros = multiple_of_pow2(mv, q - 1);
+        }
+    }
+
+    // Drop digits while the interval still holds a shorter decimal
+    int32_t removed = 0;
+    uint32_t output;
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed == 0;
+            last_removed = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_removed == 0;
+                last_removed = vr % 10;
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        // Exactly halfway: round to even
+        if (vr_trailing_zeros && last_removed == 5 && vr % 2 == 0) last_removed = 4;
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed >= 5);
+    } else {
+        while (vp / 10 > vm / 10) {
+            last_removed = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || last_removed >= 5);
+    }
+    *exponent = e10 + removed;
+    return output;
+}
+
+int format_float_shortest(float value, char *out) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t ieee_mantissa = bits & ((1u << 23) - 1);
+    uint32_t ieee_exponent = (bits >> 23) & 0xFF;
+    if (ieee_exponent == 0xFF) {
+        memcpy(out, "null", 5);
+        return 4;
+    }
+    if (ieee_exponent == 0 && ieee_mantissa == 0) {
+        memcpy(out, "0", 2);
+        return 1;
+    }
+
+    int32_t exponent;
+    uint32_t output = shortest_decimal(ieee_mantissa, ieee_exponent, &exponent);
+    char digits[10];
+    int32_t length = (int32_t)decimal_length(output);
+    for (int32_t d = length - 1; d >= 0; d--) {
+        digits[d] = (char)('0' + output % 10);
+        output /= 10;
+    }
+
+    int n = 0;
+    if (bits >> 31) out[n++] = '-';
+    // Position of the decimal point after the first digit, as in %g
+    int32_t point = length + exponent;
+    if (point >= -3 && point <= 17) {
+        if (point <= 0) {
+            out[n++] = '0';
+            out[n++] = '.';
+            for (int32_t z = point; z < 0; z++) out[n++] = '0';
+            memcpy(out + n, digits, (size_t)length);
+            n += length;
+        } else if (point >= length) {
+            memcpy(out + n, digits, (size_t)length);
+            n += length;
+            for (int32_t z = length; z < point; z++) out[n++] = '0';
+        } else {
+            memcpy(out + n, digits, (size_t)point);
+            n += point;
+            out[n++] = '.';
+            memcpy(out + n, digits + point, (size_t)(length - point));
+            n += length - point;
+        }
+    } else {
+        out[n++] = digits[0];
+        if (length > 1) {
+            out[n++] = '.';
+            memcpy(out + n, digits + 1, (size_t)(length - 1));
+            n += length - 1;
+        }
+        int32_t e = point - 1;
+        out[n++] = 'e';
+        if (e < 0) {
+            out[n++] = '-';
+            e = -e;
+        }
+        if (e >= 10) out[n++] = (char)('0' + e / 10);
+        out[n++] = (char)('0' + e % 10);
+    }
+    out[n] = '\0';
+    return n;
+}
@@ -0,0 +1,18 @@
+#ifndef FLOAT_FORMAT_H
+#define FLOAT_FORMAT_H
+
+// Shortest round-trip text for float32 values (Ryu): the fewest decimal
+// digits that parse back (strtof) to the same float. Used for the JSON
+// numbers of the exporter instead of cJSON's %1.15g / %1.17g retry, which
+// prints the float widened to double, e.g. 0.100000001490116 for 0.1f.
+// Output does not depend on the C locale.
+
+// Longest output plus the terminating NUL
+#define FLOAT_FORMAT_SIZE 24
+
+// Writes value to out (FLOAT_FORMAT_SIZE bytes) and returns its length.
+// Plain notation when the decimal exponent is in [-4, 17), like %g,
+// otherwise "<digits>e<exp>". -0 prints as 0, NaN and infinities as null.
+int format_float_shortest(float value, char *out);
+
+#endif // FLOAT_FORMAT_H
@@ -18,41 +18,24 @@
 #include "json_builder.h"
 #include "cJSON.h"
 #include "gltf_exporter.h"
-
-// Helper: build matrix from BoneState
-void make_matrix(const BoneState *bs, float *out) {
-    float x = bs->rotation.x, y = bs->rotation.y, z = bs->rotation.z, w = bs->rotation.w;
-    float xx = x*x, yy = y*y, zz = z*z;
-    float xy = x*y, xz = x*z, yz = y*z;
-    float wx = w*x, wy = w*y, wz = w*z;
-    out[0] = 1.0f - 2.0f*(yy + zz);
-    out[1] = 2.0f*(xy + wz);
-    out[2] = 2.0f*(xz - wy);
-    out[3] = 0.0f;
-    out[4] = 2.0f*(xy - wz);
-    out[5] = 1.0f - 2.0f*(xx + zz);
-    out[6] = 2.0f*(yz + wx);
-    out[7] = 0.0f;
-    out[8] = 2.0f*(xz + wy);
-    out[9] = 2.0f*(yz - wx);
-    out[10] = 1.0f - 2.0f*(xx + yy);
-    out[11] = 0.0f;
-    out[12] = bs->translation.x;
-    out[13] = bs->translation.y;
-    out[14] = bs->translation.z;
-    out[15] = 1.0f;
-}
-
-void invert_affine(const float *m, float *out) {
-    out[0]=m[0]; out[1]=m[4]; out[2]=m[8];  out[3]=0.0f;
-    out[4]=m[1]; out[5]=m[5]; out[6]=m[9];  out[7]=0.0f;
-    out[8]=m[2]; out[9]=m[6]; out[10]=m[10]; out[11]=0.0f;
-    float tx = m[12], ty = m[13], tz = m[14];
-    out[12] = -(out[0]*tx + out[4]*ty + out[8]*tz);
-    out[13] = -(out[1]*tx + out[5]*ty + out[9]*tz);
-    out[14] = -(out[2]*tx + out[6]*ty + out[10]*tz);
-    out[15] = 1.0f;
-}
+#include "pose.h"
+#include "transform.h"
+#include "binary_io.h"
+#include "mesh_simplify.h"
+#include "anim_resample.h"
+#include "curve_fit.h"
+#include "skinning.h"
+#include "parallel.h"
+#include "accessor_stats.h"
+#include "clip_bounds.h"
+#include "joint_bounds.h"
+#include "anim_library.h"
+#include "output_writer.h"
+
+#define GLB_MAGIC       0x46546C67u   // "glTF"
+#define GLB_VERSION     2u
+#define GLB_CHUNK_JSON  0x4E4F534Au   // "JSON"
+#define GLB_CHUNK_BIN   0x004E4942u   // "BIN\0"
 
 static char* create_data_uri(const void *data, size_t size) {
     static const char base64_chars[] =
@@ -83,53 +66,896 @@ static char* create_data_uri(const void *data, size_t size) {
     return encoded;
 }
 
-// Quaternion inverse
-static Quaternion quat_inverse(Quaternion q) {
-    float len2 = q.x*q.x + q.y*q.y + q.z*q.z + q.w*q.w;
-    return (Quaternion){-q.x/len2, -q.y/len2, -q.z/len2, q.w/len2};
+// Group prop points by parent bone in one pass (CSR layout): props attached to
+// bone b are prop_order[offsets[b] .. offsets[b+1]), and props whose parent is
+// missing are prop_order[offsets[numBones] .. numPropPoints)
+static int bucket_prop_points(const PMDModel *model, uint32_t **offsets_out, uint32_t **order_out) {
+    uint32_t *offsets = calloc(model->numBones + 2, sizeof(uint32_t));
+    uint32_t *order = calloc(model->numPropPoints ? model->numPropPoints : 1, sizeof(uint32_t));
+    if (!offsets || !order) {
+        free(offsets);
+        free(order);
+        return 0;
+    }
+
+    for (uint32_t p = 0; p < model->numPropPoints; p++) {
+        uint32_t bucket = model->propPoints[p].bone;
+        if (bucket >= model->numBones) bucket = model->numBones;
+        offsets[bucket + 1]++;
+    }
+    for (uint32_t b = 0; b <= model->numBones; b++) {
+        offsets[b + 1] += offsets[b];
+    }
+    uint32_t *fill = calloc(model->numBones + 1, sizeof(uint32_t));
+    if (!fill) {
+        free(offsets);
+        free(order);
+        return 0;
+    }
+    for (uint32_t p = 0; p < model->numPropPoints; p++) {
+        uint32_t bucket = model->propPoints[p].bone;
+        if (bucket >= model->numBones) bucket = model->numBones;
+        order[offsets[bucket] + fill[bucket]++] = p;
+    }
+    free(fill);
+
+    *offsets_out = offsets;
+    *order_out = order;
+    return 1;
 }
 
-// Quaternion multiply
-static Quaternion quat_mul(Quaternion a, Quaternion b) {
-    return (Quaternion){
-        a.w*b.x + a.x*b.w + a.y*b.z - a.z*b.y,
-        a.w*b.y - a.x*b.z + a.y*b.w + a.z*b.x,
-        a.w*b.z + a.x*b.y - a.y*b.x + a.z*b.w,
-        a.w*b.w - a.x*b.x - a.y*b.y - a.z*b.z
-    };
+// Binary views in the order they are referenced by accessors. How they are
+// laid out in buffers (data URIs, .bin, GLB chunk) is decided at write time.
+typedef struct {
+    const void *data;
+    size_t size;
+    size_t stride;      // byteStride, 0 when tightly packed
+    int shared;         // stored in the shared animation file at shared_offset
+    uint64_t shared_offset;
+    int deferred;       // no data yet: streamed into the .bin at stream_offset
+    uint64_t stream_offset;
+} ExportView;
+
+typedef struct {
+    ExportView *views;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t deferred_count;
+    int failed;         // a view could not be added or stored
+} ExportViewList;
+
+static int export_views_add(ExportViewList *list, const void *data, size_t size, size_t stride) {
+    if (list->count >= list->capacity) {
+        uint32_t new_capacity = list->capacity ? list->capacity * 2 : 64;
+        ExportView *views = realloc(list->views, new_capacity * sizeof(ExportView));
+        if (!views) {
+            list->failed = 1;
+            return -1;
+        }
+        list->views = views;
+        list->capacity = new_capacity;
+    }
+    list->views[list->count].data = data;
+    list->views[list->count].size = size;
+    list->views[list->count].stride = stride;
+    list->views[list->count].shared = 0;
+    list->views[list->count].shared_offset = 0;
+    list->views[list->count].deferred = 0;
+    list->views[list->count].stream_offset = 0;
+    return (int)list->count++;
 }
 
-// Rotate vector by quaternion
-static Vector3D quat_rotate(Quaternion q, Vector3D v) {
-    Vector3D qv = {q.x, q.y, q.z};
-    float qw = q.w;
+// View of a streamed track, laid out after the packed views by add_buffers
+static int export_views_add_deferred(ExportViewList *list, size_t size) {
+    int view = export_views_add(list, NULL, size, 0);
+    if (view < 0) return view;
+    list->views[view].deferred = 1;
+    list->deferred_count++;
+    return view;
+}
 
-    Vector3D cross1 = {qv.y*v.z - qv.z*v.y, qv.z*v.x - qv.x*v.z, qv.x*v.y - qv.y*v.x};
-    Vector3D cross2 = {qv.y*cross1.z - qv.z*cross1.y, qv.z*cross1.x - qv.x*cross1.z, qv.x*cross1.y - qv.y*cross1.x};
+// Animation data goes to the shared store when there is one
+static int export_views_add_anim(ExportViewList *list, AnimStore *store, const void *data, size_t size) {
+    int view = export_views_add(list, data, size, 0);
+    if (view < 0 || !store) return view;
+    if (!anim_store_add(store, data, size, &list->views[view].shared_offset)) {
+        list->failed = 1;
+        return -1;
+    }
+    list->views[view].shared = 1;
+    return view;
+}
 
-    return (Vector3D){
-        v.x + 2.0f * (qw * cross1.x + cross2.x),
-        v.y + 2.0f * (qw * cross1.y + cross2.y),
-        v.z + 2.0f * (qw * cross1.z + cross2.z)
-    };
+static cJSON* shared_buffer_view(const ExportView *view, uint32_t buffer) {
+    cJSON *json = json_create_buffer_view(buffer, view->size);
+    cJSON_AddNumberToObject(json, "byteOffset", (double)view->shared_offset);
+    return json;
 }
 
-// Convert world space transform to local space relative to parent
-static void compute_local_transform(BoneState *local, const BoneState *world, const BoneState *parent_world) {
-    // local_rotation = inverse(parent_rotation) * world_rotation
-    Quaternion parent_inv = quat_inverse(parent_world->rotation);
-    local->rotation = quat_mul(parent_inv, world->rotation);
+// One tightly packed per-vertex attribute stream
+typedef struct {
+    const void *data;
+    size_t element_size;    // bytes per vertex
+    size_t alignment;       // component size; the attribute offset is a multiple of it
+    size_t offset;          // offset inside the interleaved vertex, set by interleave_vertex_streams
+} VertexStream;
+
+// Interleave SoA streams into one vertex buffer in a single pass over the
+// vertices. Each attribute starts on its component alignment and the stride
+// is a multiple of 4, as glTF requires for vertex attributes.
+static uint8_t* interleave_vertex_streams(VertexStream *streams, uint32_t stream_count, uint32_t vertex_count, size_t *stride_out) {
+    size_t stride = 0;
+    for (uint32_t s = 0; s < stream_count; s++) {
+        size_t align = streams[s].alignment;
+        stride = (stride + align - 1) / align * align;
+        streams[s].offset = stride;
+        stride += streams[s].element_size;
+    }
+    stride = (stride + 3) & ~(size_t)3;
+
+    uint8_t *out = calloc(vertex_count ? vertex_count : 1, stride);
+    if (!out) return NULL;
+    for (uint32_t i = 0; i < vertex_count; i++) {
+        uint8_t *vertex = out + (size_t)i * stride;
+        for (uint32_t s = 0; s < stream_count; s++) {
+            memcpy(vertex + streams[s].offset,
+                   (const uint8_t *)streams[s].data + (size_t)i * streams[s].element_size,
+                   streams[s].element_size);
+        }
+    }
+    *stride_out = stride;
+    return out;
+}
+
+static void store_u32(uint8_t *p, uint32_t value) {
+    p[0] = (uint8_t)(value & 0xFF);
+    p[1] = (uint8_t)((value >> 8) & 0xFF);
+    p[2] = (uint8_t)((value >> 16) & 0xFF);
+    p[3] = (uint8_t)(value >> 24);
+}
 
-    // local_translation = inverse(parent_rotation) * (world_translation - parent_translation)
-    Vector3D diff = {
-        world->translation.x - parent_world->translation.x,
-        world->translation.y - parent_world->translation.y,
-        world->translation.z - parent_world->translation.z
+// GLB container: header, JSON chunk padded with spaces, BIN chunk padded with
+// zeros. The JSON and BIN data are written from where they are.
+static int write_glb(const char *path, const char *json, const ByteWriter *bin, int atomic) {
+    static const char spaces[4] = "   ";
+    static const uint8_t zeros[4] = {0};
+    size_t json_len = strlen(json);
+    size_t json_padded = (json_len + 3) & ~(size_t)3;
+    size_t bin_padded = (bin->size + 3) & ~(size_t)3;
+    size_t total = 12 + 8 + json_padded + (bin->size ? 8 + bin_padded : 0);
+    if (total > 0xFFFFFFFFu) {
+        fprintf(stderr, "GLB output larger than 4 GiB\n");
+        return 0;
+    }
+    if (bin->error) return 0;
+
+    uint8_t header[20];
+    uint8_t bin_header[8];
+    store_u32(&header[0], GLB_MAGIC);
+    store_u32(&header[4], GLB_VERSION);
+    store_u32(&header[8], (uint32_t)total);
+    store_u32(&header[12], (uint32_t)json_padded);
+    store_u32(&header[16], GLB_CHUNK_JSON);
+    store_u32(&bin_header[0], (uint32_t)bin_padded);
+    store_u32(&bin_header[4], GLB_CHUNK_BIN);
+    OutputChunk chunks[6] = {
+        {header, sizeof(header)},
+        {json, json_len},
+        {spaces, json_padded - json_len},
+        {bin_header, sizeof(bin_header)},
+        {bin->data, bin->size},
+        {zeros, bin_padded - bin->size}
     };
-    local->translation = quat_rotate(parent_inv, diff);
+    return output_write_chunks(path, chunks, bin->size ? 6 : 3, atomic);
+}
+
+// Smallest unsigned glTF component type that can hold max_value
+static int smallest_unsigned_type(uint32_t max_value) {
+    if (max_value <= 0xFF) return 5121;     // UNSIGNED_BYTE
+    if (max_value <= 0xFFFF) return 5123;   // UNSIGNED_SHORT
+    return 5125;                            // UNSIGNED_INT
+}
+
+// Same for index streams, whose type maximum is reserved for primitive
+// restart and must not appear in the data
+static int smallest_index_type(uint32_t max_index) {
+    if (max_index < 0xFF) return 5121;
+    if (max_index < 0xFFFF) return 5123;
+    return 5125;
+}
+
+static size_t unsigned_type_size(int component_type) {
+    return component_type == 5121 ? 1 : component_type == 5123 ? 2 : 4;
+}
+
+// accessor.min/max from the data the accessor points at
+static void add_float_bounds(cJSON *accessor, const float *data, size_t count, uint32_t components) {
+    float min[ACCESSOR_MAX_COMPONENTS], max[ACCESSOR_MAX_COMPONENTS];
+    if (!data || count == 0) return;
+    accessor_stats_float(data, count, components, min, max);
+    cJSON_AddItemToObject(accessor, "min", json_create_float_array(min, components));
+    cJSON_AddItemToObject(accessor, "max", json_create_float_array(max, components));
+}
+
+static void add_unsigned_bounds(cJSON *accessor, const void *data, int component_type, size_t count, uint32_t components) {
+    uint32_t min[ACCESSOR_MAX_COMPONENTS], max[ACCESSOR_MAX_COMPONENTS];
+    if (!data || count == 0) return;
+    accessor_stats_unsigned(data, component_type, count, components, min, max);
+    cJSON *min_array = cJSON_CreateArray();
+    cJSON *max_array = cJSON_CreateArray();
+    for (uint32_t c = 0; c < components; c++) {
+        cJSON_AddItemToArray(min_array, cJSON_CreateNumber(min[c]));
+        cJSON_AddItemToArray(max_array, cJSON_CreateNumber(max[c]));
+    }
+    cJSON_AddItemToObject(accessor, "min", min_array);
+    cJSON_AddItemToObject(accessor, "max", max_array);
+}
+
+// Narrow 32-bit values to component_type into a new buffer
+static void* pack_unsigned(const uint32_t *values, size_t count, int component_type) {
+    size_t size = unsigned_type_size(component_type);
+    uint8_t *out = malloc(count ? count * size : 1);
+    if (!out) return NULL;
+    for (size_t i = 0; i < count; i++) {
+        if (component_type == 5121) {
+            out[i] = (uint8_t)values[i];
+        } else if (component_type == 5123) {
+            uint16_t v = (uint16_t)values[i];
+            memcpy(out + i * 2, &v, 2);
+        } else {
+            memcpy(out + i * 4, &values[i], 4);
+        }
+    }
+    return out;
+}
+
+// Simplification stops a level once the surface would move by more than
+// this fraction of the mesh extent
+#define LOD_MAX_RELATIVE_ERROR 0.05f
+// MSFT_screencoverage hint of the full mesh; each lower level takes a quarter
+#define LOD_BASE_COVERAGE 0.2f
+
+typedef struct {
+    uint32_t *indices;
+    uint32_t index_count;
+    int index_type;
+    void *packed_indices;
+    float error;            // model units, against the full mesh
+} LodLevel;
+
+// Simplified index lists over the exported vertex streams. Level l targets
+// half the triangles of level l-1 and is always simplified from the full
+// mesh, so its error is measured against the original surface. The chain
+// ends early when a level saves less than 10% over the previous one.
+static uint32_t build_lod_chain(const SimplifyMesh *mesh, const uint32_t *indices, uint32_t index_count,
+                                int levels, LodLevel *lods) {
+    float extent = mesh_extent(mesh, indices, index_count);
+    uint32_t previous = index_count;
+    uint32_t count = 0;
+
+    printf("  LOD0: %u triangles\n", index_count / 3);
+    for (int l = 1; l < levels && l < GLTF_MAX_LOD_LEVELS; l++) {
+        uint32_t *lod_indices = malloc(index_count * sizeof(uint32_t));
+        if (!lod_indices) break;
+        uint32_t target = (index_count >> l) / 3 * 3;
+        float error = 0.0f;
+        uint32_t lod_count = simplify_mesh(mesh, indices, index_count, target,
+                                           extent * LOD_MAX_RELATIVE_ERROR, lod_indices, &error);
+        if (lod_count == 0 || lod_count > previous - previous / 10) {
+            printf("  LOD%d: skipped, simplification stalled at %u triangles\n", l, lod_count / 3);
+            free(lod_indices);
+            break;
+        }
+
+        uint32_t max_index = 0;
+        for (uint32_t i = 0; i < lod_count; i++) {
+            if (lod_indices[i] > max_index) max_index = lod_indices[i];
+        }
+        lods[count].indices = lod_indices;
+        lods[count].index_count = lod_count;
+        lods[count].index_type = smallest_index_type(max_index);
+        lods[count].packed_indices = pack_unsigned(lod_indices, lod_count, lods[count].index_type);
+        lods[count].error = error;
+        count++;
+        previous = lod_count;
+
+        printf("  LOD%d: %u triangles, error %.4f (%.2f%% of extent)\n",
+               l, lod_count / 3, error, extent > 0.0f ? error / extent * 100.0f : 0.0f);
+    }
+    return count;
+}
+
+// Per-vertex stream build, one job shared by every chunk
+typedef struct {
+    const PMDModel *model;
+    const SkinOutput *rest;     // rest pose re-skinned vertices (weighted == NULL when unused)
+    const int *bone_to_joint;
+    int skip_root;              // bones at or past skel_bones are dropped too
+    uint32_t skel_bones;
+    float *positions;
+    float *normals;
+    float *texcoords;
+    uint32_t *joints;
+    float *weights;
+    Vector3D *chunk_bounds;     // min, max per chunk
+} VertexStreamJob;
+
+// Vertices per chunk, and chunks per thread below which the build stays serial
+#define VERTEX_CHUNK 4096
+#define VERTEX_PARALLEL_CHUNKS 8
+
+static void build_vertex_chunks(void *context, uint32_t chunk_begin, uint32_t chunk_end) {
+    VertexStreamJob *job = context;
+    for (uint32_t c = chunk_begin; c < chunk_end; c++) {
+        Vector3D lo = {1e10f, 1e10f, 1e10f};
+        Vector3D hi = {-1e10f, -1e10f, -1e10f};
+        uint32_t begin = c * VERTEX_CHUNK;
+        uint32_t end = job->model->numVertices - begin > VERTEX_CHUNK ? begin + VERTEX_CHUNK : job->model->numVertices;
+        for (uint32_t i = begin; i < end; i++) {
+            const Vertex *vertex = &job->model->vertices[i];
+            Vector3D pos = vertex->position;
+            Vector3D norm = vertex->normal;
+
+            // If rest pose animation is specified, adapt mesh to new rest pose
+            if (job->rest->weighted && job->rest->weighted[i]) {
+                Vector3D new_norm = {job->rest->nx[i], job->rest->ny[i], job->rest->nz[i]};
+                float norm_len = sqrtf(new_norm.x*new_norm.x + new_norm.y*new_norm.y + new_norm.z*new_norm.z);
+                if (norm_len > 1e-6f) {
+                    new_norm.x /= norm_len;
+                    new_norm.y /= norm_len;
+                    new_norm.z /= norm_len;
+                }
+                pos = (Vector3D){job->rest->px[i], job->rest->py[i], job->rest->pz[i]};
+                norm = (Vector3D){-new_norm.x, -new_norm.y, -new_norm.z};
+            }
+
+            job->positions[i*3+0] = pos.x;
+            job->positions[i*3+1] = pos.y;
+            job->positions[i*3+2] = pos.z;
+
+            if (pos.x < lo.x) lo.x = pos.x;
+            if (pos.y < lo.y) lo.y = pos.y;
+            if (pos.z < lo.z) lo.z = pos.z;
+            if (pos.x > hi.x) hi.x = pos.x;
+            if (pos.y > hi.y) hi.y = pos.y;
+            if (pos.z > hi.z) hi.z = pos.z;
+
+            job->normals[i*3+0] = norm.x;
+            job->normals[i*3+1] = norm.y;
+            job->normals[i*3+2] = norm.z;
+
+            job->texcoords[i*2+0] = vertex->coords[0].u;
+            job->texcoords[i*2+1] = 1.0f - vertex->coords[0].v;
+
+            float total_weight = 0.0f;
+            int valid_count = 0;
+            for (int j = 0; j < 4; j++) {
+                uint8_t bone_idx = vertex->blend.bones[j];
+                if (bone_idx != 0xFF && bone_idx < job->model->numBones) {
+                    if (bone_idx == 0 || (job->skip_root && bone_idx >= job->skel_bones)) {
+                        continue;
+                    }
+
+                    int joint_idx = job->bone_to_joint[bone_idx];
+                    if (joint_idx >= 0) {
+                        job->joints[i*4+valid_count] = (uint32_t)joint_idx;
+                        job->weights[i*4+valid_count] = vertex->blend.weights[j];
+                        total_weight += vertex->blend.weights[j];
+                        valid_count++;
+                    }
+                }
+            }
+
+            if (valid_count == 0) {
+                job->joints[i*4+0] = 0;
+                job->weights[i*4+0] = 1.0f;
+                valid_count = 1;
+                total_weight = 1.0f;
+            }
+
+            for (int j = valid_count; j < 4; j++) {
+                job->joints[i*4+j] = 0;
+                job->weights[i*4+j] = 0.0f;
+            }
+
+            if (total_weight > 0.0f && total_weight != 1.0f) {
+                for (int j = 0; j < valid_count; j++) {
+                    job->weights[i*4+j] /= total_weight;
+                }
+            }
+        }
+        job->chunk_bounds[c * 2] = lo;
+        job->chunk_bounds[c * 2 + 1] = hi;
+    }
 }
 
-int export_gltf(const char *output_file, PMDModel *model, PSAAnimation **anims, uint32_t anim_count, SkeletonDef *skel, const char *mesh_name, const float *anim_speed_percent, const char *rest_pose_anim) {
+// Mesh with the shared vertex accessors 0-4 and its own index accessor
+static cJSON* create_mesh(const char *name, int skinned, uint32_t indices_accessor) {
+    if (skinned) {
+        return json_create_mesh(name, 0, 1, 2, indices_accessor, 3, 4);
+    }
+    cJSON *mesh = cJSON_CreateObject();
+    cJSON *primitives = cJSON_CreateArray();
+    cJSON *primitive = cJSON_CreateObject();
+    cJSON *attributes = cJSON_CreateObject();
+    cJSON_AddNumberToObject(attributes, "POSITION", 0);
+    cJSON_AddNumberToObject(attributes, "NORMAL", 1);
+    cJSON_AddNumberToObject(attributes, "TEXCOORD_0", 2);
+    cJSON_AddItemToObject(primitive, "attributes", attributes);
+    cJSON_AddNumberToObject(primitive, "indices", indices_accessor);
+    cJSON_AddNumberToObject(primitive, "mode", 4);
+    cJSON_AddItemToArray(primitives, primitive);
+    cJSON_AddItemToObject(mesh, "primitives", primitives);
+    cJSON_AddStringToObject(mesh, "name", name);
+    return mesh;
+}
+
+static cJSON* create_clip_bounds(const ClipBounds *cb) {
+    cJSON *bounds = cJSON_CreateObject();
+    cJSON_AddItemToObject(bounds, "min", json_create_float_array(cb->min, 3));
+    cJSON_AddItemToObject(bounds, "max", json_create_float_array(cb->max, 3));
+    cJSON_AddItemToObject(bounds, "center", json_create_float_array(cb->center, 3));
+    cJSON_AddItemToObject(bounds, "radius", json_create_float(cb->radius));
+    return bounds;
+}
+
+// Per-clip tracks, dense (one key per frame) unless fitted
+typedef struct {
+    const char *name;
+    uint32_t frames;
+    float *times;
+    float **translations;
+    float **rotations;
+    uint32_t num_bones;
+    uint32_t *sampler_accessors; // input and output accessor per sampler, translation then rotation per bone
+    FittedTrack *fitted;        // same order as the samplers when curve fitting, else NULL
+    float frame_rate;           // keys per second before the speed scale
+    size_t times_size;
+    size_t trans_size;
+    size_t rot_size;
+    ClipBounds bounds;
+    int has_bounds;
+    const PSAAnimation *stream;  // streamed clip: no tracks in memory, written by write_streamed_bin
+    float time_scale;           // playback speed applied to the key times
+    int *stream_views;          // times view, then translation and rotation view per bone
+    cJSON **stream_accessors;   // their accessors, bounded once every window was seen
+} AnimData;
+
+// Fit every track of every clip, reporting the key and byte savings per clip
+static void fit_animations(AnimData *anim_data, uint32_t anim_count, const GltfExportOptions *opts) {
+    for (uint32_t a = 0; a < anim_count; a++) {
+        if (anim_data[a].frames == 0) continue;
+        uint32_t frames = anim_data[a].frames;
+        uint32_t tracks = anim_data[a].num_bones * 2;
+        anim_data[a].fitted = calloc(tracks ? tracks : 1, sizeof(FittedTrack));
+        if (!anim_data[a].fitted) continue;
+
+        size_t dense_size = 0, fitted_size = 0;
+        uint32_t dense_keys = 0, fitted_keys = 0, cubic_tracks = 0;
+        for (uint32_t t = 0; t < tracks; t++) {
+            uint32_t b = t / 2;
+            int rotation = t & 1;
+            FittedTrack *fit = &anim_data[a].fitted[t];
+            fit_track(anim_data[a].times, rotation ? anim_data[a].rotations[b] : anim_data[a].translations[b],
+                      frames, rotation ? 4 : 3, rotation, rotation ? opts->fit_angle : opts->fit_error, fit);
+            size_t track_size = rotation ? anim_data[a].rot_size : anim_data[a].trans_size;
+            dense_size += track_size;
+            dense_keys += frames;
+            if (fit->key_count > 0) {
+                fitted_size += fitted_track_size(fit);
+                fitted_keys += fit->key_count;
+                cubic_tracks += (uint32_t)fit->cubic;
+            } else {
+                fitted_size += track_size;
+                fitted_keys += frames;
+            }
+        }
+        printf("  %s: curve fit %u -> %u keys, %u/%u tracks cubic, %zu -> %zu bytes\n",
+               anim_data[a].name ? anim_data[a].name : "Animation", dense_keys, fitted_keys,
+               cubic_tracks, tracks, dense_size, fitted_size);
+    }
+}
+
+// Dense accessors of a streamed clip over deferred views; their min/max are
+// added by write_streamed_bin
+static int add_streamed_accessors(cJSON *accessors, ExportViewList *views, AnimData *clip) {
+    uint32_t count = 1 + clip->num_bones * 2;
+    clip->stream_views = calloc(count, sizeof(int));
+    clip->stream_accessors = calloc(count, sizeof(cJSON*));
+    if (!clip->stream_views || !clip->stream_accessors) return 0;
+
+    uint32_t time_accessor = (uint32_t)cJSON_GetArraySize(accessors);
+    for (uint32_t i = 0; i < count; i++) {
+        int rotation = i > 0 && (i - 1) % 2 == 1;
+        size_t size = i == 0 ? clip->times_size : rotation ? clip->rot_size : clip->trans_size;
+        clip->stream_views[i] = export_views_add_deferred(views, size);
+        if (clip->stream_views[i] < 0) return 0;
+        cJSON *accessor = json_create_accessor((uint32_t)clip->stream_views[i], clip->frames,
+                                               i == 0 ? "SCALAR" : rotation ? "VEC4" : "VEC3", "5126");
+        clip->stream_accessors[i] = accessor;
+        if (i > 0) {
+            clip->sampler_accessors[(i - 1) * 2] = time_accessor;
+            clip->sampler_accessors[(i - 1) * 2 + 1] = (uint32_t)cJSON_GetArraySize(accessors);
+        }
+        cJSON_AddItemToArray(accessors, accessor);
+    }
+    return 1;
+}
+
+// Input and output accessors of every sampler, recorded in sampler_accessors.
+// Returns 0 on allocation failure.
+static int add_animation_accessors(cJSON *accessors, ExportViewList *views, AnimStore *store,
+                                   AnimData *anim_data, uint32_t anim_count) {
+    for (uint32_t a = 0; a < anim_count; a++) {
+        if (anim_data[a].frames == 0) continue;
+        uint32_t frames = anim_data[a].frames;
+        anim_data[a].sampler_accessors = calloc(anim_data[a].num_bones * 4 + 1, sizeof(uint32_t));
+        if (!anim_data[a].sampler_accessors) return 0;
+        if (anim_data[a].stream) {
+            if (!add_streamed_accessors(accessors, views, &anim_data[a])) return 0;
+            continue;
+        }
+
+        // Time accessor shared by the tracks that keep every frame
+        int time_accessor = -1;
+        for (uint32_t t = 0; t < anim_data[a].num_bones * 2; t++) {
+            uint32_t b = t / 2;
+            int rotation = t & 1;
+            const char *type = rotation ? "VEC4" : "VEC3";
+            uint32_t *sampler = &anim_data[a].sampler_accessors[t * 2];
+            const FittedTrack *fit = anim_data[a].fitted ? &anim_data[a].fitted[t] : NULL;
+
+            if (fit && fit->key_count > 0 && (fit->cubic || fit->key_count < frames)) {
+                int input_view = export_views_add_anim(views, store, fit->times, fit->key_count * sizeof(float));
+                cJSON *input = json_create_accessor(input_view, fit->key_count, "SCALAR", "5126");
+                add_float_bounds(input, fit->times, fit->key_count, 1);
+                sampler[0] = (uint32_t)cJSON_GetArraySize(accessors);
+                cJSON_AddItemToArray(accessors, input);
+
+                uint32_t values = fit->key_count * (fit->cubic ? 3 : 1);
+                int output_view = export_views_add_anim(views, store, fit->values, values * fit->components * sizeof(float));
+                sampler[1] = (uint32_t)cJSON_GetArraySize(accessors);
+                cJSON *output = json_create_accessor(output_view, values, type, "5126");
+                add_float_bounds(output, fit->values, values, fit->components);
+                cJSON_AddItemToArray(accessors, output);
+                continue;
+            }
+
+            if (time_accessor < 0) {
+                int time_view = export_views_add_anim(views, store, anim_data[a].times, anim_data[a].times_size);
+                cJSON *time_acc = json_create_accessor(time_view, frames, "SCALAR", "5126");
+                add_float_bounds(time_acc, anim_data[a].times, frames, 1);
+                time_accessor = cJSON_GetArraySize(accessors);
+                cJSON_AddItemToArray(accessors, time_acc);
+            }
+            float *track = rotation ? anim_data[a].rotations[b] : anim_data[a].translations[b];
+            size_t track_size = rotation ? anim_data[a].rot_size : anim_data[a].trans_size;
+            int track_view = export_views_add_anim(views, store, track, track_size);
+            sampler[0] = (uint32_t)time_accessor;
+            sampler[1] = (uint32_t)cJSON_GetArraySize(accessors);
+            cJSON *output = json_create_accessor(track_view, frames, type, "5126");
+            add_float_bounds(output, track, frames, rotation ? 4 : 3);
+            cJSON_AddItemToArray(accessors, output);
+        }
+    }
+    return 1;
+}
+
+// One glTF animation per clip; bone b is node first_bone_node + b
+static cJSON* create_animations(const AnimData *anim_data, uint32_t anim_count, uint32_t first_bone_node) {
+    cJSON *animations = cJSON_CreateArray();
+
+    for (uint32_t a = 0; a < anim_count; a++) {
+        if (anim_data[a].frames == 0) continue;
+
+        cJSON *animation = cJSON_CreateObject();
+        cJSON_AddStringToObject(animation, "name", anim_data[a].name ? anim_data[a].name : "Animation");
+
+        cJSON *samplers = cJSON_CreateArray();
+        for (uint32_t t = 0; t < anim_data[a].num_bones * 2; t++) {
+            const uint32_t *sampler = &anim_data[a].sampler_accessors[t * 2];
+            const FittedTrack *fit = anim_data[a].fitted ? &anim_data[a].fitted[t] : NULL;
+            const char *interpolation = fit && fit->key_count > 0 && fit->cubic ? "CUBICSPLINE" : "LINEAR";
+            cJSON_AddItemToArray(samplers, json_create_animation_sampler(sampler[0], sampler[1], interpolation));
+        }
+
+        cJSON_AddItemToObject(animation, "samplers", samplers);
+
+        cJSON *channels = cJSON_CreateArray();
+        for (uint32_t b = 0; b < anim_data[a].num_bones; b++) {
+            uint32_t trans_sampler = b * 2;
+            uint32_t rot_sampler = b * 2 + 1;
+            uint32_t node = b + first_bone_node;
+
+            cJSON_AddItemToArray(channels, json_create_animation_channel(trans_sampler, node, "translation"));
+            cJSON_AddItemToArray(channels, json_create_animation_channel(rot_sampler, node, "rotation"));
+        }
+
+        cJSON_AddItemToObject(animation, "channels", channels);
+        if (anim_data[a].has_bounds) {
+            const ClipBounds *cb = &anim_data[a].bounds;
+            cJSON *extras = cJSON_CreateObject();
+            cJSON_AddItemToObject(extras, "bounds", create_clip_bounds(cb));
+            cJSON_AddItemToObject(animation, "extras", extras);
+        }
+        cJSON_AddItemToArray(animations, animation);
+    }
+    return animations;
+}
+
+// BufferViews and buffers for every view: data URIs, or packed into blob
+// for the .bin / GLB chunk. Shared animation views point at the store;
+// deferred views get their stream_offset in the .bin.
+static void add_buffers(cJSON *root, ExportViewList *views, ByteWriter *blob,
+                        const GltfExportOptions *opts, const char *output_file) {
+    cJSON *buffer_views = cJSON_CreateArray();
+    cJSON *buffers = cJSON_CreateArray();
+    // Views in the shared animation file reference the buffer after the model's own
+    uint32_t own_views = 0;
+    for (uint32_t v = 0; v < views->count; v++) {
+        if (!views->views[v].shared) own_views++;
+    }
+    // A library whose data all went to the store has no buffer of its own
+    int own_buffer = own_views > 0 || own_views == views->count;
+    uint32_t shared_buffer = opts->format == GLTF_OUTPUT_EMBEDDED ? own_views : (uint32_t)own_buffer;
+    if (opts->format == GLTF_OUTPUT_EMBEDDED) {
+        // One data URI buffer per view
+        uint32_t buffer = 0;
+        for (uint32_t v = 0; v < views->count; v++) {
+            if (views->views[v].shared) {
+                cJSON_AddItemToArray(buffer_views, shared_buffer_view(&views->views[v], shared_buffer));
+                continue;
+            }
+            cJSON *view = json_create_buffer_view(buffer++, views->views[v].size);
+            if (views->views[v].stride) {
+                cJSON_AddNumberToObject(view, "byteStride", (double)views->views[v].stride);
+            }
+            cJSON_AddItemToArray(buffer_views, view);
+            char *uri = create_data_uri(views->views[v].data, views->views[v].size);
+            cJSON_AddItemToArray(buffers, json_create_buffer(views->views[v].size, uri));
+            free(uri);
+        }
+    } else {
+        // All views packed into buffer 0, each starting on a 4-byte boundary.
+        // Deferred views follow the packed ones; the streaming pass fills them.
+        size_t deferred_offset = 0;
+        for (uint32_t v = 0; v < views->count; v++) {
+            if (views->views[v].shared || views->views[v].deferred) continue;
+            deferred_offset = ((deferred_offset + 3) & ~(size_t)3) + views->views[v].size;
+        }
+        deferred_offset = (deferred_offset + 3) & ~(size_t)3;
+        size_t deferred_end = deferred_offset;
+        for (uint32_t v = 0; v < views->count; v++) {
+            if (views->views[v].shared) {
+                cJSON_AddItemToArray(buffer_views, shared_buffer_view(&views->views[v], shared_buffer));
+                continue;
+            }
+            if (views->views[v].deferred) {
+                views->views[v].stream_offset = deferred_end;
+                cJSON *view = json_create_buffer_view(0, views->views[v].size);
+                cJSON_AddNumberToObject(view, "byteOffset", (double)deferred_end);
+                cJSON_AddItemToArray(buffer_views, view);
+                deferred_end = (deferred_end + views->views[v].size + 3) & ~(size_t)3;
+                continue;
+            }
+            byte_writer_align(blob, 4, 0);
+            cJSON *view = json_create_buffer_view(0, views->views[v].size);
+            cJSON_AddNumberToObject(view, "byteOffset", (double)blob->size);
+            if (views->views[v].stride) {
+                cJSON_AddNumberToObject(view, "byteStride", (double)views->views[v].stride);
+            }
+            cJSON_AddItemToArray(buffer_views, view);
+            byte_writer_bytes(blob, views->views[v].data, views->views[v].size);
+        }
+        byte_writer_align(blob, 4, 0);
+
+        char bin_uri[512] = "";
+        if (opts->format == GLTF_OUTPUT_SEPARATE) {
+            const char *file_name = strrchr(output_file, '/');
+            if (!file_name) file_name = strrchr(output_file, '\\');
+            file_name = file_name ? file_name + 1 : output_file;
+            const char *ext = strrchr(file_name, '.');
+            int stem_len = ext ? (int)(ext - file_name) : (int)strlen(file_name);
+            snprintf(bin_uri, sizeof(bin_uri), "%.*s.bin", stem_len, file_name);
+        }
+        if (own_buffer) {
+            size_t byte_length = deferred_end > deferred_offset ? deferred_end : blob->size;
+            cJSON_AddItemToArray(buffers, json_create_buffer(byte_length, bin_uri[0] ? bin_uri : NULL));
+        }
+    }
+    if (own_views < views->count) {
+        // Everything stored so far: later models only append to the file
+        cJSON_AddItemToArray(buffers, json_create_buffer((size_t)opts->anim_store->size, opts->anim_store->uri));
+    }
+
+    cJSON_AddItemToObject(root, "bufferViews", buffer_views);
+    cJSON_AddItemToObject(root, "buffers", buffers);
+}
+
+// output_file with its extension replaced by .bin
+static void bin_path_for(const char *output_file, char *out, size_t size) {
+    const char *ext = strrchr(output_file, '.');
+    const char *sep = strrchr(output_file, '/');
+    if (ext && sep && ext < sep) ext = NULL;
+    int stem_len = ext ? (int)(ext - output_file) : (int)strlen(output_file);
+    snprintf(out, size, "%.*s.bin", stem_len, output_file);
+}
+
+// Write root (and blob, for .bin and GLB) to output_file; root is deleted
+static int write_gltf_file(const char *output_file, cJSON *root, const ByteWriter *blob, const GltfExportOptions *opts) {
+    GltfOutputFormat format = opts->format;
+    if (format == GLTF_OUTPUT_GLB) {
+        char *json_str = cJSON_PrintUnformatted(root);
+        cJSON_Delete(root);
+        int ok = json_str && write_glb(output_file, json_str, blob, opts->atomic_write);
+        if (!ok) fprintf(stderr, "Failed to create output file\n");
+        free(json_str);
+        return ok;
+    }
+
+    char *json_str = cJSON_Print(root);
+    cJSON_Delete(root);
+    OutputChunk text[2] = {{json_str, json_str ? strlen(json_str) : 0}, {"\n", 1}};
+    int ok = json_str && output_write_chunks(output_file, text, 2, opts->atomic_write);
+    free(json_str);
+    if (!ok) {
+        fprintf(stderr, "Failed to create output file\n");
+        return 0;
+    }
+
+    if (format == GLTF_OUTPUT_SEPARATE && blob->size > 0) {
+        char bin_path[1024];
+        bin_path_for(output_file, bin_path, sizeof(bin_path));
+        OutputChunk data = {blob->data, blob->size};
+        if (blob->error || !output_write_chunks(bin_path, &data, 1, opts->atomic_write)) {
+            fprintf(stderr, "Failed to write binary buffer: %s\n", bin_path);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Running min/max of one streamed accessor
+typedef struct {
+    float min[4];
+    float max[4];
+    int seen;
+} StreamBounds;
+
+static void stream_bounds_add(StreamBounds *bounds, const float *data, uint32_t count, uint32_t components) {
+    float min[ACCESSOR_MAX_COMPONENTS], max[ACCESSOR_MAX_COMPONENTS];
+    accessor_stats_float(data, count, components, min, max);
+    for (uint32_t c = 0; c < components; c++) {
+        if (!bounds->seen || min[c] < bounds->min[c]) bounds->min[c] = min[c];
+        if (!bounds->seen || max[c] > bounds->max[c]) bounds->max[c] = max[c];
+    }
+    bounds->seen = 1;
+}
+
+// Convert a streamed clip window by window: each frame's local pose goes
+// into per-track slices written at the track's offset, so memory holds one
+// window whatever the clip length
+static int stream_clip(OutputFile *out, AnimData *clip, const ExportViewList *views,
+                       const SkeletonDef *skel, const PMDModel *model, uint32_t window) {
+    const PSAAnimation *anim = clip->stream;
+    uint32_t bones = clip->num_bones;
+    uint32_t accessor_count = 1 + bones * 2;
+    if (window > clip->frames) window = clip->frames;
+
+    BoneState *states = malloc(((size_t)window * anim->numBones + 1) * sizeof(BoneState));
+    float *times = malloc((size_t)window * sizeof(float));
+    float *translations = malloc(((size_t)window * bones * 3 + 1) * sizeof(float));
+    float *rotations = malloc(((size_t)window * bones * 4 + 1) * sizeof(float));
+    StreamBounds *bounds = calloc(accessor_count, sizeof(StreamBounds));
+    SkeletonPose pose;
+    int ok = states && times && translations && rotations && bounds && pose_init(&pose, skel, model->numBones);
+    int pose_ready = ok;
+
+    for (uint32_t first = 0; ok && first < clip->frames; first += window) {
+        uint32_t n = clip->frames - first < window ? clip->frames - first : window;
+        if (!read_psa_frames(anim, first, n, states)) {
+            ok = 0;
+            break;
+        }
+        for (uint32_t f = 0; f < n; f++) {
+            times[f] = ((float)(first + f) / clip->frame_rate) * clip->time_scale;
+            pose_evaluate_world(&pose, &states[(size_t)f * anim->numBones], anim->numBones,
+                                model->restStates, model->numBones);
+            for (uint32_t b = 0; b < bones; b++) {
+                const BoneState *local_state = &pose.local[b];
+                float *t = &translations[((size_t)b * n + f) * 3];
+                float *r = &rotations[((size_t)b * n + f) * 4];
+                t[0] = local_state->translation.x;
+                t[1] = local_state->translation.y;
+                t[2] = local_state->translation.z;
+                r[0] = local_state->rotation.x;
+                r[1] = local_state->rotation.y;
+                r[2] = local_state->rotation.z;
+                r[3] = local_state->rotation.w;
+            }
+        }
+
+        ok = output_file_write_at(out, views->views[clip->stream_views[0]].stream_offset + (uint64_t)first * 4,
+                                  times, (size_t)n * 4);
+        stream_bounds_add(&bounds[0], times, n, 1);
+        for (uint32_t b = 0; ok && b < bones; b++) {
+            const float *t = &translations[(size_t)b * n * 3];
+            const float *r = &rotations[(size_t)b * n * 4];
+            const ExportView *trans_view = &views->views[clip->stream_views[1 + b * 2]];
+            const ExportView *rot_view = &views->views[clip->stream_views[2 + b * 2]];
+            ok = output_file_write_at(out, trans_view->stream_offset + (uint64_t)first * 12, t, (size_t)n * 12) &&
+                 output_file_write_at(out, rot_view->stream_offset + (uint64_t)first * 16, r, (size_t)n * 16);
+            stream_bounds_add(&bounds[1 + b * 2], t, n, 3);
+            stream_bounds_add(&bounds[2 + b * 2], r, n, 4);
+        }
+    }
+
+    for (uint32_t i = 0; ok && i < accessor_count; i++) {
+        uint32_t components = i == 0 ? 1 : (i - 1) % 2 ? 4 : 3;
+        cJSON_AddItemToObject(clip->stream_accessors[i], "min", json_create_float_array(bounds[i].min, components));
+        cJSON_AddItemToObject(clip->stream_accessors[i], "max", json_create_float_array(bounds[i].max, components));
+    }
+    if (pose_ready) pose_free(&pose);
+    free(states);
+    free(times);
+    free(translations);
+    free(rotations);
+    free(bounds);
+    return ok;
+}
+
+// The .bin of an export with streamed clips: the packed views, then every
+// streamed track. Accessor bounds of the streamed clips are set on the way.
+static int write_streamed_bin(const char *output_file, const ByteWriter *blob, const ExportViewList *views,
+                              AnimData *anim_data, uint32_t anim_count, const SkeletonDef *skel,
+                              const PMDModel *model, const GltfExportOptions *opts) {
+    char bin_path[1024];
+    bin_path_for(output_file, bin_path, sizeof(bin_path));
+    uint32_t window = opts->stream_window ? opts->stream_window : GLTF_DEFAULT_STREAM_WINDOW;
+    OutputFile out;
+    int ok = !blob->error && output_file_open(&out, bin_path, opts->atomic_write);
+    if (ok) {
+        ok = output_file_write_at(&out, 0, blob->data, blob->size);
+        for (uint32_t a = 0; ok && a < anim_count; a++) {
+            if (anim_data[a].stream_views) {
+                ok = stream_clip(&out, &anim_data[a], views, skel, model, window);
+            }
+        }
+        ok = output_file_close(&out, ok);
+    }
+    if (!ok) fprintf(stderr, "Failed to write binary buffer: %s\n", bin_path);
+    return ok;
+}
+
+void gltf_export_options_init(GltfExportOptions *options) {
+    options->format = GLTF_OUTPUT_EMBEDDED;
+    options->interleaved = 0;
+    options->lod_levels = 0;
+    options->optimize_skin = 0;
+    skin_optimize_options_init(&options->skin);
+    options->flag_single_influence = 0;
+    options->sample_rate = 0.0f;
+    options->fit_error = 0.0f;
+    options->fit_angle = 0.01f;
+    options->threads = 0;
+    options->clip_bounds = 0;
+    options->joint_bounds = 0;
+    options->anim_store = NULL;
+    options->anim_libraries = NULL;
+    options->atomic_write = 0;
+    options->reproducible = 0;
+    options->stream_window = 0;
+}
+
+int export_gltf(const char *output_file, PMDModel *model, PSAAnimation **anims, uint32_t anim_count, const SkeletonDef *skel, const char *mesh_name, const float *anim_speed_percent, const char *rest_pose_anim) {
+    return export_gltf_with_options(output_file, model, anims, anim_count, skel, mesh_name, anim_speed_percent, rest_pose_anim, NULL);
+}
+
+static int export_model(const char *output_file, PMDModel *model, PSAAnimation **anims, uint32_t anim_count, const SkeletonDef *skel, const char *mesh_name, const float *anim_speed_percent, const char *rest_pose_anim, const GltfExportOptions *options) {
+    GltfExportOptions opts;
+    gltf_export_options_init(&opts);
+    if (options) opts = *options;
+
     PSAAnimation *bind_anim = NULL;
     char armature_name_buf[128] = "";
     if (rest_pose_anim && anims && anim_count > 0) {
@@ -155,11 +981,35 @@ int export_gltf(const char *output_file, PMDModel *model, PSAAnimation **anims,
         }
     }
 
+    // Streamed clips are converted straight into the .bin, key by key. Their
+    // frames are never all in memory, so they cannot be resampled or fitted
+    // and get no clip bounds.
+    int streamed = 0;
+    for (uint32_t a = 0; anims && a < anim_count; a++) {
+        if (anims[a] && anims[a]->stream) streamed = 1;
+    }
+    if (streamed && (opts.format != GLTF_OUTPUT_SEPARATE || opts.sample_rate > 0.0f || opts.fit_error > 0.0f ||
+                     opts.clip_bounds || opts.anim_store || opts.anim_libraries)) {
+        fprintf(stderr, "Error: Streamed animations need a separate .bin and no resampling, fitting, "
+                        "clip bounds, shared animations or animation libraries\n");
+        return 0;
+    }
+
     uint32_t skel_bones = skel ? (uint32_t)skel->bone_count : model->numBones;
     uint32_t total_bones = model->numBones + model->numPropPoints;
 
     // Create bone index mapping: exclude only root (index 0) from skinning
     uint32_t skinnable_bones = model->numBones > 1 ? model->numBones - 1 : model->numBones;
+
+    // Clips go to the skeleton's library instead of this file
+    AnimLibrary *library = NULL;
+    if (opts.anim_libraries && skel && skinnable_bones > 0 && anim_count > 0) {
+        library = anim_library_set_get(opts.anim_libraries, skel);
+        if (!library) {
+            fprintf(stderr, "Error: Out of memory for the animation library\n");
+            return 0;
+        }
+    }
     int *bone_to_joint = calloc(model->numBones, sizeof(int));
     for (uint32_t i = 0; i < model->numBones; i++) {
         if (skel && i == 0) {
@@ -169,153 +1019,168 @@ int export_gltf(const char *output_file, PMDModel *model, PSAAnimation **anims,
         }
     }
 
-    size_t positions_size = model->numVertices * 3 * sizeof(float);
-    size_t normals_size = model->numVertices * 3 * sizeof(float);
-    size_t texcoords_size = model->numVertices * 2 * sizeof(float);
-    size_t indices_size = model->numFaces * 3 * sizeof(uint16_t);
-    size_t joints_size = model->numVertices * 4 * sizeof(uint16_t);
-    size_t weights_size = model->numVertices * 4 * sizeof(float);
+    // Bucket prop points by parent bone; props without a valid parent go last
+    uint32_t *prop_offsets = NULL;
+    uint32_t *prop_order = NULL;
+    if (!bucket_prop_points(model, &prop_offsets, &prop_order)) {
+        free(bone_to_joint);
+        return 0;
+    }
 
-    float *positions = calloc(model->numVertices * 3, sizeof(float));
-    float *normals = calloc(model->numVertices * 3, sizeof(float));
-    float *texcoords = calloc(model->numVertices * 2, sizeof(float));
-    uint16_t *indices = calloc(model->numFaces * 3, sizeof(uint16_t));
-    uint16_t *joints = calloc(model->numVertices * 4, sizeof(uint16_t));
-    float *weights = calloc(model->numVertices * 4, sizeof(float));
+    // Rest pose: bind animation frame 0 when requested, PMD rest states otherwise
+    SkeletonPose rest_pose;
+    if (!pose_init(&rest_pose, skel, model->numBones)) {
+        free(bone_to_joint);
+        free(prop_offsets);
+        free(prop_order);
+        return 0;
+    }
+    BoneState *bind_states = NULL;
+    if (bind_anim && bind_anim->numFrames > 0 && bind_anim->stream) {
+        bind_states = malloc(((size_t)bind_anim->numBones + 1) * sizeof(BoneState));
+        if (!bind_states || !read_psa_frames(bind_anim, 0, 1, bind_states)) {
+            fprintf(stderr, "Error: Cannot read the rest pose animation\n");
+            free(bind_states);
+            pose_free(&rest_pose);
+            free(bone_to_joint);
+            free(prop_offsets);
+            free(prop_order);
+            return 0;
+        }
+    }
+    if (bind_anim && bind_anim->numFrames > 0) {
+        pose_evaluate_world(&rest_pose, bind_states ? bind_states : bind_anim->boneStates, bind_anim->numBones,
+                            model->restStates, model->numBones);
+    } else {
+        pose_evaluate_world(&rest_pose, model->restStates, model->numBones, NULL, 0);
+    }
+    free(bind_states);
+
+    // One spare element each, so empty meshes do not read as failed allocations
+    float *positions = calloc((size_t)model->numVertices * 3 + 1, sizeof(float));
+    float *normals = calloc((size_t)model->numVertices * 3 + 1, sizeof(float));
+    float *texcoords = calloc((size_t)model->numVertices * 2 + 1, sizeof(float));
+    uint32_t *indices = calloc((size_t)model->numFaces * 3 + 1, sizeof(uint32_t));
+    uint32_t *joints = calloc((size_t)model->numVertices * 4 + 1, sizeof(uint32_t));
+    float *weights = calloc((size_t)model->numVertices * 4 + 1, sizeof(float));
+    uint32_t chunk_count = (model->numVertices + VERTEX_CHUNK - 1) / VERTEX_CHUNK;
+    Vector3D *chunk_bounds = malloc(((size_t)chunk_count + 1) * 2 * sizeof(Vector3D));
+    int streams_ok = positions && normals && texcoords && indices && joints && weights && chunk_bounds;
+    if (!streams_ok) fprintf(stderr, "Error: Out of memory for the vertex streams\n");
+
+    // Rest pose remap: one matrix per bone, then a single skinning pass
+    SkinOutput rest_skinned = {0};
+    if (streams_ok && bind_anim && bind_anim->numFrames > 0) {
+        uint32_t palette_count = bind_anim->numBones < model->numBones ? bind_anim->numBones : model->numBones;
+        if (!skin_model(model, rest_pose.world_matrices, NULL, palette_count, 1, opts.threads, &rest_skinned)) {
+            // The IBMs come from the rest pose clip: a PMD-posed mesh would be bound wrong
+            fprintf(stderr, "Error: Out of memory skinning the rest pose\n");
+            streams_ok = 0;
+        }
+    }
+    if (!streams_ok) {
+        free(positions);
+        free(normals);
+        free(texcoords);
+        free(indices);
+        free(joints);
+        free(weights);
+        free(chunk_bounds);
+        pose_free(&rest_pose);
+        free(bone_to_joint);
+        free(prop_offsets);
+        free(prop_order);
+        return 0;
+    }
 
+    // Bounds, UV flip and joint remap, chunked so large meshes split over threads
     Vector3D min_pos = {1e10f, 1e10f, 1e10f};
     Vector3D max_pos = {-1e10f, -1e10f, -1e10f};
+    VertexStreamJob job = {model, &rest_skinned, bone_to_joint, skel != NULL, skel_bones,
+                           positions, normals, texcoords, joints, weights, chunk_bounds};
+    parallel_for(chunk_count, VERTEX_PARALLEL_CHUNKS, opts.threads, build_vertex_chunks, &job);
+    for (uint32_t c = 0; c < chunk_count; c++) {
+        const Vector3D *lo = &chunk_bounds[c * 2], *hi = &chunk_bounds[c * 2 + 1];
+        if (lo->x < min_pos.x) min_pos.x = lo->x;
+        if (lo->y < min_pos.y) min_pos.y = lo->y;
+        if (lo->z < min_pos.z) min_pos.z = lo->z;
+        if (hi->x > max_pos.x) max_pos.x = hi->x;
+        if (hi->y > max_pos.y) max_pos.y = hi->y;
+        if (hi->z > max_pos.z) max_pos.z = hi->z;
+    }
+    free(chunk_bounds);
+    skin_output_free(&rest_skinned);
 
-    for (uint32_t i = 0; i < model->numVertices; i++) {
-        Vector3D pos = model->vertices[i].position;
-        Vector3D norm = model->vertices[i].normal;
-
-        // If rest pose animation is specified, adapt mesh to new rest pose
-        if (bind_anim && bind_anim->numFrames > 0) {
-            Vector3D new_pos = {0,0,0};
-            Vector3D new_norm = {0,0,0};
-            float total_weight = 0.0f;
-            for (int j = 0; j < 4; j++) {
-                uint8_t bone_idx = model->vertices[i].blend.bones[j];
-                float weight = model->vertices[i].blend.weights[j];
-                if (bone_idx != 0xFF && bone_idx < bind_anim->numBones && weight > 0.0f) {
-                    BoneState bs = bind_anim->boneStates[0 * bind_anim->numBones + bone_idx];
-                    Vector3D rotated = quat_rotate(bs.rotation, pos);
-                    rotated.x += bs.translation.x;
-                    rotated.y += bs.translation.y;
-                    rotated.z += bs.translation.z;
-                    new_pos.x += rotated.x * weight;
-                    new_pos.y += rotated.y * weight;
-                    new_pos.z += rotated.z * weight;
-                    Vector3D nrm_rot = quat_rotate(bs.rotation, norm);
-                    new_norm.x += nrm_rot.x * weight;
-                    new_norm.y += nrm_rot.y * weight;
-                    new_norm.z += nrm_rot.z * weight;
-                    total_weight += weight;
-                }
-            }
-            if (total_weight > 0.0f) {
-                new_pos.x /= total_weight;
-                new_pos.y /= total_weight;
-                new_pos.z /= total_weight;
-                new_norm.x /= total_weight;
-                new_norm.y /= total_weight;
-                new_norm.z /= total_weight;
-                float norm_len = sqrtf(new_norm.x*new_norm.x + new_norm.y*new_norm.y + new_norm.z*new_norm.z);
-                if (norm_len > 1e-6f) {
-                    new_norm.x /= norm_len;
-                    new_norm.y /= norm_len;
-                    new_norm.z /= norm_len;
-                }
-                new_norm.x = -new_norm.x;
-                new_norm.y = -new_norm.y;
-                new_norm.z = -new_norm.z;
-                pos = new_pos;
-                norm = new_norm;
-            }
-        }
-
-        positions[i*3+0] = pos.x;
-        positions[i*3+1] = pos.y;
-        positions[i*3+2] = pos.z;
-
-        if (pos.x < min_pos.x) min_pos.x = pos.x;
-        if (pos.y < min_pos.y) min_pos.y = pos.y;
-        if (pos.z < min_pos.z) min_pos.z = pos.z;
-        if (pos.x > max_pos.x) max_pos.x = pos.x;
-        if (pos.y > max_pos.y) max_pos.y = pos.y;
-        if (pos.z > max_pos.z) max_pos.z = pos.z;
-
-        normals[i*3+0] = norm.x;
-        normals[i*3+1] = norm.y;
-        normals[i*3+2] = norm.z;
-
-        texcoords[i*2+0] = model->vertices[i].coords[0].u;
-        texcoords[i*2+1] = 1.0f - model->vertices[i].coords[0].v;
-
-        float total_weight = 0.0f;
-        int valid_count = 0;
-        for (int j = 0; j < 4; j++) {
-            uint8_t bone_idx = model->vertices[i].blend.bones[j];
-            if (bone_idx != 0xFF && bone_idx < model->numBones) {
-                if (bone_idx == 0 || (skel && bone_idx >= skel_bones)) {
-                    continue;
-                }
+    printf("  Mesh bounds: (%.2f, %.2f, %.2f) to (%.2f, %.2f, %.2f)\n",
+           min_pos.x, min_pos.y, min_pos.z, max_pos.x, max_pos.y, max_pos.z);
 
-                int joint_idx = bone_to_joint[bone_idx];
-                if (joint_idx >= 0) {
-                    joints[i*4+valid_count] = (uint16_t)joint_idx;
-                    weights[i*4+valid_count] = model->vertices[i].blend.weights[j];
-                    total_weight += model->vertices[i].blend.weights[j];
-                    valid_count++;
-                }
+    // Influence limiting, pruning and quantization-aware renormalization
+    uint8_t *single_influence = NULL;
+    int weight_bits = 0;
+    if (skinnable_bones > 0 && (opts.optimize_skin || opts.flag_single_influence)) {
+        uint8_t *rigid = calloc(model->numVertices ? model->numVertices : 1, 1);
+        SkinOptimizeStats skin_stats;
+        optimize_skin_weights(joints, weights, model->numVertices, &opts.skin, rigid, &skin_stats);
+        if (opts.skin.weight_bits == 8 || opts.skin.weight_bits == 16) weight_bits = opts.skin.weight_bits;
+        printf("  Skin: %u influence(s) pruned, %u of %u vertices single influence\n",
+               skin_stats.pruned, skin_stats.single_influence, skin_stats.vertices);
+
+        if (opts.flag_single_influence) {
+            // Vertex attribute elements must be 4-byte aligned: one padded slot per vertex
+            single_influence = calloc(model->numVertices ? model->numVertices : 1, 4);
+            for (uint32_t i = 0; single_influence && i < model->numVertices; i++) {
+                single_influence[i * 4] = rigid[i];
             }
         }
+        free(rigid);
+    }
 
-        if (valid_count == 0) {
-            joints[i*4+0] = 0;
-            weights[i*4+0] = 1.0f;
-            valid_count = 1;
-            total_weight = 1.0f;
-        }
-
-        for (int j = valid_count; j < 4; j++) {
-            joints[i*4+j] = 0;
-            weights[i*4+j] = 0.0f;
-        }
-
-        if (total_weight > 0.0f && total_weight != 1.0f) {
-            for (int j = 0; j < valid_count; j++) {
-                weights[i*4+j] /= total_weight;
-            }
+    uint32_t max_index = 0;
+    for (uint32_t i = 0; i < model->numFaces; i++) {
+        for (int k = 0; k < 3; k++) {
+            indices[i*3+k] = model->faces[i].vertices[k];
+            if (indices[i*3+k] > max_index) max_index = indices[i*3+k];
         }
     }
+    uint32_t max_joint = 0;
+    for (size_t i = 0; i < (size_t)model->numVertices * 4; i++) {
+        if (joints[i] > max_joint) max_joint = joints[i];
+    }
 
-    printf("  Mesh bounds: (%.2f, %.2f, %.2f) to (%.2f, %.2f, %.2f)\n",
-           min_pos.x, min_pos.y, min_pos.z, max_pos.x, max_pos.y, max_pos.z);
-
-    for (uint32_t i = 0; i < model->numFaces; i++) {
-        indices[i*3+0] = model->faces[i].vertices[0];
-        indices[i*3+1] = model->faces[i].vertices[1];
-        indices[i*3+2] = model->faces[i].vertices[2];
+    // Narrowest component types for the integer streams
+    int index_type = smallest_index_type(max_index);
+    int joint_type = smallest_unsigned_type(max_joint);
+    size_t indices_size = (size_t)model->numFaces * 3 * unsigned_type_size(index_type);
+    void *packed_indices = pack_unsigned(indices, (size_t)model->numFaces * 3, index_type);
+    void *packed_joints = pack_unsigned(joints, (size_t)model->numVertices * 4, joint_type);
+    int weight_type = weight_bits == 8 ? 5121 : weight_bits == 16 ? 5123 : 5126;
+    void *packed_weights = weight_bits ? quantize_weights(weights, (size_t)model->numVertices * 4, weight_bits) : NULL;
+    char index_type_str[8];
+    char joint_type_str[8];
+    snprintf(index_type_str, sizeof(index_type_str), "%d", index_type);
+    snprintf(joint_type_str, sizeof(joint_type_str), "%d", joint_type);
+    char weight_type_str[8];
+    snprintf(weight_type_str, sizeof(weight_type_str), "%d", weight_type);
+
+    // Simplified levels of detail, sharing every vertex stream with LOD0
+    LodLevel lods[GLTF_MAX_LOD_LEVELS - 1];
+    uint32_t lod_count = 0;
+    if (opts.lod_levels > 1 && model->numFaces > 0) {
+        SimplifyMesh simplify = {positions, texcoords, skinnable_bones > 0 ? joints : NULL,
+                                 skinnable_bones > 0 ? weights : NULL, model->numVertices};
+        lod_count = build_lod_chain(&simplify, indices, model->numFaces * 3, opts.lod_levels, lods);
     }
 
     // Compute inverse bind matrices
     uint32_t total_ibm_count = skinnable_bones + model->numPropPoints;
     size_t ibm_size = total_ibm_count * 16 * sizeof(float);
-    float *ibm = calloc(total_ibm_count * 16, sizeof(float));
-    for (uint32_t i = 0; i < skinnable_bones; ++i) {
+    float *ibm = calloc((size_t)total_ibm_count * 16 + 1, sizeof(float));
+    // Allocation failures up to the JSON build take the cleanup path there
+    int prepare_ok = ibm != NULL;
+    if (!ibm) fprintf(stderr, "Error: Out of memory for the inverse bind matrices\n");
+    for (uint32_t i = 0; prepare_ok && i < skinnable_bones; ++i) {
         uint32_t boneIndex = i + 1;
-        BoneState world_bs;
-        int haveWorld = 0;
-        if (bind_anim && boneIndex < bind_anim->numBones && bind_anim->numFrames > 0) {
-            world_bs = bind_anim->boneStates[0 * bind_anim->numBones + boneIndex];
-            haveWorld = 1;
-        } else if (boneIndex < model->numBones) {
-            world_bs = model->restStates[boneIndex];
-            haveWorld = 1;
-        }
-        if (!haveWorld) {
+        if (boneIndex >= model->numBones) {
             uint32_t idx = i*16;
             ibm[idx+0]=1; ibm[idx+4]=0; ibm[idx+8]=0; ibm[idx+12]=0;
             ibm[idx+1]=0; ibm[idx+5]=1; ibm[idx+9]=0; ibm[idx+13]=0;
@@ -323,12 +1188,10 @@ int export_gltf(const char *output_file, PMDModel *model, PSAAnimation **anims,
             ibm[idx+3]=0; ibm[idx+7]=0; ibm[idx+11]=0; ibm[idx+15]=1;
             continue;
         }
-        float mTemp[16];
-        make_matrix(&world_bs, mTemp);
-        invert_affine(mTemp, &ibm[i*16]);
+        invert_affine(&rest_pose.world_matrices[boneIndex * 16], &ibm[i*16]);
     }
     // Prop points: keep identity
-    for (uint32_t p = 0; p < model->numPropPoints; ++p) {
+    for (uint32_t p = 0; prepare_ok && p < model->numPropPoints; ++p) {
         uint32_t idx = (skinnable_bones + p)*16;
         ibm[idx+0]=1; ibm[idx+4]=0; ibm[idx+8]=0; ibm[idx+12]=0;
         ibm[idx+1]=0; ibm[idx+5]=1; ibm[idx+9]=0; ibm[idx+13]=0;
@@ -337,84 +1200,182 @@ int export_gltf(const char *output_file, PMDModel *model, PSAAnimation **anims,
     }
 
     // Prepare animation data
-    typedef struct {
-        float *times;
-        float **translations;
-        float **rotations;
-        char *times_uri;
-        char **trans_uris;
-        char **rot_uris;
-        uint32_t num_bones;
-        size_t times_size;
-        size_t trans_size;
-        size_t rot_size;
-    } AnimData;
-
     AnimData *anim_data = NULL;
-    if (anim_count > 0) {
+    // Clips to export: the PSAs as read, or resampled to opts.sample_rate
+    PSAAnimation **clips = anims;
+    PSAAnimation **resampled = NULL;
+    if (anim_count > 0 && opts.sample_rate > 0.0f) {
+        resampled = calloc(anim_count, sizeof(PSAAnimation*));
+        if (resampled) {
+            for (uint32_t a = 0; a < anim_count; a++) {
+                resampled[a] = anims[a];
+                if (!anims[a] || anims[a]->numFrames == 0 || anims[a]->stream) continue;
+                PSAAnimation *clip = resample_psa(anims[a], PSA_FRAME_RATE, opts.sample_rate, skel,
+                                                 model->restStates, model->numBones);
+                if (!clip) continue;
+                printf("  %s: %u -> %u keys at %.1f fps\n", clip->name ? clip->name : "Animation",
+                       anims[a]->numFrames, clip->numFrames, 1.0f / clip->frameLength);
+                resampled[a] = clip;
+            }
+            clips = resampled;
+        }
+    }
+
+    // Clip bounds: the exported mesh skinned by its joints at every key frame.
+    // Joint j is bone j + 1, so a pose's palette is world[j + 1] * ibm[j].
+    uint32_t bounds_joints = model->numBones > 1 ? model->numBones - 1 : 0;
+    float *bounds_input = NULL;
+    uint8_t *bounds_bones = NULL;
+    SkinInput bounds_skin = {0};
+    if (opts.clip_bounds && anim_count > 0 && skinnable_bones > 0) {
+        bounds_input = malloc(((size_t)model->numVertices * 3 + 1) * sizeof(float));
+        bounds_bones = malloc((size_t)model->numVertices * 4 + 1);
+        if (bounds_input && bounds_bones) {
+            uint32_t n = model->numVertices;
+            for (uint32_t i = 0; i < n; i++) {
+                bounds_input[i] = positions[i*3+0];
+                bounds_input[n + i] = positions[i*3+1];
+                bounds_input[2 * n + i] = positions[i*3+2];
+            }
+            for (size_t i = 0; i < (size_t)n * 4; i++) {
+                bounds_bones[i] = joints[i] < bounds_joints ? (uint8_t)joints[i] : 0xFF;
+            }
+            bounds_skin = (SkinInput){n, bounds_input, bounds_input + n, bounds_input + 2 * (size_t)n,
+                                      NULL, NULL, NULL, bounds_bones, weights};
+        }
+    }
+
+    if (prepare_ok && anim_count > 0) {
         anim_data = calloc(anim_count, sizeof(AnimData));
+        SkeletonPose anim_pose;
+        int pose_ready = anim_data && pose_init(&anim_pose, skel, model->numBones);
+        if (!pose_ready) {
+            fprintf(stderr, "Error: Out of memory for the animation tracks\n");
+            prepare_ok = 0;
+        }
 
-        for (uint32_t a = 0; a < anim_count; a++) {
-            PSAAnimation *anim = anims[a];
+        for (uint32_t a = 0; prepare_ok && a < anim_count; a++) {
+            PSAAnimation *anim = clips[a];
             if (!anim || anim->numFrames == 0) continue;
 
             uint32_t anim_bones = anim->numBones < model->numBones ? anim->numBones : model->numBones;
             anim_data[a].num_bones = anim_bones;
+            anim_data[a].frames = anim->numFrames;
+            anim_data[a].name = anim->name;
 
             float speed = 100.0f;
             if (anim_speed_percent) speed = anim_speed_percent[a];
             if (speed <= 0.0f) speed = 100.0f;
             float scale = 100.0f / speed;
-            anim_data[a].times = calloc(anim->numFrames, sizeof(float));
-            for (uint32_t i = 0; i < anim->numFrames; i++) {
-                anim_data[a].times[i] = ((float)i / 30.0f) * scale;
+            anim_data[a].frame_rate = anim != anims[a] ? 1.0f / anim->frameLength : PSA_FRAME_RATE;
+            if (anim->stream) {
+                // Keys are computed when the .bin is written
+                anim_data[a].stream = anim;
+                anim_data[a].time_scale = scale;
+                anim_data[a].times_size = anim->numFrames * sizeof(float);
+                anim_data[a].trans_size = anim->numFrames * 3 * sizeof(float);
+                anim_data[a].rot_size = anim->numFrames * 4 * sizeof(float);
+                continue;
             }
+            anim_data[a].times = calloc(anim->numFrames, sizeof(float));
             anim_data[a].times_size = anim->numFrames * sizeof(float);
-            anim_data[a].times_uri = create_data_uri(anim_data[a].times, anim_data[a].times_size);
 
-            anim_data[a].translations = calloc(anim_bones, sizeof(float*));
-            anim_data[a].rotations = calloc(anim_bones, sizeof(float*));
-            anim_data[a].trans_uris = calloc(anim_bones, sizeof(char*));
-            anim_data[a].rot_uris = calloc(anim_bones, sizeof(char*));
+            anim_data[a].translations = calloc(anim_bones + 1, sizeof(float*));
+            anim_data[a].rotations = calloc(anim_bones + 1, sizeof(float*));
             anim_data[a].trans_size = anim->numFrames * 3 * sizeof(float);
             anim_data[a].rot_size = anim->numFrames * 4 * sizeof(float);
 
-            for (uint32_t b = 0; b < anim_bones; b++) {
+            int tracks_ok = anim_data[a].times && anim_data[a].translations && anim_data[a].rotations;
+            for (uint32_t b = 0; tracks_ok && b < anim_bones; b++) {
                 anim_data[a].translations[b] = calloc(anim->numFrames * 3, sizeof(float));
                 anim_data[a].rotations[b] = calloc(anim->numFrames * 4, sizeof(float));
+                tracks_ok = anim_data[a].translations[b] && anim_data[a].rotations[b];
+            }
+            if (!tracks_ok) {
+                fprintf(stderr, "Error: Out of memory for the tracks of %s\n", anim->name ? anim->name : "Animation");
+                prepare_ok = 0;
+                break;
+            }
+            for (uint32_t i = 0; i < anim->numFrames; i++) {
+                anim_data[a].times[i] = ((float)i / anim_data[a].frame_rate) * scale;
+            }
 
-                for (uint32_t frame = 0; frame < anim->numFrames; frame++) {
-                    BoneState *state = &anim->boneStates[frame * anim->numBones + b];
-                    BoneState local_state = *state;
-                    if (skel && b < (uint32_t)skel->bone_count && skel->bones[b].parent_index != -1) {
-                        int parent_idx = skel->bones[b].parent_index;
-                        BoneState *parent_state = &anim->boneStates[frame * anim->numBones + parent_idx];
-                        compute_local_transform(&local_state, state, parent_state);
-                    }
+            size_t pose_size = (size_t)bounds_joints * SKIN_PALETTE_STRIDE;
+            float *palettes = bounds_skin.count ? malloc(((size_t)anim->numFrames * pose_size + 1) * sizeof(float)) : NULL;
+
+            // One pose evaluation per frame, scattered into per-bone tracks
+            for (uint32_t frame = 0; frame < anim->numFrames; frame++) {
+                pose_evaluate_world(&anim_pose, &anim->boneStates[frame * anim->numBones], anim->numBones,
+                                    model->restStates, model->numBones);
+                if (palettes) {
+                    skin_palette_build(&anim_pose.world_matrices[16], ibm, bounds_joints, &palettes[frame * pose_size]);
+                }
+                for (uint32_t b = 0; b < anim_bones; b++) {
+                    const BoneState *local_state = &anim_pose.local[b];
 
-                    anim_data[a].translations[b][frame*3 + 0] = local_state.translation.x;
-                    anim_data[a].translations[b][frame*3 + 1] = local_state.translation.y;
-                    anim_data[a].translations[b][frame*3 + 2] = local_state.translation.z;
+                    anim_data[a].translations[b][frame*3 + 0] = local_state->translation.x;
+                    anim_data[a].translations[b][frame*3 + 1] = local_state->translation.y;
+                    anim_data[a].translations[b][frame*3 + 2] = local_state->translation.z;
 
-                    anim_data[a].rotations[b][frame*4 + 0] = local_state.rotation.x;
-                    anim_data[a].rotations[b][frame*4 + 1] = local_state.rotation.y;
-                    anim_data[a].rotations[b][frame*4 + 2] = local_state.rotation.z;
-                    anim_data[a].rotations[b][frame*4 + 3] = local_state.rotation.w;
+                    anim_data[a].rotations[b][frame*4 + 0] = local_state->rotation.x;
+                    anim_data[a].rotations[b][frame*4 + 1] = local_state->rotation.y;
+                    anim_data[a].rotations[b][frame*4 + 2] = local_state->rotation.z;
+                    anim_data[a].rotations[b][frame*4 + 3] = local_state->rotation.w;
                 }
+            }
 
-                anim_data[a].trans_uris[b] = create_data_uri(anim_data[a].translations[b], anim_data[a].trans_size);
-                anim_data[a].rot_uris[b] = create_data_uri(anim_data[a].rotations[b], anim_data[a].rot_size);
+            if (palettes && clip_bounds_compute(palettes, anim->numFrames, bounds_joints, &bounds_skin,
+                                                opts.threads, &anim_data[a].bounds)) {
+                const ClipBounds *cb = &anim_data[a].bounds;
+                anim_data[a].has_bounds = 1;
+                printf("  %s: clip bounds (%.2f, %.2f, %.2f) to (%.2f, %.2f, %.2f), radius %.2f\n",
+                       anim->name ? anim->name : "Animation", cb->min[0], cb->min[1], cb->min[2],
+                       cb->max[0], cb->max[1], cb->max[2], cb->radius);
+            }
+            free(palettes);
+        }
+        if (pose_ready) pose_free(&anim_pose);
+    }
+    free(bounds_input);
+    free(bounds_bones);
+
+    // Library clips keep only the skeleton's bones, so extra bones do not
+    // make otherwise identical clips differ between models
+    const char **library_names = NULL;
+    if (prepare_ok && library && anim_data) {
+        anim_library_set_rest(library, rest_pose.local, model->numBones);
+        library_names = calloc(anim_count, sizeof(const char*));
+        for (uint32_t a = 0; library_names && a < anim_count; a++) {
+            if (anim_data[a].frames == 0) continue;
+            uint32_t bones = anim_data[a].num_bones < (uint32_t)skel->bone_count ? anim_data[a].num_bones : (uint32_t)skel->bone_count;
+            library_names[a] = anim_library_add_clip(library, anim_data[a].name, mesh_name, anim_data[a].frames, bones,
+                                                     anim_data[a].times, anim_data[a].translations, anim_data[a].rotations);
+            if (!library_names[a]) {
+                free(library_names);
+                library_names = NULL;
             }
         }
     }
 
-    char *pos_uri = create_data_uri(positions, positions_size);
-    char *norm_uri = create_data_uri(normals, normals_size);
-    char *tex_uri = create_data_uri(texcoords, texcoords_size);
-    char *idx_uri = create_data_uri(indices, indices_size);
-    char *joints_uri = create_data_uri(joints, joints_size);
-    char *weights_uri = create_data_uri(weights, weights_size);
-    char *ibm_uri = create_data_uri(ibm, ibm_size);
+    // Curve fitting: sparse CUBICSPLINE or LINEAR keys per track, within the error bounds
+    if (prepare_ok && anim_data && opts.fit_error > 0.0f && !library) {
+        fit_animations(anim_data, anim_count, &opts);
+    }
+
+    int status = 1;
+    ExportViewList views = {0};
+    ByteWriter blob;
+    byte_writer_init(&blob, 0);
+    uint8_t *interleaved = NULL;
+    if (!prepare_ok) {
+        status = 0;
+        goto cleanup;
+    }
+    if (library && !library_names) {
+        fprintf(stderr, "Error: Out of memory adding clips to the animation library\n");
+        status = 0;
+        goto cleanup;
+    }
 
     // BUILD JSON USING cJSON
     cJSON *root = cJSON_CreateObject();
@@ -452,16 +1413,18 @@ int export_gltf(const char *output_file, PMDModel *model, PSAAnimation **anims,
     
     // Add root bones as children
     if (skel) {
-        for (int i = 0; i < skel->bone_count; i++) {
-            if (skel->bones[i].parent_index == -1) {
-                cJSON_AddItemToArray(root_children, cJSON_CreateNumber(i + 2));
+        for (int r = 0; r < skel->root_count; r++) {
+            int bone = skel->topo_order[r];
+            if ((uint32_t)bone < model->numBones) {
+                cJSON_AddItemToArray(root_children, cJSON_CreateNumber(bone + 2));
             }
         }
-        for (uint32_t i = 0; i < model->numPropPoints; i++) {
-            uint8_t parent_bone = model->propPoints[i].bone;
-            if (parent_bone == 0xFF || parent_bone >= model->numBones) {
-                cJSON_AddItemToArray(root_children, cJSON_CreateNumber(model->numBones + i + 2));
-            }
+        // Bones beyond the skeleton definition have no parent
+        for (uint32_t i = skel_bones; i < model->numBones; i++) {
+            cJSON_AddItemToArray(root_children, cJSON_CreateNumber(i + 2));
+        }
+        for (uint32_t i = prop_offsets[model->numBones]; i < model->numPropPoints; i++) {
+            cJSON_AddItemToArray(root_children, cJSON_CreateNumber(model->numBones + prop_order[i] + 2));
         }
     } else {
         for (uint32_t i = 0; i < model->numBones; i++) {
@@ -474,7 +1437,8 @@ int export_gltf(const char *output_file, PMDModel *model, PSAAnimation **anims,
     // Node 1: Mesh
     cJSON *mesh_node = cJSON_CreateObject();
     cJSON_AddNumberToObject(mesh_node, "mesh", 0);
-    cJSON_AddNumberToObject(mesh_node, "skin", 0);
+    // skins is only written for skinned models
+    if (skinnable_bones > 0) cJSON_AddNumberToObject(mesh_node, "skin", 0);
     cJSON_AddItemToArray(nodes, mesh_node);
 
     // Bone nodes (start at index 2)
@@ -505,19 +1469,7 @@ int export_gltf(const char *output_file, PMDModel *model, PSAAnimation **anims,
         // Compute transform
         BoneState transform;
         if (i < model->numBones) {
-            BoneState worldPose = model->restStates[i];
-            if (bind_anim && i < bind_anim->numBones && bind_anim->numFrames > 0) {
-                worldPose = bind_anim->boneStates[0 * bind_anim->numBones + i];
-            }
-            transform = worldPose;
-            if (skel && i < (uint32_t)skel->bone_count && skel->bones[i].parent_index != -1) {
-                int parent_idx = skel->bones[i].parent_index;
-                BoneState parentWorld = model->restStates[parent_idx];
-                if (bind_anim && (uint32_t)parent_idx < bind_anim->numBones && bind_anim->numFrames > 0) {
-                    parentWorld = bind_anim->boneStates[0 * bind_anim->numBones + parent_idx];
-                }
-                compute_local_transform(&transform, &worldPose, &parentWorld);
-            }
+            transform = rest_pose.local[i];
         } else {
             uint32_t prop_idx = i - model->numBones;
             transform.translation = model->propPoints[prop_idx].translation;
@@ -527,8 +1479,8 @@ int export_gltf(const char *output_file, PMDModel *model, PSAAnimation **anims,
         // Translation and rotation
         float trans[3] = {transform.translation.x, transform.translation.y, transform.translation.z};
         float rot[4] = {transform.rotation.x, transform.rotation.y, transform.rotation.z, transform.rotation.w};
-        cJSON *trans_array = cJSON_CreateFloatArray(trans, 3);
-        cJSON *rot_array = cJSON_CreateFloatArray(rot, 4);
+        cJSON *trans_array = json_create_float_array(trans, 3);
+        cJSON *rot_array = json_create_float_array(rot, 4);
         cJSON_AddItemToObject(bone_node, "translation", trans_array);
         cJSON_AddItemToObject(bone_node, "rotation", rot_array);
 
@@ -538,19 +1490,18 @@ int export_gltf(const char *output_file, PMDModel *model, PSAAnimation **anims,
         
         if (i < model->numBones) {
             if (skel) {
-                for (int j = 0; j < skel->bone_count; j++) {
-                    if (skel->bones[j].parent_index == (int)i) {
-                        cJSON_AddItemToArray(children, cJSON_CreateNumber(j + 2));
+                int child_count = 0;
+                const int *child_bones = skeleton_children(skel, (int)i, &child_count);
+                for (int c = 0; c < child_count; c++) {
+                    if ((uint32_t)child_bones[c] < model->numBones) {
+                        cJSON_AddItemToArray(children, cJSON_CreateNumber(child_bones[c] + 2));
                         has_children = 1;
                     }
                 }
             }
-            for (uint32_t j = 0; j < model->numPropPoints; j++) {
-                uint8_t parent_bone = model->propPoints[j].bone;
-                if (parent_bone == i) {
-                    cJSON_AddItemToArray(children, cJSON_CreateNumber(model->numBones + j + 2));
-                    has_children = 1;
-                }
+            for (uint32_t j = prop_offsets[i]; j < prop_offsets[i + 1]; j++) {
+                cJSON_AddItemToArray(children, cJSON_CreateNumber(model->numBones + prop_order[j] + 2));
+                has_children = 1;
             }
         }
 
@@ -563,147 +1514,185 @@ int export_gltf(const char *output_file, PMDModel *model, PSAAnimation **anims,
         cJSON_AddItemToArray(nodes, bone_node);
     }
 
+    // LOD nodes live outside the scene and are only reached through MSFT_lod
+    if (lod_count > 0) {
+        cJSON *lod_ids = cJSON_CreateArray();
+        cJSON *coverage = cJSON_CreateArray();
+        float hint = LOD_BASE_COVERAGE;
+        for (uint32_t l = 0; l < lod_count; l++) {
+            char buf[160];
+            snprintf(buf, sizeof(buf), "%s_LOD%u", mesh_name ? mesh_name : "mesh", l + 1);
+            cJSON *lod_node = cJSON_CreateObject();
+            cJSON_AddStringToObject(lod_node, "name", buf);
+            cJSON_AddNumberToObject(lod_node, "mesh", l + 1);
+            if (skinnable_bones > 0) cJSON_AddNumberToObject(lod_node, "skin", 0);
+            cJSON_AddItemToArray(lod_ids, cJSON_CreateNumber(2 + total_bones + l));
+            cJSON_AddItemToArray(nodes, lod_node);
+            cJSON_AddItemToArray(coverage, json_create_float(hint));
+            hint *= 0.25f;
+        }
+        // The last threshold is the cull distance: never cull, the game decides
+        cJSON_AddItemToArray(coverage, cJSON_CreateNumber(0));
+
+        cJSON *extensions = cJSON_CreateObject();
+        cJSON *msft_lod = cJSON_CreateObject();
+        cJSON_AddItemToObject(msft_lod, "ids", lod_ids);
+        cJSON_AddItemToObject(extensions, "MSFT_lod", msft_lod);
+        cJSON_AddItemToObject(mesh_node, "extensions", extensions);
+        cJSON *extras = cJSON_CreateObject();
+        cJSON_AddItemToObject(extras, "MSFT_screencoverage", coverage);
+        cJSON_AddItemToObject(mesh_node, "extras", extras);
+
+        cJSON *extensions_used = cJSON_CreateArray();
+        cJSON_AddItemToArray(extensions_used, cJSON_CreateString("MSFT_lod"));
+        cJSON_AddItemToObject(root, "extensionsUsed", extensions_used);
+    }
+
     cJSON_AddItemToObject(root, "nodes", nodes);
 
     // Meshes
     cJSON *meshes = cJSON_CreateArray();
-    cJSON *mesh = NULL;
-    // Force le nom du mesh à partir du nom du fichier de sortie
-    const char *forced_mesh_name = mesh_name;
-    if (strstr(output_file, "cube_nobones")) forced_mesh_name = "cube_nobones";
-    else if (strstr(output_file, "cube_4bones")) forced_mesh_name = "cube_4bones";
-    else if (strstr(output_file, "cube_5bones")) forced_mesh_name = "cube_5bones";
-    if (skinnable_bones > 0) {
-        mesh = json_create_mesh(forced_mesh_name, 0, 1, 2, 5, 3, 4);
-    } else {
-        mesh = cJSON_CreateObject();
-        cJSON *primitives = cJSON_CreateArray();
-        cJSON *primitive = cJSON_CreateObject();
-        cJSON *attributes = cJSON_CreateObject();
-        cJSON_AddNumberToObject(attributes, "POSITION", 0);
-        cJSON_AddNumberToObject(attributes, "NORMAL", 1);
-        cJSON_AddNumberToObject(attributes, "TEXCOORD_0", 2);
-        cJSON_AddItemToObject(primitive, "attributes", attributes);
-        cJSON_AddNumberToObject(primitive, "indices", 3);
-        cJSON_AddNumberToObject(primitive, "mode", 4);
-        cJSON_AddItemToArray(primitives, primitive);
-        cJSON_AddItemToObject(mesh, "primitives", primitives);
-        cJSON_AddStringToObject(mesh, "name", forced_mesh_name);
-    }
+    uint32_t first_lod_accessor = skinnable_bones > 0 ? 7 : 4;
+    cJSON *mesh = create_mesh(mesh_name, skinnable_bones > 0, skinnable_bones > 0 ? 5 : 3);
     cJSON_AddItemToArray(meshes, mesh);
+    for (uint32_t l = 0; l < lod_count; l++) {
+        char buf[160];
+        snprintf(buf, sizeof(buf), "%s_LOD%u", mesh_name ? mesh_name : "mesh", l + 1);
+        cJSON_AddItemToArray(meshes, create_mesh(buf, skinnable_bones > 0, first_lod_accessor + l));
+    }
+    // The flag accessor follows the LOD index accessors
+    if (single_influence) {
+        cJSON *lod_mesh = NULL;
+        cJSON_ArrayForEach(lod_mesh, meshes) {
+            cJSON *primitive = cJSON_GetArrayItem(cJSON_GetObjectItem(lod_mesh, "primitives"), 0);
+            cJSON_AddNumberToObject(cJSON_GetObjectItem(primitive, "attributes"), "_SINGLE_INFLUENCE",
+                                    first_lod_accessor + lod_count);
+        }
+    }
     cJSON_AddItemToObject(root, "meshes", meshes);
 
-    // Accessors
-    cJSON *accessors = cJSON_CreateArray();
-    cJSON_AddItemToArray(accessors, json_create_accessor(0, model->numVertices, "VEC3", "5126"));
-    cJSON_AddItemToArray(accessors, json_create_accessor(1, model->numVertices, "VEC3", "5126"));
-    cJSON_AddItemToArray(accessors, json_create_accessor(2, model->numVertices, "VEC2", "5126"));
-    if (skinnable_bones > 0) {
-        cJSON_AddItemToArray(accessors, json_create_accessor(3, model->numVertices, "VEC4", "5123"));
-        cJSON_AddItemToArray(accessors, json_create_accessor(4, model->numVertices, "VEC4", "5126"));
-        cJSON_AddItemToArray(accessors, json_create_accessor(5, model->numFaces * 3, "SCALAR", "5123"));
-        cJSON_AddItemToArray(accessors, json_create_accessor(6, skinnable_bones + model->numPropPoints, "MAT4", "5126"));
+    // Vertex attributes: one view per stream, or one strided view for all
+    uint32_t attribute_count = skinnable_bones > 0 ? 5 : 3;
+    uint32_t stream_count = attribute_count + (single_influence ? 1 : 0);
+    size_t weight_size = unsigned_type_size(weight_type);
+    VertexStream streams[6] = {
+        {positions, 3 * sizeof(float), sizeof(float), 0},
+        {normals, 3 * sizeof(float), sizeof(float), 0},
+        {texcoords, 2 * sizeof(float), sizeof(float), 0},
+        {packed_joints, 4 * unsigned_type_size(joint_type), unsigned_type_size(joint_type), 0},
+        {packed_weights ? packed_weights : weights, 4 * weight_size, weight_size, 0},
+        {single_influence, 4, 4, 0}
+    };
+    static const char *attribute_types[5] = {"VEC3", "VEC3", "VEC2", "VEC4", "VEC4"};
+    static const uint32_t attribute_sizes[5] = {3, 3, 2, 4, 4};
+    const int attribute_component_types[5] = {5126, 5126, 5126, joint_type, weight_type};
+    const char *attribute_components[5] = {"5126", "5126", "5126", joint_type_str, weight_type_str};
+    int attribute_views[6];
+    int lods_packed = 1;
+    for (uint32_t l = 0; l < lod_count; l++) {
+        if (!lods[l].packed_indices) lods_packed = 0;
+    }
+    if (!packed_indices || !packed_joints || !lods_packed || (weight_bits && !packed_weights) ||
+        (opts.flag_single_influence && skinnable_bones > 0 && !single_influence)) {
+        cJSON_Delete(root);
+        status = 0;
+        goto cleanup;
+    }
+    if (opts.interleaved) {
+        size_t stride = 0;
+        interleaved = interleave_vertex_streams(streams, stream_count, model->numVertices, &stride);
+        if (!interleaved) {
+            cJSON_Delete(root);
+            status = 0;
+            goto cleanup;
+        }
+        int view = export_views_add(&views, interleaved, stride * model->numVertices, stride);
+        for (uint32_t i = 0; i < stream_count; i++) attribute_views[i] = view;
     } else {
-        // Pour cube_nobones, forcer le nombre de vertices à 8 dans l'accessor
-        uint32_t vertex_count = 8;
-        cJSON_AddItemToArray(accessors, json_create_accessor(3, vertex_count * 3, "SCALAR", "5123"));
+        for (uint32_t i = 0; i < stream_count; i++) {
+            // The padded flag slots need an explicit stride
+            size_t stride = i == 5 ? streams[i].element_size : 0;
+            attribute_views[i] = export_views_add(&views, streams[i].data, streams[i].element_size * model->numVertices, stride);
+        }
     }
 
-    // Animation accessors
-    if (anim_data) {
-        uint32_t accessor_idx = 7;
-        for (uint32_t a = 0; a < anim_count; a++) {
-            if (!anims[a] || anims[a]->numFrames == 0) continue;
-
-            // Time accessor
-            cJSON *time_acc = json_create_accessor(accessor_idx, anims[a]->numFrames, "SCALAR", "5126");
-            cJSON *min_array = cJSON_CreateFloatArray((float[]){0.0f}, 1);
-            cJSON *max_array = cJSON_CreateFloatArray((float[]){(float)(anims[a]->numFrames - 1) / 30.0f}, 1);
-            cJSON_AddItemToObject(time_acc, "min", min_array);
-            cJSON_AddItemToObject(time_acc, "max", max_array);
-            cJSON_AddItemToArray(accessors, time_acc);
-            accessor_idx++;
-
-            // Per-bone accessors
-            for (uint32_t b = 0; b < anim_data[a].num_bones; b++) {
-                cJSON_AddItemToArray(accessors, json_create_accessor(accessor_idx, anims[a]->numFrames, "VEC3", "5126"));
-                accessor_idx++;
-                cJSON_AddItemToArray(accessors, json_create_accessor(accessor_idx, anims[a]->numFrames, "VEC4", "5126"));
-                accessor_idx++;
-            }
+    // Accessors
+    cJSON *accessors = cJSON_CreateArray();
+    for (uint32_t i = 0; i < attribute_count; i++) {
+        cJSON *accessor = json_create_accessor(attribute_views[i], model->numVertices, attribute_types[i], attribute_components[i]);
+        if (attribute_component_types[i] == 5126) {
+            add_float_bounds(accessor, streams[i].data, model->numVertices, attribute_sizes[i]);
+        } else {
+            add_unsigned_bounds(accessor, streams[i].data, attribute_component_types[i], model->numVertices, attribute_sizes[i]);
+        }
+        if (opts.interleaved) {
+            cJSON_AddNumberToObject(accessor, "byteOffset", (double)streams[i].offset);
         }
+        if (i == 4 && weight_bits) {
+            cJSON_AddTrueToObject(accessor, "normalized");
+        }
+        cJSON_AddItemToArray(accessors, accessor);
     }
-
-    cJSON_AddItemToObject(root, "accessors", accessors);
-
-    // BufferViews
-    cJSON *buffer_views = cJSON_CreateArray();
-    cJSON_AddItemToArray(buffer_views, json_create_buffer_view(0, positions_size));
-    cJSON_AddItemToArray(buffer_views, json_create_buffer_view(1, normals_size));
-    cJSON_AddItemToArray(buffer_views, json_create_buffer_view(2, texcoords_size));
+    int index_view = export_views_add(&views, packed_indices, indices_size, 0);
+    cJSON *index_accessor = json_create_accessor(index_view, model->numFaces * 3, "SCALAR", index_type_str);
+    add_unsigned_bounds(index_accessor, packed_indices, index_type, (size_t)model->numFaces * 3, 1);
+    cJSON_AddItemToArray(accessors, index_accessor);
     if (skinnable_bones > 0) {
-        cJSON_AddItemToArray(buffer_views, json_create_buffer_view(3, joints_size));
-        cJSON_AddItemToArray(buffer_views, json_create_buffer_view(4, weights_size));
-        cJSON_AddItemToArray(buffer_views, json_create_buffer_view(5, indices_size));
-        cJSON_AddItemToArray(buffer_views, json_create_buffer_view(6, ibm_size));
-    } else {
-        cJSON_AddItemToArray(buffer_views, json_create_buffer_view(3, indices_size));
+        int ibm_view = export_views_add(&views, ibm, ibm_size, 0);
+        cJSON *ibm_accessor = json_create_accessor(ibm_view, skinnable_bones + model->numPropPoints, "MAT4", "5126");
+        add_float_bounds(ibm_accessor, ibm, skinnable_bones + model->numPropPoints, 16);
+        cJSON_AddItemToArray(accessors, ibm_accessor);
     }
-
-    // Animation buffer views
-    if (anim_data) {
-        uint32_t view_idx = 7;
-        for (uint32_t a = 0; a < anim_count; a++) {
-            if (!anims[a] || anims[a]->numFrames == 0) continue;
-
-            cJSON_AddItemToArray(buffer_views, json_create_buffer_view(view_idx, anim_data[a].times_size));
-            view_idx++;
-
-            for (uint32_t b = 0; b < anim_data[a].num_bones; b++) {
-                cJSON_AddItemToArray(buffer_views, json_create_buffer_view(view_idx, anim_data[a].trans_size));
-                view_idx++;
-                cJSON_AddItemToArray(buffer_views, json_create_buffer_view(view_idx, anim_data[a].rot_size));
-                view_idx++;
-            }
+    for (uint32_t l = 0; l < lod_count; l++) {
+        char lod_type_str[8];
+        snprintf(lod_type_str, sizeof(lod_type_str), "%d", lods[l].index_type);
+        int lod_view = export_views_add(&views, lods[l].packed_indices,
+                                        lods[l].index_count * unsigned_type_size(lods[l].index_type), 0);
+        cJSON *lod_accessor = json_create_accessor(lod_view, lods[l].index_count, "SCALAR", lod_type_str);
+        add_unsigned_bounds(lod_accessor, lods[l].packed_indices, lods[l].index_type, lods[l].index_count, 1);
+        cJSON_AddItemToArray(accessors, lod_accessor);
+    }
+    if (single_influence) {
+        cJSON *accessor = json_create_accessor(attribute_views[5], model->numVertices, "SCALAR", "5121");
+        // Flags sit in the first byte of 4-byte slots: scan slots, keep byte 0
+        uint32_t min[4], max[4];
+        accessor_stats_unsigned(single_influence, 5121, model->numVertices, 4, min, max);
+        cJSON_AddItemToObject(accessor, "min", cJSON_CreateIntArray((const int[]){(int)min[0]}, 1));
+        cJSON_AddItemToObject(accessor, "max", cJSON_CreateIntArray((const int[]){(int)max[0]}, 1));
+        if (opts.interleaved) {
+            cJSON_AddNumberToObject(accessor, "byteOffset", (double)streams[5].offset);
         }
+        cJSON_AddItemToArray(accessors, accessor);
     }
 
-    cJSON_AddItemToObject(root, "bufferViews", buffer_views);
-
-    // Buffers
-    cJSON *buffers = cJSON_CreateArray();
-    cJSON_AddItemToArray(buffers, json_create_buffer(positions_size, pos_uri));
-    cJSON_AddItemToArray(buffers, json_create_buffer(normals_size, norm_uri));
-    cJSON_AddItemToArray(buffers, json_create_buffer(texcoords_size, tex_uri));
-    if (skinnable_bones > 0) {
-        cJSON_AddItemToArray(buffers, json_create_buffer(joints_size, joints_uri));
-        cJSON_AddItemToArray(buffers, json_create_buffer(weights_size, weights_uri));
-        cJSON_AddItemToArray(buffers, json_create_buffer(indices_size, idx_uri));
-        cJSON_AddItemToArray(buffers, json_create_buffer(ibm_size, ibm_uri));
-    } else {
-        cJSON_AddItemToArray(buffers, json_create_buffer(indices_size, idx_uri));
+    // Animation accessors
+    if (anim_data && !library && !add_animation_accessors(accessors, &views, opts.anim_store, anim_data, anim_count)) {
+        cJSON_Delete(accessors);
+        cJSON_Delete(root);
+        status = 0;
+        goto cleanup;
     }
 
-    // Animation buffers
-    if (anim_data) {
-        for (uint32_t a = 0; a < anim_count; a++) {
-            if (!anims[a] || anims[a]->numFrames == 0) continue;
-
-            cJSON_AddItemToArray(buffers, json_create_buffer(anim_data[a].times_size, anim_data[a].times_uri));
-
-            for (uint32_t b = 0; b < anim_data[a].num_bones; b++) {
-                cJSON_AddItemToArray(buffers, json_create_buffer(anim_data[a].trans_size, anim_data[a].trans_uris[b]));
-                cJSON_AddItemToArray(buffers, json_create_buffer(anim_data[a].rot_size, anim_data[a].rot_uris[b]));
-            }
-        }
+    cJSON_AddItemToObject(root, "accessors", accessors);
+    if (views.failed) {
+        cJSON_Delete(root);
+        status = 0;
+        goto cleanup;
     }
 
-    cJSON_AddItemToObject(root, "buffers", buffers);
+    add_buffers(root, &views, &blob, &opts, output_file);
 
     // Skin
     if (skinnable_bones > 0) {
         cJSON *skins = cJSON_CreateArray();
         uint32_t *joint_indices = calloc(skinnable_bones + model->numPropPoints, sizeof(uint32_t));
+        if (!joint_indices) {
+            fprintf(stderr, "Error: Out of memory for the skin joints\n");
+            cJSON_Delete(skins);
+            cJSON_Delete(root);
+            status = 0;
+            goto cleanup;
+        }
         for (uint32_t i = 0; i < skinnable_bones; i++) {
             joint_indices[i] = i + 3;
         }
@@ -711,66 +1700,72 @@ int export_gltf(const char *output_file, PMDModel *model, PSAAnimation **anims,
             joint_indices[skinnable_bones + i] = model->numBones + i + 2;
         }
         cJSON *skin = json_create_skin(6, joint_indices, skinnable_bones + model->numPropPoints, 0);
+        // Joint-space boxes of the vertices each joint dominates; props get null
+        JointBounds *joint_bounds = opts.joint_bounds ? calloc(skinnable_bones, sizeof(JointBounds)) : NULL;
+        if (joint_bounds) {
+            joint_bounds_compute(positions, joints, weights, model->numVertices, ibm, skinnable_bones, joint_bounds);
+            cJSON *boxes = cJSON_CreateArray();
+            uint32_t bounded = 0;
+            for (uint32_t i = 0; i < skinnable_bones + model->numPropPoints; i++) {
+                if (i >= skinnable_bones || joint_bounds[i].vertices == 0) {
+                    cJSON_AddItemToArray(boxes, cJSON_CreateNull());
+                    continue;
+                }
+                cJSON *box = cJSON_CreateObject();
+                cJSON_AddItemToObject(box, "min", json_create_float_array(joint_bounds[i].min, 3));
+                cJSON_AddItemToObject(box, "max", json_create_float_array(joint_bounds[i].max, 3));
+                cJSON_AddItemToArray(boxes, box);
+                bounded++;
+            }
+            cJSON *extras = cJSON_CreateObject();
+            cJSON_AddItemToObject(extras, "jointBounds", boxes);
+            cJSON_AddItemToObject(skin, "extras", extras);
+            printf("  Joint bounds: %u of %u joints own vertices\n", bounded, skinnable_bones);
+            free(joint_bounds);
+        }
         cJSON_AddItemToArray(skins, skin);
         cJSON_AddItemToObject(root, "skins", skins);
         free(joint_indices);
     }
 
     // Animations
-    if (skinnable_bones > 0 && anim_data && anim_count > 0) {
-        cJSON *animations = cJSON_CreateArray();
-        uint32_t accessor_base = 7;
-
+    if (skinnable_bones > 0 && anim_data && anim_count > 0 && !library) {
+        cJSON_AddItemToObject(root, "animations", create_animations(anim_data, anim_count, 2));
+    }
+    if (library) {
+        // The library file and the names this model's clips have in it
+        char library_uri[256];
+        gltf_anim_library_file_name(library, opts.format, library_uri, sizeof(library_uri));
+        cJSON *reference = cJSON_CreateObject();
+        cJSON_AddStringToObject(reference, "uri", library_uri);
+        cJSON *clip_list = cJSON_CreateArray();
         for (uint32_t a = 0; a < anim_count; a++) {
-            if (!anims[a] || anims[a]->numFrames == 0) continue;
-
-            cJSON *animation = cJSON_CreateObject();
-            cJSON_AddStringToObject(animation, "name", anims[a]->name ? anims[a]->name : "Animation");
-
-            cJSON *samplers = cJSON_CreateArray();
-            uint32_t time_accessor = accessor_base;
-            accessor_base++;
-
-            for (uint32_t b = 0; b < anim_data[a].num_bones; b++) {
-                uint32_t trans_accessor = accessor_base++;
-                uint32_t rot_accessor = accessor_base++;
-
-                cJSON_AddItemToArray(samplers, json_create_animation_sampler(time_accessor, trans_accessor, "LINEAR"));
-                cJSON_AddItemToArray(samplers, json_create_animation_sampler(time_accessor, rot_accessor, "LINEAR"));
+            if (anim_data[a].frames == 0) continue;
+            cJSON *clip = cJSON_CreateObject();
+            cJSON_AddStringToObject(clip, "name", library_names[a]);
+            if (anim_data[a].has_bounds) {
+                cJSON_AddItemToObject(clip, "bounds", create_clip_bounds(&anim_data[a].bounds));
             }
-
-            cJSON_AddItemToObject(animation, "samplers", samplers);
-
-            cJSON *channels = cJSON_CreateArray();
-            for (uint32_t b = 0; b < anim_data[a].num_bones; b++) {
-                uint32_t trans_sampler = b * 2;
-                uint32_t rot_sampler = b * 2 + 1;
-                uint32_t node = b + 2;
-
-                cJSON_AddItemToArray(channels, json_create_animation_channel(trans_sampler, node, "translation"));
-                cJSON_AddItemToArray(channels, json_create_animation_channel(rot_sampler, node, "rotation"));
-            }
-
-            cJSON_AddItemToObject(animation, "channels", channels);
-            cJSON_AddItemToArray(animations, animation);
+            cJSON_AddItemToArray(clip_list, clip);
         }
-
-        cJSON_AddItemToObject(root, "animations", animations);
+        cJSON_AddItemToObject(reference, "animations", clip_list);
+        cJSON *extras = cJSON_CreateObject();
+        cJSON_AddItemToObject(extras, "animationLibrary", reference);
+        cJSON_AddItemToObject(root, "extras", extras);
     }
 
-    // Write to file
-    FILE *f = fopen(output_file, "w");
-    if (!f) {
-        fprintf(stderr, "Failed to create output file\n");
-        cJSON_Delete(root);
-        goto cleanup;
+    // Write to file; streamed tracks go to the .bin first, which sets
+    // their accessor bounds, and write_gltf_file then skips it
+    if (views.deferred_count > 0) {
+        if (!write_streamed_bin(output_file, &blob, &views, anim_data, anim_count, skel, model, &opts)) {
+            cJSON_Delete(root);
+            status = 0;
+            goto cleanup;
+        }
+        byte_writer_free(&blob);
+        byte_writer_init(&blob, 0);
     }
-
-    char *json_str = cJSON_Print(root);
-    fprintf(f, "%s\n", json_str);
-    fclose(f);
-    free(json_str);
-    cJSON_Delete(root);
+    if (!write_gltf_file(output_file, root, &blob, &opts)) status = 0;
 
     // Cleanup
 cleanup:
@@ -779,37 +1774,208 @@ cleanup:
     free(texcoords);
     free(indices);
     free(joints);
+    free(packed_indices);
+    free(packed_joints);
+    free(packed_weights);
+    free(single_influence);
+    for (uint32_t l = 0; l < lod_count; l++) {
+        free(lods[l].indices);
+        free(lods[l].packed_indices);
+    }
     free(weights);
     free(ibm);
     free(bone_to_joint);
-    free(pos_uri);
-    free(norm_uri);
-    free(tex_uri);
-    free(idx_uri);
-    free(joints_uri);
-    free(weights_uri);
-    free(ibm_uri);
+    free(prop_offsets);
+    free(prop_order);
+    pose_free(&rest_pose);
+    free(interleaved);
+    free(views.views);
+    byte_writer_free(&blob);
+    free(library_names);
 
     if (anim_data) {
         for (uint32_t a = 0; a < anim_count; a++) {
-            if (!anims[a] || anims[a]->numFrames == 0) continue;
-
             free(anim_data[a].times);
-            free(anim_data[a].times_uri);
 
-            for (uint32_t b = 0; b < anim_data[a].num_bones; b++) {
+            for (uint32_t b = 0; anim_data[a].translations && anim_data[a].rotations && b < anim_data[a].num_bones; b++) {
                 free(anim_data[a].translations[b]);
                 free(anim_data[a].rotations[b]);
-                free(anim_data[a].trans_uris[b]);
-                free(anim_data[a].rot_uris[b]);
             }
 
             free(anim_data[a].translations);
             free(anim_data[a].rotations);
-            free(anim_data[a].trans_uris);
-            free(anim_data[a].rot_uris);
+            free(anim_data[a].sampler_accessors);
+            free(anim_data[a].stream_views);
+            free(anim_data[a].stream_accessors);
+            if (anim_data[a].fitted) {
+                for (uint32_t t = 0; t < anim_data[a].num_bones * 2; t++) {
+                    fitted_track_free(&anim_data[a].fitted[t]);
+                }
+                free(anim_data[a].fitted);
+            }
         }
         free(anim_data);
     }
-    return 1;
+    if (resampled) {
+        for (uint32_t a = 0; a < anim_count; a++) {
+            if (resampled[a] != anims[a]) free_psa(resampled[a]);
+        }
+        free(resampled);
+    }
+    return status;
+}
+
+typedef struct {
+    const char *name;
+    uint32_t index;
+} AnimOrder;
+
+// Byte order of the clip names, whatever order the PSA files were listed in
+static int compare_anim_order(const void *a, const void *b) {
+    const AnimOrder *x = a, *y = b;
+    int c = strcmp(x->name, y->name);
+    if (c) return c;
+    return x->index < y->index ? -1 : x->index > y->index;
+}
+
+int export_gltf_with_options(const char *output_file, PMDModel *model, PSAAnimation **anims, uint32_t anim_count, const SkeletonDef *skel, const char *mesh_name, const float *anim_speed_percent, const char *rest_pose_anim, const GltfExportOptions *options) {
+    if (!options || !options->reproducible || !anims || anim_count < 2) {
+        return export_model(output_file, model, anims, anim_count, skel, mesh_name, anim_speed_percent, rest_pose_anim, options);
+    }
+
+    AnimOrder *order = malloc(anim_count * sizeof(AnimOrder));
+    PSAAnimation **sorted = malloc(anim_count * sizeof(PSAAnimation*));
+    float *speeds = anim_speed_percent ? malloc(anim_count * sizeof(float)) : NULL;
+    if (!order || !sorted || (anim_speed_percent && !speeds)) {
+        free(order);
+        free(sorted);
+        free(speeds);
+        return 0;
+    }
+    for (uint32_t a = 0; a < anim_count; a++) {
+        order[a].name = anims[a] && anims[a]->name ? anims[a]->name : "";
+        order[a].index = a;
+    }
+    qsort(order, anim_count, sizeof(AnimOrder), compare_anim_order);
+    for (uint32_t a = 0; a < anim_count; a++) {
+        sorted[a] = anims[order[a].index];
+        if (speeds) speeds[a] = anim_speed_percent[order[a].index];
+    }
+    int ok = export_model(output_file, model, sorted, anim_count, skel, mesh_name, speeds, rest_pose_anim, options);
+    free(order);
+    free(sorted);
+    free(speeds);
+    return ok;
+}
+
+void gltf_anim_library_file_name(const AnimLibrary *lib, GltfOutputFormat format, char *out, size_t size) {
+    snprintf(out, size, "%s.anims.%s", lib->stem, format == GLTF_OUTPUT_GLB ? "glb" : "gltf");
+}
+
+int export_anim_library(const char *output_file, AnimLibrary *lib, const GltfExportOptions *options) {
+    GltfExportOptions opts;
+    gltf_export_options_init(&opts);
+    if (options) opts = *options;
+    const SkeletonDef *skel = lib->skel;
+
+    // Clip tracks are bone-major arrays: point each track into them
+    AnimData *anim_data = calloc(lib->clip_count + 1, sizeof(AnimData));
+    if (!anim_data) return 0;
+    int status = 1;
+    for (uint32_t c = 0; c < lib->clip_count; c++) {
+        AnimLibraryClip *clip = &lib->clips[c];
+        AnimData *data = &anim_data[c];
+        size_t frames = clip->frame_count;
+        data->translations = calloc(clip->bone_count + 1, sizeof(float*));
+        data->rotations = calloc(clip->bone_count + 1, sizeof(float*));
+        if (!data->translations || !data->rotations) {
+            status = 0;
+            break;
+        }
+        data->name = clip->name;
+        data->frames = clip->frame_count;
+        data->times = clip->times;
+        data->num_bones = clip->bone_count;
+        data->times_size = frames * sizeof(float);
+        data->trans_size = frames * 3 * sizeof(float);
+        data->rot_size = frames * 4 * sizeof(float);
+        for (uint32_t b = 0; b < clip->bone_count; b++) {
+            data->translations[b] = &clip->translations[b * frames * 3];
+            data->rotations[b] = &clip->rotations[b * frames * 4];
+        }
+    }
+    if (status && opts.fit_error > 0.0f) {
+        fit_animations(anim_data, lib->clip_count, &opts);
+    }
+
+    ExportViewList views = {0};
+    ByteWriter blob;
+    byte_writer_init(&blob, 0);
+    cJSON *root = NULL;
+    if (!status) goto cleanup;
+
+    root = cJSON_CreateObject();
+    cJSON *asset = cJSON_CreateObject();
+    cJSON_AddStringToObject(asset, "version", "2.0");
+    cJSON_AddStringToObject(asset, "generator", "PMD-PSA-Converter");
+    cJSON_AddItemToObject(root, "asset", asset);
+
+    // Bone b is node b; the scene holds the skeleton roots
+    cJSON_AddNumberToObject(root, "scene", 0);
+    cJSON *scenes = cJSON_CreateArray();
+    cJSON *scene = cJSON_CreateObject();
+    cJSON *scene_nodes = cJSON_CreateArray();
+    for (int r = 0; r < skel->root_count; r++) {
+        cJSON_AddItemToArray(scene_nodes, cJSON_CreateNumber(skel->topo_order[r]));
+    }
+    cJSON_AddItemToObject(scene, "nodes", scene_nodes);
+    if (skel->title[0] != '\0') cJSON_AddStringToObject(scene, "name", skel->title);
+    cJSON_AddItemToArray(scenes, scene);
+    cJSON_AddItemToObject(root, "scenes", scenes);
+
+    cJSON *nodes = cJSON_CreateArray();
+    for (int b = 0; b < skel->bone_count; b++) {
+        cJSON *bone_node = cJSON_CreateObject();
+        cJSON_AddStringToObject(bone_node, "name", skel->bones[b].name);
+        const BoneState *rest = &lib->rest[b];
+        float trans[3] = {rest->translation.x, rest->translation.y, rest->translation.z};
+        float rot[4] = {rest->rotation.x, rest->rotation.y, rest->rotation.z, rest->rotation.w};
+        cJSON_AddItemToObject(bone_node, "translation", json_create_float_array(trans, 3));
+        cJSON_AddItemToObject(bone_node, "rotation", json_create_float_array(rot, 4));
+        int child_count = 0;
+        const int *child_bones = skeleton_children(skel, b, &child_count);
+        if (child_count > 0) {
+            cJSON_AddItemToObject(bone_node, "children", cJSON_CreateIntArray(child_bones, child_count));
+        }
+        cJSON_AddItemToArray(nodes, bone_node);
+    }
+    cJSON_AddItemToObject(root, "nodes", nodes);
+
+    cJSON *accessors = cJSON_CreateArray();
+    cJSON_AddItemToObject(root, "accessors", accessors);
+    if (!add_animation_accessors(accessors, &views, opts.anim_store, anim_data, lib->clip_count) || views.failed) {
+        cJSON_Delete(root);
+        status = 0;
+        goto cleanup;
+    }
+    add_buffers(root, &views, &blob, &opts, output_file);
+    cJSON_AddItemToObject(root, "animations", create_animations(anim_data, lib->clip_count, 0));
+    status = write_gltf_file(output_file, root, &blob, &opts);
+
+cleanup:
+    free(views.views);
+    byte_writer_free(&blob);
+    for (uint32_t c = 0; c < lib->clip_count; c++) {
+        free(anim_data[c].translations);
+        free(anim_data[c].rotations);
+        free(anim_data[c].sampler_accessors);
+        if (anim_data[c].fitted) {
+            for (uint32_t t = 0; t < anim_data[c].num_bones * 2; t++) {
+                fitted_track_free(&anim_data[c].fitted[t]);
+            }
+            free(anim_data[c].fitted);
+        }
+    }
+    free(anim_data);
+    return status;
 }
@@ -3,12 +3,62 @@
 
 #include "pmd_psa_types.h"
 #include "skeleton.h"
+#include "skin_optimize.h"
+#include "anim_store.h"
+#include "anim_library.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-int export_gltf(const char *output_file, PMDModel *model, PSAAnimation **anims, uint32_t anim_count, SkeletonDef *skel, const char *mesh_name, const float *anim_speed_percent, const char *rest_pose_anim);
+// Where the binary data goes
+typedef enum {
+    GLTF_OUTPUT_EMBEDDED,   // .gltf, one base64 data URI buffer per view
+    GLTF_OUTPUT_SEPARATE,   // .gltf plus a single .bin next to it
+    GLTF_OUTPUT_GLB         // single binary .glb container
+} GltfOutputFormat;
+
+// Levels of detail, counting the full mesh
+#define GLTF_MAX_LOD_LEVELS 4
+
+// Frames decoded at a time for streamed clips when stream_window is 0
+#define GLTF_DEFAULT_STREAM_WINDOW 256
+
+typedef struct {
+    GltfOutputFormat format;
+    int interleaved;        // one strided vertex view instead of one view per attribute
+    int lod_levels;         // 2..GLTF_MAX_LOD_LEVELS adds simplified MSFT_lod meshes, 0 or 1 disables
+    int optimize_skin;      // run optimize_skin_weights() with skin on skinned meshes
+    SkinOptimizeOptions skin;
+    int flag_single_influence;  // adds a _SINGLE_INFLUENCE vertex attribute (implies optimize_skin)
+    float sample_rate;      // animation keys per second, 0 keeps every 30 fps PSA frame
+    float fit_error;        // > 0 fits CUBICSPLINE/LINEAR tracks to this translation error (model units)
+    float fit_angle;        // rotation error bound in radians when fitting
+    int threads;            // worker threads for per-vertex passes, 0 = all cores
+    int clip_bounds;        // skin every key frame and write per-animation bounds into extras
+    int joint_bounds;       // write joint-space boxes of each joint's dominant vertices into skin extras
+    AnimStore *anim_store;  // when set, animation data goes to this shared file instead of the model's buffers
+    AnimLibrarySet *anim_libraries;  // when set, clips of skinned models with a skeleton go to its library
+    int atomic_write;       // write each file under a temporary name and rename it into place
+    int reproducible;       // export clips sorted by name so listing order cannot change the bytes
+    uint32_t stream_window; // frames decoded at a time for clips opened with open_psa_stream, 0 = default
+} GltfExportOptions;
+
+// Defaults match export_gltf(): embedded buffers, one stream per attribute,
+// no LODs, influences exported as read, PSA frames kept as LINEAR keys
+void gltf_export_options_init(GltfExportOptions *options);
+
+int export_gltf_with_options(const char *output_file, PMDModel *model, PSAAnimation **anims, uint32_t anim_count, const SkeletonDef *skel, const char *mesh_name, const float *anim_speed_percent, const char *rest_pose_anim, const GltfExportOptions *options);
+
+int export_gltf(const char *output_file, PMDModel *model, PSAAnimation **anims, uint32_t anim_count, const SkeletonDef *skel, const char *mesh_name, const float *anim_speed_percent, const char *rest_pose_anim);
+
+// File name (no directory) the models of lib reference for format
+void gltf_anim_library_file_name(const AnimLibrary *lib, GltfOutputFormat format, char *out, size_t size);
+
+// Write a skeleton's animation library: one node per skeleton bone, named as
+// in the skeleton JSON and posed as the first model using it, plus every
+// clip. Uses the format, fitting and anim_store of options.
+int export_anim_library(const char *output_file, AnimLibrary *lib, const GltfExportOptions *options);
 
 #ifdef __cplusplus
 }
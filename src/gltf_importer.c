@@ -0,0 +1,970 @@
+#include "portable_string.h"
+#include "gltf_importer.h"
+#include "pmd_writer.h"
+#include "binary_io.h"
+#include "filesystem.h"
+#include "pose.h"
+#include "transform.h"
+#include "cJSON.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GLB_MAGIC       0x46546C67u   // "glTF"
+#define GLB_CHUNK_JSON  0x4E4F534Au   // "JSON"
+#define GLB_CHUNK_BIN   0x004E4942u   // "BIN\0"
+#define IMPORT_FPS      30.0f
+#define MAX_PMD_BONES   254           // 0xFF marks an unused influence
+
+typedef enum {
+    INTERP_LINEAR,
+    INTERP_STEP,
+    INTERP_CUBICSPLINE
+} Interpolation;
+
+typedef struct {
+    uint8_t *data;
+    size_t size;
+} GltfBuffer;
+
+typedef struct {
+    uint32_t count;
+    int components;
+    float *values;      // count * components, normalized integers already scaled
+    int loaded;
+} AccessorData;
+
+typedef struct {
+    cJSON *root;
+    const cJSON *nodes;
+    int node_count;
+    int *node_parents;      // -1 for scene roots
+    GltfBuffer *buffers;
+    int buffer_count;
+    AccessorData *accessors;  // decoded on first use
+    int accessor_count;
+} GltfDocument;
+
+static int base64_value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+' || c == '-') return 62;
+    if (c == '/' || c == '_') return 63;
+    return -1;
+}
+
+// Decode base64, skipping padding and whitespace
+static uint8_t* decode_base64(const char *text, size_t *size) {
+    size_t len = strlen(text);
+    uint8_t *out = malloc(len / 4 * 3 + 3);
+    if (!out) return NULL;
+
+    uint32_t acc = 0;
+    int bits = 0;
+    size_t n = 0;
+    for (size_t i = 0; i < len; i++) {
+        int v = base64_value(text[i]);
+        if (v < 0) continue;
+        acc = (acc << 6) | (uint32_t)v;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out[n++] = (uint8_t)(acc >> bits);
+        }
+    }
+    *size = n;
+    return out;
+}
+
+static int json_int(const cJSON *obj, const char *key, int fallback) {
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(obj, key);
+    return item && cJSON_IsNumber(item) ? item->valueint : fallback;
+}
+
+static const char* json_string(const cJSON *obj, const char *key) {
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(obj, key);
+    return item && cJSON_IsString(item) ? item->valuestring : NULL;
+}
+
+static const cJSON* json_array(const cJSON *obj, const char *key) {
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(obj, key);
+    return item && cJSON_IsArray(item) ? item : NULL;
+}
+
+static const cJSON* get_node(const GltfDocument *doc, int index) {
+    if (index < 0 || index >= doc->node_count) return NULL;
+    return cJSON_GetArrayItem(doc->nodes, index);
+}
+
+// Resolve a buffer URI: embedded data URI, otherwise a path relative to the glTF file
+static uint8_t* load_buffer_uri(const char *uri, const char *gltf_file, size_t *size) {
+    if (strncmp(uri, "data:", 5) == 0) {
+        const char *payload = strstr(uri, ";base64,");
+        if (!payload) {
+            fprintf(stderr, "Unsupported data URI encoding in glTF buffer\n");
+            return NULL;
+        }
+        return decode_base64(payload + 8, size);
+    }
+
+    char path[1024];
+    const char *dir_end = strrchr(gltf_file, '/');
+    const char *dir_end_win = strrchr(gltf_file, '\\');
+    if (dir_end_win > dir_end) dir_end = dir_end_win;
+    if (dir_end) {
+        snprintf(path, sizeof(path), "%.*s/%s", (int)(dir_end - gltf_file), gltf_file, uri);
+    } else {
+        snprintf(path, sizeof(path), "%s", uri);
+    }
+    uint8_t *data = (uint8_t *)read_file(path, size);
+    if (!data) fprintf(stderr, "Failed to read glTF buffer: %s\n", path);
+    return data;
+}
+
+static int load_buffers(GltfDocument *doc, const char *gltf_file, const uint8_t *glb_bin, size_t glb_bin_size) {
+    const cJSON *buffers = json_array(doc->root, "buffers");
+    doc->buffer_count = buffers ? cJSON_GetArraySize(buffers) : 0;
+    if (doc->buffer_count == 0) return 1;
+    doc->buffers = calloc((size_t)doc->buffer_count, sizeof(GltfBuffer));
+    if (!doc->buffers) return 0;
+
+    for (int i = 0; i < doc->buffer_count; i++) {
+        const cJSON *buffer = cJSON_GetArrayItem(buffers, i);
+        const char *uri = json_string(buffer, "uri");
+        size_t byte_length = (size_t)json_int(buffer, "byteLength", 0);
+        GltfBuffer *out = &doc->buffers[i];
+
+        if (uri) {
+            out->data = load_buffer_uri(uri, gltf_file, &out->size);
+        } else if (glb_bin && i == 0) {
+            out->data = malloc(glb_bin_size ? glb_bin_size : 1);
+            if (out->data) {
+                memcpy(out->data, glb_bin, glb_bin_size);
+                out->size = glb_bin_size;
+            }
+        }
+        if (!out->data) {
+            fprintf(stderr, "glTF buffer %d has no data\n", i);
+            return 0;
+        }
+        if (out->size < byte_length) {
+            fprintf(stderr, "glTF buffer %d is shorter than its byteLength\n", i);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int type_components(const char *type) {
+    if (!type) return 0;
+    if (strcmp(type, "SCALAR") == 0) return 1;
+    if (strcmp(type, "VEC2") == 0) return 2;
+    if (strcmp(type, "VEC3") == 0) return 3;
+    if (strcmp(type, "VEC4") == 0) return 4;
+    if (strcmp(type, "MAT4") == 0) return 16;
+    return 0;
+}
+
+static size_t component_size(int component_type) {
+    switch (component_type) {
+        case 5120: case 5121: return 1;
+        case 5122: case 5123: return 2;
+        case 5125: case 5126: return 4;
+        default: return 0;
+    }
+}
+
+static float read_component(ByteReader *r, int component_type, int normalized) {
+    switch (component_type) {
+        case 5120: {
+            float v = (float)(int8_t)byte_reader_u8(r);
+            return normalized ? fmaxf(v / 127.0f, -1.0f) : v;
+        }
+        case 5121: {
+            float v = (float)byte_reader_u8(r);
+            return normalized ? v / 255.0f : v;
+        }
+        case 5122: {
+            float v = (float)(int16_t)byte_reader_u16(r);
+            return normalized ? fmaxf(v / 32767.0f, -1.0f) : v;
+        }
+        case 5123: {
+            float v = (float)byte_reader_u16(r);
+            return normalized ? v / 65535.0f : v;
+        }
+        case 5125: return (float)byte_reader_u32(r);
+        default: return byte_reader_f32(r);
+    }
+}
+
+// Decode an accessor into floats once; later calls return the cached values
+static const AccessorData* read_accessor(GltfDocument *doc, int index) {
+    if (index < 0 || index >= doc->accessor_count) return NULL;
+    AccessorData *out = &doc->accessors[index];
+    if (out->loaded) return out->values ? out : NULL;
+    out->loaded = 1;
+
+    const cJSON *accessor = cJSON_GetArrayItem(json_array(doc->root, "accessors"), index);
+    int component_type = json_int(accessor, "componentType", 0);
+    int components = type_components(json_string(accessor, "type"));
+    size_t csize = component_size(component_type);
+    const cJSON *normalized_item = cJSON_GetObjectItemCaseSensitive(accessor, "normalized");
+    int normalized = normalized_item && cJSON_IsTrue(normalized_item);
+    int count = json_int(accessor, "count", 0);
+    if (components == 0 || csize == 0 || count < 0) {
+        fprintf(stderr, "Unsupported glTF accessor %d\n", index);
+        return NULL;
+    }
+    if (cJSON_GetObjectItemCaseSensitive(accessor, "sparse")) {
+        fprintf(stderr, "Warning: sparse accessor %d read as its base values\n", index);
+    }
+
+    out->count = (uint32_t)count;
+    out->components = components;
+    out->values = calloc((size_t)count * components + 1, sizeof(float));
+    if (!out->values) return NULL;
+
+    int view_index = json_int(accessor, "bufferView", -1);
+    if (view_index < 0 || count == 0) return out;   // no view: all zeros
+
+    const cJSON *view = cJSON_GetArrayItem(json_array(doc->root, "bufferViews"), view_index);
+    int buffer_index = json_int(view, "buffer", -1);
+    size_t view_offset = (size_t)json_int(view, "byteOffset", 0);
+    size_t view_length = (size_t)json_int(view, "byteLength", 0);
+    size_t stride = (size_t)json_int(view, "byteStride", 0);
+    size_t accessor_offset = (size_t)json_int(accessor, "byteOffset", 0);
+    size_t element_size = csize * (size_t)components;
+    if (stride == 0) stride = element_size;
+
+    if (!view || buffer_index < 0 || buffer_index >= doc->buffer_count ||
+        view_offset > doc->buffers[buffer_index].size ||
+        view_length > doc->buffers[buffer_index].size - view_offset ||
+        accessor_offset + stride * ((size_t)count - 1) + element_size > view_length) {
+        fprintf(stderr, "glTF accessor %d is out of bounds\n", index);
+        free(out->values);
+        out->values = NULL;
+        return NULL;
+    }
+
+    ByteReader r;
+    byte_reader_init(&r, doc->buffers[buffer_index].data + view_offset, view_length);
+    float *dst = out->values;
+    for (int i = 0; i < count; i++) {
+        r.pos = accessor_offset + (size_t)i * stride;
+        for (int c = 0; c < components; c++) {
+            *dst++ = read_component(&r, component_type, normalized);
+        }
+    }
+    return out;
+}
+
+static BoneState node_local_state(const cJSON *node) {
+    BoneState state = {{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 1.0f}};
+    const cJSON *matrix = json_array(node, "matrix");
+    if (matrix && cJSON_GetArraySize(matrix) == 16) {
+        float m[16];
+        for (int i = 0; i < 16; i++) m[i] = (float)cJSON_GetArrayItem(matrix, i)->valuedouble;
+        matrix_to_bone_state(m, &state);
+        return state;
+    }
+
+    const cJSON *t = json_array(node, "translation");
+    if (t && cJSON_GetArraySize(t) == 3) {
+        state.translation.x = (float)cJSON_GetArrayItem(t, 0)->valuedouble;
+        state.translation.y = (float)cJSON_GetArrayItem(t, 1)->valuedouble;
+        state.translation.z = (float)cJSON_GetArrayItem(t, 2)->valuedouble;
+    }
+    const cJSON *r = json_array(node, "rotation");
+    if (r && cJSON_GetArraySize(r) == 4) {
+        state.rotation.x = (float)cJSON_GetArrayItem(r, 0)->valuedouble;
+        state.rotation.y = (float)cJSON_GetArrayItem(r, 1)->valuedouble;
+        state.rotation.z = (float)cJSON_GetArrayItem(r, 2)->valuedouble;
+        state.rotation.w = (float)cJSON_GetArrayItem(r, 3)->valuedouble;
+    }
+    return state;
+}
+
+// World state of a node: its local TRS composed up through every ancestor
+static BoneState node_world_state(const GltfDocument *doc, int node) {
+    BoneState world = node_local_state(get_node(doc, node));
+    int parent = doc->node_parents[node];
+    for (int guard = 0; parent >= 0 && guard < doc->node_count; guard++) {
+        BoneState parent_local = node_local_state(get_node(doc, parent));
+        BoneState composed;
+        compose_world_transform(&composed, &world, &parent_local);
+        world = composed;
+        parent = doc->node_parents[parent];
+    }
+    return world;
+}
+
+static int is_ancestor(const GltfDocument *doc, int ancestor, int node) {
+    int parent = doc->node_parents[node];
+    for (int guard = 0; parent >= 0 && guard < doc->node_count; guard++) {
+        if (parent == ancestor) return 1;
+        parent = doc->node_parents[parent];
+    }
+    return 0;
+}
+
+static int is_prop_node(const cJSON *node) {
+    const char *name = json_string(node, "name");
+    return name && strncmp(name, "prop-", 5) == 0;
+}
+
+static int load_document(GltfDocument *doc, const char *filename) {
+    memset(doc, 0, sizeof(*doc));
+    size_t size = 0;
+    char *content = read_file(filename, &size);
+    if (!content) {
+        fprintf(stderr, "Failed to open glTF file: %s\n", filename);
+        return 0;
+    }
+
+    const char *json_text = content;
+    size_t json_size = size;
+    const uint8_t *bin = NULL;
+    size_t bin_size = 0;
+
+    ByteReader r;
+    byte_reader_init(&r, content, size);
+    if (size >= 12 && byte_reader_u32(&r) == GLB_MAGIC) {
+        byte_reader_u32(&r);   // container version
+        uint32_t total = byte_reader_u32(&r);
+        if (total < r.size) r.size = total;
+        json_text = NULL;
+        while (byte_reader_remaining(&r) >= 8) {
+            uint32_t chunk_size = byte_reader_u32(&r);
+            uint32_t chunk_type = byte_reader_u32(&r);
+            const uint8_t *chunk = byte_reader_take(&r, chunk_size);
+            if (!chunk) break;
+            if (chunk_type == GLB_CHUNK_JSON && !json_text) {
+                json_text = (const char *)chunk;
+                json_size = chunk_size;
+            } else if (chunk_type == GLB_CHUNK_BIN && !bin) {
+                bin = chunk;
+                bin_size = chunk_size;
+            }
+        }
+        if (!json_text) {
+            fprintf(stderr, "GLB file has no JSON chunk: %s\n", filename);
+            free(content);
+            return 0;
+        }
+    }
+
+    doc->root = cJSON_ParseWithLength(json_text, json_size);
+    if (!doc->root || !cJSON_IsObject(doc->root)) {
+        fprintf(stderr, "Invalid glTF JSON: %s\n", filename);
+        free(content);
+        return 0;
+    }
+
+    int ok = load_buffers(doc, filename, bin, bin_size);
+    free(content);
+    if (!ok) return 0;
+
+    const cJSON *accessors = json_array(doc->root, "accessors");
+    doc->accessor_count = accessors ? cJSON_GetArraySize(accessors) : 0;
+    doc->accessors = calloc((size_t)doc->accessor_count + 1, sizeof(AccessorData));
+
+    doc->nodes = json_array(doc->root, "nodes");
+    doc->node_count = doc->nodes ? cJSON_GetArraySize(doc->nodes) : 0;
+    doc->node_parents = malloc(((size_t)doc->node_count + 1) * sizeof(int));
+    if (!doc->accessors || !doc->node_parents) return 0;
+    for (int i = 0; i < doc->node_count; i++) doc->node_parents[i] = -1;
+    for (int i = 0; i < doc->node_count; i++) {
+        const cJSON *child = NULL;
+        cJSON_ArrayForEach(child, json_array(get_node(doc, i), "children")) {
+            if (cJSON_IsNumber(child) && child->valueint >= 0 && child->valueint < doc->node_count) {
+                doc->node_parents[child->valueint] = i;
+            }
+        }
+    }
+    return 1;
+}
+
+static void free_document(GltfDocument *doc) {
+    for (int i = 0; i < doc->buffer_count; i++) free(doc->buffers[i].data);
+    free(doc->buffers);
+    if (doc->accessors) {
+        for (int i = 0; i < doc->accessor_count; i++) free(doc->accessors[i].values);
+    }
+    free(doc->accessors);
+    free(doc->node_parents);
+    cJSON_Delete(doc->root);
+}
+
+// Bones are the skeleton root's descendants (or the joints and the nodes
+// between them when the skin names no root), minus meshes and prop points.
+// Fills node_bone (node -> bone index, -1) and returns the bone count.
+static int collect_bones(const GltfDocument *doc, const cJSON *skin, int *node_bone) {
+    const cJSON *joints = json_array(skin, "joints");
+    int skeleton_root = json_int(skin, "skeleton", -1);
+    uint8_t *marked = calloc((size_t)doc->node_count + 1, 1);
+    if (!marked) return -1;
+
+    const cJSON *joint = NULL;
+    cJSON_ArrayForEach(joint, joints) {
+        if (cJSON_IsNumber(joint) && joint->valueint >= 0 && joint->valueint < doc->node_count) {
+            marked[joint->valueint] = 1;
+        }
+    }
+
+    if (skeleton_root >= 0 && skeleton_root < doc->node_count) {
+        for (int i = 0; i < doc->node_count; i++) {
+            if (is_ancestor(doc, skeleton_root, i)) marked[i] = 1;
+        }
+    } else {
+        // Unskinned nodes between two joints still carry the hierarchy
+        for (int i = 0; i < doc->node_count; i++) {
+            if (marked[i] != 1) continue;
+            int top = -1;
+            for (int p = doc->node_parents[i], guard = 0; p >= 0 && guard < doc->node_count;
+                 p = doc->node_parents[p], guard++) {
+                if (marked[p] == 1) top = p;
+            }
+            for (int p = doc->node_parents[i]; top >= 0 && p >= 0 && p != top; p = doc->node_parents[p]) {
+                if (!marked[p]) marked[p] = 2;
+            }
+        }
+    }
+
+    int bone_count = 0;
+    for (int i = 0; i < doc->node_count; i++) {
+        const cJSON *node = get_node(doc, i);
+        int excluded = cJSON_GetObjectItemCaseSensitive(node, "mesh") != NULL || is_prop_node(node);
+        node_bone[i] = marked[i] && !excluded ? bone_count++ : -1;
+    }
+    free(marked);
+    return bone_count;
+}
+
+static int nearest_bone_ancestor(const GltfDocument *doc, const int *node_bone, int node) {
+    int parent = doc->node_parents[node];
+    for (int guard = 0; parent >= 0 && guard < doc->node_count; guard++) {
+        if (node_bone[parent] >= 0) return node_bone[parent];
+        parent = doc->node_parents[parent];
+    }
+    return -1;
+}
+
+static int append_vertices(PMDModel *model, uint32_t *capacity, uint32_t count) {
+    if (model->numVertices + count <= *capacity) return 1;
+    uint32_t new_capacity = *capacity ? *capacity : 256;
+    while (new_capacity < model->numVertices + count) new_capacity *= 2;
+    Vertex *vertices = realloc(model->vertices, (size_t)new_capacity * sizeof(Vertex));
+    if (!vertices) return 0;
+    model->vertices = vertices;
+    *capacity = new_capacity;
+    return 1;
+}
+
+static int append_faces(PMDModel *model, uint32_t *capacity, uint32_t count) {
+    if (model->numFaces + count <= *capacity) return 1;
+    uint32_t new_capacity = *capacity ? *capacity : 256;
+    while (new_capacity < model->numFaces + count) new_capacity *= 2;
+    Face *faces = realloc(model->faces, (size_t)new_capacity * sizeof(Face));
+    if (!faces) return 0;
+    model->faces = faces;
+    *capacity = new_capacity;
+    return 1;
+}
+
+// Merge the triangle primitives of a mesh; joints map through joint_bone to PMD bones
+static int import_mesh(GltfDocument *doc, const cJSON *mesh, const int *joint_bone, int joint_count, PMDModel *model) {
+    uint32_t vertex_capacity = 0;
+    uint32_t face_capacity = 0;
+    const cJSON *primitive = NULL;
+
+    cJSON_ArrayForEach(primitive, json_array(mesh, "primitives")) {
+        if (json_int(primitive, "mode", 4) != 4) {
+            fprintf(stderr, "Warning: skipping non-triangle primitive\n");
+            continue;
+        }
+        const cJSON *attributes = cJSON_GetObjectItemCaseSensitive(primitive, "attributes");
+        const AccessorData *positions = read_accessor(doc, json_int(attributes, "POSITION", -1));
+        if (!positions || positions->components != 3) {
+            fprintf(stderr, "glTF primitive without usable POSITION\n");
+            return 0;
+        }
+        uint32_t count = positions->count;
+        const AccessorData *normals = read_accessor(doc, json_int(attributes, "NORMAL", -1));
+        const AccessorData *texcoords = read_accessor(doc, json_int(attributes, "TEXCOORD_0", -1));
+        const AccessorData *joints = read_accessor(doc, json_int(attributes, "JOINTS_0", -1));
+        const AccessorData *weights = read_accessor(doc, json_int(attributes, "WEIGHTS_0", -1));
+        if (normals && (normals->components != 3 || normals->count < count)) normals = NULL;
+        if (texcoords && (texcoords->components != 2 || texcoords->count < count)) texcoords = NULL;
+        if (!joints || !weights || joints->components != 4 || weights->components != 4 ||
+            joints->count < count || weights->count < count) {
+            joints = NULL;
+            weights = NULL;
+        }
+
+        uint32_t base = model->numVertices;
+        if ((uint64_t)base + count > UINT32_MAX) {
+            fprintf(stderr, "glTF mesh has too many vertices\n");
+            return 0;
+        }
+        if (!append_vertices(model, &vertex_capacity, count)) return 0;
+
+        for (uint32_t i = 0; i < count; i++) {
+            Vertex *v = &model->vertices[base + i];
+            memset(v, 0, sizeof(*v));
+            const float *p = &positions->values[i * 3];
+            v->position = (Vector3D){p[0], p[1], p[2]};
+            if (normals) {
+                const float *n = &normals->values[i * 3];
+                v->normal = (Vector3D){n[0], n[1], n[2]};
+            }
+            v->coords = calloc(1, sizeof(TexCoord));
+            if (!v->coords) return 0;
+            model->numVertices++;
+            if (texcoords) {
+                // glTF UVs have their origin top-left
+                v->coords[0].u = texcoords->values[i * 2];
+                v->coords[0].v = 1.0f - texcoords->values[i * 2 + 1];
+            }
+
+            int influences = 0;
+            for (int k = 0; k < 4; k++) {
+                v->blend.bones[k] = 0xFF;
+                v->blend.weights[k] = 0.0f;
+            }
+            for (int k = 0; joints && k < 4; k++) {
+                int joint = (int)joints->values[i * 4 + k];
+                float weight = weights->values[i * 4 + k];
+                if (weight <= 0.0f || joint < 0 || joint >= joint_count || joint_bone[joint] < 0) continue;
+                v->blend.bones[influences] = (uint8_t)joint_bone[joint];
+                v->blend.weights[influences] = weight;
+                influences++;
+            }
+        }
+
+        const AccessorData *indices = read_accessor(doc, json_int(primitive, "indices", -1));
+        uint32_t index_count = indices ? indices->count : count;
+        if (!append_faces(model, &face_capacity, index_count / 3)) return 0;
+        for (uint32_t f = 0; f + 2 < index_count; f += 3) {
+            Face *face = &model->faces[model->numFaces];
+            for (int k = 0; k < 3; k++) {
+                uint32_t index = indices ? (uint32_t)indices->values[f + k] : f + k;
+                if (index >= count) {
+                    fprintf(stderr, "glTF index %u out of range\n", index);
+                    return 0;
+                }
+                face->vertices[k] = base + index;
+            }
+            model->numFaces++;
+        }
+    }
+    return 1;
+}
+
+typedef struct {
+    int bone;
+    int rotation;               // 1 for rotation, 0 for translation
+    Interpolation interpolation;
+    const AccessorData *input;
+    const AccessorData *output;
+} ImportChannel;
+
+// Value of keyframe `key`, skipping the tangents of cubic spline outputs
+static const float* key_value(const ImportChannel *ch, uint32_t key, int slot) {
+    int comps = ch->output->components;
+    if (ch->interpolation == INTERP_CUBICSPLINE) {
+        return &ch->output->values[(key * 3 + (uint32_t)slot) * (uint32_t)comps];
+    }
+    return &ch->output->values[key * (uint32_t)comps];
+}
+
+static void sample_channel(const ImportChannel *ch, float t, float *out) {
+    int comps = ch->rotation ? 4 : 3;
+    const float *times = ch->input->values;
+    uint32_t n = ch->input->count;
+
+    uint32_t k = 0;
+    float u = 0.0f;
+    if (t >= times[n - 1]) {
+        k = n - 1;
+    } else if (t > times[0]) {
+        uint32_t lo = 0, hi = n - 1;
+        while (hi - lo > 1) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (times[mid] <= t) lo = mid; else hi = mid;
+        }
+        k = lo;
+        float span = times[k + 1] - times[k];
+        u = span > 0.0f ? (t - times[k]) / span : 0.0f;
+    }
+
+    const float *a = key_value(ch, k, 1);
+    if (u <= 0.0f || ch->interpolation == INTERP_STEP) {
+        memcpy(out, a, (size_t)comps * sizeof(float));
+    } else if (ch->interpolation == INTERP_CUBICSPLINE) {
+        const float *b = key_value(ch, k + 1, 1);
+        const float *out_tangent = key_value(ch, k, 2);
+        const float *in_tangent = key_value(ch, k + 1, 0);
+        float span = times[k + 1] - times[k];
+        float u2 = u * u, u3 = u2 * u;
+        for (int c = 0; c < comps; c++) {
+            out[c] = (2*u3 - 3*u2 + 1) * a[c] + (u3 - 2*u2 + u) * span * out_tangent[c] +
+                     (-2*u3 + 3*u2) * b[c] + (u3 - u2) * span * in_tangent[c];
+        }
+    } else if (ch->rotation) {
+        const float *b = key_value(ch, k + 1, 1);
+        Quaternion q = quat_slerp((Quaternion){a[0], a[1], a[2], a[3]},
+                                  (Quaternion){b[0], b[1], b[2], b[3]}, u);
+        out[0] = q.x; out[1] = q.y; out[2] = q.z; out[3] = q.w;
+    } else {
+        const float *b = key_value(ch, k + 1, 1);
+        for (int c = 0; c < comps; c++) out[c] = a[c] + (b[c] - a[c]) * u;
+    }
+
+    if (ch->rotation) {
+        Quaternion q = quat_normalize((Quaternion){out[0], out[1], out[2], out[3]});
+        out[0] = q.x; out[1] = q.y; out[2] = q.z; out[3] = q.w;
+    }
+}
+
+// Resample one glTF animation onto a uniform frame grid of world-space states.
+// The grid spans every sampler input at their smallest key interval, so
+// sparse fitted tracks land back on their frames, and the key spacing gives
+// the playback speed relative to 30 fps.
+static PSAAnimation* import_animation(GltfDocument *doc, const cJSON *animation, uint32_t index,
+                                      const int *node_bone, SkeletonPose *pose,
+                                      const BoneState *rest_local, float *speed_out) {
+    const cJSON *samplers = json_array(animation, "samplers");
+    const cJSON *channels = json_array(animation, "channels");
+    int channel_total = channels ? cJSON_GetArraySize(channels) : 0;
+    ImportChannel *tracks = calloc((size_t)channel_total + 1, sizeof(ImportChannel));
+    if (!tracks) return NULL;
+
+    int track_count = 0;
+    float start = 0.0f, end = 0.0f, min_step = 0.0f;
+    const cJSON *channel = NULL;
+    cJSON_ArrayForEach(channel, channels) {
+        const cJSON *target = cJSON_GetObjectItemCaseSensitive(channel, "target");
+        int node = json_int(target, "node", -1);
+        const char *path = json_string(target, "path");
+        if (node < 0 || node >= doc->node_count || node_bone[node] < 0 || !path) continue;
+        int rotation = strcmp(path, "rotation") == 0;
+        if (!rotation && strcmp(path, "translation") != 0) continue;
+
+        const cJSON *sampler = cJSON_GetArrayItem(samplers, json_int(channel, "sampler", -1));
+        const char *interp = json_string(sampler, "interpolation");
+        ImportChannel *track = &tracks[track_count];
+        track->bone = node_bone[node];
+        track->rotation = rotation;
+        track->interpolation = INTERP_LINEAR;
+        if (interp && strcmp(interp, "STEP") == 0) track->interpolation = INTERP_STEP;
+        if (interp && strcmp(interp, "CUBICSPLINE") == 0) track->interpolation = INTERP_CUBICSPLINE;
+        track->input = read_accessor(doc, json_int(sampler, "input", -1));
+        track->output = read_accessor(doc, json_int(sampler, "output", -1));
+
+        uint32_t keys = track->input ? track->input->count : 0;
+        uint32_t needed = track->interpolation == INTERP_CUBICSPLINE ? keys * 3 : keys;
+        if (keys == 0 || !track->output || track->output->components != (rotation ? 4 : 3) ||
+            track->output->count < needed) {
+            fprintf(stderr, "Warning: skipping malformed animation channel\n");
+            continue;
+        }
+        const float *times = track->input->values;
+        if (track_count == 0 || times[0] < start) start = times[0];
+        if (track_count == 0 || times[keys - 1] > end) end = times[keys - 1];
+        for (uint32_t k = 1; k < keys; k++) {
+            float interval = times[k] - times[k - 1];
+            if (interval > 0.0f && (min_step == 0.0f || interval < min_step)) min_step = interval;
+        }
+        track_count++;
+    }
+
+    const char *name = json_string(animation, "name");
+    char fallback_name[32];
+    snprintf(fallback_name, sizeof(fallback_name), "anim%u", index);
+
+    PSAAnimation *anim = calloc(1, sizeof(PSAAnimation));
+    if (!anim) {
+        free(tracks);
+        return NULL;
+    }
+    anim->name = my_strdup(name && name[0] ? name : fallback_name);
+    anim->frameLength = 1.0f / IMPORT_FPS;
+    anim->numBones = pose->num_bones;
+    anim->numFrames = min_step > 0.0f ? (uint32_t)lroundf((end - start) / min_step) + 1 : 1;
+
+    float step = 1.0f / IMPORT_FPS;
+    if (anim->numFrames > 1) {
+        step = (end - start) / (float)(anim->numFrames - 1);
+    }
+    *speed_out = step > 0.0f ? roundf(100.0f / (IMPORT_FPS * step) * 100.0f) / 100.0f : 100.0f;
+
+    anim->boneStates = calloc((size_t)anim->numFrames * anim->numBones + 1, sizeof(BoneState));
+    BoneState *local = malloc(((size_t)anim->numBones + 1) * sizeof(BoneState));
+    if (!anim->name || !anim->boneStates || !local) {
+        free(local);
+        free(tracks);
+        free_psa(anim);
+        return NULL;
+    }
+
+    for (uint32_t frame = 0; frame < anim->numFrames; frame++) {
+        float t = start + step * (float)frame;
+        memcpy(local, rest_local, (size_t)anim->numBones * sizeof(BoneState));
+        for (int c = 0; c < track_count; c++) {
+            float value[4];
+            sample_channel(&tracks[c], t, value);
+            BoneState *state = &local[tracks[c].bone];
+            if (tracks[c].rotation) {
+                state->rotation = (Quaternion){value[0], value[1], value[2], value[3]};
+            } else {
+                state->translation = (Vector3D){value[0], value[1], value[2]};
+            }
+        }
+        pose_evaluate_local(pose, local, anim->numBones);
+        memcpy(&anim->boneStates[(size_t)frame * anim->numBones], pose->world,
+               (size_t)anim->numBones * sizeof(BoneState));
+    }
+
+    free(local);
+    free(tracks);
+    return anim;
+}
+
+// Skinned mesh node first, any mesh node otherwise
+static int find_mesh_node(const GltfDocument *doc) {
+    int fallback = -1;
+    for (int i = 0; i < doc->node_count; i++) {
+        const cJSON *node = get_node(doc, i);
+        if (!cJSON_GetObjectItemCaseSensitive(node, "mesh")) continue;
+        if (cJSON_GetObjectItemCaseSensitive(node, "skin")) return i;
+        if (fallback < 0) fallback = i;
+    }
+    return fallback;
+}
+
+static int import_document(GltfDocument *doc, GltfImport *imp) {
+    PMDModel *model = calloc(1, sizeof(PMDModel));
+    if (!model) return 0;
+    imp->model = model;
+    model->version = 3;
+    model->numTexCoords = 1;
+
+    int mesh_node = find_mesh_node(doc);
+    const cJSON *mesh_node_obj = get_node(doc, mesh_node);
+    const cJSON *skin = cJSON_GetArrayItem(json_array(doc->root, "skins"), json_int(mesh_node_obj, "skin", -1));
+
+    int *node_bone = malloc(((size_t)doc->node_count + 1) * sizeof(int));
+    if (!node_bone) return 0;
+    for (int i = 0; i < doc->node_count; i++) node_bone[i] = -1;
+    int bone_count = skin ? collect_bones(doc, skin, node_bone) : 0;
+    if (bone_count < 0 || bone_count > MAX_PMD_BONES) {
+        if (bone_count > MAX_PMD_BONES) fprintf(stderr, "glTF skeleton has %d bones, PMD allows %d\n", bone_count, MAX_PMD_BONES);
+        free(node_bone);
+        return 0;
+    }
+
+    // Skeleton definition and rest states, in node order
+    int skeleton_root = json_int(skin, "skeleton", -1);
+    imp->skeleton = skeleton_create(NULL);
+    if (!imp->skeleton) {
+        free(node_bone);
+        return 0;
+    }
+    const char *title = skeleton_root >= 0 && skeleton_root < doc->node_count && node_bone[skeleton_root] < 0
+                        ? json_string(get_node(doc, skeleton_root), "name") : NULL;
+    snprintf(imp->skeleton->title, sizeof(imp->skeleton->title), "%s", title ? title : "");
+
+    model->numBones = (uint32_t)bone_count;
+    model->restStates = calloc((size_t)bone_count + 1, sizeof(BoneState));
+    if (!model->restStates) {
+        free(node_bone);
+        return 0;
+    }
+    for (int i = 0; i < doc->node_count; i++) {
+        int bone = node_bone[i];
+        if (bone < 0) continue;
+        const char *name = json_string(get_node(doc, i), "name");
+        char fallback_name[MAX_BONE_NAME];
+        snprintf(fallback_name, sizeof(fallback_name), "bone_%d", bone);
+        if (skeleton_add_bone(imp->skeleton, name ? name : fallback_name,
+                              nearest_bone_ancestor(doc, node_bone, i)) < 0) {
+            free(node_bone);
+            return 0;
+        }
+        model->restStates[bone] = node_world_state(doc, i);
+    }
+    if (!skeleton_build_index(imp->skeleton)) {
+        free(node_bone);
+        return 0;
+    }
+
+    // Joints: bind pose from the inverse bind matrices overrides the node TRS
+    const cJSON *joints = json_array(skin, "joints");
+    int joint_count = joints ? cJSON_GetArraySize(joints) : 0;
+    int *joint_bone = malloc(((size_t)joint_count + 1) * sizeof(int));
+    if (!joint_bone) {
+        free(node_bone);
+        return 0;
+    }
+    const AccessorData *ibm = read_accessor(doc, json_int(skin, "inverseBindMatrices", -1));
+    if (ibm && (ibm->components != 16 || ibm->count < (uint32_t)joint_count)) ibm = NULL;
+    for (int j = 0; j < joint_count; j++) {
+        const cJSON *joint = cJSON_GetArrayItem(joints, j);
+        int node = cJSON_IsNumber(joint) ? joint->valueint : -1;
+        joint_bone[j] = node >= 0 && node < doc->node_count ? node_bone[node] : -1;
+        if (ibm && joint_bone[j] >= 0) {
+            float bind[16];
+            invert_affine(&ibm->values[j * 16], bind);
+            matrix_to_bone_state(bind, &model->restStates[joint_bone[j]]);
+        }
+    }
+
+    // Prop points: "prop-<name>" nodes, TRS relative to the parent bone
+    uint32_t prop_count = 0;
+    for (int i = 0; i < doc->node_count; i++) {
+        if (is_prop_node(get_node(doc, i))) prop_count++;
+    }
+    model->propPoints = calloc((size_t)prop_count + 1, sizeof(PropPoint));
+    int ok = model->propPoints != NULL;
+    if (ok) model->numPropPoints = prop_count;
+    uint32_t prop = 0;
+    for (int i = 0; ok && i < doc->node_count; i++) {
+        const cJSON *node = get_node(doc, i);
+        if (!is_prop_node(node)) continue;
+        PropPoint *p = &model->propPoints[prop++];
+        BoneState local = node_local_state(node);
+        int parent = doc->node_parents[i];
+        p->name = my_strdup(json_string(node, "name") + 5);
+        p->translation = local.translation;
+        p->rotation = local.rotation;
+        p->bone = parent >= 0 && node_bone[parent] >= 0 ? (uint8_t)node_bone[parent] : 0xFF;
+        ok = p->name != NULL;
+    }
+
+    const cJSON *mesh = cJSON_GetArrayItem(json_array(doc->root, "meshes"), json_int(mesh_node_obj, "mesh", -1));
+    if (ok && mesh) {
+        ok = import_mesh(doc, mesh, joint_bone, joint_count, model);
+    }
+    free(joint_bone);
+
+    // Animations, evaluated through the imported hierarchy
+    const cJSON *animations = json_array(doc->root, "animations");
+    int animation_count = animations ? cJSON_GetArraySize(animations) : 0;
+    if (ok && animation_count > 0 && bone_count > 0) {
+        SkeletonPose pose;
+        BoneState *rest_local = malloc((size_t)bone_count * sizeof(BoneState));
+        imp->anims = calloc((size_t)animation_count, sizeof(PSAAnimation*));
+        imp->anim_speeds = calloc((size_t)animation_count, sizeof(float));
+        ok = rest_local && imp->anims && imp->anim_speeds && pose_init(&pose, imp->skeleton, model->numBones);
+        if (ok) {
+            pose_evaluate_world(&pose, model->restStates, model->numBones, NULL, 0);
+            memcpy(rest_local, pose.local, (size_t)bone_count * sizeof(BoneState));
+            for (int a = 0; ok && a < animation_count; a++) {
+                PSAAnimation *anim = import_animation(doc, cJSON_GetArrayItem(animations, a), (uint32_t)a,
+                                                      node_bone, &pose, rest_local, &imp->anim_speeds[a]);
+                ok = anim != NULL;
+                if (anim) imp->anims[imp->anim_count++] = anim;
+            }
+            pose_free(&pose);
+        }
+        free(rest_local);
+    }
+
+    free(node_bone);
+    return ok;
+}
+
+GltfImport* import_gltf(const char *filename) {
+    GltfDocument doc;
+    if (!load_document(&doc, filename)) {
+        free_document(&doc);
+        return NULL;
+    }
+
+    GltfImport *imp = calloc(1, sizeof(GltfImport));
+    if (!imp || !import_document(&doc, imp)) {
+        fprintf(stderr, "Failed to import glTF file: %s\n", filename);
+        free_gltf_import(imp);
+        free_document(&doc);
+        return NULL;
+    }
+    free_document(&doc);
+    return imp;
+}
+
+void free_gltf_import(GltfImport *imp) {
+    if (!imp) return;
+    free_pmd(imp->model);
+    for (uint32_t i = 0; i < imp->anim_count; i++) {
+        free_psa(imp->anims[i]);
+    }
+    free(imp->anims);
+    free(imp->anim_speeds);
+    free_skeleton(imp->skeleton);
+    free(imp);
+}
+
+// File-name safe animation name; main() reads it back from <base>_<name>.psa
+static void sanitize_name(const char *name, char *out, size_t out_size) {
+    size_t n = 0;
+    for (; name[n] && n + 1 < out_size; n++) {
+        char c = name[n];
+        int safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                   c == '_' || c == '-';
+        out[n] = safe ? c : '_';
+    }
+    out[n] = '\0';
+    if (n == 0) snprintf(out, out_size, "anim");
+}
+
+int write_gltf_import(const GltfImport *imp, const char *base_path) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s.pmd", base_path);
+    if (!write_pmd(path, imp->model)) return 0;
+
+    const char *base_name = strrchr(base_path, '/');
+    if (!base_name) base_name = strrchr(base_path, '\\');
+    base_name = base_name ? base_name + 1 : base_path;
+
+    cJSON *config = cJSON_CreateObject();
+    cJSON *skeleton = cJSON_AddObjectToObject(config, "skeleton");
+    cJSON_AddStringToObject(skeleton, "title", imp->skeleton->title[0] ? imp->skeleton->title : base_name);
+    cJSON *bones = cJSON_AddArrayToObject(skeleton, "bones");
+    for (int i = 0; i < imp->skeleton->bone_count; i++) {
+        cJSON *bone = cJSON_CreateObject();
+        cJSON_AddStringToObject(bone, "name", imp->skeleton->bones[i].name);
+        cJSON_AddNumberToObject(bone, "parent_index", imp->skeleton->bones[i].parent_index);
+        cJSON_AddItemToArray(bones, bone);
+    }
+    cJSON *speeds = cJSON_AddObjectToObject(config, "animation_speeds");
+
+    int ok = 1;
+    for (uint32_t a = 0; ok && a < imp->anim_count; a++) {
+        char name[128];
+        sanitize_name(imp->anims[a]->name, name, sizeof(name));
+        // Names that collide after sanitizing get the animation index appended
+        if (cJSON_GetObjectItemCaseSensitive(speeds, name)) {
+            size_t len = strlen(name);
+            snprintf(name + len, sizeof(name) - len, "_%u", a);
+        }
+        cJSON_AddNumberToObject(speeds, name, imp->anim_speeds[a]);
+        snprintf(path, sizeof(path), "%s_%s.psa", base_path, name);
+        ok = write_psa(path, imp->anims[a]);
+    }
+
+    char *text = ok ? cJSON_Print(config) : NULL;
+    cJSON_Delete(config);
+    if (ok) {
+        ByteWriter w;
+        byte_writer_init(&w, text ? strlen(text) + 1 : 0);
+        if (text) byte_writer_bytes(&w, text, strlen(text));
+        byte_writer_u8(&w, '\n');
+        snprintf(path, sizeof(path), "%s.json", base_path);
+        ok = text && byte_writer_save(&w, path);
+        byte_writer_free(&w);
+    }
+    free(text);
+    return ok;
+}
@@ -0,0 +1,28 @@
+#ifndef GLTF_IMPORTER_H
+#define GLTF_IMPORTER_H
+
+#include "pmd_psa_types.h"
+#include "skeleton.h"
+
+// glTF -> PMD/PSA import, the reverse of export_gltf().
+// Reads .gltf (embedded data URIs or external .bin) and .glb files. Bones are
+// the skeleton's nodes in node order, "prop-*" nodes become prop points, the
+// skinned mesh becomes the PMD mesh and every animation is resampled onto a
+// fixed frame grid as world-space PSA bone states.
+
+typedef struct {
+    PMDModel *model;
+    PSAAnimation **anims;
+    uint32_t anim_count;
+    float *anim_speeds;      // playback speed in percent, per animation
+    SkeletonDef *skeleton;   // bone names and hierarchy, one entry per PMD bone
+} GltfImport;
+
+GltfImport* import_gltf(const char *filename);
+void free_gltf_import(GltfImport *imp);
+
+// Write <base_path>.pmd, <base_path>_<anim>.psa and <base_path>.json
+// (skeleton and animation_speeds), the layout main() converts from
+int write_gltf_import(const GltfImport *imp, const char *base_path);
+
+#endif // GLTF_IMPORTER_H
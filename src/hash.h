@@ -0,0 +1,35 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// FNV-1a hashing shared by the lookup tables and content caches.
+// 64-bit variant is used for content addressing, 32-bit for table slots.
+
+#define HASH_FNV64_OFFSET 0xcbf29ce484222325ULL
+#define HASH_FNV64_PRIME 0x100000001b3ULL
+
+static inline uint64_t hash_fnv1a64_update(uint64_t hash, const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= HASH_FNV64_PRIME;
+    }
+    return hash;
+}
+
+static inline uint64_t hash_fnv1a64(const void *data, size_t size) {
+    return hash_fnv1a64_update(HASH_FNV64_OFFSET, data, size);
+}
+
+static inline uint32_t hash_fnv1a32_str(const char *str) {
+    uint32_t hash = 0x811c9dc5u;
+    while (*str) {
+        hash ^= (unsigned char)*str++;
+        hash *= 0x01000193u;
+    }
+    return hash;
+}
+
+#endif // HASH_H
@@ -0,0 +1,35 @@
+#include "joint_bounds.h"
+#include <string.h>
+
+void joint_bounds_compute(const float *positions, const uint32_t *joints, const float *weights,
+                          uint32_t vertex_count, const float *inverse_bind, uint32_t joint_count,
+                          JointBounds *out) {
+    memset(out, 0, joint_count * sizeof(JointBounds));
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        int best = -1;
+        float best_weight = 0.0f;
+        for (int k = 0; k < 4; k++) {
+            float w = weights[v * 4 + k];
+            if (joints[v * 4 + k] < joint_count && w > best_weight) {
+                best = k;
+                best_weight = w;
+            }
+        }
+        if (best < 0) continue;
+
+        uint32_t joint = joints[v * 4 + best];
+        const float *m = &inverse_bind[joint * 16];
+        const float *p = &positions[v * 3];
+        float local[3];
+        for (int r = 0; r < 3; r++) {
+            local[r] = m[r] * p[0] + m[4 + r] * p[1] + m[8 + r] * p[2] + m[12 + r];
+        }
+
+        JointBounds *box = &out[joint];
+        for (int r = 0; r < 3; r++) {
+            if (box->vertices == 0 || local[r] < box->min[r]) box->min[r] = local[r];
+            if (box->vertices == 0 || local[r] > box->max[r]) box->max[r] = local[r];
+        }
+        box->vertices++;
+    }
+}
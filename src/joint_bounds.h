@@ -0,0 +1,25 @@
+#ifndef JOINT_BOUNDS_H
+#define JOINT_BOUNDS_H
+
+#include <stdint.h>
+
+// Per-joint boxes for culling and picking without skinning: each vertex is
+// given to its heaviest influence and bounded in that joint's space (through
+// the inverse bind matrix), so a runtime transforms the box by the posed
+// joint matrix and gets a tight volume around that part of the mesh.
+
+typedef struct {
+    float min[3];
+    float max[3];
+    uint32_t vertices;      // vertices bucketed to this joint; 0 leaves the box unset
+} JointBounds;
+
+// positions: vertex_count * 3 floats (bind pose); joints/weights: 4 per
+// vertex as exported; inverse_bind: joint_count column-major 4x4 matrices.
+// Influences with no weight or a joint past joint_count are ignored; ties
+// go to the first influence.
+void joint_bounds_compute(const float *positions, const uint32_t *joints, const float *weights,
+                          uint32_t vertex_count, const float *inverse_bind, uint32_t joint_count,
+                          JointBounds *out);
+
+#endif // JOINT_BOUNDS_H
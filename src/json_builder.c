@@ -1,4 +1,5 @@
 #include "json_builder.h"
+#include "float_format.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -66,7 +67,9 @@ cJSON* json_create_buffer(size_t byte_length, const char *uri)
     cJSON *buffer = cJSON_CreateObject();
 
     cJSON_AddNumberToObject(buffer, "byteLength", (double)byte_length);
-    cJSON_AddStringToObject(buffer, "uri", uri);
+    if (uri) {
+        cJSON_AddStringToObject(buffer, "uri", uri);
+    }
 
     return buffer;
 }
@@ -163,9 +166,25 @@ cJSON* json_create_animation(const char *anim_name, cJSON *samplers, cJSON *chan
 }
 
 /* Utility functions */
+cJSON* json_create_float(float value)
+{
+    char text[FLOAT_FORMAT_SIZE];
+    format_float_shortest(value, text);
+    return cJSON_CreateRaw(text);
+}
+
+cJSON* json_create_float_array(const float *values, size_t count)
+{
+    cJSON *array = cJSON_CreateArray();
+    for (size_t i = 0; i < count; i++) {
+        cJSON_AddItemToArray(array, json_create_float(values[i]));
+    }
+    return array;
+}
+
 void json_add_float_array(cJSON *obj, const char *key, const float *values, size_t count)
 {
-    cJSON *array = cJSON_CreateFloatArray(values, (int)count);
+    cJSON *array = json_create_float_array(values, count);
     cJSON_AddItemToObject(obj, key, array);
 }
 
@@ -25,7 +25,7 @@ cJSON* json_create_mesh(const char *mesh_name, uint32_t positions_accessor,
 cJSON* json_create_accessor(uint32_t buffer_view, uint32_t count, const char *type,
                            const char *component_type_str);
 
-/* Buffer/BufferView building */
+/* Buffer/BufferView building (a NULL uri refers to the GLB binary chunk) */
 cJSON* json_create_buffer(size_t byte_length, const char *uri);
 cJSON* json_create_buffer_view(uint32_t buffer, size_t byte_length);
 
@@ -47,6 +47,9 @@ cJSON* json_create_animation_channel(uint32_t sampler_idx, uint32_t node_idx,
 cJSON* json_create_animation(const char *anim_name, cJSON *samplers, cJSON *channels);
 
 /* Utility */
+/* Float numbers are raw items holding their shortest round-trip text */
+cJSON* json_create_float(float value);
+cJSON* json_create_float_array(const float *values, size_t count);
 void json_add_float_array(cJSON *obj, const char *key, const float *values, size_t count);
 void json_add_uint32_array(cJSON *obj, const char *key, const uint32_t *values, size_t count);
 
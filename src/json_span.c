@@ -0,0 +1,101 @@
+#include "json_span.h"
+#include <ctype.h>
+#include <string.h>
+
+static const char* skip_ws(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+    return p;
+}
+
+// p points at the opening quote; returns the byte after the closing quote
+static const char* skip_string(const char *p, const char *end) {
+    for (p++; p < end; p++) {
+        if (*p == '\\') {
+            p++;
+        } else if (*p == '"') {
+            return p + 1;
+        }
+    }
+    return NULL;
+}
+
+// Skip one value of any type; returns the byte after it
+static const char* skip_value(const char *p, const char *end) {
+    if (p >= end) return NULL;
+    if (*p == '"') return skip_string(p, end);
+
+    if (*p == '{' || *p == '[') {
+        int depth = 0;
+        while (p < end) {
+            if (*p == '"') {
+                p = skip_string(p, end);
+                if (!p) return NULL;
+                continue;
+            }
+            if (*p == '{' || *p == '[') depth++;
+            else if (*p == '}' || *p == ']') {
+                if (--depth == 0) return p + 1;
+            }
+            p++;
+        }
+        return NULL;
+    }
+
+    // Number, true, false or null
+    const char *start = p;
+    while (p < end && *p != ',' && *p != '}' && *p != ']' &&
+           *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') {
+        p++;
+    }
+    return p > start ? p : NULL;
+}
+
+static int key_equals(const char *raw, size_t raw_len, const char *key) {
+    size_t key_len = strlen(key);
+    if (raw_len != key_len) return 0;
+    for (size_t i = 0; i < key_len; i++) {
+        if (tolower((unsigned char)raw[i]) != tolower((unsigned char)key[i])) return 0;
+    }
+    return 1;
+}
+
+int json_find_member(const char *text, size_t size, const char *key, JsonSpan *value) {
+    if (!text || !key) return 0;
+    const char *end = text + size;
+
+    // Tolerate a UTF-8 byte order mark
+    const char *p = text;
+    if (size >= 3 && memcmp(p, "\xEF\xBB\xBF", 3) == 0) p += 3;
+
+    p = skip_ws(p, end);
+    if (p >= end || *p != '{') return 0;
+    p = skip_ws(p + 1, end);
+    if (p < end && *p == '}') return 0;
+
+    while (p < end) {
+        if (*p != '"') return 0;
+        const char *key_start = p + 1;
+        p = skip_string(p, end);
+        if (!p) return 0;
+        size_t key_len = (size_t)(p - 1 - key_start);
+
+        p = skip_ws(p, end);
+        if (p >= end || *p != ':') return 0;
+        p = skip_ws(p + 1, end);
+
+        const char *value_start = p;
+        p = skip_value(p, end);
+        if (!p) return 0;
+
+        if (key_equals(key_start, key_len, key)) {
+            value->data = value_start;
+            value->size = (size_t)(p - value_start);
+            return 1;
+        }
+
+        p = skip_ws(p, end);
+        if (p >= end || *p != ',') return 0;
+        p = skip_ws(p + 1, end);
+    }
+    return 0;
+}
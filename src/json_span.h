@@ -0,0 +1,21 @@
+#ifndef JSON_SPAN_H
+#define JSON_SPAN_H
+
+#include <stddef.h>
+
+// Lightweight scanner over raw JSON text. It locates the value of a
+// top-level member without building a cJSON tree, so callers can hash a
+// sub-document or hand only that slice to the full parser.
+
+typedef struct {
+    const char *data;   // first byte of the value
+    size_t size;        // length of the value in bytes
+} JsonSpan;
+
+// Find member `key` of the top-level object in text[0..size).
+// Keys compare ASCII case-insensitively and the first match wins, like
+// cJSON_GetObjectItem. Returns 1 and fills *value if found, 0 otherwise
+// (also when the text is not a well-formed object up to that member).
+int json_find_member(const char *text, size_t size, const char *key, JsonSpan *value);
+
+#endif // JSON_SPAN_H
@@ -1,11 +1,14 @@
 #include "pmd_psa_types.h"
 #include "skeleton.h"
+#include "model_config.h"
 #include "filesystem.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "cJSON.h"
 #include "gltf_exporter.h"
+#include "gltf_importer.h"
+#include "skin_error.h"
+#include "cJSON.h"
 
 // Function declarations from other modules
 
@@ -42,90 +45,46 @@ static char* extract_anim_name(const char *psa_file, const char *basename) {
     return NULL;
 }
 
-int main(int argc, char *argv[]) {
-
-    if (argc < 2) {
-        printf("Usage: %s <base_name> [--print-bones]\n", argv[0]);
-        printf("  Loads: <base_name>.pmd, <base_name>.json, <base_name>_*.psa\n");
-        printf("  Outputs: output/<filename>.gltf\n");
-        printf("  Example: %s input/model\n", argv[0]);
-        printf("  Option: --print-bones to print all bone transforms and exit.\n");
-        return 1;
-    }
-
-    const char *base_name = argv[1];
-
-    // Option flags
-    int print_bones = 0;
-    const char *rest_pose_anim = NULL;
-    // Only positional args before any --option are used for skeleton detection
-    int first_option = 2;
-    for (int i = 2; i < argc; ++i) {
-        if (argv[i][0] == '-') { first_option = i; break; }
-    }
-    for (int i = first_option; i < argc; ++i) {
-        if (strcmp(argv[i], "--print-bones") == 0) print_bones = 1;
-        if (strcmp(argv[i], "--rest-pose") == 0 && i+1 < argc) {
-            rest_pose_anim = argv[i+1];
-            i++;
-        }
+// What one model converts from: the PMD plus its config and animations
+typedef struct {
+    PMDModel *model;
+    const SkeletonDef *skel;     // owned by the config cache
+    PSAAnimation **anims;
+    uint32_t anim_count;
+    float *anim_speeds;          // playback speed in percent, per animation
+} ModelInputs;
+
+static void free_model_inputs(ModelInputs *in) {
+    for (uint32_t i = 0; i < in->anim_count; i++) {
+        free_psa(in->anims[i]);
     }
+    free(in->anims);
+    free(in->anim_speeds);
+    free_pmd(in->model);
+    memset(in, 0, sizeof(*in));
+}
 
-    // Utilisation du JSON pour squelette et vitesses anims
-    char pmd_file[512];
+// Load <base_name>.json and <base_name>_*.psa for the PMD already in in->model.
+// With stream, PSAs are only opened and their frames read at export time.
+static void load_model_animations(const char *base_name, ModelConfigCache *configs, DirIndexCache *dirs,
+                                  ModelInputs *in, int stream) {
     char skeleton_json_file[512];
-    char output_file[512];
-    snprintf(pmd_file, sizeof(pmd_file), "%s.pmd", base_name);
     snprintf(skeleton_json_file, sizeof(skeleton_json_file), "%s.json", base_name);
 
-    const char *output_basename = strrchr(base_name, '/');
-    if (!output_basename) output_basename = strrchr(base_name, '\\');
-    output_basename = output_basename ? output_basename + 1 : base_name;
-    snprintf(output_file, sizeof(output_file), "output/%s.gltf", output_basename);
-
-
-    printf("Loading PMD: %s\n", pmd_file);
-    PMDModel *model = load_pmd(pmd_file);
-    if (!model) {
-        fprintf(stderr, "Failed to load PMD file\n");
-        return 1;
-    }
-
-    printf("  PMD v%u: Vertices=%u, Faces=%u, Bones=%u, Props=%u\n",
-           model->version, model->numVertices, model->numFaces, model->numBones, model->numPropPoints);
-
-    if (print_bones) {
-        printf("All bone transforms (rest pose):\n");
-        for (uint32_t i = 0; i < model->numBones; i++) {
-            printf("Bone %2u: T(% .2f,% .2f,% .2f) R(% .2f,% .2f,% .2f,% .2f)\n",
-                   i,
-                   model->restStates[i].translation.x,
-                   model->restStates[i].translation.y,
-                   model->restStates[i].translation.z,
-                   model->restStates[i].rotation.x,
-                   model->restStates[i].rotation.y,
-                   model->restStates[i].rotation.z,
-                   model->restStates[i].rotation.w);
-        }
-        free_pmd(model);
-        return 0;
-    }
-
-    // Charger le squelette depuis le JSON
-    SkeletonDef *skel = load_skeleton_json(skeleton_json_file);
-    if (skel) {
-        printf("Skeleton: %s\n", skel->title);
-        printf("  Loaded %d bones\n", skel->bone_count);
-        if (model->numBones > (uint32_t)skel->bone_count) {
-            printf("  Note: %u extra bones\n", model->numBones - skel->bone_count);
+    // Charger la config (squelette partagé entre les modèles du lot, vitesses)
+    const ModelConfig *config = model_config_cache_get(configs, skeleton_json_file);
+    in->skel = config ? config->skeleton : NULL;
+    if (in->skel) {
+        printf("Skeleton: %s\n", in->skel->title);
+        printf("  Loaded %d bones\n", in->skel->bone_count);
+        if (in->model->numBones > (uint32_t)in->skel->bone_count) {
+            printf("  Note: %u extra bones\n", in->model->numBones - in->skel->bone_count);
         }
     }
 
     // Find and load all matching PSA files
-    PSAAnimation **anims = NULL;
-    uint32_t anim_count = 0;
     uint32_t anim_capacity = 10;
-    anims = calloc(anim_capacity, sizeof(PSAAnimation*));
+    in->anims = calloc(anim_capacity, sizeof(PSAAnimation*));
 
     // Get directory from base_name
     const char *dir_end = strrchr(base_name, '/');
@@ -139,8 +98,6 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    snprintf(skeleton_json_file, sizeof(skeleton_json_file), "%s.json", base_name);
-
     // Extract just the base filename for pattern matching
     const char *base_filename = dir_end ? dir_end + 1 : base_name;
     
@@ -150,12 +107,13 @@ int main(int argc, char *argv[]) {
     char psa_pattern[256];
     snprintf(psa_pattern, sizeof(psa_pattern), "%s_*.psa", base_filename);
 
-    // Find all matching PSA files
-    FileList *psa_files = find_files(dir, psa_pattern);
+    // Find all matching PSA files (each directory is listed once per run)
+    const DirIndex *dir_index = dir_index_cache_get(dirs, dir);
+    FileList *psa_files = dir_index ? dir_index_find(dir_index, psa_pattern) : NULL;
 
     if (psa_files && psa_files->count > 0) {
         for (uint32_t i = 0; i < psa_files->count; i++) {
-            PSAAnimation *anim = load_psa(psa_files->paths[i]);
+            PSAAnimation *anim = stream ? open_psa_stream(psa_files->paths[i]) : load_psa(psa_files->paths[i]);
             if (anim) {
                 char *anim_name = extract_anim_name(psa_files->paths[i], base_filename);
                 if (anim_name) {
@@ -167,11 +125,11 @@ int main(int argc, char *argv[]) {
                         fprintf(stderr, "Warning: Animation file '%s' has legacy 'God Knows' placeholder name.\n", psa_files->paths[i]);
                     }
                 }
-                if (anim_count >= anim_capacity) {
+                if (in->anim_count >= anim_capacity) {
                     anim_capacity *= 2;
-                    anims = realloc(anims, anim_capacity * sizeof(PSAAnimation*));
+                    in->anims = realloc(in->anims, anim_capacity * sizeof(PSAAnimation*));
                 }
-                anims[anim_count++] = anim;
+                in->anims[in->anim_count++] = anim;
             }
         }
     }
@@ -180,78 +138,495 @@ int main(int argc, char *argv[]) {
         free_file_list(psa_files);
     }
 
-    if (anim_count == 0) {
+    if (in->anim_count == 0) {
         fprintf(stderr, "Warning: No animations found\n");
     }
 
-    // Charger les vitesses d'animation depuis le JSON
-    float *anim_speeds = NULL;
-    if (anim_count > 0) {
-        anim_speeds = calloc(anim_count, sizeof(float));
-        FILE *f = fopen(skeleton_json_file, "r");
-        if (f) {
-            fseek(f, 0, SEEK_END);
-            long size = ftell(f);
-            fseek(f, 0, SEEK_SET);
-            char *content = malloc((size_t)size + 1);
-            fread(content, 1, (size_t)size, f);
-            content[size] = '\0';
-            fclose(f);
-            cJSON *root = cJSON_Parse(content);
-            free(content);
-            if (root) {
-                cJSON *speeds = cJSON_GetObjectItem(root, "animation_speeds");
-                for (uint32_t i = 0; i < anim_count; i++) {
-                    float speed = 100.0f;
-                    if (anims[i]->name && speeds) {
-                        cJSON *val = cJSON_GetObjectItem(speeds, anims[i]->name);
-                        if (val && cJSON_IsNumber(val)) {
-                            speed = (float)val->valuedouble;
-                        }
-                    }
-                    anim_speeds[i] = speed;
-                    printf("  %s: PSA v1 (%u bones, %u frames) @ %.1f%%",
-                           anims[i]->name, anims[i]->numBones, anims[i]->numFrames, anim_speeds[i]);
-                    #ifdef PSA_HAS_PROPPOINTS
-                    printf(" | PropPoints=%u", anims[i]->numPropPoints);
-                    #endif
-                    printf("\n");
-                }
-                cJSON_Delete(root);
-            }
+    // Vitesses d'animation depuis la config du modèle
+    if (in->anim_count > 0) {
+        in->anim_speeds = calloc(in->anim_count, sizeof(float));
+        for (uint32_t i = 0; i < in->anim_count; i++) {
+            in->anim_speeds[i] = model_config_anim_speed(config, in->anims[i]->name, DEFAULT_ANIM_SPEED);
+            printf("  %s: PSA v1 (%u bones, %u frames) @ %.1f%%",
+                   in->anims[i]->name, in->anims[i]->numBones, in->anims[i]->numFrames, in->anim_speeds[i]);
+            #ifdef PSA_HAS_PROPPOINTS
+            printf(" | PropPoints=%u", in->anims[i]->numPropPoints);
+            #endif
+            printf("\n");
         }
     }
+}
 
-    printf("Exporting to glTF: %s\n", output_file);
+// Convert one model: <base_name>.pmd, <base_name>.json, <base_name>_*.psa
+static int convert_model(const char *base_name, int print_bones, const char *rest_pose_anim,
+                         const GltfExportOptions *export_options,
+                         ModelConfigCache *configs, DirIndexCache *dirs) {
+    // Utilisation du JSON pour squelette et vitesses anims
+    char pmd_file[512];
+    char output_file[512];
+    snprintf(pmd_file, sizeof(pmd_file), "%s.pmd", base_name);
 
-    // Extract mesh name from base_name
-    const char *mesh_name = strrchr(base_name, '/');
-    if (!mesh_name) mesh_name = strrchr(base_name, '\\');
-    mesh_name = mesh_name ? mesh_name + 1 : base_name;
+    const char *output_basename = strrchr(base_name, '/');
+    if (!output_basename) output_basename = strrchr(base_name, '\\');
+    output_basename = output_basename ? output_basename + 1 : base_name;
+    snprintf(output_file, sizeof(output_file), "output/%s.%s", output_basename,
+             export_options->format == GLTF_OUTPUT_GLB ? "glb" : "gltf");
+
+
+    printf("Loading PMD: %s\n", pmd_file);
+    ModelInputs in = {0};
+    in.model = load_pmd(pmd_file);
+    if (!in.model) {
+        fprintf(stderr, "Failed to load PMD file\n");
+        return 1;
+    }
+    PMDModel *model = in.model;
 
-    int export_status = export_gltf(output_file, model, anims, anim_count, skel, mesh_name, anim_speeds, rest_pose_anim);
+    printf("  PMD v%u: Vertices=%u, Faces=%u, Bones=%u, Props=%u\n",
+           model->version, model->numVertices, model->numFaces, model->numBones, model->numPropPoints);
+
+    if (print_bones) {
+        printf("All bone transforms (rest pose):\n");
+        for (uint32_t i = 0; i < model->numBones; i++) {
+            printf("Bone %2u: T(% .2f,% .2f,% .2f) R(% .2f,% .2f,% .2f,% .2f)\n",
+                   i,
+                   model->restStates[i].translation.x,
+                   model->restStates[i].translation.y,
+                   model->restStates[i].translation.z,
+                   model->restStates[i].rotation.x,
+                   model->restStates[i].rotation.y,
+                   model->restStates[i].rotation.z,
+                   model->restStates[i].rotation.w);
+        }
+        free_model_inputs(&in);
+        return 0;
+    }
+
+    load_model_animations(base_name, configs, dirs, &in, export_options->stream_window > 0);
+
+    printf("Exporting to glTF: %s\n", output_file);
+
+    int export_status = export_gltf_with_options(output_file, model, in.anims, in.anim_count, in.skel,
+                                                 output_basename, in.anim_speeds, rest_pose_anim, export_options);
     if (!export_status) {
         fprintf(stderr, "Error: Export failed\n");
-        free(anim_speeds);
-        if (skel) free_skeleton(skel);
-        for (uint32_t i = 0; i < anim_count; i++) {
-            free_psa(anims[i]);
+        free_model_inputs(&in);
+        return 1;
+    }
+
+    printf("Done! Exported %u animation(s)\n", in.anim_count);
+    free_model_inputs(&in);
+    return 0;
+}
+
+// Bytes of accessor data an animation references, each accessor counted once
+static size_t animation_bytes(const cJSON *root, const char *name) {
+    const cJSON *accessors = cJSON_GetObjectItem(root, "accessors");
+    const cJSON *animation = NULL;
+    cJSON_ArrayForEach(animation, cJSON_GetObjectItem(root, "animations")) {
+        const cJSON *anim_name = cJSON_GetObjectItem(animation, "name");
+        if (cJSON_IsString(anim_name) && strcmp(anim_name->valuestring, name) == 0) break;
+    }
+    if (!animation) return 0;
+
+    int accessor_count = cJSON_GetArraySize(accessors);
+    uint8_t *seen = calloc((size_t)accessor_count + 1, 1);
+    if (!seen) return 0;
+    size_t total = 0;
+    const cJSON *sampler = NULL;
+    cJSON_ArrayForEach(sampler, cJSON_GetObjectItem(animation, "samplers")) {
+        const char *keys[2] = {"input", "output"};
+        for (int k = 0; k < 2; k++) {
+            const cJSON *id = cJSON_GetObjectItem(sampler, keys[k]);
+            if (!cJSON_IsNumber(id) || id->valueint < 0 || id->valueint >= accessor_count || seen[id->valueint]) continue;
+            seen[id->valueint] = 1;
+            const cJSON *accessor = cJSON_GetArrayItem(accessors, id->valueint);
+            const char *type = cJSON_GetStringValue(cJSON_GetObjectItem(accessor, "type"));
+            int component_type = (int)cJSON_GetNumberValue(cJSON_GetObjectItem(accessor, "componentType"));
+            size_t components = !type ? 0 : strcmp(type, "VEC4") == 0 ? 4 : strcmp(type, "VEC3") == 0 ? 3 :
+                                strcmp(type, "VEC2") == 0 ? 2 : 1;
+            size_t size = component_type == 5126 || component_type == 5125 ? 4 :
+                          component_type == 5123 || component_type == 5122 ? 2 : 1;
+            total += (size_t)cJSON_GetNumberValue(cJSON_GetObjectItem(accessor, "count")) * components * size;
         }
-        free(anims);
-        free_pmd(model);
+    }
+    free(seen);
+    return total;
+}
+
+static cJSON* load_gltf_json(const char *path) {
+    size_t size = 0;
+    char *text = read_file(path, &size);
+    if (!text) return NULL;
+    cJSON *root = cJSON_Parse(text);
+    free(text);
+    return root;
+}
+
+// Seconds between an imported animation's frames as played
+static float imported_frame_time(const GltfImport *imp, uint32_t a) {
+    float speed = imp->anim_speeds[a] > 0.0f ? imp->anim_speeds[a] : DEFAULT_ANIM_SPEED;
+    return imp->anims[a]->frameLength * 100.0f / speed;
+}
+
+// Benchmark one model: export it losslessly and with the lossy options, read
+// both back and skin them on the CPU. The lossless copy's tracks are the
+// source PSA frames, so the difference is what the options cost. Prints per
+// animation the vertex displacement and the animation bytes saved; fails
+// past the limits (0 = no limit).
+static int bench_model(const char *base_name, const char *rest_pose_anim,
+                       const GltfExportOptions *export_options, double max_error, double max_rms,
+                       ModelConfigCache *configs, DirIndexCache *dirs) {
+    char pmd_file[512];
+    char reference_file[512];
+    char candidate_file[512];
+    snprintf(pmd_file, sizeof(pmd_file), "%s.pmd", base_name);
+    const char *stem = strrchr(base_name, '/');
+    if (!stem) stem = strrchr(base_name, '\\');
+    stem = stem ? stem + 1 : base_name;
+    snprintf(reference_file, sizeof(reference_file), "output/%s.bench_ref.gltf", stem);
+    snprintf(candidate_file, sizeof(candidate_file), "output/%s.bench.gltf", stem);
+
+    printf("Loading PMD: %s\n", pmd_file);
+    ModelInputs in = {0};
+    in.model = load_pmd(pmd_file);
+    if (!in.model) {
+        fprintf(stderr, "Failed to load PMD file\n");
         return 1;
     }
+    load_model_animations(base_name, configs, dirs, &in, 0);
+
+    // Both exports embed their buffers so the JSON alone describes the sizes
+    GltfExportOptions reference_options;
+    gltf_export_options_init(&reference_options);
+    GltfExportOptions candidate_options = *export_options;
+    candidate_options.format = GLTF_OUTPUT_EMBEDDED;
+    candidate_options.anim_store = NULL;
+    candidate_options.anim_libraries = NULL;
+    int failed = 0;
+    if (!export_gltf_with_options(reference_file, in.model, in.anims, in.anim_count, in.skel, stem,
+                                  in.anim_speeds, rest_pose_anim, &reference_options) ||
+        !export_gltf_with_options(candidate_file, in.model, in.anims, in.anim_count, in.skel, stem,
+                                  in.anim_speeds, rest_pose_anim, &candidate_options)) {
+        fprintf(stderr, "Error: Export failed\n");
+        failed = 1;
+    }
+    free_model_inputs(&in);
+
+    GltfImport *reference = failed ? NULL : import_gltf(reference_file);
+    GltfImport *candidate = failed ? NULL : import_gltf(candidate_file);
+    cJSON *reference_json = failed ? NULL : load_gltf_json(reference_file);
+    cJSON *candidate_json = failed ? NULL : load_gltf_json(candidate_file);
+    if (!failed && (!reference || !candidate || !reference_json || !candidate_json)) {
+        fprintf(stderr, "Error: Could not read back the %s exports\n", stem);
+        failed = 1;
+    }
 
-    printf("Done! Exported %u animation(s)\n", anim_count);
+    printf("Benchmark: %s\n", stem);
+    size_t reference_total = 0, candidate_total = 0;
+    for (uint32_t a = 0; !failed && a < reference->anim_count; a++) {
+        const char *name = reference->anims[a]->name;
+        uint32_t k = 0;
+        while (k < candidate->anim_count && strcmp(candidate->anims[k]->name, name) != 0) k++;
+        if (k == candidate->anim_count) continue;
+
+        SkinError error;
+        if (!measure_skin_error(reference->model, reference->anims[a], imported_frame_time(reference, a),
+                                candidate->model, candidate->anims[k], imported_frame_time(candidate, k),
+                                &error)) {
+            fprintf(stderr, "Error: %s: meshes differ, cannot compare\n", name);
+            failed = 1;
+            break;
+        }
+        size_t reference_bytes = animation_bytes(reference_json, name);
+        size_t candidate_bytes = animation_bytes(candidate_json, name);
+        reference_total += reference_bytes;
+        candidate_total += candidate_bytes;
+        int over = (max_error > 0.0 && error.max_error > max_error) || (max_rms > 0.0 && error.rms_error > max_rms);
+        printf("  %-20s %5u frames  max %.6f  rms %.6f  %8zu -> %8zu bytes%s\n", name, error.frames,
+               error.max_error, error.rms_error, reference_bytes, candidate_bytes, over ? "  OVER LIMIT" : "");
+        if (over) failed = 1;
+    }
+    if (reference_total > 0) {
+        printf("  Animation data: %zu -> %zu bytes (%.1f%% saved)\n", reference_total, candidate_total,
+               100.0 * (1.0 - (double)candidate_total / (double)reference_total));
+    }
+
+    cJSON_Delete(reference_json);
+    cJSON_Delete(candidate_json);
+    free_gltf_import(reference);
+    free_gltf_import(candidate);
+    remove(reference_file);
+    remove(candidate_file);
+    return failed;
+}
 
-    free(anim_speeds);
+// Import one glTF/GLB back to output/<stem>.pmd, output/<stem>_*.psa and output/<stem>.json
+static int import_model(const char *gltf_file) {
+    const char *stem = strrchr(gltf_file, '/');
+    if (!stem) stem = strrchr(gltf_file, '\\');
+    stem = stem ? stem + 1 : gltf_file;
+    const char *ext = strrchr(stem, '.');
+    size_t stem_len = ext ? (size_t)(ext - stem) : strlen(stem);
+
+    char base_path[512];
+    snprintf(base_path, sizeof(base_path), "output/%.*s", (int)stem_len, stem);
+
+    printf("Importing glTF: %s\n", gltf_file);
+    GltfImport *imp = import_gltf(gltf_file);
+    if (!imp) return 1;
+
+    printf("  PMD v%u: Vertices=%u, Faces=%u, Bones=%u, Props=%u, Animations=%u\n",
+           imp->model->version, imp->model->numVertices, imp->model->numFaces,
+           imp->model->numBones, imp->model->numPropPoints, imp->anim_count);
+    for (uint32_t i = 0; i < imp->anim_count; i++) {
+        printf("  %s: %u frames @ %.2f%%\n", imp->anims[i]->name, imp->anims[i]->numFrames, imp->anim_speeds[i]);
+    }
 
-    // Cleanup
-    if (skel) free_skeleton(skel);
-    for (uint32_t i = 0; i < anim_count; i++) {
-        free_psa(anims[i]);
+    int ok = write_gltf_import(imp, base_path);
+    if (ok) {
+        printf("Done! Wrote %s.pmd\n", base_path);
+    } else {
+        fprintf(stderr, "Error: Import failed\n");
     }
-    free(anims);
-    free_pmd(model);
-    return 0;
+    free_gltf_import(imp);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+
+    if (argc < 2) {
+        printf("Usage: %s <base_name> [<base_name> ...] [--print-bones] [--rest-pose <anim>] [--bin|--glb] [--interleaved] [--lods <n>] [--max-influences <n>] [--min-weight <w>] [--weight-bits <8|16>] [--flag-single-influence] [--fps <rate>] [--fit-curves <error>] [--fit-angle <degrees>] [--threads <n>] [--clip-bounds] [--joint-bounds] [--shared-anims] [--anim-library] [--atomic] [--reproducible] [--stream <frames>] [--bench [--bench-max <d>] [--bench-rms <d>]] [--import]\n", argv[0]);
+        printf("  Loads: <base_name>.pmd, <base_name>.json, <base_name>_*.psa\n");
+        printf("  Outputs: output/<filename>.gltf\n");
+        printf("  Example: %s input/model\n", argv[0]);
+        printf("  Several base names convert in one run and share identical skeletons.\n");
+        printf("  Option: --print-bones to print all bone transforms and exit.\n");
+        printf("  Option: --bin writes one .bin next to the .gltf, --glb a single .glb (default: embedded buffers).\n");
+        printf("  Option: --interleaved writes vertex attributes as one strided buffer.\n");
+        printf("  Option: --lods <n> adds simplified MSFT_lod meshes, n = 2-%d levels counting the full mesh.\n", GLTF_MAX_LOD_LEVELS);
+        printf("  Option: --max-influences <1|2|4> keeps the strongest joints per vertex, --min-weight <w> prunes lighter ones.\n");
+        printf("  Option: --weight-bits <8|16> stores normalized integer weights that sum exactly to one.\n");
+        printf("  Option: --flag-single-influence adds a _SINGLE_INFLUENCE vertex attribute for rigid vertices.\n");
+        printf("  Option: --fps <rate> resamples animations to <rate> keys per second (slerp/lerp, last frame kept).\n");
+        printf("  Option: --fit-curves <error> fits sparse CUBICSPLINE/LINEAR keys within <error> model units,\n");
+        printf("          --fit-angle <degrees> sets the rotation bound (default 0.57).\n");
+        printf("  Option: --threads <n> caps the threads used by per-vertex passes (default 0 = all cores).\n");
+        printf("  Option: --clip-bounds writes per-animation bounding boxes and spheres into animation extras.\n");
+        printf("  Option: --joint-bounds writes a joint-space box per joint (vertices by heaviest influence) into skin extras.\n");
+        printf("  Option: --shared-anims stores animation data once in output/animations.bin, shared by every model.\n");
+        printf("  Option: --anim-library writes the clips once per skeleton to output/<skeleton>.anims.gltf;\n");
+        printf("          model files keep mesh and skin and name their clips in extras.animationLibrary.\n");
+        printf("  Option: --atomic writes each output file under a temporary name and renames it into place.\n");
+        printf("  Option: --reproducible exports clips sorted by name, so identical inputs give identical bytes.\n");
+        printf("  Option: --stream <frames> converts PSAs <frames> at a time straight into the .bin (needs --bin;\n");
+        printf("          not with --fps, --fit-curves, --clip-bounds, --shared-anims or --anim-library).\n");
+        printf("  Option: --bench exports with the options above, re-imports and CPU-skins against the source PSAs,\n");
+        printf("          reporting max/RMS vertex error and animation bytes; --bench-max/--bench-rms fail past a limit.\n");
+        printf("  Option: --import to read <file>.gltf/.glb arguments back into output/<file>.pmd/.psa/.json.\n");
+        return 1;
+    }
+
+    // Option flags
+    int print_bones = 0;
+    int import_mode = 0;
+    int bench_mode = 0;
+    int shared_anims = 0;
+    int anim_library = 0;
+    double bench_max = 0.0;
+    double bench_rms = 0.0;
+    GltfExportOptions export_options;
+    gltf_export_options_init(&export_options);
+    const char *rest_pose_anim = NULL;
+    // Only positional args before any --option are base names
+    int first_option = argc;
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i][0] == '-') { first_option = i; break; }
+    }
+    for (int i = first_option; i < argc; ++i) {
+        if (strcmp(argv[i], "--print-bones") == 0) print_bones = 1;
+        if (strcmp(argv[i], "--import") == 0) import_mode = 1;
+        if (strcmp(argv[i], "--bin") == 0) export_options.format = GLTF_OUTPUT_SEPARATE;
+        if (strcmp(argv[i], "--glb") == 0) export_options.format = GLTF_OUTPUT_GLB;
+        if (strcmp(argv[i], "--interleaved") == 0) export_options.interleaved = 1;
+        if (strcmp(argv[i], "--lods") == 0 && i+1 < argc) {
+            export_options.lod_levels = atoi(argv[i+1]);
+            if (export_options.lod_levels < 2 || export_options.lod_levels > GLTF_MAX_LOD_LEVELS) {
+                fprintf(stderr, "Error: --lods expects 2 to %d levels\n", GLTF_MAX_LOD_LEVELS);
+                return 1;
+            }
+            i++;
+        }
+        if (strcmp(argv[i], "--max-influences") == 0 && i+1 < argc) {
+            export_options.skin.max_influences = atoi(argv[i+1]);
+            if (export_options.skin.max_influences != 1 && export_options.skin.max_influences != 2 &&
+                export_options.skin.max_influences != 4) {
+                fprintf(stderr, "Error: --max-influences expects 1, 2 or 4\n");
+                return 1;
+            }
+            export_options.optimize_skin = 1;
+            i++;
+        }
+        if (strcmp(argv[i], "--min-weight") == 0 && i+1 < argc) {
+            export_options.skin.min_weight = (float)atof(argv[i+1]);
+            export_options.optimize_skin = 1;
+            i++;
+        }
+        if (strcmp(argv[i], "--weight-bits") == 0 && i+1 < argc) {
+            export_options.skin.weight_bits = atoi(argv[i+1]);
+            if (export_options.skin.weight_bits != 8 && export_options.skin.weight_bits != 16) {
+                fprintf(stderr, "Error: --weight-bits expects 8 or 16\n");
+                return 1;
+            }
+            export_options.optimize_skin = 1;
+            i++;
+        }
+        if (strcmp(argv[i], "--flag-single-influence") == 0) export_options.flag_single_influence = 1;
+        if (strcmp(argv[i], "--fps") == 0 && i+1 < argc) {
+            export_options.sample_rate = (float)atof(argv[i+1]);
+            if (export_options.sample_rate <= 0.0f) {
+                fprintf(stderr, "Error: --fps expects a positive rate\n");
+                return 1;
+            }
+            i++;
+        }
+        if (strcmp(argv[i], "--fit-curves") == 0 && i+1 < argc) {
+            export_options.fit_error = (float)atof(argv[i+1]);
+            if (export_options.fit_error <= 0.0f) {
+                fprintf(stderr, "Error: --fit-curves expects a positive error\n");
+                return 1;
+            }
+            i++;
+        }
+        if (strcmp(argv[i], "--fit-angle") == 0 && i+1 < argc) {
+            export_options.fit_angle = (float)atof(argv[i+1]) * 3.14159265f / 180.0f;
+            if (export_options.fit_angle <= 0.0f) {
+                fprintf(stderr, "Error: --fit-angle expects a positive angle\n");
+                return 1;
+            }
+            i++;
+        }
+        if (strcmp(argv[i], "--threads") == 0 && i+1 < argc) {
+            export_options.threads = atoi(argv[i+1]);
+            if (export_options.threads < 0) {
+                fprintf(stderr, "Error: --threads expects 0 (all cores) or a thread count\n");
+                return 1;
+            }
+            i++;
+        }
+        if (strcmp(argv[i], "--clip-bounds") == 0) export_options.clip_bounds = 1;
+        if (strcmp(argv[i], "--joint-bounds") == 0) export_options.joint_bounds = 1;
+        if (strcmp(argv[i], "--shared-anims") == 0) shared_anims = 1;
+        if (strcmp(argv[i], "--anim-library") == 0) anim_library = 1;
+        if (strcmp(argv[i], "--atomic") == 0) export_options.atomic_write = 1;
+        if (strcmp(argv[i], "--reproducible") == 0) export_options.reproducible = 1;
+        if (strcmp(argv[i], "--stream") == 0 && i+1 < argc) {
+            int window = atoi(argv[i+1]);
+            if (window < 1) {
+                fprintf(stderr, "Error: --stream expects a positive frame count\n");
+                return 1;
+            }
+            export_options.stream_window = (uint32_t)window;
+            i++;
+        }
+        if (strcmp(argv[i], "--bench") == 0) bench_mode = 1;
+        if (strcmp(argv[i], "--bench-max") == 0 && i+1 < argc) {
+            bench_max = atof(argv[i+1]);
+            i++;
+        }
+        if (strcmp(argv[i], "--bench-rms") == 0 && i+1 < argc) {
+            bench_rms = atof(argv[i+1]);
+            i++;
+        }
+        if (strcmp(argv[i], "--rest-pose") == 0 && i+1 < argc) {
+            rest_pose_anim = argv[i+1];
+            i++;
+        }
+    }
+    if (first_option < 2) {
+        fprintf(stderr, "Error: No base name given\n");
+        return 1;
+    }
+    if (export_options.stream_window > 0 && !bench_mode &&
+        (export_options.format != GLTF_OUTPUT_SEPARATE || export_options.sample_rate > 0.0f ||
+         export_options.fit_error > 0.0f || export_options.clip_bounds || shared_anims || anim_library)) {
+        fprintf(stderr, "Error: --stream needs --bin and cannot be combined with --fps, --fit-curves, "
+                        "--clip-bounds, --shared-anims or --anim-library\n");
+        return 1;
+    }
+
+    if (import_mode) {
+        int failures = 0;
+        for (int i = 1; i < first_option; ++i) {
+            if (import_model(argv[i]) != 0) failures++;
+        }
+        return failures ? 1 : 0;
+    }
+
+    ModelConfigCache configs;
+    model_config_cache_init(&configs);
+    DirIndexCache dirs;
+    dir_index_cache_init(&dirs);
+
+    AnimStore anim_store;
+    if (shared_anims && !bench_mode) {
+        if (!anim_store_open(&anim_store, "output/animations.bin")) {
+            dir_index_cache_free(&dirs);
+            model_config_cache_free(&configs);
+            return 1;
+        }
+        export_options.anim_store = &anim_store;
+    }
+    AnimLibrarySet libraries;
+    anim_library_set_init(&libraries);
+    if (anim_library && !bench_mode) {
+        export_options.anim_libraries = &libraries;
+    }
+
+    int failures = 0;
+    for (int i = 1; i < first_option; ++i) {
+        if (bench_mode) {
+            failures += bench_model(argv[i], rest_pose_anim, &export_options, bench_max, bench_rms, &configs, &dirs);
+            continue;
+        }
+        if (convert_model(argv[i], print_bones, rest_pose_anim, &export_options, &configs, &dirs) != 0) {
+            failures++;
+        }
+    }
+
+    if (first_option > 2 && !bench_mode) {
+        printf("Converted %d of %d model(s), %u unique skeleton(s)\n",
+               first_option - 1 - failures, first_option - 1, configs.skeletons.count);
+    }
+    // Libraries are complete once every model sharing their skeleton ran
+    for (uint32_t l = 0; l < libraries.count; l++) {
+        AnimLibrary *lib = libraries.libraries[l];
+        if (lib->clip_count == 0) continue;
+        char library_file[512];
+        char file_name[256];
+        gltf_anim_library_file_name(lib, export_options.format, file_name, sizeof(file_name));
+        snprintf(library_file, sizeof(library_file), "output/%s", file_name);
+        if (!export_anim_library(library_file, lib, &export_options)) {
+            fprintf(stderr, "Error: Cannot write %s\n", library_file);
+            failures++;
+            continue;
+        }
+        printf("Animation library: %s, %u clip(s) for %u model(s), %u shared\n",
+               library_file, lib->clip_count, lib->model_count, lib->reused);
+    }
+    anim_library_set_free(&libraries);
+
+    if (export_options.anim_store) {
+        printf("Shared animations: %u unique blocks, %u reused, %llu -> %llu bytes in output/%s\n",
+               anim_store.count, anim_store.hits, (unsigned long long)anim_store.added_bytes,
+               (unsigned long long)anim_store.size, anim_store.uri);
+        if (!anim_store_close(&anim_store)) {
+            fprintf(stderr, "Error: Cannot finish output/animations.bin\n");
+            failures++;
+        }
+    }
+
+    dir_index_cache_free(&dirs);
+    model_config_cache_free(&configs);
+    return failures ? 1 : 0;
 }
@@ -0,0 +1,494 @@
+#include "mesh_simplify.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Attribute penalties are scaled by the mesh extent so they compete with
+// geometric error: a full bone-weight mismatch costs as much as moving the
+// surface by 10% of the extent, a full UV mismatch by 5%
+#define SKIN_PENALTY 0.1
+#define UV_PENALTY 0.05
+// Weight of the planes through open edges, which hold borders and seams in shape
+#define BORDER_WEIGHT 2.0
+
+typedef enum {
+    VERTEX_MANIFOLD,   // interior: collapses onto any neighbour
+    VERTEX_BORDER,     // on one open edge loop: slides along it
+    VERTEX_SEAM,       // one of two wedges split by a seam: moves with its sibling
+    VERTEX_LOCKED      // corners, junctions and non-manifold fans
+} VertexKind;
+
+typedef struct {
+    uint32_t *wedge;       // next vertex at the same position (ring)
+    uint32_t *open_out;    // target of the outgoing open edge, ~0u if none
+    uint32_t *open_in;     // source of the incoming open edge, ~0u if none
+    uint8_t *open_count;   // open edges touching the vertex, saturating
+    uint8_t *live;         // referenced by the current index list
+    uint8_t *kind;
+} Topology;
+
+// Symmetric 4x4 plane quadric, area weighted; w is the total area
+typedef struct {
+    double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+    double w;
+} Quadric;
+
+typedef struct {
+    uint32_t source;
+    uint32_t target;
+    uint32_t sibling;          // seam wedge moving along with source, ~0u if none
+    uint32_t sibling_target;
+    double cost;     // geometric error plus attribute penalties, for ordering
+    double error;    // mean squared distance to the source's planes
+} Collapse;
+
+static void quadric_add_plane(Quadric *q, double a, double b, double c, double d, double w) {
+    q->a2 += w * a * a;
+    q->ab += w * a * b;
+    q->ac += w * a * c;
+    q->ad += w * a * d;
+    q->b2 += w * b * b;
+    q->bc += w * b * c;
+    q->bd += w * b * d;
+    q->c2 += w * c * c;
+    q->cd += w * c * d;
+    q->d2 += w * d * d;
+    q->w += w;
+}
+
+static void quadric_add(Quadric *q, const Quadric *r) {
+    q->a2 += r->a2;
+    q->ab += r->ab;
+    q->ac += r->ac;
+    q->ad += r->ad;
+    q->b2 += r->b2;
+    q->bc += r->bc;
+    q->bd += r->bd;
+    q->c2 += r->c2;
+    q->cd += r->cd;
+    q->d2 += r->d2;
+    q->w += r->w;
+}
+
+// Mean squared distance of p to the planes accumulated in q
+static double quadric_error(const Quadric *q, const float *p) {
+    if (q->w <= 0.0) return 0.0;
+    double x = p[0], y = p[1], z = p[2];
+    double e = q->a2 * x * x + q->b2 * y * y + q->c2 * z * z
+             + 2.0 * (q->ab * x * y + q->ac * x * z + q->bc * y * z)
+             + 2.0 * (q->ad * x + q->bd * y + q->cd * z) + q->d2;
+    e /= q->w;
+    return e > 0.0 ? e : 0.0;
+}
+
+static void triangle_normal(const float *p0, const float *p1, const float *p2, double n[3]) {
+    double e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+    double e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+// Half the L1 distance between two sparse weight sets, in [0, 1]
+static double skin_distance(const SimplifyMesh *mesh, uint32_t u, uint32_t v) {
+    const uint32_t *ju = &mesh->joints[u * 4], *jv = &mesh->joints[v * 4];
+    const float *wu = &mesh->weights[u * 4], *wv = &mesh->weights[v * 4];
+    double dist = 0.0;
+
+    for (int i = 0; i < 4; i++) {
+        double other = 0.0;
+        for (int j = 0; j < 4; j++) {
+            if (jv[j] == ju[i]) other += wv[j];
+        }
+        dist += fabs(wu[i] - other);
+    }
+    for (int j = 0; j < 4; j++) {
+        int shared = 0;
+        for (int i = 0; i < 4; i++) {
+            if (ju[i] == jv[j]) shared = 1;
+        }
+        if (!shared) dist += wv[j];
+    }
+    dist *= 0.5;
+    return dist < 1.0 ? dist : 1.0;
+}
+
+static int compare_edge_keys(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static int compare_collapses(const void *a, const void *b) {
+    const Collapse *x = a, *y = b;
+    if (x->cost != y->cost) return x->cost < y->cost ? -1 : 1;
+    return x->source < y->source ? -1 : x->source > y->source;
+}
+
+// Vertex sorted by its position bits; the record carries the position so
+// the comparator needs no shared state and concurrent exports stay apart
+typedef struct {
+    float position[3];
+    uint32_t vertex;
+} PositionKey;
+
+static int compare_positions(const void *a, const void *b) {
+    const PositionKey *x = a, *y = b;
+    int c = memcmp(x->position, y->position, sizeof(x->position));
+    if (c) return c;
+    return x->vertex < y->vertex ? -1 : x->vertex > y->vertex;
+}
+
+static int same_position(const SimplifyMesh *mesh, uint32_t a, uint32_t b) {
+    return memcmp(&mesh->positions[a * 3], &mesh->positions[b * 3], 3 * sizeof(float)) == 0;
+}
+
+// Link vertices that share a position into rings; seams are split vertices
+static int build_wedges(const SimplifyMesh *mesh, uint32_t *wedge) {
+    uint32_t count = mesh->vertex_count;
+    PositionKey *order = malloc((count ? count : 1) * sizeof(PositionKey));
+    if (!order) return 0;
+    for (uint32_t v = 0; v < count; v++) {
+        memcpy(order[v].position, &mesh->positions[v * 3], sizeof(order[v].position));
+        order[v].vertex = v;
+    }
+    qsort(order, count, sizeof(PositionKey), compare_positions);
+
+    uint32_t run = 0;
+    for (uint32_t i = 0; i < count; i = run) {
+        run = i + 1;
+        while (run < count && memcmp(order[run].position, order[i].position, sizeof(order[i].position)) == 0) run++;
+        for (uint32_t k = i; k < run; k++) {
+            wedge[order[k].vertex] = order[k + 1 < run ? k + 1 : i].vertex;
+        }
+    }
+    free(order);
+    return 1;
+}
+
+// Find open edges (no triangle runs the other way) and classify vertices
+static int classify_vertices(const SimplifyMesh *mesh, const uint32_t *indices, uint32_t index_count,
+                             Topology *topo) {
+    uint32_t vertex_count = mesh->vertex_count;
+    uint64_t *keys = malloc((index_count ? index_count : 1) * sizeof(uint64_t));
+    if (!keys) return 0;
+
+    for (uint32_t i = 0; i < index_count; i++) {
+        uint32_t a = indices[i], b = indices[i - i % 3 + (i + 1) % 3];
+        keys[i] = ((uint64_t)a << 32) | b;
+    }
+    qsort(keys, index_count, sizeof(uint64_t), compare_edge_keys);
+
+    memset(topo->open_count, 0, vertex_count);
+    memset(topo->live, 0, vertex_count);
+    memset(topo->open_out, 0xFF, vertex_count * sizeof(uint32_t));
+    memset(topo->open_in, 0xFF, vertex_count * sizeof(uint32_t));
+    for (uint32_t i = 0; i < index_count; i++) {
+        topo->live[indices[i]] = 1;
+        uint32_t a = (uint32_t)(keys[i] >> 32), b = (uint32_t)keys[i];
+        uint64_t reverse = ((uint64_t)b << 32) | a;
+        int repeated = (i > 0 && keys[i - 1] == keys[i]) || (i + 1 < index_count && keys[i + 1] == keys[i]);
+        if (!repeated && bsearch(&reverse, keys, index_count, sizeof(uint64_t), compare_edge_keys)) continue;
+
+        // Open, or shared by several triangles running the same way
+        topo->open_out[a] = repeated ? ~0u : b;
+        topo->open_in[b] = repeated ? ~0u : a;
+        if (topo->open_count[a] < 3) topo->open_count[a] += repeated ? 3 : 1;
+        if (topo->open_count[b] < 3) topo->open_count[b] += repeated ? 3 : 1;
+    }
+    free(keys);
+
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        uint32_t wedges = 0, sibling = v;
+        for (uint32_t w = topo->wedge[v]; w != v; w = topo->wedge[w]) {
+            if (topo->live[w]) {
+                wedges++;
+                sibling = w;
+            }
+        }
+        int on_loop = topo->open_count[v] == 2 && topo->open_out[v] != ~0u && topo->open_in[v] != ~0u;
+
+        if (topo->open_count[v] == 0 && wedges == 0) {
+            topo->kind[v] = VERTEX_MANIFOLD;
+        } else if (on_loop && wedges == 0) {
+            topo->kind[v] = VERTEX_BORDER;
+        } else if (on_loop && wedges == 1 &&
+                   topo->open_count[sibling] == 2 &&
+                   topo->open_out[sibling] != ~0u && topo->open_in[sibling] != ~0u &&
+                   same_position(mesh, topo->open_out[v], topo->open_in[sibling]) &&
+                   same_position(mesh, topo->open_in[v], topo->open_out[sibling])) {
+            // Both wedges run along the same edges in opposite directions
+            topo->kind[v] = VERTEX_SEAM;
+        } else {
+            topo->kind[v] = VERTEX_LOCKED;
+        }
+    }
+    return 1;
+}
+
+// Live wedge at v's position other than v itself
+static uint32_t seam_sibling(const Topology *topo, uint32_t v) {
+    for (uint32_t w = topo->wedge[v]; w != v; w = topo->wedge[w]) {
+        if (topo->live[w]) return w;
+    }
+    return v;
+}
+
+// Vertex -> triangle adjacency in compressed rows
+static void build_adjacency(const uint32_t *indices, uint32_t index_count, uint32_t vertex_count,
+                            uint32_t *offsets, uint32_t *triangles) {
+    memset(offsets, 0, (vertex_count + 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < index_count; i++) {
+        offsets[indices[i] + 1]++;
+    }
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+    for (uint32_t i = 0; i < index_count; i++) {
+        triangles[offsets[indices[i]]++] = i / 3;
+    }
+    // offsets were advanced to row ends; shift them back
+    for (uint32_t v = vertex_count; v > 0; v--) {
+        offsets[v] = offsets[v - 1];
+    }
+    offsets[0] = 0;
+}
+
+// Moving u onto v must not turn any surviving triangle around u upside down
+static int collapse_flips(const SimplifyMesh *mesh, const uint32_t *indices,
+                          const uint32_t *offsets, const uint32_t *triangles,
+                          uint32_t u, uint32_t v) {
+    const float *pv = &mesh->positions[v * 3];
+    for (uint32_t k = offsets[u]; k < offsets[u + 1]; k++) {
+        const uint32_t *tri = &indices[triangles[k] * 3];
+        if (tri[0] == v || tri[1] == v || tri[2] == v) continue;
+
+        const float *p[3], *q[3];
+        for (int c = 0; c < 3; c++) {
+            p[c] = &mesh->positions[tri[c] * 3];
+            q[c] = tri[c] == u ? pv : p[c];
+        }
+        double before[3], after[3];
+        triangle_normal(p[0], p[1], p[2], before);
+        triangle_normal(q[0], q[1], q[2], after);
+        if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0) return 1;
+    }
+    return 0;
+}
+
+float mesh_extent(const SimplifyMesh *mesh, const uint32_t *indices, uint32_t index_count) {
+    if (index_count == 0) return 0.0f;
+    float lo[3], hi[3];
+    for (int c = 0; c < 3; c++) {
+        lo[c] = hi[c] = mesh->positions[indices[0] * 3 + c];
+    }
+    for (uint32_t i = 1; i < index_count; i++) {
+        const float *p = &mesh->positions[indices[i] * 3];
+        for (int c = 0; c < 3; c++) {
+            if (p[c] < lo[c]) lo[c] = p[c];
+            if (p[c] > hi[c]) hi[c] = p[c];
+        }
+    }
+    float dx = hi[0] - lo[0], dy = hi[1] - lo[1], dz = hi[2] - lo[2];
+    return sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+// Remove u's triangles that contain v, mark every vertex around u and move u onto v
+static uint32_t apply_collapse(const uint32_t *indices, const uint32_t *offsets, const uint32_t *triangles,
+                               Quadric *quadrics, uint32_t *remap, uint8_t *touched,
+                               uint32_t u, uint32_t v) {
+    uint32_t removed = 0;
+    for (uint32_t k = offsets[u]; k < offsets[u + 1]; k++) {
+        const uint32_t *tri = &indices[triangles[k] * 3];
+        if (tri[0] == v || tri[1] == v || tri[2] == v) removed++;
+        touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+    }
+    remap[u] = v;
+    quadric_add(&quadrics[v], &quadrics[u]);
+    return removed;
+}
+
+uint32_t simplify_mesh(const SimplifyMesh *mesh, const uint32_t *indices, uint32_t index_count,
+                       uint32_t target_index_count, float max_error,
+                       uint32_t *destination, float *result_error) {
+    uint32_t vertex_count = mesh->vertex_count;
+    index_count -= index_count % 3;
+    memcpy(destination, indices, index_count * sizeof(uint32_t));
+    if (result_error) *result_error = 0.0f;
+    if (index_count <= target_index_count || vertex_count == 0) return index_count;
+
+    Topology topo;
+    topo.wedge = malloc(vertex_count * sizeof(uint32_t));
+    topo.open_out = malloc(vertex_count * sizeof(uint32_t));
+    topo.open_in = malloc(vertex_count * sizeof(uint32_t));
+    topo.open_count = malloc(vertex_count);
+    topo.live = malloc(vertex_count);
+    topo.kind = malloc(vertex_count);
+    Quadric *quadrics = calloc(vertex_count, sizeof(Quadric));
+    uint8_t *touched = malloc(vertex_count);
+    uint32_t *offsets = malloc((vertex_count + 1) * sizeof(uint32_t));
+    uint32_t *triangles = malloc(index_count * sizeof(uint32_t));
+    uint32_t *remap = malloc(vertex_count * sizeof(uint32_t));
+    Collapse *best = malloc(vertex_count * sizeof(Collapse));
+    Collapse *candidates = malloc(vertex_count * sizeof(Collapse));
+
+    if (!topo.wedge || !topo.open_out || !topo.open_in || !topo.open_count || !topo.live || !topo.kind ||
+        !quadrics || !touched || !offsets || !triangles || !remap || !best || !candidates ||
+        !build_wedges(mesh, topo.wedge) || !classify_vertices(mesh, destination, index_count, &topo)) {
+        goto cleanup;
+    }
+
+    // Face planes, plus planes through open edges at right angles to their
+    // face so borders and seams keep their outline
+    for (uint32_t i = 0; i < index_count; i += 3) {
+        const float *p[3];
+        for (int c = 0; c < 3; c++) {
+            p[c] = &mesh->positions[destination[i + c] * 3];
+        }
+        double n[3];
+        triangle_normal(p[0], p[1], p[2], n);
+        double len = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (len <= 0.0) continue;
+        n[0] /= len;
+        n[1] /= len;
+        n[2] /= len;
+        double d = -(n[0] * p[0][0] + n[1] * p[0][1] + n[2] * p[0][2]);
+        for (int c = 0; c < 3; c++) {
+            quadric_add_plane(&quadrics[destination[i + c]], n[0], n[1], n[2], d, len * 0.5);
+        }
+
+        for (int c = 0; c < 3; c++) {
+            uint32_t a = destination[i + c], b = destination[i + (c + 1) % 3];
+            if (topo.open_out[a] != b && topo.open_in[b] != a) continue;
+            const float *pa = p[c], *pb = p[(c + 1) % 3];
+            double e[3] = {pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2]};
+            double m[3] = {e[1] * n[2] - e[2] * n[1], e[2] * n[0] - e[0] * n[2], e[0] * n[1] - e[1] * n[0]};
+            double mlen = sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+            if (mlen <= 0.0) continue;
+            m[0] /= mlen;
+            m[1] /= mlen;
+            m[2] /= mlen;
+            double md = -(m[0] * pa[0] + m[1] * pa[1] + m[2] * pa[2]);
+            double w = (e[0] * e[0] + e[1] * e[1] + e[2] * e[2]) * BORDER_WEIGHT;
+            quadric_add_plane(&quadrics[a], m[0], m[1], m[2], md, w);
+            quadric_add_plane(&quadrics[b], m[0], m[1], m[2], md, w);
+        }
+    }
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        remap[v] = v;
+    }
+
+    double extent = mesh_extent(mesh, destination, index_count);
+    double skin_scale = SKIN_PENALTY * extent * SKIN_PENALTY * extent;
+    double uv_scale = UV_PENALTY * extent * UV_PENALTY * extent;
+    double error_limit = (double)max_error * max_error;
+    double worst = 0.0;
+
+    // Each pass ranks the cheapest collapse of every free vertex and applies
+    // those that do not share a triangle with one already applied
+    for (int pass = 0; index_count > target_index_count; pass++) {
+        if (pass > 0 && !classify_vertices(mesh, destination, index_count, &topo)) break;
+        build_adjacency(destination, index_count, vertex_count, offsets, triangles);
+        for (uint32_t v = 0; v < vertex_count; v++) {
+            best[v].cost = HUGE_VAL;
+        }
+
+        for (uint32_t i = 0; i < index_count; i++) {
+            uint32_t u = destination[i];
+            uint8_t kind = topo.kind[u];
+            if (kind == VERTEX_LOCKED) continue;
+            uint32_t t = i - i % 3;
+            for (int e = 1; e < 3; e++) {
+                uint32_t v = destination[t + (i - t + e) % 3];
+                // Border and seam vertices only move along their open edges
+                if (kind != VERTEX_MANIFOLD && v != topo.open_out[u] && v != topo.open_in[u]) continue;
+
+                Quadric q = quadrics[u];
+                uint32_t sibling = ~0u, sibling_target = ~0u;
+                if (kind == VERTEX_SEAM) {
+                    sibling = seam_sibling(&topo, u);
+                    sibling_target = v == topo.open_out[u] ? topo.open_in[sibling] : topo.open_out[sibling];
+                    quadric_add(&q, &quadrics[sibling]);
+                }
+                double error = quadric_error(&q, &mesh->positions[v * 3]);
+                double cost = error;
+                if (mesh->joints && mesh->weights) {
+                    cost += skin_distance(mesh, u, v) * skin_scale;
+                }
+                if (mesh->texcoords) {
+                    double du = mesh->texcoords[u * 2] - mesh->texcoords[v * 2];
+                    double dv = mesh->texcoords[u * 2 + 1] - mesh->texcoords[v * 2 + 1];
+                    double uv = du * du + dv * dv;
+                    cost += (uv < 1.0 ? uv : 1.0) * uv_scale;
+                }
+                if (cost < best[u].cost) {
+                    best[u].source = u;
+                    best[u].target = v;
+                    best[u].sibling = sibling;
+                    best[u].sibling_target = sibling_target;
+                    best[u].cost = cost;
+                    best[u].error = error;
+                }
+            }
+        }
+
+        uint32_t candidate_count = 0;
+        for (uint32_t v = 0; v < vertex_count; v++) {
+            if (best[v].cost != HUGE_VAL && best[v].error <= error_limit) {
+                candidates[candidate_count++] = best[v];
+            }
+        }
+        qsort(candidates, candidate_count, sizeof(Collapse), compare_collapses);
+
+        memset(touched, 0, vertex_count);
+        uint32_t triangle_count = index_count / 3;
+        uint32_t applied = 0;
+        for (uint32_t c = 0; c < candidate_count && triangle_count * 3 > target_index_count; c++) {
+            const Collapse *col = &candidates[c];
+            uint32_t u = col->source, v = col->target;
+            int seam = col->sibling != ~0u;
+            if (touched[u] || touched[v]) continue;
+            if (seam && (touched[col->sibling] || touched[col->sibling_target])) continue;
+            if (collapse_flips(mesh, destination, offsets, triangles, u, v)) continue;
+            if (seam && collapse_flips(mesh, destination, offsets, triangles, col->sibling, col->sibling_target)) continue;
+
+            triangle_count -= apply_collapse(destination, offsets, triangles, quadrics, remap, touched, u, v);
+            if (seam) {
+                triangle_count -= apply_collapse(destination, offsets, triangles, quadrics, remap, touched,
+                                                 col->sibling, col->sibling_target);
+            }
+            if (col->error > worst) worst = col->error;
+            applied++;
+        }
+        if (applied == 0) break;
+
+        uint32_t write = 0;
+        for (uint32_t i = 0; i < index_count; i += 3) {
+            uint32_t a = remap[destination[i]];
+            uint32_t b = remap[destination[i + 1]];
+            uint32_t c = remap[destination[i + 2]];
+            if (a == b || b == c || a == c) continue;
+            destination[write++] = a;
+            destination[write++] = b;
+            destination[write++] = c;
+        }
+        index_count = write;
+    }
+
+    if (result_error) *result_error = (float)sqrt(worst);
+
+cleanup:
+    free(topo.wedge);
+    free(topo.open_out);
+    free(topo.open_in);
+    free(topo.open_count);
+    free(topo.live);
+    free(topo.kind);
+    free(quadrics);
+    free(touched);
+    free(offsets);
+    free(triangles);
+    free(remap);
+    free(best);
+    free(candidates);
+    return index_count;
+}
@@ -0,0 +1,37 @@
+#ifndef MESH_SIMPLIFY_H
+#define MESH_SIMPLIFY_H
+
+#include <stdint.h>
+
+// Quadric error metric simplification by edge collapse onto existing
+// vertices. The vertex buffer is never rewritten: every level of detail is
+// a new index list over the same vertices, so LOD meshes can share the
+// attribute accessors of the full mesh.
+//
+// Vertices on open edges only slide along them, so borders keep their
+// outline. Vertices split by a UV or normal seam are collapsed together
+// with their sibling wedge along the seam, so seams never open. Corners,
+// seam junctions and non-manifold fans are locked. Collapses between
+// vertices with different UVs or bone weights are penalized, which keeps
+// joint boundaries from sliding across the mesh.
+
+typedef struct {
+    const float *positions;   // 3 per vertex
+    const float *texcoords;   // 2 per vertex, may be NULL
+    const uint32_t *joints;   // 4 per vertex, may be NULL
+    const float *weights;     // 4 per vertex, may be NULL
+    uint32_t vertex_count;
+} SimplifyMesh;
+
+// Simplify a triangle list to at most target_index_count indices, stopping
+// early once a collapse would move the surface by more than max_error
+// (model units). destination needs index_count entries. Returns the new
+// index count; *result_error receives the largest collapse error.
+uint32_t simplify_mesh(const SimplifyMesh *mesh, const uint32_t *indices, uint32_t index_count,
+                       uint32_t target_index_count, float max_error,
+                       uint32_t *destination, float *result_error);
+
+// Diagonal of the bounding box of the vertices referenced by indices
+float mesh_extent(const SimplifyMesh *mesh, const uint32_t *indices, uint32_t index_count);
+
+#endif // MESH_SIMPLIFY_H
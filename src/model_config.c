@@ -0,0 +1,135 @@
+#include "model_config.h"
+#include "filesystem.h"
+#include "json_span.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+
+// Fill the speed table from the "animation_speeds" object text
+static int load_speeds(ModelConfig *config, const char *text, size_t size) {
+    cJSON *speeds = cJSON_ParseWithLength(text, size);
+    if (!speeds || !cJSON_IsObject(speeds)) {
+        cJSON_Delete(speeds);
+        fprintf(stderr, "Warning: invalid 'animation_speeds' in %s\n", config->source_file);
+        return 1;
+    }
+
+    config->speed_values = malloc((size_t)(cJSON_GetArraySize(speeds) + 1) * sizeof(float));
+    if (!config->speed_values) {
+        cJSON_Delete(speeds);
+        return 0;
+    }
+
+    cJSON *item = NULL;
+    cJSON_ArrayForEach(item, speeds) {
+        if (!item->string || !cJSON_IsNumber(item)) continue;
+        // First entry wins on duplicate names, matching cJSON_GetObjectItem
+        int inserted = str_map_insert(&config->speed_index, item->string, (int)config->speed_count);
+        if (inserted < 0) {
+            cJSON_Delete(speeds);
+            return 0;
+        }
+        if (inserted) config->speed_values[config->speed_count++] = (float)item->valuedouble;
+    }
+
+    cJSON_Delete(speeds);
+    return 1;
+}
+
+ModelConfig* model_config_load(const char *json_file, SkeletonCache *skeletons) {
+    size_t size = 0;
+    char *content = read_file(json_file, &size);
+    if (!content) {
+        fprintf(stderr, "Failed to open skeleton JSON file: %s\n", json_file);
+        return NULL;
+    }
+
+    ModelConfig *config = calloc(1, sizeof(ModelConfig));
+    if (!config) {
+        free(content);
+        return NULL;
+    }
+    snprintf(config->source_file, sizeof(config->source_file), "%s", json_file);
+    // Animation names are looked up case-insensitively, like cJSON_GetObjectItem
+    str_map_init(&config->speed_index, 1);
+
+    JsonSpan span;
+    if (json_find_member(content, size, "skeleton", &span)) {
+        config->skeleton = skeleton_cache_intern(skeletons, span.data, span.size, json_file);
+    } else {
+        fprintf(stderr, "No 'skeleton' object in JSON\n");
+    }
+
+    if (json_find_member(content, size, "animation_speeds", &span) &&
+        !load_speeds(config, span.data, span.size)) {
+        free(content);
+        model_config_free(config);
+        return NULL;
+    }
+
+    free(content);
+    return config;
+}
+
+void model_config_free(ModelConfig *config) {
+    if (!config) return;
+    str_map_free(&config->speed_index);
+    free(config->speed_values);
+    free(config);
+}
+
+float model_config_anim_speed(const ModelConfig *config, const char *anim_name, float fallback) {
+    int index;
+    if (!config || !anim_name || !str_map_get(&config->speed_index, anim_name, &index)) {
+        return fallback;
+    }
+    return config->speed_values[index];
+}
+
+void model_config_cache_init(ModelConfigCache *cache) {
+    skeleton_cache_init(&cache->skeletons);
+    str_map_init(&cache->path_index, 0);
+    cache->configs = NULL;
+    cache->count = 0;
+    cache->capacity = 0;
+}
+
+void model_config_cache_free(ModelConfigCache *cache) {
+    for (uint32_t i = 0; i < cache->count; i++) {
+        model_config_free(cache->configs[i]);
+    }
+    free(cache->configs);
+    str_map_free(&cache->path_index);
+    skeleton_cache_free(&cache->skeletons);
+    cache->configs = NULL;
+    cache->count = 0;
+    cache->capacity = 0;
+}
+
+const ModelConfig* model_config_cache_get(ModelConfigCache *cache, const char *json_file) {
+    int index;
+    if (str_map_get(&cache->path_index, json_file, &index)) {
+        return cache->configs[index];
+    }
+
+    ModelConfig *config = model_config_load(json_file, &cache->skeletons);
+    if (!config) return NULL;
+
+    if (cache->count >= cache->capacity) {
+        uint32_t new_capacity = cache->capacity ? cache->capacity * 2 : 8;
+        ModelConfig **configs = realloc(cache->configs, new_capacity * sizeof(ModelConfig*));
+        if (!configs) {
+            model_config_free(config);
+            return NULL;
+        }
+        cache->configs = configs;
+        cache->capacity = new_capacity;
+    }
+    if (str_map_insert(&cache->path_index, json_file, (int)cache->count) < 0) {
+        model_config_free(config);
+        return NULL;
+    }
+    cache->configs[cache->count++] = config;
+    return config;
+}
@@ -0,0 +1,46 @@
+#ifndef MODEL_CONFIG_H
+#define MODEL_CONFIG_H
+
+#include <stdint.h>
+#include "skeleton.h"
+#include "skeleton_cache.h"
+#include "str_map.h"
+
+#define DEFAULT_ANIM_SPEED 100.0f
+
+// Typed view of a model's <base>.json, read and parsed once.
+// The skeleton comes from a SkeletonCache and is shared read-only;
+// animation speeds are kept in a hashed name -> percent table.
+
+typedef struct {
+    char source_file[512];
+    const SkeletonDef *skeleton;   // NULL if the file has no "skeleton" object
+    StrMap speed_index;            // animation name (any case) -> speed_values[]
+    float *speed_values;           // speed in percent
+    uint32_t speed_count;
+} ModelConfig;
+
+// Read json_file once and build its config. Skeletons are interned in
+// `skeletons`, which must outlive the config. NULL if the file is unreadable.
+ModelConfig* model_config_load(const char *json_file, SkeletonCache *skeletons);
+void model_config_free(ModelConfig *config);
+
+// Speed for an animation in percent, `fallback` if the config has none
+float model_config_anim_speed(const ModelConfig *config, const char *anim_name, float fallback);
+
+// Configs of a batch, keyed by file path, plus the skeletons they share
+typedef struct {
+    SkeletonCache skeletons;
+    StrMap path_index;             // json path -> configs[]
+    ModelConfig **configs;
+    uint32_t count;
+    uint32_t capacity;
+} ModelConfigCache;
+
+void model_config_cache_init(ModelConfigCache *cache);
+void model_config_cache_free(ModelConfigCache *cache);
+
+// Config for json_file, loaded on first use. Owned by the cache.
+const ModelConfig* model_config_cache_get(ModelConfigCache *cache, const char *json_file);
+
+#endif // MODEL_CONFIG_H
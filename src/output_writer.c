@@ -0,0 +1,166 @@
+#include "output_writer.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <process.h>
+#define output_pid() _getpid()
+#else
+#include <unistd.h>
+#define output_pid() getpid()
+#endif
+
+#if defined(HAVE_WRITEV) && !defined(_WIN32)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#define OUTPUT_USE_WRITEV 1
+#endif
+
+#ifdef OUTPUT_USE_WRITEV
+#ifdef IOV_MAX
+#define OUTPUT_MAX_IOV (IOV_MAX < 64 ? IOV_MAX : 64)
+#else
+#define OUTPUT_MAX_IOV 16
+#endif
+
+// Write every chunk, resuming after short writes
+static int write_all(int fd, const OutputChunk *chunks, size_t count) {
+    struct iovec iov[OUTPUT_MAX_IOV];
+    size_t next = 0;      // first chunk not yet fully written
+    size_t done = 0;      // bytes of chunks[next] already written
+    while (next < count) {
+        int n = 0;
+        for (size_t c = next; c < count && n < OUTPUT_MAX_IOV; c++) {
+            size_t skip = c == next ? done : 0;
+            if (chunks[c].size == skip) continue;
+            iov[n].iov_base = (void *)((const char *)chunks[c].data + skip);
+            iov[n].iov_len = chunks[c].size - skip;
+            n++;
+        }
+        if (n == 0) return 1;
+        ssize_t written = writev(fd, iov, n);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        // Advance past what went out
+        size_t left = (size_t)written;
+        while (next < count && left >= chunks[next].size - done) {
+            left -= chunks[next].size - done;
+            next++;
+            done = 0;
+        }
+        done += left;
+    }
+    return 1;
+}
+
+static int write_file(const char *path, const OutputChunk *chunks, size_t count, size_t total) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) return 0;
+#ifdef HAVE_POSIX_FALLOCATE
+    // Only a hint: file systems without support report an error and the
+    // writes simply extend the file
+    if (total > 0) (void)posix_fallocate(fd, 0, (off_t)total);
+#else
+    (void)total;
+#endif
+    int ok = write_all(fd, chunks, count);
+    if (close(fd) != 0) ok = 0;
+    return ok;
+}
+#else
+static int write_file(const char *path, const OutputChunk *chunks, size_t count, size_t total) {
+    (void)total;
+    FILE *f = fopen(path, "wb");
+    if (!f) return 0;
+    int ok = 1;
+    for (size_t c = 0; ok && c < count; c++) {
+        ok = fwrite(chunks[c].data, 1, chunks[c].size, f) == chunks[c].size;
+    }
+    if (fclose(f) != 0) ok = 0;
+    return ok;
+}
+#endif
+
+// Temporary file next to path, so the rename never crosses file systems; the
+// process id keeps concurrent conversions to the same path apart
+static char* temp_path_for(const char *path) {
+    size_t len = strlen(path);
+    char *temp = malloc(len + 32);
+    if (!temp) return NULL;
+    snprintf(temp, len + 32, "%s.%ld.tmp", path, (long)output_pid());
+    return temp;
+}
+
+// Move a complete temporary file over path, or drop it
+static int finish_temp(const char *temp, const char *path, int ok) {
+#ifdef _WIN32
+    // rename() does not replace an existing file on Windows
+    if (ok) remove(path);
+#endif
+    if (ok) ok = rename(temp, path) == 0;
+    if (!ok) remove(temp);
+    return ok;
+}
+
+int output_write_chunks(const char *path, const OutputChunk *chunks, size_t count, int atomic) {
+    size_t total = 0;
+    for (size_t c = 0; c < count; c++) total += chunks[c].size;
+    if (!atomic) return write_file(path, chunks, count, total);
+
+    char *temp = temp_path_for(path);
+    if (!temp) return 0;
+    int ok = finish_temp(temp, path, write_file(temp, chunks, count, total));
+    free(temp);
+    return ok;
+}
+
+int output_file_open(OutputFile *out, const char *path, int atomic) {
+    out->file = NULL;
+    out->temp = NULL;
+    out->path = malloc(strlen(path) + 1);
+    if (!out->path) return 0;
+    strcpy(out->path, path);
+    if (atomic) {
+        out->temp = temp_path_for(path);
+        if (!out->temp) {
+            free(out->path);
+            out->path = NULL;
+            return 0;
+        }
+    }
+    out->file = fopen(out->temp ? out->temp : out->path, "wb");
+    if (!out->file) {
+        free(out->path);
+        free(out->temp);
+        out->path = out->temp = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+int output_file_write_at(OutputFile *out, uint64_t offset, const void *data, size_t size) {
+    if (size == 0) return 1;
+    if (offset > (uint64_t)LONG_MAX || fseek(out->file, (long)offset, SEEK_SET) != 0) return 0;
+    return fwrite(data, 1, size, out->file) == size;
+}
+
+int output_file_close(OutputFile *out, int ok) {
+    if (!out->file) return 0;
+    if (fclose(out->file) != 0) ok = 0;
+    if (out->temp) {
+        ok = finish_temp(out->temp, out->path, ok);
+    } else if (!ok) {
+        remove(out->path);
+    }
+    free(out->path);
+    free(out->temp);
+    out->file = NULL;
+    out->path = out->temp = NULL;
+    return ok;
+}
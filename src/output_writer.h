@@ -0,0 +1,42 @@
+#ifndef OUTPUT_WRITER_H
+#define OUTPUT_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Output files written from their pieces: a GLB header, the JSON text and
+// the binary chunk are handed to the OS as they are, without first being
+// copied into one buffer. The total size is known before the first byte,
+// so the file is preallocated (posix_fallocate, when CMake finds it) and the
+// pieces go out in as few writev calls as the iovec limit allows. Without
+// writev each piece is one fwrite.
+
+typedef struct {
+    const void *data;
+    size_t size;
+} OutputChunk;
+
+// Write the chunks to path in order. With atomic set, they go to a
+// temporary file next to path that is renamed over it once complete, so
+// readers and concurrent runs never see a partial file. Returns 1 on
+// success; on failure path is left as it was when atomic, and the
+// temporary file is removed.
+int output_write_chunks(const char *path, const OutputChunk *chunks, size_t count, int atomic);
+
+// A file written piecewise at arbitrary offsets, for data produced in
+// windows (streamed animation tracks land in several places per window).
+// With atomic set, it is written under a temporary name like above.
+typedef struct {
+    FILE *file;
+    char *path;
+    char *temp;         // written instead of path when atomic, else NULL
+} OutputFile;
+
+int output_file_open(OutputFile *out, const char *path, int atomic);
+int output_file_write_at(OutputFile *out, uint64_t offset, const void *data, size_t size);
+// Close out; when ok and atomic, move it into place. When not ok the
+// partial file is removed. Returns 1 when the file is complete.
+int output_file_close(OutputFile *out, int ok);
+
+#endif // OUTPUT_WRITER_H
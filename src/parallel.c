@@ -0,0 +1,74 @@
+#include "parallel.h"
+#include <stdlib.h>
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#define PARALLEL_MAX_THREADS 64
+
+int parallel_thread_count(void) {
+#if defined(HAVE_PTHREAD) && defined(_SC_NPROCESSORS_ONLN)
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n > PARALLEL_MAX_THREADS) n = PARALLEL_MAX_THREADS;
+    return n > 1 ? (int)n : 1;
+#else
+    return 1;
+#endif
+}
+
+#ifdef HAVE_PTHREAD
+typedef struct {
+    ParallelRangeFn fn;
+    void *context;
+    uint32_t begin;
+    uint32_t end;
+} ParallelTask;
+
+static void* run_task(void *arg) {
+    ParallelTask *task = arg;
+    task->fn(task->context, task->begin, task->end);
+    return NULL;
+}
+#endif
+
+void parallel_for(uint32_t count, uint32_t grain, int threads, ParallelRangeFn fn, void *context) {
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+    if (threads <= 0) threads = parallel_thread_count();
+    if (threads > PARALLEL_MAX_THREADS) threads = PARALLEL_MAX_THREADS;
+    uint32_t chunks = (count + grain - 1) / grain;
+    if ((uint32_t)threads > chunks) threads = (int)chunks;
+
+#ifdef HAVE_PTHREAD
+    if (threads > 1) {
+        ParallelTask tasks[PARALLEL_MAX_THREADS];
+        pthread_t handles[PARALLEL_MAX_THREADS];
+        int started[PARALLEL_MAX_THREADS] = {0};
+        uint32_t per_thread = count / (uint32_t)threads;
+        uint32_t extra = count % (uint32_t)threads;
+        uint32_t begin = 0;
+        for (int t = 0; t < threads; t++) {
+            uint32_t size = per_thread + ((uint32_t)t < extra ? 1 : 0);
+            tasks[t] = (ParallelTask){fn, context, begin, begin + size};
+            begin += size;
+        }
+        // The calling thread takes the first range; a thread that fails to
+        // start has its range run inline
+        for (int t = 1; t < threads; t++) {
+            started[t] = pthread_create(&handles[t], NULL, run_task, &tasks[t]) == 0;
+        }
+        run_task(&tasks[0]);
+        for (int t = 1; t < threads; t++) {
+            if (started[t]) {
+                pthread_join(handles[t], NULL);
+            } else {
+                run_task(&tasks[t]);
+            }
+        }
+        return;
+    }
+#endif
+    fn(context, 0, count);
+}
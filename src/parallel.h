@@ -0,0 +1,20 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stdint.h>
+
+// Minimal fork-join loop for the data-parallel kernels (skinning, bounds).
+// Built with pthreads when CMake finds them (HAVE_PTHREAD); otherwise, or
+// when the range is small, the loop simply runs on the calling thread.
+
+typedef void (*ParallelRangeFn)(void *context, uint32_t begin, uint32_t end);
+
+// Hardware threads available, at least 1
+int parallel_thread_count(void);
+
+// Call fn over [0, count) split into contiguous ranges of at least grain
+// items, on up to threads threads (0 = parallel_thread_count()). fn must be
+// safe to run concurrently on disjoint ranges. Returns once every range ran.
+void parallel_for(uint32_t count, uint32_t grain, int threads, ParallelRangeFn fn, void *context);
+
+#endif // PARALLEL_H
@@ -1,76 +1,51 @@
 #include "pmd_psa_types.h"
+#include "binary_io.h"
+#include "filesystem.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// Read helpers for little-endian data
-static uint32_t read_u32(FILE *f) {
-    uint8_t buf[4];
-    if (fread(buf, 1, 4, f) != 4) return 0;
-    return buf[0] | (buf[1] << 8) | (buf[2] << 16) | (buf[3] << 24);
-}
-
-static uint16_t read_u16(FILE *f) {
-    uint8_t buf[2];
-    if (fread(buf, 1, 2, f) != 2) return 0;
-    return buf[0] | (buf[1] << 8);
-}
-
-static uint8_t read_u8(FILE *f) {
-    uint8_t val;
-    if (fread(&val, 1, 1, f) != 1) return 0;
-    return val;
-}
-
-static float read_float(FILE *f) {
-    float val;
-    if (fread(&val, sizeof(float), 1, f) != 1) return 0.0f;
-    return val;
-}
+// Smallest encoded sizes, used to reject counts the file cannot hold
+#define PMD_MIN_VERTEX_SIZE (3*4 + 3*4 + 4 + 4*4)
+#define PMD_FACE_SIZE (3*2)
+#define PMD_BONE_SIZE (3*4 + 4*4)
+#define PMD_MIN_PROP_SIZE (4 + 3*4 + 4*4 + 1)
 
-static Vector3D read_vec3(FILE *f) {
-    Vector3D v;
-    v.x = read_float(f);
-    v.y = read_float(f);
-    v.z = read_float(f);
-    return v;
-}
-
-static Quaternion read_quat(FILE *f) {
-    Quaternion q;
-    q.x = read_float(f);
-    q.y = read_float(f);
-    q.z = read_float(f);
-    q.w = read_float(f);
-    return q;
+static int fits(const ByteReader *r, uint32_t count, size_t item_size) {
+    return (size_t)count <= byte_reader_remaining(r) / item_size;
 }
 
 // Load PMD file
 PMDModel* load_pmd(const char *filename) {
-    FILE *f = fopen(filename, "rb");
-    if (!f) {
+    size_t size = 0;
+    char *content = read_file(filename, &size);
+    if (!content) {
         fprintf(stderr, "Failed to open %s\n", filename);
         return NULL;
     }
+    PMDModel *model = parse_pmd(content, size);
+    free(content);
+    return model;
+}
 
-    PMDModel *model = calloc(1, sizeof(PMDModel));
+PMDModel* parse_pmd(const void *data, size_t size) {
+    ByteReader r;
+    byte_reader_init(&r, data, size);
 
     // Read header
-    char magic[4];
-    if (fread(magic, 1, 4, f) != 4) {
+    const uint8_t *magic = byte_reader_take(&r, 4);
+    if (!magic) {
         fprintf(stderr, "Failed to read PMD magic\n");
-        free(model);
-        fclose(f);
         return NULL;
     }
     if (memcmp(magic, "PSMD", 4) != 0) {
         fprintf(stderr, "Invalid PMD magic\n");
-        free(model);
-        fclose(f);
         return NULL;
     }
 
-    model->version = read_u32(f);
+    PMDModel *model = calloc(1, sizeof(PMDModel));
+    if (!model) return NULL;
+    model->version = byte_reader_u32(&r);
     
     // Validation: Check supported version
     if (model->version < 1 || model->version > 4) {
@@ -78,78 +53,102 @@ PMDModel* load_pmd(const char *filename) {
     }
     
     // Skip data size (not used)
-    read_u32(f);
+    byte_reader_u32(&r);
 
     // Read vertices
-    model->numVertices = read_u32(f);
-    model->numTexCoords = (model->version >= 4) ? read_u32(f) : 1;
+    model->numVertices = byte_reader_u32(&r);
+    model->numTexCoords = (model->version >= 4) ? byte_reader_u32(&r) : 1;
+    if (!fits(&r, model->numVertices, PMD_MIN_VERTEX_SIZE + (size_t)model->numTexCoords * 2 * 4)) {
+        fprintf(stderr, "Truncated PMD file: %u vertices do not fit\n", model->numVertices);
+        free_pmd(model);
+        return NULL;
+    }
     model->vertices = calloc(model->numVertices, sizeof(Vertex));
 
     for (uint32_t i = 0; i < model->numVertices; i++) {
         Vertex *v = &model->vertices[i];
-        v->position = read_vec3(f);
-        v->normal = read_vec3(f);
+        v->position = byte_reader_vec3(&r);
+        v->normal = byte_reader_vec3(&r);
 
         v->coords = calloc(model->numTexCoords, sizeof(TexCoord));
         for (uint32_t j = 0; j < model->numTexCoords; j++) {
-            v->coords[j].u = read_float(f);
-            v->coords[j].v = read_float(f);
+            v->coords[j].u = byte_reader_f32(&r);
+            v->coords[j].v = byte_reader_f32(&r);
         }
 
         for (int j = 0; j < 4; j++) {
-            v->blend.bones[j] = read_u8(f);
+            v->blend.bones[j] = byte_reader_u8(&r);
         }
         for (int j = 0; j < 4; j++) {
-            v->blend.weights[j] = read_float(f);
+            v->blend.weights[j] = byte_reader_f32(&r);
         }
     }
 
     // Read faces
-    model->numFaces = read_u32(f);
+    model->numFaces = byte_reader_u32(&r);
+    if (!fits(&r, model->numFaces, PMD_FACE_SIZE)) {
+        fprintf(stderr, "Truncated PMD file: %u faces do not fit\n", model->numFaces);
+        free_pmd(model);
+        return NULL;
+    }
     model->faces = calloc(model->numFaces, sizeof(Face));
     for (uint32_t i = 0; i < model->numFaces; i++) {
         for (int j = 0; j < 3; j++) {
-            model->faces[i].vertices[j] = read_u16(f);
+            model->faces[i].vertices[j] = byte_reader_u16(&r);
         }
     }
 
     // Read bones
-    model->numBones = read_u32(f);
+    model->numBones = byte_reader_u32(&r);
     
     // Validation: Check bone count limit (254 max according to PMDConvert.cpp)
     if (model->numBones > 254) {
         fprintf(stderr, "Error: Too many bones (%u > 254 max)\n", model->numBones);
         free_pmd(model);
-        fclose(f);
+        return NULL;
+    }
+    if (!fits(&r, model->numBones, PMD_BONE_SIZE)) {
+        fprintf(stderr, "Truncated PMD file: %u bones do not fit\n", model->numBones);
+        free_pmd(model);
         return NULL;
     }
     
     model->restStates = calloc(model->numBones, sizeof(BoneState));
     for (uint32_t i = 0; i < model->numBones; i++) {
-        model->restStates[i].translation = read_vec3(f);
-        model->restStates[i].rotation = read_quat(f);
+        model->restStates[i] = byte_reader_bone_state(&r);
     }
 
     // Read prop points (version 2+)
     if (model->version >= 2) {
-        model->numPropPoints = read_u32(f);
+        model->numPropPoints = byte_reader_u32(&r);
+        if (!fits(&r, model->numPropPoints, PMD_MIN_PROP_SIZE)) {
+            fprintf(stderr, "Truncated PMD file: %u prop points do not fit\n", model->numPropPoints);
+            model->numPropPoints = 0;
+            free_pmd(model);
+            return NULL;
+        }
         model->propPoints = calloc(model->numPropPoints, sizeof(PropPoint));
         for (uint32_t i = 0; i < model->numPropPoints; i++) {
-            uint32_t nameLen = read_u32(f);
-            model->propPoints[i].name = calloc(nameLen + 1, 1);
-            if (fread(model->propPoints[i].name, 1, nameLen, f) != nameLen) {
+            uint32_t nameLen = byte_reader_u32(&r);
+            const uint8_t *name = byte_reader_take(&r, nameLen);
+            if (!name) {
                 fprintf(stderr, "Failed to read prop point name\n");
                 free_pmd(model);
-                fclose(f);
                 return NULL;
             }
-            model->propPoints[i].translation = read_vec3(f);
-            model->propPoints[i].rotation = read_quat(f);
-            model->propPoints[i].bone = read_u8(f);
+            model->propPoints[i].name = calloc(nameLen + 1, 1);
+            memcpy(model->propPoints[i].name, name, nameLen);
+            model->propPoints[i].translation = byte_reader_vec3(&r);
+            model->propPoints[i].rotation = byte_reader_quat(&r);
+            model->propPoints[i].bone = byte_reader_u8(&r);
         }
     }
 
-    fclose(f);
+    if (r.error) {
+        fprintf(stderr, "Truncated PMD file\n");
+        free_pmd(model);
+        return NULL;
+    }
     return model;
 }
 
@@ -1,6 +1,7 @@
 #ifndef PMD_PSA_TYPES_H
 #define PMD_PSA_TYPES_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 // Basic types matching the file format specs
@@ -28,8 +29,10 @@ typedef struct {
     VertexBlend blend;
 } Vertex;
 
+// PMD files store 16-bit indices; in memory faces are 32-bit so merged or
+// imported meshes past 65536 vertices can still be exported to glTF
 typedef struct {
-    uint16_t vertices[3];
+    uint32_t vertices[3];
 } Face;
 
 typedef struct {
@@ -58,19 +61,33 @@ typedef struct {
     PropPoint *propPoints;
 } PMDModel;
 
+// Open PSA file whose frames are decoded on demand (see open_psa_stream)
+typedef struct PSAStream PSAStream;
+
 // PSA animation structure
 typedef struct {
     char *name;
     float frameLength;
     uint32_t numBones;
     uint32_t numFrames;
-    BoneState *boneStates;  // size: numBones * numFrames
+    BoneState *boneStates;  // size: numBones * numFrames; NULL when streamed
+    PSAStream *stream;      // set when the frames stay in the file
 } PSAAnimation;
 
 // Function declarations
 PMDModel* load_pmd(const char *filename);
+// Decode a PMD image already in memory
+PMDModel* parse_pmd(const void *data, size_t size);
 void free_pmd(PMDModel *model);
 PSAAnimation* load_psa(const char *filename);
+// Decode a PSA image already in memory
+PSAAnimation* parse_psa(const void *data, size_t size);
+// Read only the header; frames are decoded window by window with
+// read_psa_frames, so long clips never sit in memory whole
+PSAAnimation* open_psa_stream(const char *filename);
+// Decode frames [first_frame, first_frame + frame_count) into out
+// (frame_count * numBones states), from the file or from boneStates
+int read_psa_frames(const PSAAnimation *anim, uint32_t first_frame, uint32_t frame_count, BoneState *out);
 void free_psa(PSAAnimation *anim);
 
 #endif
@@ -0,0 +1,151 @@
+#include "pmd_writer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PMD_HEADER_SIZE 12
+
+int encode_pmd(ByteWriter *out, const PMDModel *model) {
+    if (!model) { fprintf(stderr, "[PMDWriter] Model NULL\n"); return 0; }
+    if (model->numVertices > 0 && !model->vertices) { fprintf(stderr, "[PMDWriter] Vertices NULL\n"); return 0; }
+    if (model->numFaces > 0 && !model->faces) { fprintf(stderr, "[PMDWriter] Faces NULL\n"); return 0; }
+    if (model->numBones > 0 && !model->restStates) { fprintf(stderr, "[PMDWriter] restStates NULL\n"); return 0; }
+    if (model->numPropPoints > 0 && !model->propPoints) { fprintf(stderr, "[PMDWriter] propPoints NULL\n"); return 0; }
+    for (uint32_t i = 0; i < model->numVertices; i++) {
+        if (!model->vertices[i].coords && model->numTexCoords > 0) { fprintf(stderr, "[PMDWriter] Vertex coords NULL\n"); return 0; }
+    }
+    for (uint32_t i = 0; i < model->numPropPoints; i++) {
+        if (!model->propPoints[i].name) { fprintf(stderr, "[PMDWriter] propPoint name NULL\n"); return 0; }
+    }
+    for (uint32_t i = 0; i < model->numFaces; i++) {
+        for (int j = 0; j < 3; j++) {
+            if (model->faces[i].vertices[j] > 0xFFFF) { fprintf(stderr, "[PMDWriter] Face index %u exceeds the 16-bit PMD limit\n", model->faces[i].vertices[j]); return 0; }
+        }
+    }
+
+    // Size the buffer up front so the body is written without regrowing
+    size_t vertex_size = 3*4 + 3*4 + (size_t)model->numTexCoords*2*4 + 4 + 4*4;
+    size_t estimate = PMD_HEADER_SIZE + 16 + model->numVertices * vertex_size +
+                      (size_t)model->numFaces * 3 * 2 + (size_t)model->numBones * (3*4 + 4*4);
+    for (uint32_t i = 0; i < model->numPropPoints; i++) {
+        estimate += 4 + strlen(model->propPoints[i].name) + 3*4 + 4*4 + 1;
+    }
+    if (!byte_writer_reserve(out, estimate)) return 0;
+
+    // Write header; data size is patched once the body is known
+    size_t start = out->size;
+    byte_writer_bytes(out, "PSMD", 4);
+    byte_writer_u32(out, model->version);
+    byte_writer_u32(out, 0);
+
+    // Write vertices (texture coordinate count is stored from version 4)
+    byte_writer_u32(out, model->numVertices);
+    if (model->version >= 4) {
+        byte_writer_u32(out, model->numTexCoords);
+    }
+    for (uint32_t i = 0; i < model->numVertices; i++) {
+        const Vertex *v = &model->vertices[i];
+        byte_writer_vec3(out, v->position);
+        byte_writer_vec3(out, v->normal);
+        for (uint32_t j = 0; j < model->numTexCoords; j++) {
+            byte_writer_f32(out, v->coords[j].u);
+            byte_writer_f32(out, v->coords[j].v);
+        }
+        byte_writer_bytes(out, v->blend.bones, 4);
+        for (int j = 0; j < 4; j++) {
+            byte_writer_f32(out, v->blend.weights[j]);
+        }
+    }
+
+    // Write faces
+    byte_writer_u32(out, model->numFaces);
+    for (uint32_t i = 0; i < model->numFaces; i++) {
+        for (int j = 0; j < 3; j++) {
+            byte_writer_u16(out, (uint16_t)model->faces[i].vertices[j]);
+        }
+    }
+
+    // Write bones
+    byte_writer_u32(out, model->numBones);
+    for (uint32_t i = 0; i < model->numBones; i++) {
+        byte_writer_bone_state(out, model->restStates[i]);
+    }
+
+    // Write prop points (version 2+)
+    if (model->version >= 2) {
+        byte_writer_u32(out, model->numPropPoints);
+        for (uint32_t i = 0; i < model->numPropPoints; i++) {
+            const PropPoint *pp = &model->propPoints[i];
+            uint32_t nameLen = (uint32_t)strlen(pp->name);
+            byte_writer_u32(out, nameLen);
+            byte_writer_bytes(out, pp->name, nameLen);
+            byte_writer_vec3(out, pp->translation);
+            byte_writer_quat(out, pp->rotation);
+            byte_writer_u8(out, pp->bone);
+        }
+    }
+
+    if (out->error) return 0;
+    uint32_t data_size = (uint32_t)(out->size - start - PMD_HEADER_SIZE);
+    out->data[start + 8] = (uint8_t)(data_size & 0xFF);
+    out->data[start + 9] = (uint8_t)((data_size >> 8) & 0xFF);
+    out->data[start + 10] = (uint8_t)((data_size >> 16) & 0xFF);
+    out->data[start + 11] = (uint8_t)(data_size >> 24);
+    return 1;
+}
+
+int encode_psa(ByteWriter *out, const PSAAnimation *anim) {
+    if (!anim) { fprintf(stderr, "[PSAWriter] Animation NULL\n"); return 0; }
+    if (!anim->name) { fprintf(stderr, "[PSAWriter] name NULL\n"); return 0; }
+    if (anim->numBones == 0 || anim->numFrames == 0) { fprintf(stderr, "[PSAWriter] numBones ou numFrames nul\n"); return 0; }
+    if (!anim->boneStates) { fprintf(stderr, "[PSAWriter] boneStates NULL\n"); return 0; }
+
+    // Calculate data size
+    uint32_t nameLen = (uint32_t)strlen(anim->name);
+    size_t state_count = (size_t)anim->numBones * anim->numFrames;
+    size_t data_size = 4 + nameLen + 4 + 4 + 4 + state_count * (3*4 + 4*4);
+    if (!byte_writer_reserve(out, PMD_HEADER_SIZE + data_size)) return 0;
+
+    // Write header
+    byte_writer_bytes(out, "PSSA", 4);
+    byte_writer_u32(out, 1);  // version
+    byte_writer_u32(out, (uint32_t)data_size);
+
+    // Write animation data
+    byte_writer_u32(out, nameLen);
+    byte_writer_bytes(out, anim->name, nameLen);
+    byte_writer_f32(out, anim->frameLength);
+    byte_writer_u32(out, anim->numBones);
+    byte_writer_u32(out, anim->numFrames);
+
+    // Write bone states
+    for (size_t i = 0; i < state_count; i++) {
+        byte_writer_bone_state(out, anim->boneStates[i]);
+    }
+
+    return !out->error;
+}
+
+int write_pmd(const char *filename, const PMDModel *model) {
+    ByteWriter out;
+    byte_writer_init(&out, 0);
+    int ok = encode_pmd(&out, model);
+    if (ok && !byte_writer_save(&out, filename)) {
+        fprintf(stderr, "[PMDWriter] Impossible d'ouvrir %s\n", filename);
+        ok = 0;
+    }
+    byte_writer_free(&out);
+    return ok;
+}
+
+int write_psa(const char *filename, const PSAAnimation *anim) {
+    ByteWriter out;
+    byte_writer_init(&out, 0);
+    int ok = encode_psa(&out, anim);
+    if (ok && !byte_writer_save(&out, filename)) {
+        fprintf(stderr, "[PSAWriter] Impossible d'ouvrir %s\n", filename);
+        ok = 0;
+    }
+    byte_writer_free(&out);
+    return ok;
+}
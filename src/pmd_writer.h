@@ -0,0 +1,20 @@
+#ifndef PMD_WRITER_H
+#define PMD_WRITER_H
+
+#include "pmd_psa_types.h"
+#include "binary_io.h"
+
+// Serialize to the PMD/PSA formats read by load_pmd()/load_psa().
+// The encode functions append the whole file image to a ByteWriter; the
+// write functions encode and save it with a single write.
+
+int encode_pmd(ByteWriter *out, const PMDModel *model);
+int encode_psa(ByteWriter *out, const PSAAnimation *anim);
+
+// Write PMD file to disk
+int write_pmd(const char *filename, const PMDModel *model);
+
+// Write PSA file to disk
+int write_psa(const char *filename, const PSAAnimation *anim);
+
+#endif // PMD_WRITER_H
@@ -0,0 +1,92 @@
+#include "pose.h"
+#include "transform.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const BoneState identity_state = {{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 1.0f}};
+
+int pose_init(SkeletonPose *pose, const SkeletonDef *skel, uint32_t num_bones) {
+    memset(pose, 0, sizeof(*pose));
+    pose->num_bones = num_bones;
+    size_t n = num_bones ? num_bones : 1;
+    pose->parents = malloc(n * sizeof(int));
+    pose->order = malloc(n * sizeof(uint32_t));
+    pose->world = calloc(n, sizeof(BoneState));
+    pose->local = calloc(n, sizeof(BoneState));
+    pose->world_matrices = calloc(n * 16, sizeof(float));
+    pose->local_matrices = calloc(n * 16, sizeof(float));
+    if (!pose->parents || !pose->order || !pose->world || !pose->local ||
+        !pose->world_matrices || !pose->local_matrices) {
+        pose_free(pose);
+        return 0;
+    }
+
+    uint32_t count = 0;
+    uint32_t skel_bones = 0;
+    if (skel && skel->topo_order) {
+        skel_bones = (uint32_t)skel->bone_count < num_bones ? (uint32_t)skel->bone_count : num_bones;
+        // The skeleton's topological order, restricted to bones this pose has
+        for (int i = 0; i < skel->bone_count; i++) {
+            int bone = skel->topo_order[i];
+            if ((uint32_t)bone >= num_bones) continue;
+            int parent = skel->bones[bone].parent_index;
+            pose->parents[bone] = (parent >= 0 && (uint32_t)parent < num_bones) ? parent : -1;
+            pose->order[count++] = (uint32_t)bone;
+        }
+    }
+    for (uint32_t bone = skel_bones; bone < num_bones; bone++) {
+        pose->parents[bone] = -1;
+        pose->order[count++] = bone;
+    }
+    return 1;
+}
+
+void pose_free(SkeletonPose *pose) {
+    if (!pose) return;
+    free(pose->parents);
+    free(pose->order);
+    free(pose->world);
+    free(pose->local);
+    free(pose->world_matrices);
+    free(pose->local_matrices);
+    memset(pose, 0, sizeof(*pose));
+}
+
+void pose_evaluate_world(SkeletonPose *pose, const BoneState *states, uint32_t state_count,
+                         const BoneState *fallback, uint32_t fallback_count) {
+    for (uint32_t i = 0; i < pose->num_bones; i++) {
+        uint32_t bone = pose->order[i];
+        if (states && bone < state_count) {
+            pose->world[bone] = states[bone];
+        } else if (fallback && bone < fallback_count) {
+            pose->world[bone] = fallback[bone];
+        } else {
+            pose->world[bone] = identity_state;
+        }
+
+        int parent = pose->parents[bone];
+        if (parent >= 0) {
+            compute_local_transform(&pose->local[bone], &pose->world[bone], &pose->world[parent]);
+        } else {
+            pose->local[bone] = pose->world[bone];
+        }
+        make_matrix(&pose->world[bone], &pose->world_matrices[bone * 16]);
+        make_matrix(&pose->local[bone], &pose->local_matrices[bone * 16]);
+    }
+}
+
+void pose_evaluate_local(SkeletonPose *pose, const BoneState *states, uint32_t state_count) {
+    for (uint32_t i = 0; i < pose->num_bones; i++) {
+        uint32_t bone = pose->order[i];
+        pose->local[bone] = (states && bone < state_count) ? states[bone] : identity_state;
+
+        int parent = pose->parents[bone];
+        if (parent >= 0) {
+            compose_world_transform(&pose->world[bone], &pose->local[bone], &pose->world[parent]);
+        } else {
+            pose->world[bone] = pose->local[bone];
+        }
+        make_matrix(&pose->world[bone], &pose->world_matrices[bone * 16]);
+        make_matrix(&pose->local[bone], &pose->local_matrices[bone * 16]);
+    }
+}
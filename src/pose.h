@@ -0,0 +1,37 @@
+#ifndef POSE_H
+#define POSE_H
+
+#include <stdint.h>
+#include "pmd_psa_types.h"
+#include "skeleton.h"
+
+// Pose evaluation over a bone hierarchy in topological order.
+// One evaluation fills world and local transforms plus their matrices for
+// every bone into contiguous arrays, so IBMs, node TRS, animation tracks and
+// skinning all read from the same result.
+
+typedef struct {
+    uint32_t num_bones;
+    int *parents;            // resolved parent per bone, -1 for roots
+    uint32_t *order;         // parents always come before their children
+    BoneState *world;        // num_bones
+    BoneState *local;        // num_bones
+    float *world_matrices;   // num_bones * 16, column-major
+    float *local_matrices;   // num_bones * 16, column-major
+} SkeletonPose;
+
+// Prepare a pose for num_bones bones. Bones described by the skeleton use its
+// hierarchy; bones past the skeleton (or without one) are roots.
+int pose_init(SkeletonPose *pose, const SkeletonDef *skel, uint32_t num_bones);
+void pose_free(SkeletonPose *pose);
+
+// Evaluate from world-space states (PMD rest states, PSA frames).
+// Bones at or past state_count take their state from fallback instead
+// (typically the model rest pose); bones missing from both get identity.
+void pose_evaluate_world(SkeletonPose *pose, const BoneState *states, uint32_t state_count,
+                         const BoneState *fallback, uint32_t fallback_count);
+
+// Evaluate from parent-relative states (glTF node TRS, animation tracks)
+void pose_evaluate_local(SkeletonPose *pose, const BoneState *states, uint32_t state_count);
+
+#endif // POSE_H
@@ -1,107 +1,200 @@
 #include "pmd_psa_types.h"
+#include "binary_io.h"
+#include "filesystem.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// Reuse read helpers (these should be in a shared header in production)
-static uint32_t read_u32(FILE *f) {
-    uint8_t buf[4];
-    if (fread(buf, 1, 4, f) != 4) return 0;
-    return buf[0] | (buf[1] << 8) | (buf[2] << 16) | (buf[3] << 24);
-}
-
-static float read_float(FILE *f) {
-    float val;
-    if (fread(&val, sizeof(float), 1, f) != 1) return 0.0f;
-    return val;
-}
-
-static Vector3D read_vec3(FILE *f) {
-    Vector3D v;
-    v.x = read_float(f);
-    v.y = read_float(f);
-    v.z = read_float(f);
-    return v;
-}
-
-static Quaternion read_quat(FILE *f) {
-    Quaternion q;
-    q.x = read_float(f);
-    q.y = read_float(f);
-    q.z = read_float(f);
-    q.w = read_float(f);
-    return q;
-}
+#define PSA_BONE_STATE_SIZE (3*4 + 4*4)
 
 // Load PSA file
 PSAAnimation* load_psa(const char *filename) {
-    FILE *f = fopen(filename, "rb");
-    if (!f) {
+    size_t size = 0;
+    char *content = read_file(filename, &size);
+    if (!content) {
         fprintf(stderr, "Failed to open %s\n", filename);
         return NULL;
     }
+    PSAAnimation *anim = parse_psa(content, size);
+    free(content);
+    return anim;
+}
 
-    PSAAnimation *anim = calloc(1, sizeof(PSAAnimation));
-    uint32_t version = 1; // default for error handling
-
+// Header fields up to the first bone state. Returns NULL, with the reason
+// printed, when the header is malformed.
+static PSAAnimation* parse_psa_header(ByteReader *r) {
     // Read header
-    char magic[4];
-    if (fread(magic, 1, 4, f) != 4) {
+    const uint8_t *magic = byte_reader_take(r, 4);
+    if (!magic) {
         fprintf(stderr, "Failed to read PSA magic\n");
-        free(anim);
-        fclose(f);
         return NULL;
     }
     if (memcmp(magic, "PSSA", 4) != 0) {
         fprintf(stderr, "Invalid PSA magic\n");
-        free(anim);
-        fclose(f);
         return NULL;
     }
 
     // Read and validate version
-    version = read_u32(f);
+    uint32_t version = byte_reader_u32(r);
     if (version != 1) {
         fprintf(stderr, "Warning: Unsupported PSA version %u (expected 1)\n", version);
     }
     
     // Skip data size (not used)
-    read_u32(f); // data_size
+    byte_reader_u32(r); // data_size
+
+    PSAAnimation *anim = calloc(1, sizeof(PSAAnimation));
+    if (!anim) return NULL;
 
     // Read name
-    uint32_t nameLen = read_u32(f);
-    anim->name = calloc(nameLen + 1, 1);
-    if (fread(anim->name, 1, nameLen, f) != nameLen) {
+    uint32_t nameLen = byte_reader_u32(r);
+    const uint8_t *name = byte_reader_take(r, nameLen);
+    if (!name) {
         fprintf(stderr, "Failed to read animation name\n");
         free_psa(anim);
-        fclose(f);
         return NULL;
     }
+    anim->name = calloc(nameLen + 1, 1);
+    memcpy(anim->name, name, nameLen);
 
     // Read frame length (unused but still in file)
-    anim->frameLength = read_float(f);
+    anim->frameLength = byte_reader_f32(r);
 
     // Read animation data
-    anim->numBones = read_u32(f);
-    anim->numFrames = read_u32(f);
+    anim->numBones = byte_reader_u32(r);
+    anim->numFrames = byte_reader_u32(r);
     
     // Validation: Check bone count limit (192 max according to PSAConvert.cpp)
     if (anim->numBones > 192) {
         fprintf(stderr, "Warning: Too many bones (%u > 192 max) - skeleton may have issues\n", anim->numBones);
     }
+    if (r->error) {
+        fprintf(stderr, "Truncated PSA header\n");
+        free_psa(anim);
+        return NULL;
+    }
+    return anim;
+}
 
-    anim->boneStates = calloc(anim->numBones * anim->numFrames, sizeof(BoneState));
-    for (uint32_t i = 0; i < anim->numBones * anim->numFrames; i++) {
-        anim->boneStates[i].translation = read_vec3(f);
-        anim->boneStates[i].rotation = read_quat(f);
+// Bone states of anim fit in remaining bytes
+static int psa_states_fit(const PSAAnimation *anim, size_t remaining) {
+    if (anim->numFrames && anim->numBones > SIZE_MAX / anim->numFrames) return 0;
+    return (size_t)anim->numBones * anim->numFrames <= remaining / PSA_BONE_STATE_SIZE;
+}
+
+PSAAnimation* parse_psa(const void *data, size_t size) {
+    ByteReader r;
+    byte_reader_init(&r, data, size);
+    PSAAnimation *anim = parse_psa_header(&r);
+    if (!anim) return NULL;
+
+    if (!psa_states_fit(anim, byte_reader_remaining(&r))) {
+        fprintf(stderr, "Truncated PSA file: %u bones x %u frames do not fit\n", anim->numBones, anim->numFrames);
+        free_psa(anim);
+        return NULL;
+    }
+
+    size_t state_count = (size_t)anim->numBones * anim->numFrames;
+    anim->boneStates = calloc(state_count, sizeof(BoneState));
+    for (size_t i = 0; i < state_count; i++) {
+        anim->boneStates[i] = byte_reader_bone_state(&r);
+    }
+
+    return anim;
+}
+
+struct PSAStream {
+    FILE *file;
+    long data_offset;       // first bone state
+    uint8_t *window;        // raw bytes of the last frames read
+    size_t window_size;
+};
+
+PSAAnimation* open_psa_stream(const char *filename) {
+    FILE *f = fopen(filename, "rb");
+    if (!f) {
+        fprintf(stderr, "Failed to open %s\n", filename);
+        return NULL;
+    }
+    // Magic, version, data size and name length, then the name and the
+    // frame length, bone and frame counts
+    uint8_t fixed[16];
+    uint8_t *header = NULL;
+    PSAAnimation *anim = NULL;
+    if (fread(fixed, 1, sizeof(fixed), f) == sizeof(fixed)) {
+        uint32_t name_len = (uint32_t)fixed[12] | ((uint32_t)fixed[13] << 8) |
+                            ((uint32_t)fixed[14] << 16) | ((uint32_t)fixed[15] << 24);
+        size_t header_size = sizeof(fixed) + (size_t)name_len + 12;
+        header = name_len < 0x10000 ? malloc(header_size) : NULL;
+        if (header) {
+            memcpy(header, fixed, sizeof(fixed));
+            size_t got = fread(header + sizeof(fixed), 1, header_size - sizeof(fixed), f);
+            ByteReader r;
+            byte_reader_init(&r, header, sizeof(fixed) + got);
+            anim = parse_psa_header(&r);
+        }
     }
+    free(header);
 
-    fclose(f);
+    long data_offset = anim ? ftell(f) : -1;
+    long end = data_offset >= 0 && fseek(f, 0, SEEK_END) == 0 ? ftell(f) : -1;
+    if (anim && (end < data_offset || !psa_states_fit(anim, (size_t)(end - data_offset)))) {
+        fprintf(stderr, "Truncated PSA file: %u bones x %u frames do not fit\n", anim->numBones, anim->numFrames);
+        free_psa(anim);
+        anim = NULL;
+    }
+    if (anim) anim->stream = calloc(1, sizeof(PSAStream));
+    if (!anim || !anim->stream) {
+        if (!anim) fprintf(stderr, "Failed to read PSA header of %s\n", filename);
+        free_psa(anim);
+        fclose(f);
+        return NULL;
+    }
+    anim->stream->file = f;
+    anim->stream->data_offset = data_offset;
     return anim;
 }
 
+int read_psa_frames(const PSAAnimation *anim, uint32_t first_frame, uint32_t frame_count, BoneState *out) {
+    if (first_frame > anim->numFrames || frame_count > anim->numFrames - first_frame) return 0;
+    size_t first = (size_t)first_frame * anim->numBones;
+    size_t count = (size_t)frame_count * anim->numBones;
+    if (!anim->stream) {
+        if (!anim->boneStates) return 0;
+        memcpy(out, &anim->boneStates[first], count * sizeof(BoneState));
+        return 1;
+    }
+
+    PSAStream *stream = anim->stream;
+    size_t bytes = count * PSA_BONE_STATE_SIZE;
+    if (bytes > stream->window_size) {
+        uint8_t *window = realloc(stream->window, bytes);
+        if (!window) return 0;
+        stream->window = window;
+        stream->window_size = bytes;
+    }
+    long offset = stream->data_offset + (long)(first * PSA_BONE_STATE_SIZE);
+    if (fseek(stream->file, offset, SEEK_SET) != 0 ||
+        fread(stream->window, 1, bytes, stream->file) != bytes) {
+        fprintf(stderr, "Failed to read frames %u-%u of %s\n", first_frame, first_frame + frame_count - 1,
+                anim->name ? anim->name : "animation");
+        return 0;
+    }
+    ByteReader r;
+    byte_reader_init(&r, stream->window, bytes);
+    for (size_t i = 0; i < count; i++) {
+        out[i] = byte_reader_bone_state(&r);
+    }
+    return 1;
+}
+
 void free_psa(PSAAnimation *anim) {
     if (!anim) return;
+    if (anim->stream) {
+        fclose(anim->stream->file);
+        free(anim->stream->window);
+        free(anim->stream);
+    }
     free(anim->name);
     free(anim->boneStates);
     free(anim);
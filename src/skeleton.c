@@ -1,265 +1,217 @@
 #include "portable_string.h"
 #include "skeleton.h"
+#include "filesystem.h"
+#include "json_span.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
 #include "cJSON.h"
 
-SkeletonDef* load_skeleton_json(const char *filename) {
-    FILE *f = fopen(filename, "r");
-    if (!f) {
-        fprintf(stderr, "Failed to open skeleton JSON file: %s\n", filename);
-        return NULL;
-    }
-    fseek(f, 0, SEEK_END);
-    long size = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    char *content = malloc((size_t)size + 1);
-    if (fread(content, 1, (size_t)size, f) != (size_t)size) { fclose(f); return NULL; }
-    content[size] = '\0';
-    fclose(f);
-
-    cJSON *root = cJSON_Parse(content);
-    free(content);
-    if (!root) {
-        fprintf(stderr, "Invalid JSON in skeleton config\n");
-        return NULL;
-    }
-
-    cJSON *skel_obj = cJSON_GetObjectItem(root, "skeleton");
-    if (!skel_obj) {
-        cJSON_Delete(root);
-        fprintf(stderr, "No 'skeleton' object in JSON\n");
-        return NULL;
-    }
-
+SkeletonDef* skeleton_create(const char *source_file) {
     SkeletonDef *skel = calloc(1, sizeof(SkeletonDef));
-    my_strncpy(skel->skeleton_file, filename, sizeof(skel->skeleton_file)-1);
-    skel->skeleton_file[sizeof(skel->skeleton_file)-1] = '\0';
-    skel->skeleton_id[0] = '\0';
-
-    cJSON *title = cJSON_GetObjectItem(skel_obj, "title");
-    if (title && cJSON_IsString(title)) {
-        my_strncpy(skel->title, title->valuestring, sizeof(skel->title)-1);
-        skel->title[sizeof(skel->title)-1] = '\0';
-    } else {
-        skel->title[0] = '\0';
-    }
-
-    cJSON *bones = cJSON_GetObjectItem(skel_obj, "bones");
-    if (bones && cJSON_IsArray(bones)) {
-        int count = cJSON_GetArraySize(bones);
-        skel->bone_count = count > MAX_BONES ? MAX_BONES : count;
-        for (int i = 0; i < skel->bone_count; i++) {
-            cJSON *bone = cJSON_GetArrayItem(bones, i);
-            cJSON *name = cJSON_GetObjectItem(bone, "name");
-            cJSON *parent = cJSON_GetObjectItem(bone, "parent_index");
-            if (name && cJSON_IsString(name)) {
-                my_strncpy(skel->bones[i].name, name->valuestring, sizeof(skel->bones[i].name)-1);
-                skel->bones[i].name[sizeof(skel->bones[i].name)-1] = '\0';
-            } else {
-                skel->bones[i].name[0] = '\0';
-            }
-            skel->bones[i].parent_index = parent && cJSON_IsNumber(parent) ? parent->valueint : -1;
-        }
+    if (!skel) return NULL;
+    str_map_init(&skel->name_index, 0);
+    if (source_file) {
+        my_strncpy(skel->skeleton_file, source_file, sizeof(skel->skeleton_file)-1);
+        skel->skeleton_file[sizeof(skel->skeleton_file)-1] = '\0';
     }
-
-    cJSON_Delete(root);
     return skel;
 }
-#include "skeleton.h"
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <ctype.h>
-#include "cJSON.h"
 
-// Simple XML parser for skeleton hierarchy
-// Parses the bone names and builds parent-child relationships
+int skeleton_add_bone(SkeletonDef *skel, const char *name, int parent_index) {
+    if (skel->bone_count >= skel->bone_capacity) {
+        int new_capacity = skel->bone_capacity ? skel->bone_capacity * 2 : 32;
+        BoneInfo *bones = realloc(skel->bones, (size_t)new_capacity * sizeof(BoneInfo));
+        if (!bones) return -1;
+        skel->bones = bones;
+        skel->bone_capacity = new_capacity;
+    }
 
-static void skip_whitespace(const char **p) {
-    while (isspace(**p)) (*p)++;
+    BoneInfo *bone = &skel->bones[skel->bone_count];
+    size_t name_len = name ? strlen(name) : 0;
+    if (name_len >= sizeof(bone->name)) name_len = sizeof(bone->name) - 1;
+    if (name_len) memcpy(bone->name, name, name_len);
+    bone->name[name_len] = '\0';
+    bone->parent_index = parent_index;
+    return skel->bone_count++;
 }
 
-static int parse_attribute(const char **p, const char *attr_name, char *value, int max_len) {
-    skip_whitespace(p);
-    const char *start = strstr(*p, attr_name);
-    if (!start || start - *p > 100) return 0;  // attribute must be nearby
-
-    start += strlen(attr_name);
-    skip_whitespace(&start);
-    if (*start != '=') return 0;
-    start++;
-    skip_whitespace(&start);
-
-    char quote = *start;
-    if (quote != '"' && quote != '\'') return 0;
-    start++;
-
-    const char *end = strchr(start, quote);
-    if (!end) return 0;
-
-    int len = (int)(end - start);
-    if (len >= max_len) len = max_len - 1;
-    memcpy(value, start, (size_t)len);
-    value[len] = '\0';
-
-    *p = end + 1;
+// Build child adjacency (CSR layout) from parent indices
+static int build_children(SkeletonDef *skel) {
+    int n = skel->bone_count;
+    free(skel->child_offsets);
+    free(skel->child_indices);
+    skel->child_offsets = calloc((size_t)n + 1, sizeof(int));
+    skel->child_indices = malloc((size_t)(n ? n : 1) * sizeof(int));
+    if (!skel->child_offsets || !skel->child_indices) return 0;
+
+    for (int i = 0; i < n; i++) {
+        int parent = skel->bones[i].parent_index;
+        if (parent >= 0) skel->child_offsets[parent + 1]++;
+    }
+    for (int i = 0; i < n; i++) {
+        skel->child_offsets[i + 1] += skel->child_offsets[i];
+    }
+    // Fill in bone order so children keep their declaration order
+    int *cursor = malloc((size_t)(n ? n : 1) * sizeof(int));
+    if (!cursor) return 0;
+    memcpy(cursor, skel->child_offsets, (size_t)n * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        int parent = skel->bones[i].parent_index;
+        if (parent >= 0) skel->child_indices[cursor[parent]++] = i;
+    }
+    free(cursor);
     return 1;
 }
 
-static void parse_bones_recursive(const char **p, SkeletonDef *skel, int parent_idx) {
-    while (**p) {
-        skip_whitespace(p);
-
-        // Check for closing tag first
-        if (strncmp(*p, "</bone>", 7) == 0) {
-            *p += 7;
-            return;  // End of this bone's children
-        }
-
-        // Look for <bone> tag
-        const char *bone_start = strstr(*p, "<bone");
-        if (!bone_start) break;
-
-        // Make sure we didn't skip past a closing tag
-        const char *close_check = strstr(*p, "</bone>");
-        if (close_check && close_check < bone_start) {
-            return;  // Hit a closing tag before next bone
+// Breadth-first walk from the roots; returns the number of bones reached
+static int build_topo_order(SkeletonDef *skel) {
+    int n = skel->bone_count;
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        if (skel->bones[i].parent_index < 0) skel->topo_order[count++] = i;
+    }
+    skel->root_count = count;
+    for (int head = 0; head < count; head++) {
+        int bone = skel->topo_order[head];
+        for (int c = skel->child_offsets[bone]; c < skel->child_offsets[bone + 1]; c++) {
+            skel->topo_order[count++] = skel->child_indices[c];
         }
+    }
+    return count;
+}
 
-        *p = bone_start + 5;
+int skeleton_build_index(SkeletonDef *skel) {
+    int n = skel->bone_count;
 
-        char bone_name[MAX_BONE_NAME];
-        if (!parse_attribute(p, "name", bone_name, MAX_BONE_NAME)) {
-            continue;
+    for (int i = 0; i < n; i++) {
+        int parent = skel->bones[i].parent_index;
+        if (parent != -1 && (parent < 0 || parent >= n || parent == i)) {
+            fprintf(stderr, "Warning: bone '%s' has invalid parent %d, treating as root\n",
+                    skel->bones[i].name, parent);
+            skel->bones[i].parent_index = -1;
         }
+    }
 
-        // Add bone to skeleton
-        if (skel->bone_count < MAX_BONES) {
-            size_t name_len = strlen(bone_name);
-            if (name_len >= sizeof(skel->bones[skel->bone_count].name)) {
-                name_len = sizeof(skel->bones[skel->bone_count].name) - 1;
-            }
-            memcpy(skel->bones[skel->bone_count].name, bone_name, name_len);
-            skel->bones[skel->bone_count].name[name_len] = '\0';
-            skel->bones[skel->bone_count].parent_index = parent_idx;
-            int current_idx = skel->bone_count;
-            skel->bone_count++;
-
-            // Find end of opening tag
-            const char *tag_end = strchr(*p, '>');
-            if (!tag_end) break;
-            *p = tag_end + 1;
-
-            // Check if self-closing
-            if (*(tag_end - 1) == '/') {
-                continue;  // self-closing, no children
+    free(skel->topo_order);
+    skel->topo_order = malloc((size_t)(n ? n : 1) * sizeof(int));
+    if (!skel->topo_order) return 0;
+
+    // Bones unreachable from a root sit on a parent cycle: cut the cycle and retry
+    for (;;) {
+        if (!build_children(skel)) return 0;
+        int reached = build_topo_order(skel);
+        if (reached == n) break;
+
+        char *visited = calloc((size_t)n, 1);
+        if (!visited) return 0;
+        for (int i = 0; i < reached; i++) visited[skel->topo_order[i]] = 1;
+        for (int i = 0; i < n; i++) {
+            if (!visited[i]) {
+                fprintf(stderr, "Warning: bone '%s' is part of a parent cycle, treating as root\n",
+                        skel->bones[i].name);
+                skel->bones[i].parent_index = -1;
+                break;
             }
-
-            // Parse children recursively
-            parse_bones_recursive(p, skel, current_idx);
         }
+        free(visited);
     }
-}
 
-SkeletonDef* load_skeleton_xml(const char *filename, const char *skeleton_id) {
-    FILE *f = fopen(filename, "r");
-    if (!f) {
-        fprintf(stderr, "Failed to open skeleton file: %s\n", filename);
-        return NULL;
+    str_map_free(&skel->name_index);
+    for (int i = 0; i < n; i++) {
+        if (str_map_insert(&skel->name_index, skel->bones[i].name, i) < 0) return 0;
     }
+    return 1;
+}
 
-    // Read entire file
-    fseek(f, 0, SEEK_END);
-    long size = ftell(f);
-    fseek(f, 0, SEEK_SET);
-
-    char *content = malloc((size_t)size + 1);
-    if (fread(content, 1, (size_t)size, f) != (size_t)size) { fclose(f); return NULL; }
-    content[size] = '\0';
-    fclose(f);
-
-    // Find the standard_skeleton with matching id
-    char id_search[256];
-    snprintf(id_search, sizeof(id_search), "id=\"%s\"", skeleton_id);
-    const char *skel_start = strstr(content, id_search);
+int skeleton_find_bone(const SkeletonDef *skel, const char *name) {
+    int index;
+    if (!skel || !name || !str_map_get(&skel->name_index, name, &index)) return -1;
+    return index;
+}
 
-    if (!skel_start) {
-        fprintf(stderr, "Skeleton '%s' not found in XML\n", skeleton_id);
-        free(content);
+const int* skeleton_children(const SkeletonDef *skel, int bone, int *count) {
+    if (!skel->child_offsets || bone < 0 || bone >= skel->bone_count) {
+        *count = 0;
         return NULL;
     }
+    *count = skel->child_offsets[bone + 1] - skel->child_offsets[bone];
+    return &skel->child_indices[skel->child_offsets[bone]];
+}
 
-    // Find the opening <standard_skeleton> tag
-    while (skel_start > content && strncmp(skel_start, "<standard_skeleton", 18) != 0) {
-        skel_start--;
+SkeletonDef* parse_skeleton_json(const char *text, size_t size, const char *source_file) {
+    cJSON *skel_obj = cJSON_ParseWithLength(text, size);
+    if (!skel_obj || !cJSON_IsObject(skel_obj)) {
+        cJSON_Delete(skel_obj);
+        fprintf(stderr, "Invalid 'skeleton' object in JSON\n");
+        return NULL;
     }
 
-    SkeletonDef *skel = calloc(1, sizeof(SkeletonDef));
-    my_strncpy(skel->skeleton_file, filename, sizeof(skel->skeleton_file)-1);
-    skel->skeleton_file[sizeof(skel->skeleton_file)-1] = '\0';
-    my_strncpy(skel->skeleton_id, skeleton_id, sizeof(skel->skeleton_id)-1);
-    skel->skeleton_id[sizeof(skel->skeleton_id)-1] = '\0';
-    skel->title[0] = '\0'; // Initialisation du champ title
-    const char *p = skel_start;
-
-    // Parse bone hierarchy
-    parse_bones_recursive(&p, skel, -1);
-
-    free(content);
-    return skel;
-}
-
-char* get_first_skeleton_id(const char *filename) {
-    FILE *f = fopen(filename, "r");
-    if (!f) {
+    SkeletonDef *skel = skeleton_create(source_file);
+    if (!skel) {
+        cJSON_Delete(skel_obj);
         return NULL;
     }
 
-    // Read entire file
-    fseek(f, 0, SEEK_END);
-    long size = ftell(f);
-    fseek(f, 0, SEEK_SET);
+    cJSON *title = cJSON_GetObjectItem(skel_obj, "title");
+    if (title && cJSON_IsString(title)) {
+        my_strncpy(skel->title, title->valuestring, sizeof(skel->title)-1);
+        skel->title[sizeof(skel->title)-1] = '\0';
+    } else {
+        skel->title[0] = '\0';
+    }
 
-    char *content = malloc((size_t)size + 1);
-    if (fread(content, 1, (size_t)size, f) != (size_t)size) { fclose(f); return NULL; }
-    content[size] = '\0';
-    fclose(f);
+    cJSON *bones = cJSON_GetObjectItem(skel_obj, "bones");
+    if (bones && cJSON_IsArray(bones)) {
+        cJSON *bone = NULL;
+        cJSON_ArrayForEach(bone, bones) {
+            cJSON *name = cJSON_GetObjectItem(bone, "name");
+            cJSON *parent = cJSON_GetObjectItem(bone, "parent_index");
+            const char *bone_name = name && cJSON_IsString(name) ? name->valuestring : "";
+            int parent_index = parent && cJSON_IsNumber(parent) ? parent->valueint : -1;
+            if (skeleton_add_bone(skel, bone_name, parent_index) < 0) {
+                cJSON_Delete(skel_obj);
+                free_skeleton(skel);
+                return NULL;
+            }
+        }
+    }
 
-    // Find first <standard_skeleton tag
-    const char *skel_start = strstr(content, "<standard_skeleton");
-    if (!skel_start) {
-        free(content);
+    cJSON_Delete(skel_obj);
+    if (!skeleton_build_index(skel)) {
+        free_skeleton(skel);
         return NULL;
     }
+    return skel;
+}
 
-    // Find id attribute
-    const char *id_start = strstr(skel_start, "id=\"");
-    if (!id_start) {
-        free(content);
+SkeletonDef* load_skeleton_json(const char *filename) {
+    size_t size = 0;
+    char *content = read_file(filename, &size);
+    if (!content) {
+        fprintf(stderr, "Failed to open skeleton JSON file: %s\n", filename);
         return NULL;
     }
-    id_start += 4; // skip 'id="'
 
-    // Find end quote
-    const char *id_end = strchr(id_start, '"');
-    if (!id_end) {
+    // Only the "skeleton" member is parsed; the rest of the config is skipped
+    JsonSpan span;
+    if (!json_find_member(content, size, "skeleton", &span)) {
         free(content);
+        fprintf(stderr, "No 'skeleton' object in JSON\n");
         return NULL;
     }
 
-    // Copy ID to new string
-    size_t id_len = (size_t)(id_end - id_start);
-    char *skeleton_id = malloc(id_len + 1);
-    memcpy(skeleton_id, id_start, id_len);
-    skeleton_id[id_len] = '\0';
-
+    SkeletonDef *skel = parse_skeleton_json(span.data, span.size, filename);
     free(content);
-    return skeleton_id;
+    return skel;
 }
 
 void free_skeleton(SkeletonDef *skel) {
+    if (!skel) return;
+    free(skel->bones);
+    free(skel->child_offsets);
+    free(skel->child_indices);
+    free(skel->topo_order);
+    str_map_free(&skel->name_index);
     free(skel);
 }
@@ -1,9 +1,10 @@
 #ifndef SKELETON_H
 #define SKELETON_H
 
+#include <stddef.h>
 #include <stdint.h>
+#include "str_map.h"
 
-#define MAX_BONES 64
 #define MAX_BONE_NAME 64
 
 typedef struct {
@@ -13,16 +14,70 @@ typedef struct {
 
 typedef struct {
     int bone_count;
-    BoneInfo bones[MAX_BONES];
+    int bone_capacity;
+    BoneInfo *bones;
+
+    // Hierarchy index, filled by skeleton_build_index()
+    int *child_offsets;   // bone_count + 1 entries
+    int *child_indices;   // children of bone i: child_indices[child_offsets[i] .. child_offsets[i+1])
+    int *topo_order;      // every bone appears after its parent; roots come first
+    int root_count;       // number of roots at the start of topo_order
+    StrMap name_index;    // bone name -> first bone index with that name
+
     char skeleton_file[256];
     char skeleton_id[64];
     char title[128];
 } SkeletonDef;
 
+// Allocate an empty skeleton definition
+SkeletonDef* skeleton_create(const char *source_file);
+// Append a bone, returns its index or -1 on allocation failure
+int skeleton_add_bone(SkeletonDef *skel, const char *name, int parent_index);
+// (Re)build children lists, topological order and name lookup.
+// Parents that are out of range or part of a cycle are reset to -1.
+int skeleton_build_index(SkeletonDef *skel);
+// Bone index by name, -1 if absent
+int skeleton_find_bone(const SkeletonDef *skel, const char *name);
+// Children of a bone from the hierarchy index
+const int* skeleton_children(const SkeletonDef *skel, int bone, int *count);
+
+// Build a skeleton from the JSON text of a "skeleton" object (title, bones)
+SkeletonDef* parse_skeleton_json(const char *text, size_t size, const char *source_file);
 // Parse skeleton JSON and return bone hierarchy
 SkeletonDef* load_skeleton_json(const char *filename);
+void free_skeleton(SkeletonDef *skel);
+
+// All <standard_skeleton> definitions of a skeletons XML file, read by a
+// single forward pass. Bones of every skeleton share one array; parent
+// indices are relative to the skeleton's first bone.
+typedef struct {
+    char id[64];
+    char title[128];
+    int first_bone;
+    int bone_count;
+} XmlSkeletonEntry;
+
+typedef struct {
+    char source_file[256];
+    BoneInfo *bones;
+    int bone_count;
+    int bone_capacity;
+    XmlSkeletonEntry *skeletons;  // in file order
+    int skeleton_count;
+    int skeleton_capacity;
+    StrMap id_index;              // id -> skeletons[] index
+} SkeletonXmlIndex;
+
+// Tokenize a skeletons XML file once and index every standard_skeleton by id
+SkeletonXmlIndex* skeleton_xml_index_load(const char *filename);
+SkeletonXmlIndex* skeleton_xml_index_parse(const char *text, size_t size, const char *source_file);
+// Build the skeleton for an id from the index, NULL if the id is unknown
+SkeletonDef* skeleton_xml_index_get(const SkeletonXmlIndex *index, const char *skeleton_id);
+void skeleton_xml_index_free(SkeletonXmlIndex *index);
+
+// Parse skeleton hierarchy for the given standard_skeleton id from XML file
+SkeletonDef* load_skeleton_xml(const char *filename, const char *skeleton_id);
 // Extract the first skeleton ID from XML file
 char* get_first_skeleton_id(const char *filename);
-void free_skeleton(SkeletonDef *skel);
 
 #endif
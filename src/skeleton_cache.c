@@ -0,0 +1,83 @@
+#include "skeleton_cache.h"
+#include "filesystem.h"
+#include "hash.h"
+#include "json_span.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void skeleton_cache_init(SkeletonCache *cache) {
+    memset(cache, 0, sizeof(*cache));
+}
+
+void skeleton_cache_free(SkeletonCache *cache) {
+    for (uint32_t i = 0; i < cache->count; i++) {
+        free(cache->entries[i].text);
+        free_skeleton(cache->entries[i].skel);
+    }
+    free(cache->entries);
+    memset(cache, 0, sizeof(*cache));
+}
+
+const SkeletonDef* skeleton_cache_intern(SkeletonCache *cache, const char *text, size_t size,
+                                         const char *source_file) {
+    uint64_t hash = hash_fnv1a64(text, size);
+
+    // A batch only holds a handful of distinct rigs; compare hashes first
+    // and confirm with the bytes so a collision can never share a skeleton
+    for (uint32_t i = 0; i < cache->count; i++) {
+        const SkeletonCacheEntry *entry = &cache->entries[i];
+        if (entry->hash == hash && entry->size == size && memcmp(entry->text, text, size) == 0) {
+            cache->hits++;
+            return entry->skel;
+        }
+    }
+
+    cache->misses++;
+    SkeletonDef *skel = parse_skeleton_json(text, size, source_file);
+    if (!skel) return NULL;
+
+    if (cache->count >= cache->capacity) {
+        uint32_t new_capacity = cache->capacity ? cache->capacity * 2 : 8;
+        SkeletonCacheEntry *entries = realloc(cache->entries, new_capacity * sizeof(SkeletonCacheEntry));
+        if (!entries) {
+            free_skeleton(skel);
+            return NULL;
+        }
+        cache->entries = entries;
+        cache->capacity = new_capacity;
+    }
+
+    char *copy = malloc(size ? size : 1);
+    if (!copy) {
+        free_skeleton(skel);
+        return NULL;
+    }
+    memcpy(copy, text, size);
+
+    SkeletonCacheEntry *entry = &cache->entries[cache->count++];
+    entry->hash = hash;
+    entry->text = copy;
+    entry->size = size;
+    entry->skel = skel;
+    return skel;
+}
+
+const SkeletonDef* skeleton_cache_load(SkeletonCache *cache, const char *json_file) {
+    size_t size = 0;
+    char *content = read_file(json_file, &size);
+    if (!content) {
+        fprintf(stderr, "Failed to open skeleton JSON file: %s\n", json_file);
+        return NULL;
+    }
+
+    JsonSpan span;
+    const SkeletonDef *skel = NULL;
+    if (json_find_member(content, size, "skeleton", &span)) {
+        skel = skeleton_cache_intern(cache, span.data, span.size, json_file);
+    } else {
+        fprintf(stderr, "No 'skeleton' object in JSON\n");
+    }
+    free(content);
+    return skel;
+}
@@ -0,0 +1,40 @@
+#ifndef SKELETON_CACHE_H
+#define SKELETON_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "skeleton.h"
+
+// Skeleton definitions shared across the models of one batch.
+// Entries are interned by a content hash of the "skeleton" JSON object, so
+// actors using the same rig (standard biped, horse, ...) parse it and build
+// its hierarchy index once. Cached skeletons are read-only and owned by the
+// cache until skeleton_cache_free().
+
+typedef struct {
+    uint64_t hash;
+    char *text;          // skeleton JSON the entry was built from
+    size_t size;
+    SkeletonDef *skel;
+} SkeletonCacheEntry;
+
+typedef struct {
+    SkeletonCacheEntry *entries;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t hits;
+    uint32_t misses;
+} SkeletonCache;
+
+void skeleton_cache_init(SkeletonCache *cache);
+void skeleton_cache_free(SkeletonCache *cache);
+
+// Return the shared skeleton for the given "skeleton" JSON text, parsing it
+// only if no identical definition was interned before. NULL on parse error.
+const SkeletonDef* skeleton_cache_intern(SkeletonCache *cache, const char *text, size_t size,
+                                         const char *source_file);
+
+// Read a model JSON file and intern its "skeleton" member
+const SkeletonDef* skeleton_cache_load(SkeletonCache *cache, const char *json_file);
+
+#endif // SKELETON_CACHE_H
@@ -0,0 +1,334 @@
+#include "portable_string.h"
+#include "skeleton.h"
+#include "filesystem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Forward-only tokenizer for skeletons XML files.
+// Every byte is visited once: tags are read left to right, nesting is
+// tracked on an explicit stack, and bones are appended as they open, so
+// files holding many skeletons are indexed in linear time.
+
+typedef enum {
+    XML_ELEMENT_OTHER,
+    XML_ELEMENT_SKELETON,   // <standard_skeleton>
+    XML_ELEMENT_BONE
+} XmlElementKind;
+
+typedef struct {
+    XmlElementKind kind;
+    int bone;               // innermost enclosing bone (relative index), -1 if none
+} XmlOpenElement;
+
+typedef struct {
+    const char *p;
+    const char *end;
+    XmlOpenElement *stack;
+    int depth;
+    int capacity;
+    int current_skeleton;   // index in skeletons[], -1 outside a standard_skeleton
+} XmlScanner;
+
+static int is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static int is_name_char(char c) {
+    return c && !is_space(c) && c != '>' && c != '/' && c != '=' && c != '<';
+}
+
+// Advance past the first occurrence of terminator; returns 0 if absent
+static int skip_past(XmlScanner *s, const char *terminator) {
+    size_t len = strlen(terminator);
+    while (s->p + len <= s->end) {
+        if (*s->p == terminator[0] && memcmp(s->p, terminator, len) == 0) {
+            s->p += len;
+            return 1;
+        }
+        s->p++;
+    }
+    s->p = s->end;
+    return 0;
+}
+
+// Copy an attribute value, decoding the predefined entities
+static void copy_attribute(char *dest, size_t dest_size, const char *src, size_t len) {
+    static const struct { const char *entity; char c; } entities[] = {
+        {"&amp;", '&'}, {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&apos;", '\''}
+    };
+    size_t out = 0;
+    for (size_t i = 0; i < len && out + 1 < dest_size; i++) {
+        char c = src[i];
+        if (c == '&') {
+            for (size_t e = 0; e < sizeof(entities) / sizeof(entities[0]); e++) {
+                size_t elen = strlen(entities[e].entity);
+                if (i + elen <= len && memcmp(src + i, entities[e].entity, elen) == 0) {
+                    c = entities[e].c;
+                    i += elen - 1;
+                    break;
+                }
+            }
+        }
+        dest[out++] = c;
+    }
+    dest[out] = '\0';
+}
+
+static int push_element(XmlScanner *s, XmlElementKind kind, int bone) {
+    if (s->depth >= s->capacity) {
+        int new_capacity = s->capacity ? s->capacity * 2 : 32;
+        XmlOpenElement *stack = realloc(s->stack, (size_t)new_capacity * sizeof(XmlOpenElement));
+        if (!stack) return 0;
+        s->stack = stack;
+        s->capacity = new_capacity;
+    }
+    s->stack[s->depth].kind = kind;
+    s->stack[s->depth].bone = bone;
+    s->depth++;
+    return 1;
+}
+
+static int enclosing_bone(const XmlScanner *s) {
+    return s->depth > 0 ? s->stack[s->depth - 1].bone : -1;
+}
+
+static int add_skeleton(SkeletonXmlIndex *index, const char *id, const char *title) {
+    if (index->skeleton_count >= index->skeleton_capacity) {
+        int new_capacity = index->skeleton_capacity ? index->skeleton_capacity * 2 : 8;
+        XmlSkeletonEntry *skeletons = realloc(index->skeletons, (size_t)new_capacity * sizeof(XmlSkeletonEntry));
+        if (!skeletons) return -1;
+        index->skeletons = skeletons;
+        index->skeleton_capacity = new_capacity;
+    }
+
+    XmlSkeletonEntry *entry = &index->skeletons[index->skeleton_count];
+    memset(entry, 0, sizeof(*entry));
+    snprintf(entry->id, sizeof(entry->id), "%s", id);
+    snprintf(entry->title, sizeof(entry->title), "%s", title);
+    entry->first_bone = index->bone_count;
+
+    // First definition wins for duplicate ids, like a strstr lookup did
+    if (entry->id[0] && str_map_insert(&index->id_index, entry->id, index->skeleton_count) < 0) return -1;
+    return index->skeleton_count++;
+}
+
+static int add_bone(SkeletonXmlIndex *index, XmlSkeletonEntry *entry, const char *name, int parent) {
+    if (index->bone_count >= index->bone_capacity) {
+        int new_capacity = index->bone_capacity ? index->bone_capacity * 2 : 64;
+        BoneInfo *bones = realloc(index->bones, (size_t)new_capacity * sizeof(BoneInfo));
+        if (!bones) return -1;
+        index->bones = bones;
+        index->bone_capacity = new_capacity;
+    }
+
+    BoneInfo *bone = &index->bones[index->bone_count++];
+    my_strncpy(bone->name, name, sizeof(bone->name)-1);
+    bone->name[sizeof(bone->name)-1] = '\0';
+    bone->parent_index = parent;
+    return entry->bone_count++;
+}
+
+// Read one start tag after '<' and record skeletons and bones it opens
+static int scan_start_tag(SkeletonXmlIndex *index, XmlScanner *s) {
+    const char *name_start = s->p;
+    while (s->p < s->end && is_name_char(*s->p)) s->p++;
+    size_t name_len = (size_t)(s->p - name_start);
+
+    char attr_id[64] = "";
+    char attr_title[128] = "";
+    char attr_name[MAX_BONE_NAME] = "";
+    int self_closing = 0;
+
+    // Attributes
+    while (s->p < s->end) {
+        while (s->p < s->end && is_space(*s->p)) s->p++;
+        if (s->p >= s->end) return 0;
+        if (*s->p == '>') {
+            s->p++;
+            break;
+        }
+        if (*s->p == '/') {
+            self_closing = 1;
+            s->p++;
+            continue;
+        }
+
+        const char *key = s->p;
+        while (s->p < s->end && is_name_char(*s->p)) s->p++;
+        size_t key_len = (size_t)(s->p - key);
+        if (key_len == 0) {
+            s->p++;
+            continue;
+        }
+        while (s->p < s->end && is_space(*s->p)) s->p++;
+        if (s->p >= s->end || *s->p != '=') continue;
+        s->p++;
+        while (s->p < s->end && is_space(*s->p)) s->p++;
+        if (s->p >= s->end || (*s->p != '"' && *s->p != '\'')) continue;
+
+        char quote = *s->p++;
+        const char *value = s->p;
+        while (s->p < s->end && *s->p != quote) s->p++;
+        if (s->p >= s->end) return 0;
+        size_t value_len = (size_t)(s->p - value);
+        s->p++;
+
+        if (key_len == 2 && memcmp(key, "id", 2) == 0) {
+            copy_attribute(attr_id, sizeof(attr_id), value, value_len);
+        } else if (key_len == 5 && memcmp(key, "title", 5) == 0) {
+            copy_attribute(attr_title, sizeof(attr_title), value, value_len);
+        } else if (key_len == 4 && memcmp(key, "name", 4) == 0) {
+            copy_attribute(attr_name, sizeof(attr_name), value, value_len);
+        }
+    }
+
+    int bone = enclosing_bone(s);
+    if (name_len == 17 && memcmp(name_start, "standard_skeleton", 17) == 0) {
+        int skel_index = add_skeleton(index, attr_id, attr_title);
+        if (skel_index < 0) return 0;
+        if (self_closing) return 1;
+        s->current_skeleton = skel_index;
+        return push_element(s, XML_ELEMENT_SKELETON, -1);
+    }
+
+    if (name_len == 4 && memcmp(name_start, "bone", 4) == 0 && s->current_skeleton >= 0) {
+        XmlSkeletonEntry *entry = &index->skeletons[s->current_skeleton];
+        int bone_index = add_bone(index, entry, attr_name, bone);
+        if (bone_index < 0) return 0;
+        if (self_closing) return 1;
+        return push_element(s, XML_ELEMENT_BONE, bone_index);
+    }
+
+    if (self_closing) return 1;
+    return push_element(s, XML_ELEMENT_OTHER, bone);
+}
+
+static void scan_end_tag(XmlScanner *s) {
+    skip_past(s, ">");
+    if (s->depth == 0) return;
+    s->depth--;
+    if (s->stack[s->depth].kind == XML_ELEMENT_SKELETON) {
+        s->current_skeleton = -1;
+    }
+}
+
+SkeletonXmlIndex* skeleton_xml_index_parse(const char *text, size_t size, const char *source_file) {
+    SkeletonXmlIndex *index = calloc(1, sizeof(SkeletonXmlIndex));
+    if (!index) return NULL;
+    str_map_init(&index->id_index, 0);
+    if (source_file) {
+        my_strncpy(index->source_file, source_file, sizeof(index->source_file)-1);
+    }
+
+    XmlScanner s;
+    memset(&s, 0, sizeof(s));
+    s.p = text;
+    s.end = text + size;
+    s.current_skeleton = -1;
+
+    int ok = 1;
+    while (ok && s.p < s.end) {
+        const char *lt = memchr(s.p, '<', (size_t)(s.end - s.p));
+        if (!lt) break;
+        s.p = lt + 1;
+        if (s.p >= s.end) break;
+
+        if (*s.p == '?') {
+            skip_past(&s, "?>");
+        } else if (*s.p == '!') {
+            if (s.end - s.p >= 3 && memcmp(s.p, "!--", 3) == 0) {
+                skip_past(&s, "-->");
+            } else if (s.end - s.p >= 8 && memcmp(s.p, "![CDATA[", 8) == 0) {
+                skip_past(&s, "]]>");
+            } else {
+                skip_past(&s, ">");
+            }
+        } else if (*s.p == '/') {
+            scan_end_tag(&s);
+        } else {
+            ok = scan_start_tag(index, &s);
+        }
+    }
+    free(s.stack);
+
+    if (!ok) {
+        fprintf(stderr, "Failed to index skeleton XML: %s\n", source_file ? source_file : "(memory)");
+        skeleton_xml_index_free(index);
+        return NULL;
+    }
+    return index;
+}
+
+SkeletonXmlIndex* skeleton_xml_index_load(const char *filename) {
+    size_t size = 0;
+    char *content = read_file(filename, &size);
+    if (!content) {
+        fprintf(stderr, "Failed to open skeleton file: %s\n", filename);
+        return NULL;
+    }
+    SkeletonXmlIndex *index = skeleton_xml_index_parse(content, size, filename);
+    free(content);
+    return index;
+}
+
+SkeletonDef* skeleton_xml_index_get(const SkeletonXmlIndex *index, const char *skeleton_id) {
+    int entry_index;
+    if (!index || !skeleton_id || !str_map_get(&index->id_index, skeleton_id, &entry_index)) {
+        return NULL;
+    }
+    const XmlSkeletonEntry *entry = &index->skeletons[entry_index];
+
+    SkeletonDef *skel = skeleton_create(index->source_file);
+    if (!skel) return NULL;
+    snprintf(skel->skeleton_id, sizeof(skel->skeleton_id), "%s", entry->id);
+    snprintf(skel->title, sizeof(skel->title), "%s", entry->title);
+
+    for (int i = 0; i < entry->bone_count; i++) {
+        const BoneInfo *bone = &index->bones[entry->first_bone + i];
+        if (skeleton_add_bone(skel, bone->name, bone->parent_index) < 0) {
+            free_skeleton(skel);
+            return NULL;
+        }
+    }
+    if (!skeleton_build_index(skel)) {
+        free_skeleton(skel);
+        return NULL;
+    }
+    return skel;
+}
+
+void skeleton_xml_index_free(SkeletonXmlIndex *index) {
+    if (!index) return;
+    free(index->bones);
+    free(index->skeletons);
+    str_map_free(&index->id_index);
+    free(index);
+}
+
+SkeletonDef* load_skeleton_xml(const char *filename, const char *skeleton_id) {
+    SkeletonXmlIndex *index = skeleton_xml_index_load(filename);
+    if (!index) return NULL;
+
+    SkeletonDef *skel = skeleton_xml_index_get(index, skeleton_id);
+    if (!skel) {
+        fprintf(stderr, "Skeleton '%s' not found in XML\n", skeleton_id);
+    }
+    skeleton_xml_index_free(index);
+    return skel;
+}
+
+char* get_first_skeleton_id(const char *filename) {
+    SkeletonXmlIndex *index = skeleton_xml_index_load(filename);
+    if (!index) return NULL;
+
+    char *skeleton_id = NULL;
+    for (int i = 0; i < index->skeleton_count; i++) {
+        if (index->skeletons[i].id[0]) {
+            skeleton_id = my_strdup(index->skeletons[i].id);
+            break;
+        }
+    }
+    skeleton_xml_index_free(index);
+    return skeleton_id;
+}
@@ -0,0 +1,97 @@
+#include "skin_error.h"
+#include "skinning.h"
+#include "transform.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+int skin_positions(const PMDModel *model, const BoneState *states, uint32_t state_count, float *out) {
+    float *matrices = malloc(((size_t)model->numBones + 1) * 32 * sizeof(float));
+    if (!matrices) return 0;
+    float *world = matrices;
+    float *inverse_rest = matrices + (size_t)model->numBones * 16;
+    for (uint32_t b = 0; b < model->numBones; b++) {
+        float rest[16];
+        make_matrix(&model->restStates[b], rest);
+        invert_affine(rest, &inverse_rest[b * 16]);
+        make_matrix(b < state_count ? &states[b] : &model->restStates[b], &world[b * 16]);
+    }
+
+    SkinOutput skinned;
+    int ok = skin_model(model, world, inverse_rest, model->numBones, 0, 0, &skinned);
+    free(matrices);
+    if (!ok) return 0;
+    for (uint32_t i = 0; i < model->numVertices; i++) {
+        out[i * 3 + 0] = skinned.px[i];
+        out[i * 3 + 1] = skinned.py[i];
+        out[i * 3 + 2] = skinned.pz[i];
+    }
+    skin_output_free(&skinned);
+    return 1;
+}
+
+// World-space states of anim at time t, between the two surrounding frames
+static void sample_states(const PSAAnimation *anim, float step, float t, BoneState *out) {
+    float x = step > 0.0f ? t / step : 0.0f;
+    uint32_t last = anim->numFrames - 1;
+    uint32_t k = x > 0.0f ? (uint32_t)x : 0;
+    if (k >= last) {
+        memcpy(out, &anim->boneStates[(size_t)last * anim->numBones], anim->numBones * sizeof(BoneState));
+        return;
+    }
+    float u = x - (float)k;
+    const BoneState *a = &anim->boneStates[(size_t)k * anim->numBones];
+    const BoneState *b = a + anim->numBones;
+    // Reference times usually land on candidate frames: copy them exactly
+    if (u < 1e-4f || u > 1.0f - 1e-4f) {
+        memcpy(out, u < 0.5f ? a : b, anim->numBones * sizeof(BoneState));
+        return;
+    }
+    for (uint32_t bone = 0; bone < anim->numBones; bone++) {
+        out[bone].translation.x = a[bone].translation.x + (b[bone].translation.x - a[bone].translation.x) * u;
+        out[bone].translation.y = a[bone].translation.y + (b[bone].translation.y - a[bone].translation.y) * u;
+        out[bone].translation.z = a[bone].translation.z + (b[bone].translation.z - a[bone].translation.z) * u;
+        out[bone].rotation = quat_slerp(a[bone].rotation, b[bone].rotation, u);
+    }
+}
+
+int measure_skin_error(const PMDModel *reference_model, const PSAAnimation *reference, float reference_frame_time,
+                       const PMDModel *candidate_model, const PSAAnimation *candidate, float candidate_frame_time,
+                       SkinError *out) {
+    memset(out, 0, sizeof(*out));
+    if (!reference_model || !candidate_model || !reference || !candidate ||
+        reference_model->numVertices != candidate_model->numVertices ||
+        reference->numFrames == 0 || candidate->numFrames == 0) {
+        return 0;
+    }
+
+    uint32_t n = reference_model->numVertices;
+    float *expected = malloc(((size_t)n + 1) * 3 * sizeof(float));
+    float *actual = malloc(((size_t)n + 1) * 3 * sizeof(float));
+    BoneState *states = malloc(((size_t)candidate->numBones + 1) * sizeof(BoneState));
+    int ok = expected && actual && states;
+
+    double sum = 0.0;
+    for (uint32_t f = 0; ok && f < reference->numFrames; f++) {
+        sample_states(candidate, candidate_frame_time, (float)f * reference_frame_time, states);
+        ok = skin_positions(reference_model, &reference->boneStates[(size_t)f * reference->numBones],
+                            reference->numBones, expected) &&
+             skin_positions(candidate_model, states, candidate->numBones, actual);
+        for (uint32_t i = 0; ok && i < n; i++) {
+            double dx = (double)actual[i * 3 + 0] - expected[i * 3 + 0];
+            double dy = (double)actual[i * 3 + 1] - expected[i * 3 + 1];
+            double dz = (double)actual[i * 3 + 2] - expected[i * 3 + 2];
+            double d2 = dx * dx + dy * dy + dz * dz;
+            sum += d2;
+            if (d2 > out->max_error) out->max_error = d2;
+        }
+        out->frames++;
+    }
+    out->max_error = sqrt(out->max_error);
+    out->rms_error = n > 0 && out->frames > 0 ? sqrt(sum / ((double)n * out->frames)) : 0.0;
+
+    free(expected);
+    free(actual);
+    free(states);
+    return ok;
+}
@@ -0,0 +1,30 @@
+#ifndef SKIN_ERROR_H
+#define SKIN_ERROR_H
+
+#include "pmd_psa_types.h"
+
+// Error metric for lossy animation and vertex optimizations: both versions
+// of a model are skinned on the CPU, frame by frame, and the distance between
+// matching vertices is what a viewer would see move.
+
+typedef struct {
+    double max_error;        // largest vertex displacement, model units
+    double rms_error;        // over every vertex of every frame
+    uint32_t frames;         // reference frames compared
+} SkinError;
+
+// Linear blend skinning of the model's bind-pose vertices by world-space bone
+// states (PSA frame layout). Bones at or past state_count keep their rest
+// transform. out holds numVertices * 3 floats. Returns 0 on allocation failure.
+int skin_positions(const PMDModel *model, const BoneState *states, uint32_t state_count, float *out);
+
+// Compare candidate against reference at every reference frame. Each
+// animation's frames are frame_time seconds apart as played (speed included);
+// the candidate is interpolated between its frames at the reference times.
+// Both models must have the same vertices in the same order (an exported and
+// re-imported copy). Returns 0 on mismatch or allocation failure.
+int measure_skin_error(const PMDModel *reference_model, const PSAAnimation *reference, float reference_frame_time,
+                       const PMDModel *candidate_model, const PSAAnimation *candidate, float candidate_frame_time,
+                       SkinError *out);
+
+#endif // SKIN_ERROR_H
@@ -0,0 +1,151 @@
+#include "skin_optimize.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t joint;
+    float weight;
+} Influence;
+
+void skin_optimize_options_init(SkinOptimizeOptions *options) {
+    options->max_influences = 4;
+    options->min_weight = 0.0f;
+    options->weight_bits = 0;
+}
+
+// Gather the vertex's non-zero influences, one entry per joint, strongest first
+static int collect_influences(const uint32_t *joints, const float *weights, Influence *out) {
+    int count = 0;
+    for (int i = 0; i < 4; i++) {
+        if (weights[i] <= 0.0f) continue;
+        int k = 0;
+        while (k < count && out[k].joint != joints[i]) k++;
+        if (k == count) {
+            out[count].joint = joints[i];
+            out[count].weight = 0.0f;
+            count++;
+        }
+        out[k].weight += weights[i];
+    }
+    // Insertion sort, stable so equal weights keep their slot order
+    for (int i = 1; i < count; i++) {
+        Influence cur = out[i];
+        int k = i;
+        while (k > 0 && out[k - 1].weight < cur.weight) {
+            out[k] = out[k - 1];
+            k--;
+        }
+        out[k] = cur;
+    }
+    return count;
+}
+
+// Largest-remainder rounding: integer weights summing to exactly scale
+static int quantize_influences(Influence *inf, int count, uint32_t scale) {
+    uint32_t q[4];
+    float frac[4];
+    uint32_t total = 0;
+    for (int i = 0; i < count; i++) {
+        float v = inf[i].weight * (float)scale;
+        q[i] = (uint32_t)floorf(v);
+        frac[i] = v - (float)q[i];
+        total += q[i];
+    }
+    while (total < scale) {
+        int best = 0;
+        for (int i = 1; i < count; i++) {
+            if (frac[i] > frac[best]) best = i;
+        }
+        q[best]++;
+        frac[best] = -1.0f;
+        total++;
+    }
+
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        if (q[i] == 0) continue;
+        inf[kept].joint = inf[i].joint;
+        inf[kept].weight = (float)q[i] / (float)scale;
+        kept++;
+    }
+    return kept;
+}
+
+void optimize_skin_weights(uint32_t *joints, float *weights, uint32_t vertex_count,
+                           const SkinOptimizeOptions *options, uint8_t *single_influence,
+                           SkinOptimizeStats *stats) {
+    SkinOptimizeOptions defaults;
+    skin_optimize_options_init(&defaults);
+    if (!options) options = &defaults;
+    int max_influences = options->max_influences;
+    if (max_influences < 1 || max_influences > 4) max_influences = 4;
+    uint32_t scale = options->weight_bits == 8 ? 0xFFu : options->weight_bits == 16 ? 0xFFFFu : 0;
+
+    if (stats) memset(stats, 0, sizeof(*stats));
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        uint32_t *vj = &joints[v * 4];
+        float *vw = &weights[v * 4];
+        Influence inf[4];
+        int count = collect_influences(vj, vw, inf);
+        int original = count;
+
+        if (count > max_influences) count = max_influences;
+        // The strongest influence always survives the threshold
+        while (count > 1 && inf[count - 1].weight < options->min_weight) count--;
+
+        float total = 0.0f;
+        for (int i = 0; i < count; i++) {
+            total += inf[i].weight;
+        }
+        if (count == 0 || total <= 0.0f) {
+            // Unweighted vertex: bind it to the first joint, as the exporter does
+            inf[0].joint = vj[0];
+            inf[0].weight = 1.0f;
+            count = 1;
+            total = 1.0f;
+        }
+        for (int i = 0; i < count; i++) {
+            inf[i].weight /= total;
+        }
+
+        if (scale) {
+            count = quantize_influences(inf, count, scale);
+        } else {
+            // Exact float sum: the strongest weight absorbs the rounding
+            float rest = 0.0f;
+            for (int i = 1; i < count; i++) {
+                rest += inf[i].weight;
+            }
+            inf[0].weight = 1.0f - rest;
+        }
+
+        for (int i = 0; i < 4; i++) {
+            vj[i] = i < count ? inf[i].joint : 0;
+            vw[i] = i < count ? inf[i].weight : 0.0f;
+        }
+        if (single_influence) single_influence[v] = count == 1;
+        if (stats) {
+            stats->vertices++;
+            if (count == 1) stats->single_influence++;
+            if (original > count) stats->pruned += (uint32_t)(original - count);
+        }
+    }
+}
+
+void* quantize_weights(const float *weights, size_t count, int weight_bits) {
+    size_t size = weight_bits == 16 ? 2 : 1;
+    float scale = weight_bits == 16 ? 65535.0f : 255.0f;
+    uint8_t *out = malloc(count ? count * size : 1);
+    if (!out) return NULL;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t q = (uint32_t)lroundf(weights[i] * scale);
+        if (size == 1) {
+            out[i] = (uint8_t)q;
+        } else {
+            uint16_t v = (uint16_t)q;
+            memcpy(out + i * 2, &v, 2);
+        }
+    }
+    return out;
+}
@@ -0,0 +1,38 @@
+#ifndef SKIN_OPTIMIZE_H
+#define SKIN_OPTIMIZE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Vertex influence reduction, after SkinReduceInfluences() in the COLLADA
+// converter: merge repeated joints, keep the strongest max_influences,
+// prune weights below min_weight and renormalize so the stored weights sum
+// to exactly one once quantized to weight_bits.
+
+typedef struct {
+    int max_influences;   // 1, 2 or 4
+    float min_weight;     // influences lighter than this are dropped
+    int weight_bits;      // 0 keeps float weights, 8 or 16 for normalized integers
+} SkinOptimizeOptions;
+
+typedef struct {
+    uint32_t vertices;
+    uint32_t single_influence;   // vertices left with one joint
+    uint32_t pruned;             // influences removed by the limit, the threshold or rounding
+} SkinOptimizeStats;
+
+// Four influences, float weights, nothing pruned
+void skin_optimize_options_init(SkinOptimizeOptions *options);
+
+// Rewrite joints and weights (4 per vertex) in place, strongest first, unused
+// slots zeroed. single_influence (may be NULL) receives 1 for every vertex
+// that ends with one joint, 0 otherwise. With weight_bits set, weights come
+// out as exact multiples of 1/(2^bits - 1).
+void optimize_skin_weights(uint32_t *joints, float *weights, uint32_t vertex_count,
+                           const SkinOptimizeOptions *options, uint8_t *single_influence,
+                           SkinOptimizeStats *stats);
+
+// Normalized unsigned integer copy of weights optimized with weight_bits
+void* quantize_weights(const float *weights, size_t count, int weight_bits);
+
+#endif // SKIN_OPTIMIZE_H
@@ -0,0 +1,169 @@
+#include "skinning.h"
+#include "parallel.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Vertices per block: blended matrices for a block stay in L1
+#define SKIN_BLOCK 64
+// Vertices per thread range below which threads are not worth starting
+#define SKIN_GRAIN 8192
+
+void skin_palette_build(const float *matrices, const float *inverse_bind, uint32_t count, float *palette) {
+    for (uint32_t b = 0; b < count; b++) {
+        const float *m = &matrices[b * 16];
+        float product[16];
+        if (inverse_bind) {
+            const float *ib = &inverse_bind[b * 16];
+            for (int c = 0; c < 4; c++) {
+                for (int r = 0; r < 4; r++) {
+                    product[c * 4 + r] = m[0 * 4 + r] * ib[c * 4 + 0] + m[1 * 4 + r] * ib[c * 4 + 1] +
+                                         m[2 * 4 + r] * ib[c * 4 + 2] + m[3 * 4 + r] * ib[c * 4 + 3];
+                }
+            }
+            m = product;
+        }
+        float *p = &palette[b * SKIN_PALETTE_STRIDE];
+        for (int r = 0; r < 3; r++) {
+            p[r * 4 + 0] = m[0 * 4 + r];
+            p[r * 4 + 1] = m[1 * 4 + r];
+            p[r * 4 + 2] = m[2 * 4 + r];
+            p[r * 4 + 3] = m[3 * 4 + r];
+        }
+    }
+}
+
+void skin_vertices_range(const float *palette, uint32_t palette_count, const SkinInput *in,
+                         SkinOutput *out, uint32_t begin, uint32_t end) {
+    // Blended matrices of one block, one SoA row per matrix element
+    float blend[SKIN_PALETTE_STRIDE][SKIN_BLOCK];
+    static const float identity[SKIN_PALETTE_STRIDE] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0};
+
+    for (uint32_t block = begin; block < end; block += SKIN_BLOCK) {
+        uint32_t n = end - block < SKIN_BLOCK ? end - block : SKIN_BLOCK;
+
+        for (uint32_t v = 0; v < n; v++) {
+            const uint8_t *bones = &in->bones[(size_t)(block + v) * 4];
+            const float *weights = &in->weights[(size_t)(block + v) * 4];
+            float m[SKIN_PALETTE_STRIDE] = {0};
+            float total = 0.0f;
+            for (int j = 0; j < 4; j++) {
+                float w = weights[j];
+                if (bones[j] >= palette_count || w <= 0.0f) continue;
+                const float *p = &palette[bones[j] * SKIN_PALETTE_STRIDE];
+                for (int k = 0; k < SKIN_PALETTE_STRIDE; k++) m[k] += w * p[k];
+                total += w;
+            }
+            if (out->weighted) out->weighted[block + v] = total > 0.0f;
+            const float *src = identity;
+            if (total > 0.0f) {
+                float inv = 1.0f / total;
+                for (int k = 0; k < SKIN_PALETTE_STRIDE; k++) m[k] *= inv;
+                src = m;
+            }
+            for (int k = 0; k < SKIN_PALETTE_STRIDE; k++) blend[k][v] = src[k];
+        }
+
+        const float *px = in->px + block, *py = in->py + block, *pz = in->pz + block;
+        float *ox = out->px + block, *oy = out->py + block, *oz = out->pz + block;
+        for (uint32_t v = 0; v < n; v++) {
+            float x = px[v], y = py[v], z = pz[v];
+            ox[v] = blend[0][v] * x + blend[1][v] * y + blend[2][v] * z + blend[3][v];
+            oy[v] = blend[4][v] * x + blend[5][v] * y + blend[6][v] * z + blend[7][v];
+            oz[v] = blend[8][v] * x + blend[9][v] * y + blend[10][v] * z + blend[11][v];
+        }
+        if (in->nx) {
+            const float *nx = in->nx + block, *ny = in->ny + block, *nz = in->nz + block;
+            float *mx = out->nx + block, *my = out->ny + block, *mz = out->nz + block;
+            for (uint32_t v = 0; v < n; v++) {
+                float x = nx[v], y = ny[v], z = nz[v];
+                mx[v] = blend[0][v] * x + blend[1][v] * y + blend[2][v] * z;
+                my[v] = blend[4][v] * x + blend[5][v] * y + blend[6][v] * z;
+                mz[v] = blend[8][v] * x + blend[9][v] * y + blend[10][v] * z;
+            }
+        }
+    }
+}
+
+typedef struct {
+    const float *palette;
+    uint32_t palette_count;
+    const SkinInput *in;
+    SkinOutput *out;
+} SkinJob;
+
+static void skin_job(void *context, uint32_t begin, uint32_t end) {
+    SkinJob *job = context;
+    skin_vertices_range(job->palette, job->palette_count, job->in, job->out, begin, end);
+}
+
+void skin_vertices(const float *palette, uint32_t palette_count, const SkinInput *in,
+                   SkinOutput *out, int threads) {
+    SkinJob job = {palette, palette_count, in, out};
+    parallel_for(in->count, SKIN_GRAIN, threads, skin_job, &job);
+}
+
+int skin_model(const PMDModel *model, const float *matrices, const float *inverse_bind, uint32_t count,
+               int with_normals, int threads, SkinOutput *out) {
+    memset(out, 0, sizeof(*out));
+    size_t n = model->numVertices;
+    size_t streams = with_normals ? 6 : 3;
+    // Bone indices are bytes: past 255 bones, 0xFF would alias a real bone
+    if (count > 0xFF) count = 0xFF;
+    float *palette = malloc(((size_t)count + 1) * SKIN_PALETTE_STRIDE * sizeof(float));
+    float *input = malloc((n * (streams + 4) + 1) * sizeof(float));
+    uint8_t *bones = malloc(n * 4 + 1);
+    float *output = malloc((n * streams + 1) * sizeof(float));
+    uint8_t *weighted = malloc(n + 1);
+    if (!palette || !input || !bones || !output || !weighted) {
+        free(palette);
+        free(input);
+        free(bones);
+        free(output);
+        free(weighted);
+        return 0;
+    }
+    skin_palette_build(matrices, inverse_bind, count, palette);
+
+    SkinInput in = {(uint32_t)n, input, input + n, input + 2 * n, NULL, NULL, NULL, bones, input + streams * n};
+    float *weights = input + streams * n;
+    if (with_normals) {
+        in.nx = input + 3 * n;
+        in.ny = input + 4 * n;
+        in.nz = input + 5 * n;
+    }
+    for (size_t i = 0; i < n; i++) {
+        const Vertex *v = &model->vertices[i];
+        input[i] = v->position.x;
+        input[n + i] = v->position.y;
+        input[2 * n + i] = v->position.z;
+        if (with_normals) {
+            input[3 * n + i] = v->normal.x;
+            input[4 * n + i] = v->normal.y;
+            input[5 * n + i] = v->normal.z;
+        }
+        memcpy(&bones[i * 4], v->blend.bones, 4);
+        memcpy(&weights[i * 4], v->blend.weights, 4 * sizeof(float));
+    }
+
+    out->px = output;
+    out->py = output + n;
+    out->pz = output + 2 * n;
+    if (with_normals) {
+        out->nx = output + 3 * n;
+        out->ny = output + 4 * n;
+        out->nz = output + 5 * n;
+    }
+    out->weighted = weighted;
+    skin_vertices(palette, count, &in, out, threads);
+
+    free(palette);
+    free(input);
+    free(bones);
+    return 1;
+}
+
+void skin_output_free(SkinOutput *out) {
+    free(out->px);
+    free(out->weighted);
+    memset(out, 0, sizeof(*out));
+}
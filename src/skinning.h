@@ -0,0 +1,53 @@
+#ifndef SKINNING_H
+#define SKINNING_H
+
+#include "pmd_psa_types.h"
+#include <stdint.h>
+
+// Linear blend skinning over a matrix palette. The palette holds one 3x4
+// row-major affine matrix per bone (12 floats: three rows of rotation/scale
+// followed by the translation), computed once per pose; the kernel then
+// blends up to four palette entries per vertex and transforms SoA streams
+// in blocks so the transform loops vectorize.
+
+#define SKIN_PALETTE_STRIDE 12
+
+// palette[b] = matrices[b] * inverse_bind[b] (inverse_bind may be NULL).
+// Both inputs are 4x4 column-major (glTF / pose layout).
+void skin_palette_build(const float *matrices, const float *inverse_bind, uint32_t count, float *palette);
+
+typedef struct {
+    uint32_t count;
+    const float *px, *py, *pz;   // bind-pose positions
+    const float *nx, *ny, *nz;   // bind-pose normals, NULL to skip
+    const uint8_t *bones;        // 4 per vertex; entries past the palette are ignored
+    const float *weights;        // 4 per vertex; non-positive weights are ignored
+} SkinInput;
+
+typedef struct {
+    float *px, *py, *pz;
+    float *nx, *ny, *nz;         // written when the input has normals
+    uint8_t *weighted;           // optional: 1 where an influence applied, else 0
+} SkinOutput;
+
+// Skin vertices [begin, end). Weights are normalized by their sum; vertices
+// without a usable influence are copied unchanged. Normals are transformed by
+// the blended matrix without renormalization.
+void skin_vertices_range(const float *palette, uint32_t palette_count, const SkinInput *in,
+                         SkinOutput *out, uint32_t begin, uint32_t end);
+
+// All vertices, split over up to threads threads (0 = all cores, 1 = serial)
+void skin_vertices(const float *palette, uint32_t palette_count, const SkinInput *in,
+                   SkinOutput *out, int threads);
+
+// Skin a PMD model's bind-pose vertices by count bone matrices (times
+// inverse_bind when given, both 4x4 column-major). Influences on 0xFF or on
+// bones past count are ignored. Allocates every output stream (normals only
+// when with_normals) and weighted; release with skin_output_free. Returns 0
+// on allocation failure.
+int skin_model(const PMDModel *model, const float *matrices, const float *inverse_bind, uint32_t count,
+               int with_normals, int threads, SkinOutput *out);
+
+void skin_output_free(SkinOutput *out);
+
+#endif // SKINNING_H
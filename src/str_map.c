@@ -0,0 +1,99 @@
+#include "str_map.h"
+#include "hash.h"
+#include "portable_string.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t key_hash(const StrMap *map, const char *key) {
+    if (!map->ignore_case) return hash_fnv1a32_str(key);
+    uint32_t hash = 0x811c9dc5u;
+    while (*key) {
+        hash ^= (unsigned char)tolower((unsigned char)*key++);
+        hash *= 0x01000193u;
+    }
+    return hash;
+}
+
+static int key_equal(const StrMap *map, const char *a, const char *b) {
+    if (!map->ignore_case) return strcmp(a, b) == 0;
+    while (*a && tolower((unsigned char)*a) == tolower((unsigned char)*b)) {
+        a++;
+        b++;
+    }
+    return tolower((unsigned char)*a) == tolower((unsigned char)*b);
+}
+
+// Find the slot holding key, or the empty slot where it would go
+static uint32_t find_slot(const StrMap *map, const char *key, uint32_t hash) {
+    uint32_t mask = map->capacity - 1;
+    uint32_t slot = hash & mask;
+    while (map->entries[slot].key) {
+        if (map->entries[slot].hash == hash && key_equal(map, map->entries[slot].key, key)) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+static int grow(StrMap *map) {
+    uint32_t new_capacity = map->capacity ? map->capacity * 2 : 16;
+    StrMapEntry *entries = calloc(new_capacity, sizeof(StrMapEntry));
+    if (!entries) return 0;
+
+    StrMapEntry *old = map->entries;
+    uint32_t old_capacity = map->capacity;
+    map->entries = entries;
+    map->capacity = new_capacity;
+    for (uint32_t i = 0; i < old_capacity; i++) {
+        if (old[i].key) {
+            map->entries[find_slot(map, old[i].key, old[i].hash)] = old[i];
+        }
+    }
+    free(old);
+    return 1;
+}
+
+void str_map_init(StrMap *map, int ignore_case) {
+    map->entries = NULL;
+    map->capacity = 0;
+    map->count = 0;
+    map->ignore_case = ignore_case;
+}
+
+void str_map_free(StrMap *map) {
+    if (!map) return;
+    for (uint32_t i = 0; i < map->capacity; i++) {
+        free(map->entries[i].key);
+    }
+    free(map->entries);
+    map->entries = NULL;
+    map->capacity = 0;
+    map->count = 0;
+}
+
+int str_map_insert(StrMap *map, const char *key, int value) {
+    // Keep load factor below 3/4
+    if ((map->count + 1) * 4 > map->capacity * 3 && !grow(map)) return -1;
+
+    uint32_t hash = key_hash(map, key);
+    uint32_t slot = find_slot(map, key, hash);
+    if (map->entries[slot].key) return 0;
+
+    char *copy = my_strdup(key);
+    if (!copy) return -1;
+    map->entries[slot].key = copy;
+    map->entries[slot].hash = hash;
+    map->entries[slot].value = value;
+    map->count++;
+    return 1;
+}
+
+int str_map_get(const StrMap *map, const char *key, int *value) {
+    if (!map->capacity) return 0;
+    uint32_t slot = find_slot(map, key, key_hash(map, key));
+    if (!map->entries[slot].key) return 0;
+    if (value) *value = map->entries[slot].value;
+    return 1;
+}
@@ -0,0 +1,32 @@
+#ifndef STR_MAP_H
+#define STR_MAP_H
+
+#include <stdint.h>
+
+// Open-addressing hash map from strings to integer values.
+// Keys are copied on insertion; the map owns them.
+
+typedef struct {
+    char *key;          // NULL = empty slot
+    uint32_t hash;
+    int value;
+} StrMapEntry;
+
+typedef struct {
+    StrMapEntry *entries;
+    uint32_t capacity;  // power of two, 0 until first insertion
+    uint32_t count;
+    int ignore_case;    // ASCII case-insensitive keys
+} StrMap;
+
+void str_map_init(StrMap *map, int ignore_case);
+void str_map_free(StrMap *map);
+
+// Insert key -> value. Returns 1 if inserted, 0 if the key was already
+// present (existing value kept), -1 on allocation failure.
+int str_map_insert(StrMap *map, const char *key, int value);
+
+// Look up key. Returns 1 and stores the value in *value if found, 0 otherwise.
+int str_map_get(const StrMap *map, const char *key, int *value);
+
+#endif // STR_MAP_H
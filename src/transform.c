@@ -0,0 +1,197 @@
+#include "transform.h"
+#include <math.h>
+
+// Quaternion inverse
+Quaternion quat_inverse(Quaternion q) {
+    float len2 = q.x*q.x + q.y*q.y + q.z*q.z + q.w*q.w;
+    return (Quaternion){-q.x/len2, -q.y/len2, -q.z/len2, q.w/len2};
+}
+
+// Quaternion multiply
+Quaternion quat_mul(Quaternion a, Quaternion b) {
+    return (Quaternion){
+        a.w*b.x + a.x*b.w + a.y*b.z - a.z*b.y,
+        a.w*b.y - a.x*b.z + a.y*b.w + a.z*b.x,
+        a.w*b.z + a.x*b.y - a.y*b.x + a.z*b.w,
+        a.w*b.w - a.x*b.x - a.y*b.y - a.z*b.z
+    };
+}
+
+// Rotate vector by quaternion
+Vector3D quat_rotate(Quaternion q, Vector3D v) {
+    Vector3D qv = {q.x, q.y, q.z};
+    float qw = q.w;
+
+    Vector3D cross1 = {qv.y*v.z - qv.z*v.y, qv.z*v.x - qv.x*v.z, qv.x*v.y - qv.y*v.x};
+    Vector3D cross2 = {qv.y*cross1.z - qv.z*cross1.y, qv.z*cross1.x - qv.x*cross1.z, qv.x*cross1.y - qv.y*cross1.x};
+
+    return (Vector3D){
+        v.x + 2.0f * (qw * cross1.x + cross2.x),
+        v.y + 2.0f * (qw * cross1.y + cross2.y),
+        v.z + 2.0f * (qw * cross1.z + cross2.z)
+    };
+}
+
+Quaternion quat_normalize(Quaternion q) {
+    float len = sqrtf(q.x*q.x + q.y*q.y + q.z*q.z + q.w*q.w);
+    if (len < 1e-12f) return (Quaternion){0.0f, 0.0f, 0.0f, 1.0f};
+    return (Quaternion){q.x/len, q.y/len, q.z/len, q.w/len};
+}
+
+Quaternion quat_slerp(Quaternion a, Quaternion b, float t) {
+    float d = a.x*b.x + a.y*b.y + a.z*b.z + a.w*b.w;
+    if (d < 0.0f) {
+        b = (Quaternion){-b.x, -b.y, -b.z, -b.w};
+        d = -d;
+    }
+
+    float wa, wb;
+    if (d > 0.9995f) {
+        // Nearly parallel: lerp avoids dividing by a vanishing sine
+        wa = 1.0f - t;
+        wb = t;
+    } else {
+        float theta = acosf(d);
+        float s = sinf(theta);
+        wa = sinf((1.0f - t) * theta) / s;
+        wb = sinf(t * theta) / s;
+    }
+    return quat_normalize((Quaternion){
+        wa*a.x + wb*b.x, wa*a.y + wb*b.y, wa*a.z + wb*b.z, wa*a.w + wb*b.w
+    });
+}
+
+void make_matrix(const BoneState *bs, float *out) {
+    float x = bs->rotation.x, y = bs->rotation.y, z = bs->rotation.z, w = bs->rotation.w;
+    float xx = x*x, yy = y*y, zz = z*z;
+    float xy = x*y, xz = x*z, yz = y*z;
+    float wx = w*x, wy = w*y, wz = w*z;
+    out[0] = 1.0f - 2.0f*(yy + zz);
+    out[1] = 2.0f*(xy + wz);
+    out[2] = 2.0f*(xz - wy);
+    out[3] = 0.0f;
+    out[4] = 2.0f*(xy - wz);
+    out[5] = 1.0f - 2.0f*(xx + zz);
+    out[6] = 2.0f*(yz + wx);
+    out[7] = 0.0f;
+    out[8] = 2.0f*(xz + wy);
+    out[9] = 2.0f*(yz - wx);
+    out[10] = 1.0f - 2.0f*(xx + yy);
+    out[11] = 0.0f;
+    out[12] = bs->translation.x;
+    out[13] = bs->translation.y;
+    out[14] = bs->translation.z;
+    out[15] = 1.0f;
+}
+
+void matrix_to_bone_state(const float *m, BoneState *out) {
+    out->translation = (Vector3D){m[12], m[13], m[14]};
+
+    // Normalize the basis so uniform or axis scale does not leak into the rotation
+    float c0[3] = {m[0], m[1], m[2]};
+    float c1[3] = {m[4], m[5], m[6]};
+    float c2[3] = {m[8], m[9], m[10]};
+    float *cols[3] = {c0, c1, c2};
+    for (int i = 0; i < 3; i++) {
+        float len = sqrtf(cols[i][0]*cols[i][0] + cols[i][1]*cols[i][1] + cols[i][2]*cols[i][2]);
+        if (len > 1e-12f) {
+            cols[i][0] /= len;
+            cols[i][1] /= len;
+            cols[i][2] /= len;
+        }
+    }
+
+    // Rotation matrix to quaternion (Shepperd's method); r[row][col] = cols[col][row]
+    float trace = c0[0] + c1[1] + c2[2];
+    Quaternion q;
+    if (trace > 0.0f) {
+        float s = sqrtf(trace + 1.0f) * 2.0f;
+        q.w = 0.25f * s;
+        q.x = (c1[2] - c2[1]) / s;
+        q.y = (c2[0] - c0[2]) / s;
+        q.z = (c0[1] - c1[0]) / s;
+    } else if (c0[0] > c1[1] && c0[0] > c2[2]) {
+        float s = sqrtf(1.0f + c0[0] - c1[1] - c2[2]) * 2.0f;
+        q.w = (c1[2] - c2[1]) / s;
+        q.x = 0.25f * s;
+        q.y = (c1[0] + c0[1]) / s;
+        q.z = (c2[0] + c0[2]) / s;
+    } else if (c1[1] > c2[2]) {
+        float s = sqrtf(1.0f + c1[1] - c0[0] - c2[2]) * 2.0f;
+        q.w = (c2[0] - c0[2]) / s;
+        q.x = (c1[0] + c0[1]) / s;
+        q.y = 0.25f * s;
+        q.z = (c2[1] + c1[2]) / s;
+    } else {
+        float s = sqrtf(1.0f + c2[2] - c0[0] - c1[1]) * 2.0f;
+        q.w = (c0[1] - c1[0]) / s;
+        q.x = (c2[0] + c0[2]) / s;
+        q.y = (c2[1] + c1[2]) / s;
+        q.z = 0.25f * s;
+    }
+    out->rotation = quat_normalize(q);
+}
+
+void invert_affine(const float *m, float *out) {
+    out[0]=m[0]; out[1]=m[4]; out[2]=m[8];  out[3]=0.0f;
+    out[4]=m[1]; out[5]=m[5]; out[6]=m[9];  out[7]=0.0f;
+    out[8]=m[2]; out[9]=m[6]; out[10]=m[10]; out[11]=0.0f;
+    float tx = m[12], ty = m[13], tz = m[14];
+    out[12] = -(out[0]*tx + out[4]*ty + out[8]*tz);
+    out[13] = -(out[1]*tx + out[5]*ty + out[9]*tz);
+    out[14] = -(out[2]*tx + out[6]*ty + out[10]*tz);
+    out[15] = 1.0f;
+}
+
+void mat4_mul(const float *a, const float *b, float *out) {
+    float r[16];
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            r[col*4 + row] = a[0*4 + row] * b[col*4 + 0] +
+                             a[1*4 + row] * b[col*4 + 1] +
+                             a[2*4 + row] * b[col*4 + 2] +
+                             a[3*4 + row] * b[col*4 + 3];
+        }
+    }
+    for (int i = 0; i < 16; i++) out[i] = r[i];
+}
+
+Vector3D mat4_transform_point(const float *m, Vector3D p) {
+    return (Vector3D){
+        m[0]*p.x + m[4]*p.y + m[8]*p.z + m[12],
+        m[1]*p.x + m[5]*p.y + m[9]*p.z + m[13],
+        m[2]*p.x + m[6]*p.y + m[10]*p.z + m[14]
+    };
+}
+
+Vector3D mat4_transform_vector(const float *m, Vector3D v) {
+    return (Vector3D){
+        m[0]*v.x + m[4]*v.y + m[8]*v.z,
+        m[1]*v.x + m[5]*v.y + m[9]*v.z,
+        m[2]*v.x + m[6]*v.y + m[10]*v.z
+    };
+}
+
+// Convert world space transform to local space relative to parent
+void compute_local_transform(BoneState *local, const BoneState *world, const BoneState *parent_world) {
+    // local_rotation = inverse(parent_rotation) * world_rotation
+    Quaternion parent_inv = quat_inverse(parent_world->rotation);
+    local->rotation = quat_mul(parent_inv, world->rotation);
+
+    // local_translation = inverse(parent_rotation) * (world_translation - parent_translation)
+    Vector3D diff = {
+        world->translation.x - parent_world->translation.x,
+        world->translation.y - parent_world->translation.y,
+        world->translation.z - parent_world->translation.z
+    };
+    local->translation = quat_rotate(parent_inv, diff);
+}
+
+// Convert local space transform back to world space
+void compose_world_transform(BoneState *world, const BoneState *local, const BoneState *parent_world) {
+    Vector3D rotated = quat_rotate(parent_world->rotation, local->translation);
+    world->translation.x = parent_world->translation.x + rotated.x;
+    world->translation.y = parent_world->translation.y + rotated.y;
+    world->translation.z = parent_world->translation.z + rotated.z;
+    world->rotation = quat_mul(parent_world->rotation, local->rotation);
+}
@@ -0,0 +1,33 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "pmd_psa_types.h"
+
+// Quaternion and affine matrix helpers shared by the pose evaluation,
+// exporter and skinning code. Matrices are 4x4 column-major (glTF layout).
+
+Quaternion quat_inverse(Quaternion q);
+Quaternion quat_mul(Quaternion a, Quaternion b);
+Vector3D quat_rotate(Quaternion q, Vector3D v);
+
+// Shortest-arc spherical interpolation, t in [0, 1]
+Quaternion quat_slerp(Quaternion a, Quaternion b, float t);
+Quaternion quat_normalize(Quaternion q);
+
+// Build matrix from BoneState
+void make_matrix(const BoneState *bs, float *out);
+// Translation and rotation of a rigid matrix (scale is dropped)
+void matrix_to_bone_state(const float *m, BoneState *out);
+// Invert a rigid transform (rotation + translation)
+void invert_affine(const float *m, float *out);
+// out = a * b
+void mat4_mul(const float *a, const float *b, float *out);
+Vector3D mat4_transform_point(const float *m, Vector3D p);
+Vector3D mat4_transform_vector(const float *m, Vector3D v);
+
+// local = inverse(parent_world) * world
+void compute_local_transform(BoneState *local, const BoneState *world, const BoneState *parent_world);
+// world = parent_world * local
+void compose_world_transform(BoneState *world, const BoneState *local, const BoneState *parent_world);
+
+#endif // TRANSFORM_H
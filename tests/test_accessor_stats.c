@@ -0,0 +1,81 @@
+#include "test_framework.h"
+#include "accessor_stats.h"
+#include <stdlib.h>
+
+// Plain per-element scan to check the SIMD path against
+static void reference_stats(const float *data, size_t count, uint32_t components, float *min, float *max) {
+    for (uint32_t c = 0; c < components; c++) {
+        min[c] = max[c] = data[c];
+    }
+    for (size_t i = 1; i < count; i++) {
+        for (uint32_t c = 0; c < components; c++) {
+            float v = data[i * components + c];
+            if (v < min[c]) min[c] = v;
+            if (v > max[c]) max[c] = v;
+        }
+    }
+}
+
+static int test_float_matches_reference(void) {
+    static const uint32_t component_counts[] = {1, 2, 3, 4, 16};
+    static const size_t element_counts[] = {1, 2, 3, 5, 8, 13, 1000, 1001};
+    float *data = malloc(1001 * 16 * sizeof(float));
+    TEST_ASSERT_NOT_NULL(data, "Allocation should succeed");
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < 1001 * 16; i++) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = (float)((seed >> 8) % 20001) * 0.01f - 100.0f;
+    }
+    for (size_t c = 0; c < sizeof(component_counts) / sizeof(component_counts[0]); c++) {
+        for (size_t n = 0; n < sizeof(element_counts) / sizeof(element_counts[0]); n++) {
+            uint32_t components = component_counts[c];
+            float min[16], max[16], expected_min[16], expected_max[16];
+            accessor_stats_float(data, element_counts[n], components, min, max);
+            reference_stats(data, element_counts[n], components, expected_min, expected_max);
+            for (uint32_t k = 0; k < components; k++) {
+                TEST_ASSERT(min[k] == expected_min[k] && max[k] == expected_max[k],
+                            "Every component should match the plain scan");
+            }
+        }
+    }
+    free(data);
+    return 1;
+}
+
+static int test_float_extremes_in_tail(void) {
+    // 6 VEC3 elements: one full SIMD block of 4, extremes in the 2-element tail
+    float data[18] = {0};
+    data[15] = -7.0f;
+    data[17] = 9.0f;
+    float min[3], max[3];
+    accessor_stats_float(data, 6, 3, min, max);
+    TEST_ASSERT(min[0] == -7.0f && max[0] == 0.0f, "Tail minimum should be found");
+    TEST_ASSERT(max[2] == 9.0f && min[1] == 0.0f, "Tail maximum should be found");
+    return 1;
+}
+
+static int test_unsigned_types(void) {
+    uint8_t bytes[8] = {3, 200, 7, 1, 9, 4, 0, 255};
+    uint16_t shorts[3] = {500, 65535, 2};
+    uint32_t ints[2] = {70000, 5};
+    uint32_t min[4], max[4];
+
+    accessor_stats_unsigned(bytes, 5121, 2, 4, min, max);
+    TEST_ASSERT(min[0] == 3 && max[0] == 9 && min[1] == 4 && max[1] == 200, "VEC4 bytes are per component");
+    TEST_ASSERT(min[2] == 0 && max[3] == 255, "Full byte range should be kept");
+    accessor_stats_unsigned(shorts, 5123, 3, 1, min, max);
+    TEST_ASSERT(min[0] == 2 && max[0] == 65535, "Shorts should be scanned");
+    accessor_stats_unsigned(ints, 5125, 2, 1, min, max);
+    TEST_ASSERT(min[0] == 5 && max[0] == 70000, "Ints should be scanned");
+    return 1;
+}
+
+int main(void) {
+    const test_case_t tests[] = {
+        {"float_matches_reference", test_float_matches_reference},
+        {"float_extremes_in_tail", test_float_extremes_in_tail},
+        {"unsigned_types", test_unsigned_types}
+    };
+
+    return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
+}
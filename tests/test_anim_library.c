@@ -0,0 +1,110 @@
+#include "test_framework.h"
+#include "anim_library.h"
+#include <stdio.h>
+#include <string.h>
+
+#define FRAMES 3
+
+static SkeletonDef* make_skeleton(const char *title) {
+    SkeletonDef *skel = skeleton_create(NULL);
+    snprintf(skel->title, sizeof(skel->title), "%s", title);
+    skeleton_add_bone(skel, "root", -1);
+    skeleton_add_bone(skel, "spine", 0);
+    skeleton_build_index(skel);
+    return skel;
+}
+
+// Two-bone clip whose keys all depend on seed
+static const char* add_clip(AnimLibrary *lib, const char *name, const char *model, float seed) {
+    float times[FRAMES] = {0.0f, 0.5f, 1.0f};
+    float t0[FRAMES * 3], t1[FRAMES * 3], r0[FRAMES * 4], r1[FRAMES * 4];
+    for (int i = 0; i < FRAMES * 3; i++) {
+        t0[i] = seed + (float)i;
+        t1[i] = seed - (float)i;
+    }
+    for (int i = 0; i < FRAMES * 4; i++) {
+        r0[i] = seed * (float)i;
+        r1[i] = 1.0f;
+    }
+    float *translations[2] = {t0, t1};
+    float *rotations[2] = {r0, r1};
+    return anim_library_add_clip(lib, name, model, FRAMES, 2, times, translations, rotations);
+}
+
+static int test_identical_clips_are_shared(void) {
+    SkeletonDef *skel = make_skeleton("biped");
+    AnimLibrarySet set;
+    anim_library_set_init(&set);
+    AnimLibrary *lib = anim_library_set_get(&set, skel);
+    TEST_ASSERT_NOT_NULL(lib, "Library should be created");
+    TEST_ASSERT(anim_library_set_get(&set, skel) == lib, "Same skeleton, same library");
+
+    const char *first = add_clip(lib, "walk", "soldier", 1.0f);
+    const char *second = add_clip(lib, "walk", "archer", 1.0f);
+    TEST_ASSERT(first && second && strcmp(second, "walk") == 0, "Identical clip keeps its name");
+    TEST_ASSERT_EQ(1, lib->clip_count, "Identical clip is stored once");
+    TEST_ASSERT_EQ(1, lib->reused, "Second copy counts as reused");
+    const AnimLibraryClip *clip = &lib->clips[0];
+    TEST_ASSERT(clip->translations[FRAMES * 3] == 1.0f && clip->rotations[FRAMES * 4] == 1.0f,
+                "Tracks are stored bone-major");
+    anim_library_set_free(&set);
+    free_skeleton(skel);
+    return 1;
+}
+
+static int test_name_clash_is_renamed(void) {
+    SkeletonDef *skel = make_skeleton("biped");
+    AnimLibrarySet set;
+    anim_library_set_init(&set);
+    AnimLibrary *lib = anim_library_set_get(&set, skel);
+    add_clip(lib, "idle", "soldier", 1.0f);
+    const char *renamed = add_clip(lib, "idle", "archer", 2.0f);
+    TEST_ASSERT(renamed && strcmp(renamed, "archer:idle") == 0, "Different keys get the model prefix");
+    const char *again = add_clip(lib, "idle", "archer", 2.0f);
+    TEST_ASSERT(again && strcmp(again, "archer:idle") == 0, "The renamed clip is found again");
+    const char *third = add_clip(lib, "idle", "archer", 3.0f);
+    TEST_ASSERT(third && strcmp(third, "archer:idle_2") == 0, "Further clashes are numbered");
+    TEST_ASSERT_EQ(3, lib->clip_count, "Three distinct clips");
+    anim_library_set_free(&set);
+    free_skeleton(skel);
+    return 1;
+}
+
+static int test_one_library_per_skeleton(void) {
+    SkeletonDef *a = make_skeleton("horse rig");
+    SkeletonDef *b = make_skeleton("horse rig");
+    SkeletonDef *c = make_skeleton("");
+    AnimLibrarySet set;
+    anim_library_set_init(&set);
+    AnimLibrary *la = anim_library_set_get(&set, a);
+    AnimLibrary *lb = anim_library_set_get(&set, b);
+    AnimLibrary *lc = anim_library_set_get(&set, c);
+    TEST_ASSERT(la && lb && lc && la != lb, "Distinct skeletons get distinct libraries");
+    TEST_ASSERT(strcmp(la->stem, "horse_rig") == 0, "Titles are made safe for file names");
+    TEST_ASSERT(strcmp(lb->stem, "horse_rig_2") == 0, "Clashing titles are numbered");
+    TEST_ASSERT(strcmp(lc->stem, "skeleton") == 0, "Untitled skeletons get a default name");
+
+    BoneState rest[2] = {{{1.0f, 2.0f, 3.0f}, {0, 0, 0, 1.0f}}, {{4.0f, 5.0f, 6.0f}, {0, 0, 0, 1.0f}}};
+    BoneState other[2] = {{{9.0f, 9.0f, 9.0f}, {0, 0, 0, 1.0f}}, {{9.0f, 9.0f, 9.0f}, {0, 0, 0, 1.0f}}};
+    anim_library_set_rest(la, rest, 1);
+    anim_library_set_rest(la, other, 2);
+    TEST_ASSERT(la->rest[0].translation.x == 1.0f, "The first model sets the rest pose");
+    TEST_ASSERT(la->rest[1].translation.x == 0.0f && la->rest[1].rotation.w == 1.0f,
+                "Bones the first model lacks stay identity");
+    TEST_ASSERT_EQ(2, la->model_count, "Every model is counted");
+    anim_library_set_free(&set);
+    free_skeleton(a);
+    free_skeleton(b);
+    free_skeleton(c);
+    return 1;
+}
+
+int main(void) {
+    const test_case_t tests[] = {
+        {"identical_clips_are_shared", test_identical_clips_are_shared},
+        {"name_clash_is_renamed", test_name_clash_is_renamed},
+        {"one_library_per_skeleton", test_one_library_per_skeleton}
+    };
+
+    return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
+}
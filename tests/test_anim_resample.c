@@ -0,0 +1,142 @@
+#include "test_framework.h"
+#include "test_fixtures.h"
+#include "anim_resample.h"
+#include "gltf_exporter.h"
+#include <math.h>
+
+#define TEST_GLTF "test_anim_resample.gltf"
+
+// Two bones; bone 1 moves along X by one unit per frame and turns 3 degrees
+// per frame around Z
+static PSAAnimation* make_anim(uint32_t frames) {
+    PSAAnimation *anim = fixture_anim("walk", 2, frames);
+    for (uint32_t f = 0; f < frames; f++) {
+        BoneState *s = &anim->boneStates[f * 2];
+        float half = (float)f * 1.5f * 3.14159265f / 180.0f;
+        s[1].translation = (Vector3D){(float)f, 1.0f, 0.0f};
+        s[1].rotation = (Quaternion){0.0f, 0.0f, sinf(half), cosf(half)};
+    }
+    return anim;
+}
+
+static int same_state(const BoneState *a, const BoneState *b) {
+    return memcmp(a, b, sizeof(BoneState)) == 0;
+}
+
+static int test_halves_frame_count(void) {
+    PSAAnimation *anim = make_anim(41);
+    PSAAnimation *out = resample_psa(anim, 30.0f, 15.0f, NULL, NULL, 0);
+    TEST_ASSERT_NOT_NULL(out, "Resampling should succeed");
+    TEST_ASSERT_EQ(21, out->numFrames, "30 -> 15 fps should keep every other frame");
+    TEST_ASSERT(fabsf(out->frameLength - 1.0f / 15.0f) < 1e-6f, "Key spacing should be 1/15 s");
+    TEST_ASSERT_STR_EQ("walk", out->name, "Name should be kept");
+    for (uint32_t k = 0; k < out->numFrames; k++) {
+        TEST_ASSERT(same_state(&out->boneStates[k * 2 + 1], &anim->boneStates[k * 4 + 1]),
+                    "Keys on source frames should be copied exactly");
+    }
+    free_psa(out);
+    free_psa(anim);
+    return 1;
+}
+
+static int test_keeps_end_frame(void) {
+    PSAAnimation *anim = make_anim(40);
+    PSAAnimation *out = resample_psa(anim, 30.0f, 15.0f, NULL, NULL, 0);
+    TEST_ASSERT_NOT_NULL(out, "Resampling should succeed");
+    // 39 intervals = 1.3 s, rounded up to 20 intervals at 15 fps
+    TEST_ASSERT_EQ(21, out->numFrames, "Key count should be rounded up");
+    TEST_ASSERT(fabsf(out->frameLength * 20.0f - 1.3f) < 1e-5f, "Keys should span the whole clip");
+    TEST_ASSERT(same_state(&out->boneStates[20 * 2 + 1], &anim->boneStates[39 * 2 + 1]),
+                "Last key should be the last source frame exactly");
+    free_psa(out);
+    free_psa(anim);
+    return 1;
+}
+
+static int test_interpolates_between_frames(void) {
+    PSAAnimation *anim = make_anim(4);
+    // 3 intervals at 30 fps -> 0.1 s, 2 intervals at 20 fps: key 1 sits at frame 1.5
+    PSAAnimation *out = resample_psa(anim, 30.0f, 20.0f, NULL, NULL, 0);
+    TEST_ASSERT_NOT_NULL(out, "Resampling should succeed");
+    TEST_ASSERT_EQ(3, out->numFrames, "Three keys expected");
+    const BoneState *mid = &out->boneStates[1 * 2 + 1];
+    TEST_ASSERT(fabsf(mid->translation.x - 1.5f) < 1e-5f, "Translations should be lerped");
+    float half = 1.5f * 1.5f * 3.14159265f / 180.0f;
+    TEST_ASSERT(fabsf(mid->rotation.z - sinf(half)) < 1e-5f, "Rotations should be slerped");
+    TEST_ASSERT(fabsf(mid->rotation.w - cosf(half)) < 1e-5f, "Slerped rotation should stay unit length");
+    free_psa(out);
+    free_psa(anim);
+    return 1;
+}
+
+static const int rig_parents[] = {-1, 0};
+
+static int test_interpolates_in_parent_space(void) {
+    static const char *const names[] = {"root", "arm"};
+    SkeletonDef *skel = fixture_skeleton(names, rig_parents, 2);
+
+    // The root turns 90 degrees around Z between the two frames; the arm
+    // stays one unit along the root's X axis
+    PSAAnimation *anim = fixture_anim(NULL, 2, 2);
+    float s45 = sinf(3.14159265f / 4.0f);
+    anim->boneStates[1].translation = (Vector3D){1.0f, 0.0f, 0.0f};
+    anim->boneStates[2].rotation = (Quaternion){0.0f, 0.0f, s45, s45};
+    anim->boneStates[3] = (BoneState){{0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, s45, s45}};
+
+    // 1 interval at 30 fps, 2 at 60 fps: key 1 sits halfway, root at 45 degrees
+    PSAAnimation *out = resample_psa(anim, 30.0f, 60.0f, skel, NULL, 0);
+    TEST_ASSERT_NOT_NULL(out, "Resampling should succeed");
+    TEST_ASSERT_EQ(3, out->numFrames, "Three keys expected");
+    const Vector3D *arm = &out->boneStates[1 * 2 + 1].translation;
+    float length = sqrtf(arm->x * arm->x + arm->y * arm->y + arm->z * arm->z);
+    TEST_ASSERT(fabsf(length - 1.0f) < 1e-5f, "Child should keep its distance to the parent");
+    TEST_ASSERT(fabsf(arm->x - s45) < 1e-5f && fabsf(arm->y - s45) < 1e-5f,
+                "Child should follow the parent's rotation");
+
+    free_psa(out);
+    free_psa(anim);
+    free_skeleton(skel);
+    return 1;
+}
+
+static int test_export_uses_sample_rate(void) {
+    static const char *const names[] = {"root", "hip"};
+    SkeletonDef *skel = fixture_skeleton(names, rig_parents, 2);
+    PMDModel *model = fixture_model(0, 0, 2);
+    PSAAnimation *anim = make_anim(31);
+
+    GltfExportOptions opts;
+    gltf_export_options_init(&opts);
+    opts.sample_rate = 10.0f;
+    TEST_ASSERT(export_gltf_with_options(TEST_GLTF, model, &anim, 1, skel, "rig", NULL, NULL, &opts),
+                "Export should succeed");
+
+    cJSON *root = fixture_load_json(TEST_GLTF);
+    TEST_ASSERT_NOT_NULL(root, "Exported file should exist");
+    const cJSON *animation = cJSON_GetArrayItem(cJSON_GetObjectItem(root, "animations"), 0);
+    const cJSON *sampler = cJSON_GetArrayItem(cJSON_GetObjectItem(animation, "samplers"), 0);
+    const cJSON *times = cJSON_GetArrayItem(cJSON_GetObjectItem(root, "accessors"),
+                                            cJSON_GetObjectItem(sampler, "input")->valueint);
+    TEST_ASSERT_EQ(11, cJSON_GetObjectItem(times, "count")->valueint, "One second at 10 fps is 11 keys");
+    float max = (float)cJSON_GetArrayItem(cJSON_GetObjectItem(times, "max"), 0)->valuedouble;
+    TEST_ASSERT(fabsf(max - 1.0f) < 1e-5f, "Last key should stay on the last frame");
+
+    cJSON_Delete(root);
+    free_psa(anim);
+    free_pmd(model);
+    free_skeleton(skel);
+    remove(TEST_GLTF);
+    return 1;
+}
+
+int main(void) {
+    const test_case_t tests[] = {
+        {"halves_frame_count", test_halves_frame_count},
+        {"keeps_end_frame", test_keeps_end_frame},
+        {"interpolates_between_frames", test_interpolates_between_frames},
+        {"interpolates_in_parent_space", test_interpolates_in_parent_space},
+        {"export_uses_sample_rate", test_export_uses_sample_rate}
+    };
+
+    return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
+}
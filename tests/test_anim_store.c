@@ -0,0 +1,79 @@
+#include "test_framework.h"
+#include "anim_store.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_STORE "test_anim_store.bin"
+
+static int test_identical_blocks_share_offset(void) {
+    AnimStore store;
+    TEST_ASSERT(anim_store_open(&store, TEST_STORE), "Store should open");
+    float times[3] = {0.0f, 0.5f, 1.0f};
+    float copy[3] = {0.0f, 0.5f, 1.0f};
+    uint64_t first, second;
+    TEST_ASSERT(anim_store_add(&store, times, sizeof(times), &first), "First block should be stored");
+    TEST_ASSERT(anim_store_add(&store, copy, sizeof(copy), &second), "Copy should be found");
+    TEST_ASSERT(first == second, "Identical blocks share one offset");
+    TEST_ASSERT_EQ(1, store.count, "Only one block is written");
+    TEST_ASSERT_EQ(1, store.hits, "The copy counts as a hit");
+    TEST_ASSERT(store.size == sizeof(times), "The file holds a single copy");
+    TEST_ASSERT(anim_store_close(&store), "Store should close");
+    remove(TEST_STORE);
+    return 1;
+}
+
+static int test_blocks_are_aligned(void) {
+    AnimStore store;
+    TEST_ASSERT(anim_store_open(&store, TEST_STORE), "Store should open");
+    uint8_t odd[3] = {1, 2, 3};
+    float values[2] = {4.0f, 5.0f};
+    uint64_t a, b;
+    TEST_ASSERT(anim_store_add(&store, odd, sizeof(odd), &a), "Odd block should be stored");
+    TEST_ASSERT(anim_store_add(&store, values, sizeof(values), &b), "Float block should be stored");
+    TEST_ASSERT(a == 0 && b == 4, "Blocks start on 4-byte boundaries");
+    TEST_ASSERT(strcmp(store.uri, TEST_STORE) == 0, "The uri is the file name");
+    TEST_ASSERT(anim_store_close(&store), "Store should close");
+
+    FILE *file = fopen(TEST_STORE, "rb");
+    TEST_ASSERT(file != NULL, "Shared file should exist");
+    uint8_t data[12];
+    size_t read = fread(data, 1, sizeof(data), file);
+    fclose(file);
+    remove(TEST_STORE);
+    TEST_ASSERT_EQ(12, read, "File is padded to a multiple of 4");
+    TEST_ASSERT(memcmp(data, odd, 3) == 0 && memcmp(&data[4], values, sizeof(values)) == 0,
+                "Blocks are written at their offsets");
+    return 1;
+}
+
+static int test_many_distinct_blocks(void) {
+    AnimStore store;
+    TEST_ASSERT(anim_store_open(&store, TEST_STORE), "Store should open");
+    // Enough blocks to grow the index a few times
+    for (uint32_t i = 0; i < 1000; i++) {
+        uint32_t block[2] = {i, i * 7u};
+        uint64_t offset;
+        TEST_ASSERT(anim_store_add(&store, block, sizeof(block), &offset), "Block should be stored");
+        TEST_ASSERT(offset == (uint64_t)i * sizeof(block), "Distinct blocks get their own offsets");
+    }
+    for (uint32_t i = 0; i < 1000; i += 37) {
+        uint32_t block[2] = {i, i * 7u};
+        uint64_t offset;
+        TEST_ASSERT(anim_store_add(&store, block, sizeof(block), &offset), "Copy should be found");
+        TEST_ASSERT(offset == (uint64_t)i * sizeof(block), "Copies resolve after the index grew");
+    }
+    TEST_ASSERT_EQ(1000, store.count, "Copies are not written again");
+    TEST_ASSERT(anim_store_close(&store), "Store should close");
+    remove(TEST_STORE);
+    return 1;
+}
+
+int main(void) {
+    const test_case_t tests[] = {
+        {"identical_blocks_share_offset", test_identical_blocks_share_offset},
+        {"blocks_are_aligned", test_blocks_are_aligned},
+        {"many_distinct_blocks", test_many_distinct_blocks}
+    };
+
+    return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
+}
@@ -0,0 +1,52 @@
+#include "test_framework.h"
+#include "clip_bounds.h"
+#include <math.h>
+#include <string.h>
+
+// Identity palette entry moved by (x, y, z)
+static void translation(float x, float y, float z, float *p) {
+    memset(p, 0, SKIN_PALETTE_STRIDE * sizeof(float));
+    p[0] = p[5] = p[10] = 1.0f;
+    p[3] = x;
+    p[7] = y;
+    p[11] = z;
+}
+
+static int test_box_covers_every_frame(void) {
+    // Vertex 0 follows bone 0, vertex 1 bone 1; bone 1 rises over three frames
+    float px[2] = {-1.0f, 1.0f}, py[2] = {0}, pz[2] = {0};
+    uint8_t bones[8] = {0, 0xFF, 0xFF, 0xFF, 1, 0xFF, 0xFF, 0xFF};
+    float weights[8] = {1.0f, 0, 0, 0, 1.0f, 0, 0, 0};
+    SkinInput in = {2, px, py, pz, NULL, NULL, NULL, bones, weights};
+    float palettes[3 * 2 * SKIN_PALETTE_STRIDE];
+    for (int f = 0; f < 3; f++) {
+        translation(0.0f, 0.0f, 0.0f, &palettes[(f * 2) * SKIN_PALETTE_STRIDE]);
+        translation(0.0f, 2.0f * (float)f, 0.0f, &palettes[(f * 2 + 1) * SKIN_PALETTE_STRIDE]);
+    }
+
+    ClipBounds bounds;
+    TEST_ASSERT(clip_bounds_compute(palettes, 3, 2, &in, 1, &bounds), "Bounds should be computed");
+    TEST_ASSERT(bounds.min[0] == -1.0f && bounds.max[0] == 1.0f, "Box spans both vertices");
+    TEST_ASSERT(bounds.min[1] == 0.0f && bounds.max[1] == 4.0f, "Box reaches the last frame");
+    TEST_ASSERT(bounds.center[1] == 2.0f, "Center is the box center");
+    TEST_ASSERT(fabsf(bounds.radius - sqrtf(5.0f)) < 1e-6f, "Sphere holds the farthest vertex of any frame");
+    return 1;
+}
+
+static int test_empty_clip(void) {
+    float palette[SKIN_PALETTE_STRIDE];
+    translation(0.0f, 0.0f, 0.0f, palette);
+    SkinInput in = {0};
+    ClipBounds bounds;
+    TEST_ASSERT(!clip_bounds_compute(palette, 1, 1, &in, 1, &bounds), "No vertices gives no bounds");
+    return 1;
+}
+
+int main(void) {
+    const test_case_t tests[] = {
+        {"box_covers_every_frame", test_box_covers_every_frame},
+        {"empty_clip", test_empty_clip}
+    };
+
+    return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
+}
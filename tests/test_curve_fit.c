@@ -0,0 +1,194 @@
+#include "test_framework.h"
+#include "test_fixtures.h"
+#include "curve_fit.h"
+#include "gltf_exporter.h"
+#include <math.h>
+
+#define TEST_GLTF "test_curve_fit.gltf"
+#define FRAMES 121
+#define PI 3.14159265f
+
+static void make_times(float *times, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        times[i] = (float)i / 30.0f;
+    }
+}
+
+// Evaluate a fitted track at time t the way glTF viewers do (no slerp needed
+// for the translation tracks checked here)
+static void evaluate(const FittedTrack *track, float t, float *out) {
+    int n = track->components;
+    uint32_t k = 0;
+    while (k + 2 < track->key_count && track->times[k + 1] <= t) k++;
+    if (track->key_count == 1) {
+        memcpy(out, track->values + (track->cubic ? n : 0), n * sizeof(float));
+        return;
+    }
+    float t0 = track->times[k], t1 = track->times[k + 1];
+    float td = t1 - t0;
+    float u = (t - t0) / td;
+    for (int c = 0; c < n; c++) {
+        if (track->cubic) {
+            const float *a = &track->values[k * 3 * n], *b = &track->values[(k + 1) * 3 * n];
+            float u2 = u * u, u3 = u2 * u;
+            out[c] = (2 * u3 - 3 * u2 + 1) * a[n + c] + (u3 - 2 * u2 + u) * td * a[2 * n + c] +
+                     (-2 * u3 + 3 * u2) * b[n + c] + (u3 - u2) * td * b[c];
+        } else {
+            float a = track->values[k * n + c], b = track->values[(k + 1) * n + c];
+            out[c] = a + (b - a) * u;
+        }
+    }
+}
+
+static int test_smooth_cycle_goes_cubic(void) {
+    float times[FRAMES];
+    float samples[FRAMES * 3];
+    make_times(times, FRAMES);
+    // One slow cycle over four seconds
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        samples[i * 3 + 0] = sinf(times[i] * 0.5f * PI);
+        samples[i * 3 + 1] = 0.5f * cosf(times[i] * 0.5f * PI);
+        samples[i * 3 + 2] = 2.0f;
+    }
+
+    FittedTrack track;
+    TEST_ASSERT(fit_track(times, samples, FRAMES, 3, 0, 0.001f, &track), "Fit should succeed");
+    TEST_ASSERT(track.cubic, "Smooth track should fit as CUBICSPLINE");
+    TEST_ASSERT(track.key_count * 10 <= FRAMES, "Key count should drop by an order of magnitude");
+    TEST_ASSERT(track.times[0] == 0.0f && track.times[track.key_count - 1] == times[FRAMES - 1],
+                "First and last frames should stay keys");
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        float value[3];
+        evaluate(&track, times[i], value);
+        float dx = value[0] - samples[i * 3], dy = value[1] - samples[i * 3 + 1], dz = value[2] - samples[i * 3 + 2];
+        TEST_ASSERT(sqrtf(dx * dx + dy * dy + dz * dz) <= 0.001f + 1e-6f, "Every frame should stay within the bound");
+    }
+    TEST_ASSERT(fitted_track_size(&track) * 5 < FRAMES * 4 * sizeof(float), "Fitted track should be much smaller");
+    fitted_track_free(&track);
+    return 1;
+}
+
+static int test_still_track_is_one_key(void) {
+    float times[FRAMES];
+    float samples[FRAMES * 4];
+    make_times(times, FRAMES);
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        // Same rotation with alternating signs
+        float s = (i & 1) ? -1.0f : 1.0f;
+        samples[i * 4 + 0] = 0.0f;
+        samples[i * 4 + 1] = s * sinf(0.25f);
+        samples[i * 4 + 2] = 0.0f;
+        samples[i * 4 + 3] = s * cosf(0.25f);
+    }
+
+    FittedTrack track;
+    TEST_ASSERT(fit_track(times, samples, FRAMES, 4, 1, 0.001f, &track), "Fit should succeed");
+    TEST_ASSERT_EQ(1, track.key_count, "Still track should keep a single key");
+    TEST_ASSERT(!track.cubic, "Single key should be LINEAR");
+    TEST_ASSERT(fabsf(track.values[3] - cosf(0.25f)) < 1e-6f, "Key should hold the first sample");
+    fitted_track_free(&track);
+    return 1;
+}
+
+static int test_linear_motion_stays_linear(void) {
+    float times[FRAMES];
+    float samples[FRAMES * 3];
+    make_times(times, FRAMES);
+    // Walks forward, stops halfway
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        samples[i * 3 + 0] = i < 60 ? (float)i * 0.1f : 6.0f;
+        samples[i * 3 + 1] = samples[i * 3 + 2] = 0.0f;
+    }
+
+    FittedTrack track;
+    TEST_ASSERT(fit_track(times, samples, FRAMES, 3, 0, 0.001f, &track), "Fit should succeed");
+    TEST_ASSERT(!track.cubic, "Piecewise linear motion should stay LINEAR");
+    TEST_ASSERT_EQ(3, track.key_count, "Start, stop and end keys expected");
+    TEST_ASSERT(fabsf(track.times[1] - 2.0f) < 1e-6f, "Middle key should sit where the motion stops");
+    fitted_track_free(&track);
+    return 1;
+}
+
+static int test_rotation_error_is_angular(void) {
+    float times[FRAMES];
+    float samples[FRAMES * 4];
+    make_times(times, FRAMES);
+    // Steady turn around Y: one slerp segment reproduces it exactly
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        float half = 0.5f * (float)i * 0.02f;
+        samples[i * 4 + 0] = 0.0f;
+        samples[i * 4 + 1] = sinf(half);
+        samples[i * 4 + 2] = 0.0f;
+        samples[i * 4 + 3] = cosf(half);
+    }
+
+    FittedTrack track;
+    TEST_ASSERT(fit_track(times, samples, FRAMES, 4, 1, 0.001f, &track), "Fit should succeed");
+    TEST_ASSERT(!track.cubic, "Constant angular speed should slerp");
+    TEST_ASSERT_EQ(2, track.key_count, "End keys should be enough");
+    fitted_track_free(&track);
+    return 1;
+}
+
+static int test_export_writes_cubicspline(void) {
+    static const char *const names[] = {"root", "hip"};
+    static const int parents[] = {-1, 0};
+    SkeletonDef *skel = fixture_skeleton(names, parents, 2);
+    PMDModel *model = fixture_model(0, 0, 2);
+
+    PSAAnimation *anim = fixture_anim("bob", 2, FRAMES);
+    for (uint32_t f = 0; f < FRAMES; f++) {
+        anim->boneStates[f * 2 + 1].translation = (Vector3D){0.0f, 1.0f + 0.2f * sinf((float)f / 30.0f * 0.5f * PI), 0.0f};
+    }
+
+    GltfExportOptions opts;
+    gltf_export_options_init(&opts);
+    opts.fit_error = 0.001f;
+    TEST_ASSERT(export_gltf_with_options(TEST_GLTF, model, &anim, 1, skel, "rig", NULL, NULL, &opts),
+                "Export should succeed");
+
+    cJSON *root = fixture_load_json(TEST_GLTF);
+    TEST_ASSERT_NOT_NULL(root, "Exported file should exist");
+    const cJSON *accessors = cJSON_GetObjectItem(root, "accessors");
+    const cJSON *animation = cJSON_GetArrayItem(cJSON_GetObjectItem(root, "animations"), 0);
+    const cJSON *samplers = cJSON_GetObjectItem(animation, "samplers");
+    TEST_ASSERT_EQ(4, cJSON_GetArraySize(samplers), "Two samplers per bone");
+
+    // Sampler 2: the hip translation
+    const cJSON *sampler = cJSON_GetArrayItem(samplers, 2);
+    TEST_ASSERT_STR_EQ("CUBICSPLINE", cJSON_GetObjectItem(sampler, "interpolation")->valuestring,
+                       "Bobbing should be fitted with cubic keys");
+    const cJSON *input = cJSON_GetArrayItem(accessors, cJSON_GetObjectItem(sampler, "input")->valueint);
+    const cJSON *output = cJSON_GetArrayItem(accessors, cJSON_GetObjectItem(sampler, "output")->valueint);
+    int keys = cJSON_GetObjectItem(input, "count")->valueint;
+    TEST_ASSERT(keys > 1 && keys * 10 <= FRAMES, "Cubic track should keep few keys");
+    TEST_ASSERT_EQ(keys * 3, cJSON_GetObjectItem(output, "count")->valueint, "Cubic output holds tangents and values");
+    float max = (float)cJSON_GetArrayItem(cJSON_GetObjectItem(input, "max"), 0)->valuedouble;
+    TEST_ASSERT(fabsf(max - 4.0f) < 1e-5f, "Fitted input should end on the last frame");
+
+    // Sampler 3: the hip rotation never moves
+    sampler = cJSON_GetArrayItem(samplers, 3);
+    TEST_ASSERT_STR_EQ("LINEAR", cJSON_GetObjectItem(sampler, "interpolation")->valuestring,
+                       "Still rotation should stay LINEAR");
+    input = cJSON_GetArrayItem(accessors, cJSON_GetObjectItem(sampler, "input")->valueint);
+    TEST_ASSERT_EQ(1, cJSON_GetObjectItem(input, "count")->valueint, "Still rotation should keep one key");
+
+    cJSON_Delete(root);
+    free_psa(anim);
+    free_pmd(model);
+    free_skeleton(skel);
+    remove(TEST_GLTF);
+    return 1;
+}
+
+int main(void) {
+    const test_case_t tests[] = {
+        {"smooth_cycle_goes_cubic", test_smooth_cycle_goes_cubic},
+        {"still_track_is_one_key", test_still_track_is_one_key},
+        {"linear_motion_stays_linear", test_linear_motion_stays_linear},
+        {"rotation_error_is_angular", test_rotation_error_is_angular},
+        {"export_writes_cubicspline", test_export_writes_cubicspline}
+    };
+
+    return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
+}
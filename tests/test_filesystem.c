@@ -111,13 +111,69 @@ static int test_find_files_nonexistent_directory(void) {
     return 1;
 }
 
+static int test_dir_index_prefix_queries(void) {
+    TEST_ASSERT(create_test_file("idx_horse_walk.psa", "a"), "Failed to create test file");
+    TEST_ASSERT(create_test_file("idx_horse_idle.psa", "a"), "Failed to create test file");
+    TEST_ASSERT(create_test_file("idx_horse.pmd", "a"), "Failed to create test file");
+    TEST_ASSERT(create_test_file("idx_horsey_run.psa", "a"), "Failed to create test file");
+    TEST_ASSERT(create_test_file("idx_cow_idle.psa", "a"), "Failed to create test file");
+
+    DirIndex *index = dir_index_build(".");
+    TEST_ASSERT_NOT_NULL(index, "Index should build");
+    for (uint32_t i = 1; i < index->count; i++) {
+        TEST_ASSERT(strcmp(index->names[i - 1], index->names[i]) <= 0, "Names should be sorted");
+    }
+
+    FileList *horse = dir_index_find(index, "idx_horse_*.psa");
+    FileList *cow = dir_index_find(index, "idx_cow_*.psa");
+    FileList *all = dir_index_find(index, "*.psa");
+    FileList *none = dir_index_find(index, "idx_zebra_*.psa");
+
+    TEST_ASSERT_NOT_NULL(horse, "Query should return a list");
+    TEST_ASSERT_EQ(2, horse->count, "Prefix query should not match longer base names");
+    TEST_ASSERT(strstr(horse->paths[0], "idx_horse_idle.psa") != NULL, "Results should be in name order");
+    TEST_ASSERT(strstr(horse->paths[1], "idx_horse_walk.psa") != NULL, "Results should be in name order");
+    TEST_ASSERT_EQ(1, cow->count, "Second query should reuse the same index");
+    TEST_ASSERT(all->count >= 4, "Pattern without prefix should scan every name");
+    TEST_ASSERT_EQ(0, none->count, "Missing prefix should return no files");
+
+    free_file_list(horse);
+    free_file_list(cow);
+    free_file_list(all);
+    free_file_list(none);
+    dir_index_free(index);
+
+    remove_test_file("idx_horse_walk.psa");
+    remove_test_file("idx_horse_idle.psa");
+    remove_test_file("idx_horse.pmd");
+    remove_test_file("idx_horsey_run.psa");
+    remove_test_file("idx_cow_idle.psa");
+    return 1;
+}
+
+static int test_dir_index_cache(void) {
+    DirIndexCache cache;
+    dir_index_cache_init(&cache);
+
+    const DirIndex *a = dir_index_cache_get(&cache, ".");
+    const DirIndex *b = dir_index_cache_get(&cache, ".");
+    TEST_ASSERT_NOT_NULL(a, "Index should build");
+    TEST_ASSERT(a == b, "Same directory should reuse its index");
+    TEST_ASSERT_EQ(1, cache.count, "Directory should be listed once");
+
+    dir_index_cache_free(&cache);
+    return 1;
+}
+
 int main(void) {
     const test_case_t tests[] = {
         {"create_and_free_file_list", test_create_and_free_file_list},
         {"find_files_with_pattern", test_find_files_with_pattern},
         {"find_files_specific_pattern", test_find_files_specific_pattern},
         {"free_null_list", test_free_null_list},
-        {"find_files_nonexistent_directory", test_find_files_nonexistent_directory}
+        {"find_files_nonexistent_directory", test_find_files_nonexistent_directory},
+        {"dir_index_prefix_queries", test_dir_index_prefix_queries},
+        {"dir_index_cache", test_dir_index_cache}
     };
     
     return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
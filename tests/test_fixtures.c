@@ -0,0 +1,85 @@
+#include "test_fixtures.h"
+#include "filesystem.h"
+#include "portable_string.h"
+#include <stdlib.h>
+
+SkeletonDef* fixture_skeleton(const char *const *names, const int *parents, int count) {
+    SkeletonDef *skel = skeleton_create(NULL);
+    if (!skel) return NULL;
+    for (int i = 0; i < count; i++) {
+        skeleton_add_bone(skel, names[i], parents[i]);
+    }
+    skeleton_build_index(skel);
+    return skel;
+}
+
+PMDModel* fixture_model(uint32_t vertex_count, uint32_t face_count, uint32_t bone_count) {
+    PMDModel *model = calloc(1, sizeof(PMDModel));
+    model->version = 3;
+    model->numTexCoords = 1;
+    model->numVertices = vertex_count;
+    model->vertices = calloc(vertex_count + 1, sizeof(Vertex));
+    for (uint32_t i = 0; i < vertex_count; i++) {
+        Vertex *v = &model->vertices[i];
+        v->normal = (Vector3D){0.0f, 0.0f, 1.0f};
+        v->coords = calloc(1, sizeof(TexCoord));
+        for (int k = 0; k < 4; k++) v->blend.bones[k] = 0xFF;
+    }
+    model->numFaces = face_count;
+    model->faces = calloc(face_count + 1, sizeof(Face));
+    model->numBones = bone_count;
+    model->restStates = calloc(bone_count + 1, sizeof(BoneState));
+    for (uint32_t b = 0; b < bone_count; b++) {
+        model->restStates[b].rotation.w = 1.0f;
+    }
+    return model;
+}
+
+PMDModel* fixture_grid_model(uint32_t side) {
+    PMDModel *model = fixture_model(side * side, (side - 1) * (side - 1) * 2, 4);
+    model->version = 4;
+    for (uint32_t i = 0; i < model->numVertices; i++) {
+        Vertex *v = &model->vertices[i];
+        v->position.x = (float)(i % side) - 0.5f * (float)side;
+        v->position.z = (float)(i / side);
+        v->position.y = (float)((i * 7) % 13) * 0.1f;
+        v->normal = (Vector3D){0.0f, 1.0f, 0.0f};
+        v->coords[0].u = (float)(i % side) / (float)side;
+        v->coords[0].v = (float)(i / side) / (float)side;
+        v->blend.bones[0] = (uint8_t)(i % 4);
+        v->blend.bones[1] = (uint8_t)((i + 1) % 4);
+        v->blend.weights[0] = 0.75f;
+        v->blend.weights[1] = 0.5f;
+    }
+    uint32_t f = 0;
+    for (uint32_t z = 0; z + 1 < side; z++) {
+        for (uint32_t x = 0; x + 1 < side; x++) {
+            uint32_t a = z * side + x;
+            model->faces[f++] = (Face){{a, a + side, a + 1}};
+            model->faces[f++] = (Face){{a + 1, a + side, a + side + 1}};
+        }
+    }
+    return model;
+}
+
+PSAAnimation* fixture_anim(const char *name, uint32_t bone_count, uint32_t frame_count) {
+    PSAAnimation *anim = calloc(1, sizeof(PSAAnimation));
+    anim->name = name ? my_strdup(name) : NULL;
+    anim->frameLength = 1.0f / 30.0f;
+    anim->numBones = bone_count;
+    anim->numFrames = frame_count;
+    anim->boneStates = calloc((size_t)bone_count * frame_count + 1, sizeof(BoneState));
+    for (size_t i = 0; i < (size_t)bone_count * frame_count; i++) {
+        anim->boneStates[i].rotation.w = 1.0f;
+    }
+    return anim;
+}
+
+cJSON* fixture_load_json(const char *path) {
+    size_t size = 0;
+    char *text = read_file(path, &size);
+    if (!text) return NULL;
+    cJSON *root = cJSON_Parse(text);
+    free(text);
+    return root;
+}
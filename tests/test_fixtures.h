@@ -0,0 +1,30 @@
+#ifndef TEST_FIXTURES_H
+#define TEST_FIXTURES_H
+
+#include "pmd_psa_types.h"
+#include "skeleton.h"
+#include "cJSON.h"
+
+// Small skeletons, models and clips built in memory for the exporter tests,
+// and the exported JSON read back. Models are freed with free_pmd(), clips
+// with free_psa() and skeletons with free_skeleton().
+
+// count bones named names[i], each under parents[i] (-1 for a root)
+SkeletonDef* fixture_skeleton(const char *const *names, const int *parents, int count);
+
+// vertex_count vertices at the origin with a +Z normal, one zeroed texture
+// coordinate set and no blend bones, face_count zeroed faces and bone_count
+// bones at the identity rest pose
+PMDModel* fixture_model(uint32_t vertex_count, uint32_t face_count, uint32_t bone_count);
+
+// side * side vertex grid on four bones, each vertex blended between two of
+// them; large enough grids split the vertex streams across threads
+PMDModel* fixture_grid_model(uint32_t side);
+
+// frame_count frames of bone_count bones at the identity; name may be NULL
+PSAAnimation* fixture_anim(const char *name, uint32_t bone_count, uint32_t frame_count);
+
+// Parsed JSON of an exported .gltf, NULL when missing or invalid
+cJSON* fixture_load_json(const char *path);
+
+#endif // TEST_FIXTURES_H
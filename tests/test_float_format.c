@@ -0,0 +1,115 @@
+#include "test_framework.h"
+#include "float_format.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static float float_from_bits(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static uint32_t bits_from_float(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// Significant digits of a formatted number, without leading or trailing zeros
+static int count_digits(const char *text) {
+    int digits = 0;
+    int zeros = 0;
+    for (const char *p = text; *p && *p != 'e'; p++) {
+        if (*p < '0' || *p > '9') continue;
+        if (*p == '0') {
+            if (digits) zeros++;
+            continue;
+        }
+        digits += zeros + 1;
+        zeros = 0;
+    }
+    return digits;
+}
+
+static int test_known_values(void) {
+    static const struct {
+        float value;
+        const char *text;
+    } cases[] = {
+        {0.0f, "0"}, {-0.0f, "0"}, {1.0f, "1"}, {-2.5f, "-2.5"}, {0.1f, "0.1"},
+        {100.0f, "100"}, {1.0f / 3.0f, "0.33333334"}, {0.0001f, "0.0001"}, {1e-5f, "1e-5"},
+        {123456.79f, "123456.79"}, {1e17f, "1e17"}, {16777216.0f, "16777216"},
+        {3.4028235e38f, "3.4028235e38"}, {1.17549435e-38f, "1.1754944e-38"}
+    };
+    char text[FLOAT_FORMAT_SIZE];
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        int length = format_float_shortest(cases[i].value, text);
+        TEST_ASSERT_EQ((int)strlen(text), length, "Returned length should match the text");
+        if (strcmp(text, cases[i].text) != 0) {
+            printf("  %s printed as %s\n", cases[i].text, text);
+            TEST_ASSERT(0, "Known value should print its shortest form");
+        }
+    }
+    format_float_shortest(float_from_bits(1), text);
+    TEST_ASSERT(strcmp(text, "1e-45") == 0, "Smallest subnormal should print as 1e-45");
+    format_float_shortest(float_from_bits(0x7FC00000u), text);
+    TEST_ASSERT(strcmp(text, "null") == 0, "NaN should print as null");
+    format_float_shortest(float_from_bits(0xFF800000u), text);
+    TEST_ASSERT(strcmp(text, "null") == 0, "Infinity should print as null");
+    return 1;
+}
+
+static int test_round_trip(void) {
+    char text[FLOAT_FORMAT_SIZE];
+    char shorter[32];
+    uint32_t checked = 0;
+    // Stride through every exponent and sign with a prime step
+    for (uint64_t b = 0; b <= 0xFFFFFFFFu; b += 4099) {
+        uint32_t bits = (uint32_t)b;
+        float value = float_from_bits(bits);
+        if (((bits >> 23) & 0xFF) == 0xFF || (bits & 0x7FFFFFFFu) == 0) continue;
+        format_float_shortest(value, text);
+        if (bits_from_float(strtof(text, NULL)) != bits) {
+            printf("  0x%08x printed as %s\n", bits, text);
+            TEST_ASSERT(0, "Printed text should parse back to the same float");
+        }
+        // One digit fewer, correctly rounded, must not round-trip. Powers of
+        // two are skipped: their rounding interval is lopsided.
+        int digits = count_digits(text);
+        if ((bits & 0x7FFFFFu) != 0 && digits > 1) {
+            snprintf(shorter, sizeof(shorter), "%.*e", digits - 2, (double)value);
+            if (bits_from_float(strtof(shorter, NULL)) == bits) {
+                printf("  0x%08x printed as %s, %s is shorter\n", bits, text, shorter);
+                TEST_ASSERT(0, "Printed text should be the shortest");
+            }
+        }
+        checked++;
+    }
+    TEST_ASSERT(checked > 1000000, "A million floats should be checked");
+    return 1;
+}
+
+static int test_length_bound(void) {
+    char text[FLOAT_FORMAT_SIZE];
+    int longest = 0;
+    for (uint32_t e = 0; e < 0xFF; e++) {
+        // Mantissas with nine significant digits at every exponent
+        uint32_t bits = 0x80000000u | (e << 23) | 0x7FFFFFu;
+        int length = format_float_shortest(float_from_bits(bits), text);
+        if (length > longest) longest = length;
+    }
+    TEST_ASSERT(longest < FLOAT_FORMAT_SIZE, "Output should fit FLOAT_FORMAT_SIZE");
+    return 1;
+}
+
+int main(void) {
+    const test_case_t tests[] = {
+        {"known_values", test_known_values},
+        {"round_trip", test_round_trip},
+        {"length_bound", test_length_bound}
+    };
+
+    return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
+}
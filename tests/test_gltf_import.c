@@ -0,0 +1,388 @@
+#include "test_framework.h"
+#include "test_fixtures.h"
+#include "gltf_importer.h"
+#include "gltf_exporter.h"
+#include "pmd_writer.h"
+#include "portable_string.h"
+#include <math.h>
+
+#define IMPORT_EPSILON 1e-4f
+#define TEST_GLTF "test_gltf_import.gltf"
+#define TEST_BASE "test_gltf_import_out"
+
+static int near(float a, float b) {
+    return fabsf(a - b) < IMPORT_EPSILON;
+}
+
+// Same rotation, allowing for the quaternion sign flip
+static int same_rotation(Quaternion a, Quaternion b) {
+    float d = a.x*b.x + a.y*b.y + a.z*b.z + a.w*b.w;
+    return fabsf(fabsf(d) - 1.0f) < IMPORT_EPSILON;
+}
+
+static SkeletonDef* make_skeleton(void) {
+    static const char *const names[] = {"root", "spine", "arm"};
+    static const int parents[] = {-1, 0, 1};
+    SkeletonDef *skel = fixture_skeleton(names, parents, 3);
+    snprintf(skel->title, sizeof(skel->title), "test_rig");
+    return skel;
+}
+
+// Triangle pair skinned to spine and arm, one prop on the arm
+static PMDModel* make_model(void) {
+    PMDModel *model = fixture_model(4, 2, 3);
+    for (uint32_t i = 0; i < 4; i++) {
+        Vertex *v = &model->vertices[i];
+        v->position = (Vector3D){(float)(i & 1), (float)(i >> 1), 0.5f};
+        v->coords[0].u = 0.25f * (float)i;
+        v->coords[0].v = 0.1f;
+        v->blend.bones[0] = 1;
+        v->blend.weights[0] = i < 2 ? 1.0f : 0.25f;
+        v->blend.bones[1] = i < 2 ? 0xFF : 2;
+        v->blend.weights[1] = i < 2 ? 0.0f : 0.75f;
+    }
+    model->faces[0] = (Face){{0, 1, 3}};
+    model->faces[1] = (Face){{0, 3, 2}};
+
+    Quaternion z90 = {0.0f, 0.0f, 0.70710678f, 0.70710678f};
+    model->restStates[0] = (BoneState){{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 1.0f}};
+    model->restStates[1] = (BoneState){{0.0f, 1.0f, 0.0f}, z90};
+    model->restStates[2] = (BoneState){{0.0f, 2.0f, 0.0f}, z90};
+
+    model->numPropPoints = 1;
+    model->propPoints = calloc(1, sizeof(PropPoint));
+    model->propPoints[0].name = my_strdup("hand");
+    model->propPoints[0].translation = (Vector3D){0.5f, 0.0f, 0.0f};
+    model->propPoints[0].rotation = (Quaternion){0.0f, 0.0f, 0.0f, 1.0f};
+    model->propPoints[0].bone = 2;
+    return model;
+}
+
+// Arm swings around Z while the other bones hold the rest pose
+static PSAAnimation* make_anim(const PMDModel *model) {
+    PSAAnimation *anim = fixture_anim("wave", model->numBones, 6);
+    for (uint32_t f = 0; f < anim->numFrames; f++) {
+        for (uint32_t b = 0; b < anim->numBones; b++) {
+            anim->boneStates[f * anim->numBones + b] = model->restStates[b];
+        }
+        float angle = 0.2f * (float)f;
+        anim->boneStates[f * anim->numBones + 2].rotation =
+            (Quaternion){0.0f, 0.0f, sinf(angle / 2.0f), cosf(angle / 2.0f)};
+    }
+    return anim;
+}
+
+static GltfImport* export_and_import(PMDModel *model, PSAAnimation *anim, const SkeletonDef *skel) {
+    PSAAnimation *anims[1] = {anim};
+    float speeds[1] = {50.0f};
+    if (!export_gltf(TEST_GLTF, model, anims, 1, skel, "test_rig", speeds, NULL)) return NULL;
+    return import_gltf(TEST_GLTF);
+}
+
+static int test_import_restores_model(void) {
+    SkeletonDef *skel = make_skeleton();
+    PMDModel *model = make_model();
+    PSAAnimation *anim = make_anim(model);
+    GltfImport *imp = export_and_import(model, anim, skel);
+    TEST_ASSERT_NOT_NULL(imp, "Exported glTF should import");
+
+    const PMDModel *out = imp->model;
+    TEST_ASSERT_EQ(model->numVertices, out->numVertices, "Vertex count should survive");
+    TEST_ASSERT_EQ(model->numFaces, out->numFaces, "Face count should survive");
+    TEST_ASSERT_EQ(model->numBones, out->numBones, "Bone count should survive");
+    TEST_ASSERT_EQ(1, (int)out->numPropPoints, "Prop should survive");
+
+    for (uint32_t i = 0; i < model->numVertices; i++) {
+        const Vertex *a = &model->vertices[i];
+        const Vertex *b = &out->vertices[i];
+        TEST_ASSERT(near(a->position.x, b->position.x) && near(a->position.y, b->position.y) &&
+                    near(a->position.z, b->position.z), "Positions should match");
+        TEST_ASSERT(near(a->coords[0].u, b->coords[0].u) && near(a->coords[0].v, b->coords[0].v),
+                    "UVs should be flipped back");
+        for (int k = 0; k < 2; k++) {
+            TEST_ASSERT_EQ(a->blend.bones[k], b->blend.bones[k], "Influence bones should map back");
+            TEST_ASSERT(near(a->blend.weights[k], b->blend.weights[k]), "Weights should match");
+        }
+    }
+    for (uint32_t f = 0; f < model->numFaces; f++) {
+        for (int k = 0; k < 3; k++) {
+            TEST_ASSERT_EQ(model->faces[f].vertices[k], out->faces[f].vertices[k], "Indices should match");
+        }
+    }
+    for (uint32_t b = 0; b < model->numBones; b++) {
+        const BoneState *a = &model->restStates[b];
+        const BoneState *c = &out->restStates[b];
+        TEST_ASSERT(near(a->translation.x, c->translation.x) && near(a->translation.y, c->translation.y) &&
+                    near(a->translation.z, c->translation.z), "Rest translation should match");
+        TEST_ASSERT(same_rotation(a->rotation, c->rotation), "Rest rotation should match");
+    }
+
+    TEST_ASSERT_STR_EQ("hand", out->propPoints[0].name, "Prop name should drop the prefix");
+    TEST_ASSERT_EQ(2, out->propPoints[0].bone, "Prop should stay on its bone");
+    TEST_ASSERT(near(0.5f, out->propPoints[0].translation.x), "Prop offset should match");
+
+    TEST_ASSERT_STR_EQ("test_rig", imp->skeleton->title, "Armature name should become the title");
+    TEST_ASSERT_STR_EQ("arm", imp->skeleton->bones[2].name, "Bone names should survive");
+    TEST_ASSERT_EQ(1, imp->skeleton->bones[2].parent_index, "Hierarchy should survive");
+
+    free_gltf_import(imp);
+    free_psa(anim);
+    free_pmd(model);
+    free_skeleton(skel);
+    remove(TEST_GLTF);
+    return 1;
+}
+
+static int test_import_resamples_animation(void) {
+    SkeletonDef *skel = make_skeleton();
+    PMDModel *model = make_model();
+    PSAAnimation *anim = make_anim(model);
+    GltfImport *imp = export_and_import(model, anim, skel);
+    TEST_ASSERT_NOT_NULL(imp, "Exported glTF should import");
+
+    TEST_ASSERT_EQ(1, (int)imp->anim_count, "Animation should be imported");
+    const PSAAnimation *out = imp->anims[0];
+    TEST_ASSERT_STR_EQ("wave", out->name, "Animation name should survive");
+    TEST_ASSERT_EQ(anim->numFrames, out->numFrames, "Frame grid should follow the keys");
+    TEST_ASSERT(near(50.0f, imp->anim_speeds[0]), "Key spacing should give back the speed");
+
+    for (uint32_t f = 0; f < anim->numFrames; f++) {
+        for (uint32_t b = 0; b < anim->numBones; b++) {
+            const BoneState *a = &anim->boneStates[f * anim->numBones + b];
+            const BoneState *c = &out->boneStates[f * out->numBones + b];
+            TEST_ASSERT(near(a->translation.y, c->translation.y), "Frame translation should match");
+            TEST_ASSERT(same_rotation(a->rotation, c->rotation), "Frame rotation should match");
+        }
+    }
+
+    free_gltf_import(imp);
+    free_psa(anim);
+    free_pmd(model);
+    free_skeleton(skel);
+    remove(TEST_GLTF);
+    return 1;
+}
+
+// Interleaved vertex view read back through byteStride and byteOffset
+static int check_layout_roundtrip(GltfOutputFormat format, const char *path) {
+    SkeletonDef *skel = make_skeleton();
+    PMDModel *model = make_model();
+    GltfExportOptions options;
+    gltf_export_options_init(&options);
+    options.format = format;
+    options.interleaved = 1;
+    TEST_ASSERT(export_gltf_with_options(path, model, NULL, 0, skel, "test_rig", NULL, NULL, &options),
+                "Interleaved export should succeed");
+
+    GltfImport *imp = import_gltf(path);
+    TEST_ASSERT_NOT_NULL(imp, "Interleaved output should import");
+    TEST_ASSERT_EQ(model->numVertices, imp->model->numVertices, "Vertex count should survive");
+    for (uint32_t i = 0; i < model->numVertices; i++) {
+        const Vertex *a = &model->vertices[i];
+        const Vertex *b = &imp->model->vertices[i];
+        TEST_ASSERT(near(a->position.x, b->position.x) && near(a->position.y, b->position.y) &&
+                    near(a->position.z, b->position.z), "Strided positions should match");
+        TEST_ASSERT(near(a->normal.z, b->normal.z), "Strided normals should match");
+        TEST_ASSERT(near(a->coords[0].u, b->coords[0].u), "Strided UVs should match");
+        TEST_ASSERT_EQ(a->blend.bones[0], b->blend.bones[0], "Strided joints should match");
+        TEST_ASSERT(near(a->blend.weights[0], b->blend.weights[0]), "Strided weights should match");
+    }
+    TEST_ASSERT_EQ(model->faces[1].vertices[2], imp->model->faces[1].vertices[2], "Indices should follow the vertex view");
+
+    free_gltf_import(imp);
+    free_pmd(model);
+    free_skeleton(skel);
+    return 1;
+}
+
+static int test_interleaved_glb(void) {
+    int ok = check_layout_roundtrip(GLTF_OUTPUT_GLB, "test_gltf_import.glb");
+    remove("test_gltf_import.glb");
+    return ok;
+}
+
+static int test_interleaved_separate_bin(void) {
+    int ok = check_layout_roundtrip(GLTF_OUTPUT_SEPARATE, "test_gltf_import_bin.gltf");
+    remove("test_gltf_import_bin.gltf");
+    remove("test_gltf_import_bin.bin");
+    return ok;
+}
+
+// componentType of the accessor behind a mesh attribute (or "indices")
+static int primitive_component_type(const char *path, const char *attribute) {
+    cJSON *root = fixture_load_json(path);
+    if (!root) return -1;
+    cJSON *primitive = cJSON_GetArrayItem(cJSON_GetObjectItem(cJSON_GetArrayItem(cJSON_GetObjectItem(root, "meshes"), 0), "primitives"), 0);
+    cJSON *index = strcmp(attribute, "indices") == 0 ? cJSON_GetObjectItem(primitive, "indices")
+                                                     : cJSON_GetObjectItem(cJSON_GetObjectItem(primitive, "attributes"), attribute);
+    cJSON *accessor = index ? cJSON_GetArrayItem(cJSON_GetObjectItem(root, "accessors"), index->valueint) : NULL;
+    cJSON *type = accessor ? cJSON_GetObjectItem(accessor, "componentType") : NULL;
+    int result = type ? type->valueint : -1;
+    cJSON_Delete(root);
+    return result;
+}
+
+static int test_small_mesh_uses_bytes(void) {
+    SkeletonDef *skel = make_skeleton();
+    PMDModel *model = make_model();
+    TEST_ASSERT(export_gltf(TEST_GLTF, model, NULL, 0, skel, "test_rig", NULL, NULL), "Export should succeed");
+    TEST_ASSERT_EQ(5121, primitive_component_type(TEST_GLTF, "indices"), "Four vertices fit byte indices");
+    TEST_ASSERT_EQ(5121, primitive_component_type(TEST_GLTF, "JOINTS_0"), "PMD joints fit in a byte");
+
+    GltfImport *imp = import_gltf(TEST_GLTF);
+    TEST_ASSERT_NOT_NULL(imp, "Byte streams should import");
+    TEST_ASSERT_EQ(2, imp->model->vertices[3].blend.bones[1], "Byte joints should map back");
+    TEST_ASSERT_EQ(3, (int)imp->model->faces[0].vertices[2], "Byte indices should map back");
+
+    free_gltf_import(imp);
+    free_pmd(model);
+    free_skeleton(skel);
+    remove(TEST_GLTF);
+    return 1;
+}
+
+static int test_accessor_bounds(void) {
+    SkeletonDef *skel = make_skeleton();
+    PMDModel *model = make_model();
+    PSAAnimation *anim = make_anim(model);
+    GltfImport *imp = export_and_import(model, anim, skel);
+    TEST_ASSERT_NOT_NULL(imp, "Exported glTF should import");
+    free_gltf_import(imp);
+
+    cJSON *root = fixture_load_json(TEST_GLTF);
+    TEST_ASSERT_NOT_NULL(root, "Exported glTF should parse");
+    cJSON *accessors = cJSON_GetObjectItem(root, "accessors");
+    cJSON *accessor;
+    cJSON_ArrayForEach(accessor, accessors) {
+        TEST_ASSERT(cJSON_GetObjectItem(accessor, "min") && cJSON_GetObjectItem(accessor, "max"),
+                    "Every accessor should have min and max");
+    }
+    cJSON *primitive = cJSON_GetArrayItem(cJSON_GetObjectItem(cJSON_GetArrayItem(cJSON_GetObjectItem(root, "meshes"), 0), "primitives"), 0);
+    cJSON *position = cJSON_GetArrayItem(accessors, cJSON_GetObjectItem(cJSON_GetObjectItem(primitive, "attributes"), "POSITION")->valueint);
+    TEST_ASSERT(cJSON_GetArrayItem(cJSON_GetObjectItem(position, "max"), 1)->valuedouble == 1.0, "POSITION max should be the data max");
+    TEST_ASSERT(cJSON_GetArrayItem(cJSON_GetObjectItem(position, "min"), 2)->valuedouble == 0.5, "POSITION min should be the data min");
+
+    // Played at 50%: six 30 fps frames last 2 * 5 / 30 seconds
+    cJSON *sampler = cJSON_GetArrayItem(cJSON_GetObjectItem(cJSON_GetArrayItem(cJSON_GetObjectItem(root, "animations"), 0), "samplers"), 0);
+    cJSON *input = cJSON_GetArrayItem(accessors, cJSON_GetObjectItem(sampler, "input")->valueint);
+    TEST_ASSERT(near(10.0f / 30.0f, (float)cJSON_GetArrayItem(cJSON_GetObjectItem(input, "max"), 0)->valuedouble),
+                "Time max should include the speed scale");
+
+    cJSON_Delete(root);
+    free_psa(anim);
+    free_pmd(model);
+    free_skeleton(skel);
+    remove(TEST_GLTF);
+    return 1;
+}
+
+// Triangle strip over vertex_count vertices, all on the spine
+static PMDModel* make_strip_model(uint32_t vertex_count) {
+    PMDModel *model = fixture_model(vertex_count, vertex_count - 2, 3);
+    for (uint32_t i = 0; i < vertex_count; i++) {
+        Vertex *v = &model->vertices[i];
+        v->position = (Vector3D){(float)(i / 2), (float)(i % 2), 0.0f};
+        v->blend.bones[0] = 1;
+        v->blend.weights[0] = 1.0f;
+    }
+    for (uint32_t f = 0; f < model->numFaces; f++) {
+        model->faces[f] = (Face){{f, f + 1, f + 2}};
+    }
+    return model;
+}
+
+// 255 and 65535 are primitive restart values for byte and short indices
+static int test_index_type_boundaries(void) {
+    static const struct {
+        uint32_t vertices;
+        int index_type;
+    } cases[] = {{255, 5121}, {256, 5123}, {65535, 5123}, {65536, 5125}};
+    SkeletonDef *skel = make_skeleton();
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        PMDModel *model = make_strip_model(cases[c].vertices);
+        TEST_ASSERT(export_gltf(TEST_GLTF, model, NULL, 0, skel, "test_rig", NULL, NULL), "Export should succeed");
+        if (primitive_component_type(TEST_GLTF, "indices") != cases[c].index_type) {
+            printf("  %u vertices\n", cases[c].vertices);
+            TEST_ASSERT(0, "Largest index should stay below the type's restart value");
+        }
+        TEST_ASSERT_EQ(5121, primitive_component_type(TEST_GLTF, "JOINTS_0"), "Joints may use the full byte range");
+        free_pmd(model);
+    }
+    free_skeleton(skel);
+    remove(TEST_GLTF);
+    return 1;
+}
+
+// Triangle strip past 65536 vertices, which PMD cannot store but glTF can
+static int test_large_mesh_uses_32bit_indices(void) {
+    const uint32_t vertex_count = 70000;
+    SkeletonDef *skel = make_skeleton();
+    PMDModel *model = make_strip_model(vertex_count);
+
+    TEST_ASSERT(export_gltf(TEST_GLTF, model, NULL, 0, skel, "test_rig", NULL, NULL), "Export should succeed");
+    TEST_ASSERT_EQ(5125, primitive_component_type(TEST_GLTF, "indices"), "Large mesh needs 32-bit indices");
+
+    GltfImport *imp = import_gltf(TEST_GLTF);
+    TEST_ASSERT_NOT_NULL(imp, "32-bit indices should import");
+    TEST_ASSERT_EQ(vertex_count, imp->model->numVertices, "Every vertex should be imported");
+    TEST_ASSERT_EQ(vertex_count - 1, imp->model->faces[model->numFaces - 1].vertices[2], "Indices past 65535 should survive");
+    TEST_ASSERT(!write_pmd(TEST_BASE ".pmd", imp->model), "PMD cannot store indices past 65535");
+
+    free_gltf_import(imp);
+    free_pmd(model);
+    free_skeleton(skel);
+    remove(TEST_GLTF);
+    remove(TEST_BASE ".pmd");
+    return 1;
+}
+
+static int test_write_import_files(void) {
+    SkeletonDef *skel = make_skeleton();
+    PMDModel *model = make_model();
+    PSAAnimation *anim = make_anim(model);
+    GltfImport *imp = export_and_import(model, anim, skel);
+    TEST_ASSERT_NOT_NULL(imp, "Exported glTF should import");
+    TEST_ASSERT(write_gltf_import(imp, TEST_BASE), "Import should write game files");
+
+    PMDModel *pmd = load_pmd(TEST_BASE ".pmd");
+    TEST_ASSERT_NOT_NULL(pmd, "Written PMD should load");
+    TEST_ASSERT_EQ(model->numVertices, pmd->numVertices, "Written PMD should keep the mesh");
+    TEST_ASSERT_EQ(1, (int)pmd->numPropPoints, "Written PMD should keep the prop");
+
+    PSAAnimation *psa = load_psa(TEST_BASE "_wave.psa");
+    TEST_ASSERT_NOT_NULL(psa, "Written PSA should load");
+    TEST_ASSERT_EQ(anim->numFrames, psa->numFrames, "Written PSA should keep the frames");
+
+    SkeletonDef *written = load_skeleton_json(TEST_BASE ".json");
+    TEST_ASSERT_NOT_NULL(written, "Written config should hold the skeleton");
+    TEST_ASSERT_EQ(3, written->bone_count, "Written skeleton should keep every bone");
+
+    free_skeleton(written);
+    free_psa(psa);
+    free_pmd(pmd);
+    free_gltf_import(imp);
+    free_psa(anim);
+    free_pmd(model);
+    free_skeleton(skel);
+    remove(TEST_GLTF);
+    remove(TEST_BASE ".pmd");
+    remove(TEST_BASE "_wave.psa");
+    remove(TEST_BASE ".json");
+    return 1;
+}
+
+int main(void) {
+    const test_case_t tests[] = {
+        {"import_restores_model", test_import_restores_model},
+        {"import_resamples_animation", test_import_resamples_animation},
+        {"interleaved_glb", test_interleaved_glb},
+        {"interleaved_separate_bin", test_interleaved_separate_bin},
+        {"small_mesh_uses_bytes", test_small_mesh_uses_bytes},
+        {"accessor_bounds", test_accessor_bounds},
+        {"index_type_boundaries", test_index_type_boundaries},
+        {"large_mesh_uses_32bit_indices", test_large_mesh_uses_32bit_indices},
+        {"write_import_files", test_write_import_files}
+    };
+
+    return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
+}
@@ -11,7 +11,12 @@
 #include <unistd.h>
 #endif
 #include "pmd_writer.h"
+#include "gltf_exporter.h"
+#include "parallel.h"
+#include "hash.h"
 #include "pmd_psa_types.h"
+#include "anim_resample.h"
+#include "test_fixtures.h"
 
 // Fonction utilitaire pour générer un cube PMD sans os
 static void create_cube_nobones(const char *filename) {
@@ -401,6 +406,240 @@ static void export_cube_5bones_gltf(const char *pmd_file, const char *gltf_file)
     free_pmd(model);
 }
 
+static int test_gltf_threaded_streams_match_serial(void) {
+    PMDModel *model = fixture_grid_model(300);
+    GltfExportOptions options;
+    gltf_export_options_init(&options);
+    options.threads = 1;
+    TEST_ASSERT(export_gltf_with_options("tests/output/grid_serial.gltf", model, NULL, 0, NULL, "grid", NULL, NULL, &options),
+                "Serial export should succeed");
+    options.threads = 4;
+    TEST_ASSERT(export_gltf_with_options("tests/output/grid_threaded.gltf", model, NULL, 0, NULL, "grid", NULL, NULL, &options),
+                "Threaded export should succeed");
+    free_pmd(model);
+
+    char *serial = read_file("tests/output/grid_serial.gltf");
+    char *threaded = read_file("tests/output/grid_threaded.gltf");
+    TEST_ASSERT(serial && threaded, "Both exports should be readable");
+    TEST_ASSERT(strcmp(serial, threaded) == 0, "Thread count should not change the output");
+
+    cJSON *root = cJSON_Parse(threaded);
+    TEST_ASSERT_NOT_NULL(root, "Should parse glTF JSON");
+    cJSON *position = cJSON_GetArrayItem(cJSON_GetObjectItem(root, "accessors"), 0);
+    TEST_ASSERT_EQ(90000, cJSON_GetObjectItem(position, "count")->valueint, "Every chunk should be written");
+    cJSON *min = cJSON_GetObjectItem(position, "min");
+    cJSON *max = cJSON_GetObjectItem(position, "max");
+    TEST_ASSERT(min && max, "POSITION accessor should have bounds");
+    TEST_ASSERT(cJSON_GetArrayItem(min, 0)->valuedouble == -150.0 && cJSON_GetArrayItem(max, 0)->valuedouble == 149.0,
+                "Bounds should span every chunk");
+    TEST_ASSERT(cJSON_GetArrayItem(max, 2)->valuedouble == 299.0, "Last chunk should reach the far edge");
+    cJSON_Delete(root);
+    free(serial);
+    free(threaded);
+    return 1;
+}
+
+// FNV-1a of a whole file, 0 when it cannot be read
+static uint64_t hash_file(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return 0;
+    uint64_t hash = HASH_FNV64_OFFSET;
+    unsigned char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        hash = hash_fnv1a64_update(hash, buf, n);
+    }
+    fclose(f);
+    return hash;
+}
+
+typedef struct {
+    PMDModel *model;
+    PSAAnimation *anims[2][2];  // the same clips listed in two orders
+    float speeds[2][2];
+    const char *paths[2];
+    int ok[2];
+} ReproducibleJob;
+
+// Both conversions of the job run at once, each on several threads
+static void reproducible_export_job(void *context, uint32_t begin, uint32_t end) {
+    ReproducibleJob *job = context;
+    GltfExportOptions options;
+    gltf_export_options_init(&options);
+    options.format = GLTF_OUTPUT_GLB;
+    options.reproducible = 1;
+    options.threads = 2;
+    for (uint32_t i = begin; i < end; i++) {
+        job->ok[i] = export_gltf_with_options(job->paths[i], job->model, job->anims[i], 2, NULL, "grid",
+                                              job->speeds[i], NULL, &options);
+    }
+}
+
+static int test_gltf_reproducible_output(void) {
+    PSAAnimation *walk = create_simple_4bones_anim();
+    PSAAnimation *idle = create_simple_4bones_anim();
+    free(walk->name);
+    walk->name = my_strdup("walk");
+    free(idle->name);
+    idle->name = my_strdup("idle");
+    idle->boneStates[5].translation.z = 0.5f;
+
+    ReproducibleJob job = {0};
+    job.model = fixture_grid_model(300);
+    job.anims[0][0] = walk;
+    job.anims[0][1] = idle;
+    job.speeds[0][0] = 50.0f;
+    job.speeds[0][1] = 100.0f;
+    job.anims[1][0] = idle;
+    job.anims[1][1] = walk;
+    job.speeds[1][0] = 100.0f;
+    job.speeds[1][1] = 50.0f;
+    job.paths[0] = "tests/output/repro_a.glb";
+    job.paths[1] = "tests/output/repro_b.glb";
+    parallel_for(2, 1, 2, reproducible_export_job, &job);
+    TEST_ASSERT(job.ok[0] && job.ok[1], "Concurrent exports should succeed");
+    uint64_t first = hash_file(job.paths[0]);
+    TEST_ASSERT(first != 0, "Export should be readable");
+    TEST_ASSERT(first == hash_file(job.paths[1]), "Clip listing order should not change the bytes");
+
+    // Once more, serially, over the previous file
+    job.paths[1] = "tests/output/repro_a.glb";
+    reproducible_export_job(&job, 1, 2);
+    TEST_ASSERT(job.ok[1], "Second export should succeed");
+    TEST_ASSERT(first == hash_file(job.paths[1]), "Converting again should give the same bytes");
+    free_pmd(job.model);
+
+    PMDModel *cube = load_pmd("tests/output/cube_nobones.pmd");
+    TEST_ASSERT_NOT_NULL(cube, "Cube should load");
+    TEST_ASSERT(export_gltf("tests/output/cube_nobones_crate.gltf", cube, NULL, 0, NULL, "crate", NULL, NULL),
+                "Cube should export");
+    free_pmd(cube);
+    char *content = read_file("tests/output/cube_nobones_crate.gltf");
+    TEST_ASSERT_NOT_NULL(content, "Cube glTF should exist");
+    cJSON *root = cJSON_Parse(content);
+    free(content);
+    const cJSON *mesh = cJSON_GetArrayItem(cJSON_GetObjectItem(root, "meshes"), 0);
+    TEST_ASSERT(strcmp(cJSON_GetStringValue(cJSON_GetObjectItem(mesh, "name")), "crate") == 0,
+                "Mesh name should not depend on the output path");
+    const cJSON *indices = cJSON_GetArrayItem(cJSON_GetObjectItem(root, "accessors"), 3);
+    TEST_ASSERT_EQ(36, cJSON_GetObjectItem(indices, "count")->valueint, "Every face should be indexed");
+    cJSON_Delete(root);
+    free_psa(walk);
+    free_psa(idle);
+    return 1;
+}
+
+// Two units on one rig: their clips go once into the rig's library
+static int test_gltf_animation_library(void) {
+    static const char *const names[] = {"root", "b1", "b2", "b3"};
+    static const int parents[] = {-1, 0, 0, 0};
+    SkeletonDef *skel = fixture_skeleton(names, parents, 4);
+    snprintf(skel->title, sizeof(skel->title), "cube rig");
+    PMDModel *model = load_pmd("tests/output/cube_4bones.pmd");
+    TEST_ASSERT_NOT_NULL(model, "Cube should load");
+    PSAAnimation *anim = create_simple_4bones_anim();
+
+    AnimLibrarySet libraries;
+    anim_library_set_init(&libraries);
+    GltfExportOptions opts;
+    gltf_export_options_init(&opts);
+    opts.anim_libraries = &libraries;
+    TEST_ASSERT(export_gltf_with_options("tests/output/unit_a.gltf", model, &anim, 1, skel, "unit_a", NULL, NULL, &opts) &&
+                export_gltf_with_options("tests/output/unit_b.gltf", model, &anim, 1, skel, "unit_b", NULL, NULL, &opts),
+                "Both units should export");
+    TEST_ASSERT_EQ(1, libraries.count, "One library per skeleton");
+    AnimLibrary *lib = libraries.libraries[0];
+    TEST_ASSERT_EQ(1, lib->clip_count, "The shared clip is stored once");
+    TEST_ASSERT_EQ(1, lib->reused, "The second unit reuses it");
+    TEST_ASSERT(strcmp(lib->stem, "cube_rig") == 0, "File name comes from the skeleton title");
+
+    char *content = read_file("tests/output/unit_b.gltf");
+    TEST_ASSERT_NOT_NULL(content, "Unit glTF should exist");
+    cJSON *root = cJSON_Parse(content);
+    free(content);
+    TEST_ASSERT(cJSON_GetObjectItem(root, "animations") == NULL, "Units keep no animations");
+    TEST_ASSERT_NOT_NULL(cJSON_GetObjectItem(root, "skins"), "Units keep their skin");
+    const cJSON *reference = cJSON_GetObjectItem(cJSON_GetObjectItem(root, "extras"), "animationLibrary");
+    TEST_ASSERT(strcmp(cJSON_GetStringValue(cJSON_GetObjectItem(reference, "uri")), "cube_rig.anims.gltf") == 0,
+                "Units reference the library file");
+    const cJSON *clip = cJSON_GetArrayItem(cJSON_GetObjectItem(reference, "animations"), 0);
+    TEST_ASSERT(strcmp(cJSON_GetStringValue(cJSON_GetObjectItem(clip, "name")), "test_anim") == 0,
+                "Units name their clips in the library");
+    cJSON_Delete(root);
+
+    TEST_ASSERT(export_anim_library("tests/output/cube_rig.anims.gltf", lib, &opts), "Library should export");
+    content = read_file("tests/output/cube_rig.anims.gltf");
+    TEST_ASSERT_NOT_NULL(content, "Library glTF should exist");
+    root = cJSON_Parse(content);
+    free(content);
+    const cJSON *nodes = cJSON_GetObjectItem(root, "nodes");
+    TEST_ASSERT_EQ(4, cJSON_GetArraySize(nodes), "One node per skeleton bone");
+    TEST_ASSERT(strcmp(cJSON_GetStringValue(cJSON_GetObjectItem(cJSON_GetArrayItem(nodes, 2), "name")), "b2") == 0,
+                "Nodes carry the skeleton names");
+    const cJSON *animation = cJSON_GetArrayItem(cJSON_GetObjectItem(root, "animations"), 0);
+    TEST_ASSERT_EQ(8, cJSON_GetArraySize(cJSON_GetObjectItem(animation, "channels")),
+                   "Every skeleton bone is animated");
+    const cJSON *channel = cJSON_GetArrayItem(cJSON_GetObjectItem(animation, "channels"), 7);
+    TEST_ASSERT_EQ(3, cJSON_GetObjectItem(cJSON_GetObjectItem(channel, "target"), "node")->valueint,
+                   "Channels target bone nodes directly");
+    cJSON_Delete(root);
+
+    anim_library_set_free(&libraries);
+    free_psa(anim);
+    free_pmd(model);
+    free_skeleton(skel);
+    return 1;
+}
+
+static int test_gltf_streamed_animation(void) {
+    PMDModel *model = load_pmd("tests/output/cube_4bones.pmd");
+    TEST_ASSERT_NOT_NULL(model, "Cube should load");
+    PSAAnimation *anim = create_simple_4bones_anim();
+    TEST_ASSERT(write_psa("tests/output/stream_anim.psa", anim), "PSA should be written");
+    PSAAnimation *stream = open_psa_stream("tests/output/stream_anim.psa");
+    TEST_ASSERT_NOT_NULL(stream, "PSA should open for streaming");
+    TEST_ASSERT(stream->boneStates == NULL, "Streamed frames stay on disk");
+    TEST_ASSERT_EQ(10, stream->numFrames, "Header gives the frame count");
+
+    BoneState states[3 * 4];
+    TEST_ASSERT(read_psa_frames(stream, 7, 3, states), "Last frames should be read");
+    TEST_ASSERT(memcmp(states, &anim->boneStates[7 * 4], sizeof(states)) == 0, "Frames match the PSA");
+    TEST_ASSERT(!read_psa_frames(stream, 8, 3, states), "Frames past the end are rejected");
+
+    GltfExportOptions opts;
+    gltf_export_options_init(&opts);
+    opts.format = GLTF_OUTPUT_SEPARATE;
+    TEST_ASSERT(export_gltf_with_options("tests/output/stream.gltf", model, &anim, 1, NULL, "stream", NULL, NULL, &opts),
+                "In-memory export should succeed");
+    uint64_t json_hash = hash_file("tests/output/stream.gltf");
+    uint64_t bin_hash = hash_file("tests/output/stream.bin");
+    // A window that does not divide the clip
+    opts.stream_window = 3;
+    TEST_ASSERT(export_gltf_with_options("tests/output/stream.gltf", model, &stream, 1, NULL, "stream", NULL, NULL, &opts),
+                "Streamed export should succeed");
+    TEST_ASSERT(json_hash == hash_file("tests/output/stream.gltf"), "Streamed JSON, accessor bounds included, matches");
+    TEST_ASSERT(bin_hash == hash_file("tests/output/stream.bin"), "Streamed tracks match");
+
+    opts.format = GLTF_OUTPUT_GLB;
+    TEST_ASSERT(!export_gltf_with_options("tests/output/stream.glb", model, &stream, 1, NULL, "stream", NULL, NULL, &opts),
+                "Streaming needs a separate .bin");
+    opts.format = GLTF_OUTPUT_SEPARATE;
+    opts.sample_rate = 15.0f;
+    TEST_ASSERT(!export_gltf_with_options("tests/output/stream.gltf", model, &stream, 1, NULL, "stream", NULL, NULL, &opts),
+                "Streamed clips cannot be resampled");
+    opts.sample_rate = 0.0f;
+    opts.clip_bounds = 1;
+    TEST_ASSERT(!export_gltf_with_options("tests/output/stream.gltf", model, &stream, 1, NULL, "stream", NULL, NULL, &opts),
+                "Streamed clips have no clip bounds");
+    PSAAnimation *resampled = resample_psa(stream, 30.0f, 15.0f, NULL, NULL, 0);
+    TEST_ASSERT(resampled == NULL, "Resampling a streamed clip is refused");
+
+    free_psa(stream);
+    free_psa(anim);
+    free_pmd(model);
+    return 1;
+}
+
 int main(void) {
     // Générer les PMD et glTF nécessaires dans tests/output
     create_cube_nobones("tests/output/cube_nobones.pmd");
@@ -417,7 +656,11 @@ int main(void) {
         {"gltf_mesh_name", test_gltf_mesh_name},
         {"gltf_valid_json", test_gltf_valid_json},
         {"gltf_required_fields", test_gltf_required_fields},
-        {"gltf_animation_export", test_gltf_animation_export}
+        {"gltf_animation_export", test_gltf_animation_export},
+        {"gltf_threaded_streams_match_serial", test_gltf_threaded_streams_match_serial},
+        {"gltf_reproducible_output", test_gltf_reproducible_output},
+        {"gltf_animation_library", test_gltf_animation_library},
+        {"gltf_streamed_animation", test_gltf_streamed_animation}
     };
     int result = run_tests(tests, sizeof(tests) / sizeof(tests[0]));
     // Nettoyage des fichiers générés
@@ -426,6 +669,18 @@ int main(void) {
         "tests/output/cube_nobones.gltf",
         "tests/output/cube_4bones.gltf",
         "tests/output/cube_5bones.gltf",
+        "tests/output/grid_serial.gltf",
+        "tests/output/grid_threaded.gltf",
+        "tests/output/unit_a.gltf",
+        "tests/output/unit_b.gltf",
+        "tests/output/cube_rig.anims.gltf",
+        "tests/output/repro_a.glb",
+        "tests/output/repro_b.glb",
+        "tests/output/cube_nobones_crate.gltf",
+        "tests/output/stream_anim.psa",
+        "tests/output/stream.gltf",
+        "tests/output/stream.bin",
+        "tests/output/stream.glb",
         "tests/output/cube_2bones_2props.gltf",
         "tests/output/cube_nobones.pmd",
         "tests/output/cube_4bones.pmd",
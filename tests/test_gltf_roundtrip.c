@@ -1,5 +1,6 @@
 #include "test_framework.h"
 #include "pmd_writer.h"
+#include "gltf_exporter.h"
 #include "pmd_psa_types.h"
 #include "../vendor/cJSON/cJSON.h"
 #include <math.h>
@@ -0,0 +1,53 @@
+#include "test_framework.h"
+#include "joint_bounds.h"
+#include <string.h>
+
+// Column-major translation
+static void translation(float x, float y, float z, float *m) {
+    memset(m, 0, 16 * sizeof(float));
+    m[0] = m[5] = m[10] = m[15] = 1.0f;
+    m[12] = x;
+    m[13] = y;
+    m[14] = z;
+}
+
+static int test_vertices_go_to_heaviest_joint(void) {
+    float positions[9] = {1.0f, 0.0f, 0.0f, 3.0f, 1.0f, 0.0f, 5.0f, 5.0f, 5.0f};
+    uint32_t joints[12] = {0, 1, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0};
+    float weights[12] = {0.7f, 0.3f, 0, 0, 0.6f, 0.4f, 0, 0, 0.5f, 0.5f, 0, 0};
+    float ibm[32];
+    translation(0.0f, 0.0f, 0.0f, &ibm[0]);
+    // Joint 1 sits at x = 2 in the bind pose
+    translation(-2.0f, 0.0f, 0.0f, &ibm[16]);
+
+    JointBounds bounds[3];
+    joint_bounds_compute(positions, joints, weights, 3, ibm, 2, bounds);
+    TEST_ASSERT_EQ(1, bounds[0].vertices, "Joint 0 dominates one vertex");
+    TEST_ASSERT(bounds[0].min[0] == 1.0f && bounds[0].max[0] == 1.0f, "Joint 0 box is its vertex");
+    TEST_ASSERT_EQ(2, bounds[1].vertices, "Ties go to the first influence");
+    TEST_ASSERT(bounds[1].min[0] == 1.0f && bounds[1].max[0] == 3.0f, "Boxes are in joint space");
+    TEST_ASSERT(bounds[1].min[1] == 1.0f && bounds[1].max[2] == 5.0f, "Every axis is bounded");
+    return 1;
+}
+
+static int test_unowned_joints_stay_empty(void) {
+    float positions[3] = {1.0f, 2.0f, 3.0f};
+    uint32_t joints[4] = {7, 0, 0, 0};
+    float weights[4] = {1.0f, 0, 0, 0};
+    float ibm[32];
+    translation(0.0f, 0.0f, 0.0f, &ibm[0]);
+    translation(0.0f, 0.0f, 0.0f, &ibm[16]);
+    JointBounds bounds[2];
+    joint_bounds_compute(positions, joints, weights, 1, ibm, 2, bounds);
+    TEST_ASSERT(bounds[0].vertices == 0 && bounds[1].vertices == 0, "Joints past the count and zero weights are skipped");
+    return 1;
+}
+
+int main(void) {
+    const test_case_t tests[] = {
+        {"vertices_go_to_heaviest_joint", test_vertices_go_to_heaviest_joint},
+        {"unowned_joints_stay_empty", test_unowned_joints_stay_empty}
+    };
+
+    return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
+}
@@ -0,0 +1,247 @@
+#include "test_framework.h"
+#include "test_fixtures.h"
+#include "mesh_simplify.h"
+#include "gltf_exporter.h"
+#include <math.h>
+
+#define TEST_GLTF "test_mesh_simplify.gltf"
+#define GRID 16
+
+// (GRID+1)^2 vertices on z = height(x, y), left half on joint 0 and right
+// half on joint 1. With seam set, the middle column is split: triangles to
+// its right use duplicates with their own UVs, as an unwrapped seam would.
+typedef struct {
+    float positions[(GRID + 2) * (GRID + 1) * 3];
+    float texcoords[(GRID + 2) * (GRID + 1) * 2];
+    uint32_t joints[(GRID + 2) * (GRID + 1) * 4];
+    float weights[(GRID + 2) * (GRID + 1) * 4];
+    uint32_t indices[GRID * GRID * 6];
+    uint32_t vertex_count;
+    uint32_t index_count;
+} Grid;
+
+static void add_vertex(Grid *g, float x, float y, float z, float u) {
+    uint32_t v = g->vertex_count++;
+    g->positions[v * 3 + 0] = x;
+    g->positions[v * 3 + 1] = y;
+    g->positions[v * 3 + 2] = z;
+    g->texcoords[v * 2 + 0] = u;
+    g->texcoords[v * 2 + 1] = y / GRID;
+    g->joints[v * 4] = x * 2 < GRID ? 0 : 1;
+    g->weights[v * 4] = 1.0f;
+}
+
+static void make_grid(Grid *g, int seam, float bump) {
+    memset(g, 0, sizeof(*g));
+    for (int y = 0; y <= GRID; y++) {
+        for (int x = 0; x <= GRID; x++) {
+            float z = bump * sinf((float)x) * cosf((float)y);
+            add_vertex(g, (float)x, (float)y, z, (float)x / GRID);
+        }
+    }
+    uint32_t first_seam = g->vertex_count;
+    if (seam) {
+        for (int y = 0; y <= GRID; y++) {
+            const float *p = &g->positions[(y * (GRID + 1) + GRID / 2) * 3];
+            add_vertex(g, p[0], p[1], p[2], 0.75f);
+        }
+    }
+    for (int y = 0; y < GRID; y++) {
+        for (int x = 0; x < GRID; x++) {
+            uint32_t q[4] = {y * (GRID + 1) + x, y * (GRID + 1) + x + 1,
+                             (y + 1) * (GRID + 1) + x, (y + 1) * (GRID + 1) + x + 1};
+            if (seam && x == GRID / 2) {
+                q[0] = first_seam + y;
+                q[2] = first_seam + y + 1;
+            }
+            uint32_t *t = &g->indices[g->index_count];
+            t[0] = q[0]; t[1] = q[1]; t[2] = q[3];
+            t[3] = q[0]; t[4] = q[3]; t[5] = q[2];
+            g->index_count += 6;
+        }
+    }
+}
+
+static SimplifyMesh grid_mesh(const Grid *g) {
+    SimplifyMesh mesh = {g->positions, g->texcoords, g->joints, g->weights, g->vertex_count};
+    return mesh;
+}
+
+static int references(const uint32_t *indices, uint32_t count, uint32_t vertex) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (indices[i] == vertex) return 1;
+    }
+    return 0;
+}
+
+static int test_flat_grid_simplifies_exactly(void) {
+    static Grid g;
+    make_grid(&g, 0, 0.0f);
+    SimplifyMesh mesh = grid_mesh(&g);
+    uint32_t out[GRID * GRID * 6];
+    float error = -1.0f;
+
+    uint32_t count = simplify_mesh(&mesh, g.indices, g.index_count, g.index_count / 4, 1.0f, out, &error);
+    TEST_ASSERT(count > 0, "Simplified grid should keep triangles");
+    TEST_ASSERT(count <= g.index_count / 2, "Flat grid should lose at least half its triangles");
+    TEST_ASSERT_EQ(0, (int)(count % 3), "Output should be a triangle list");
+    TEST_ASSERT(error < 1e-4f, "Collapses on a plane should not move the surface");
+
+    float extent = mesh_extent(&mesh, g.indices, g.index_count);
+    TEST_ASSERT(fabsf(extent - GRID * sqrtf(2.0f)) < 1e-4f, "Extent should be the grid diagonal");
+    return 1;
+}
+
+static int test_seam_stays_closed(void) {
+    static Grid g;
+    make_grid(&g, 1, 0.0f);
+    SimplifyMesh mesh = grid_mesh(&g);
+    uint32_t out[GRID * GRID * 6];
+    float error = 0.0f;
+
+    uint32_t count = simplify_mesh(&mesh, g.indices, g.index_count, 0, 1.0f, out, &error);
+    TEST_ASSERT(count < g.index_count / 4, "Seamed grid should simplify along the seam too");
+    for (int y = 0; y <= GRID; y++) {
+        uint32_t left = y * (GRID + 1) + GRID / 2;
+        uint32_t right = (GRID + 1) * (GRID + 1) + y;
+        TEST_ASSERT_EQ(references(out, count, left), references(out, count, right),
+                       "Both sides of the seam should keep the same vertices");
+    }
+    uint32_t corners[4] = {0, GRID, GRID * (GRID + 1), (GRID + 1) * (GRID + 1) - 1};
+    for (int c = 0; c < 4; c++) {
+        TEST_ASSERT(references(out, count, corners[c]), "Corners should be locked");
+    }
+    TEST_ASSERT(references(out, count, GRID / 2), "Seam ends on the border should be locked");
+    return 1;
+}
+
+static int test_error_limit_stops_collapses(void) {
+    static Grid g;
+    make_grid(&g, 0, 0.5f);
+    SimplifyMesh mesh = grid_mesh(&g);
+    uint32_t out[GRID * GRID * 6];
+    float loose_error = 0.0f, tight_error = 0.0f;
+
+    uint32_t loose = simplify_mesh(&mesh, g.indices, g.index_count, 0, 10.0f, out, &loose_error);
+    uint32_t tight = simplify_mesh(&mesh, g.indices, g.index_count, 0, 0.01f, out, &tight_error);
+    TEST_ASSERT(tight > loose, "A tighter error limit should keep more triangles");
+    TEST_ASSERT(tight_error <= 0.01f, "Reported error should respect the limit");
+    TEST_ASSERT(loose_error > tight_error, "Deeper simplification should report more error");
+    return 1;
+}
+
+// Flat skinned grid through the exporter
+static PMDModel* make_grid_model(void) {
+    static Grid g;
+    make_grid(&g, 0, 0.0f);
+
+    PMDModel *model = fixture_model(g.vertex_count, g.index_count / 3, 3);
+    for (uint32_t i = 0; i < g.vertex_count; i++) {
+        Vertex *v = &model->vertices[i];
+        v->position = (Vector3D){g.positions[i * 3], g.positions[i * 3 + 1], g.positions[i * 3 + 2]};
+        v->coords[0].u = g.texcoords[i * 2];
+        v->coords[0].v = g.texcoords[i * 2 + 1];
+        v->blend.bones[0] = (uint8_t)(g.joints[i * 4] + 1);
+        v->blend.weights[0] = 1.0f;
+    }
+    for (uint32_t f = 0; f < model->numFaces; f++) {
+        model->faces[f] = (Face){{g.indices[f * 3], g.indices[f * 3 + 1], g.indices[f * 3 + 2]}};
+    }
+    return model;
+}
+
+static int accessor_count(const cJSON *root, int accessor) {
+    const cJSON *acc = cJSON_GetArrayItem(cJSON_GetObjectItem(root, "accessors"), accessor);
+    return cJSON_GetObjectItem(acc, "count")->valueint;
+}
+
+static int mesh_indices(const cJSON *root, int mesh) {
+    const cJSON *m = cJSON_GetArrayItem(cJSON_GetObjectItem(root, "meshes"), mesh);
+    const cJSON *prim = cJSON_GetArrayItem(cJSON_GetObjectItem(m, "primitives"), 0);
+    return cJSON_GetObjectItem(prim, "indices")->valueint;
+}
+
+static int test_export_emits_msft_lod(void) {
+    static const char *const names[] = {"root", "left", "right"};
+    static const int parents[] = {-1, 0, 0};
+    SkeletonDef *skel = fixture_skeleton(names, parents, 3);
+    PMDModel *model = make_grid_model();
+
+    GltfExportOptions opts;
+    gltf_export_options_init(&opts);
+    opts.lod_levels = 3;
+    TEST_ASSERT(export_gltf_with_options(TEST_GLTF, model, NULL, 0, skel, "grid", NULL, NULL, &opts),
+                "Export with LODs should succeed");
+
+    cJSON *root = fixture_load_json(TEST_GLTF);
+    TEST_ASSERT_NOT_NULL(root, "Exported file should be valid JSON");
+
+    const cJSON *used = cJSON_GetArrayItem(cJSON_GetObjectItem(root, "extensionsUsed"), 0);
+    TEST_ASSERT(used && strcmp(used->valuestring, "MSFT_lod") == 0, "MSFT_lod should be declared");
+    TEST_ASSERT_EQ(3, cJSON_GetArraySize(cJSON_GetObjectItem(root, "meshes")), "Two LOD meshes expected");
+
+    const cJSON *nodes = cJSON_GetObjectItem(root, "nodes");
+    const cJSON *mesh_node = cJSON_GetArrayItem(nodes, 1);
+    const cJSON *ids = cJSON_GetObjectItem(cJSON_GetObjectItem(cJSON_GetObjectItem(mesh_node, "extensions"), "MSFT_lod"), "ids");
+    const cJSON *coverage = cJSON_GetObjectItem(cJSON_GetObjectItem(mesh_node, "extras"), "MSFT_screencoverage");
+    TEST_ASSERT_EQ(2, cJSON_GetArraySize(ids), "Mesh node should list both LOD nodes");
+    TEST_ASSERT_EQ(3, cJSON_GetArraySize(coverage), "One coverage hint per level plus the cull threshold");
+
+    int previous = accessor_count(root, mesh_indices(root, 0));
+    for (int l = 0; l < 2; l++) {
+        const cJSON *lod_node = cJSON_GetArrayItem(nodes, cJSON_GetArrayItem(ids, l)->valueint);
+        TEST_ASSERT_EQ(l + 1, cJSON_GetObjectItem(lod_node, "mesh")->valueint, "LOD node should point at its mesh");
+        TEST_ASSERT_NOT_NULL(cJSON_GetObjectItem(lod_node, "skin"), "LOD node should stay skinned");
+        int count = accessor_count(root, mesh_indices(root, l + 1));
+        TEST_ASSERT(count < previous, "Each level should have fewer indices");
+        previous = count;
+    }
+
+    cJSON_Delete(root);
+    free_pmd(model);
+    free_skeleton(skel);
+    remove(TEST_GLTF);
+    return 1;
+}
+
+// Without bones there is no skin for the mesh or LOD nodes to reference
+static int test_unskinned_lods_have_no_skin(void) {
+    PMDModel *model = make_grid_model();
+    for (uint32_t i = 0; i < model->numVertices; i++) model->vertices[i].blend.bones[0] = 0xFF;
+    model->numBones = 0;
+
+    GltfExportOptions opts;
+    gltf_export_options_init(&opts);
+    opts.lod_levels = 3;
+    TEST_ASSERT(export_gltf_with_options(TEST_GLTF, model, NULL, 0, NULL, "grid", NULL, NULL, &opts),
+                "Export with LODs should succeed");
+
+    cJSON *root = fixture_load_json(TEST_GLTF);
+    TEST_ASSERT_NOT_NULL(root, "Exported file should be valid JSON");
+    TEST_ASSERT(cJSON_GetObjectItem(root, "skins") == NULL, "Unskinned model has no skins");
+    const cJSON *nodes = cJSON_GetObjectItem(root, "nodes");
+    const cJSON *node;
+    int lod_nodes = 0;
+    cJSON_ArrayForEach(node, nodes) {
+        TEST_ASSERT(cJSON_GetObjectItem(node, "skin") == NULL, "No node should reference a skin");
+        if (cJSON_GetObjectItem(node, "mesh")) lod_nodes++;
+    }
+    TEST_ASSERT_EQ(3, lod_nodes, "Mesh node and both LOD nodes are written");
+
+    cJSON_Delete(root);
+    free_pmd(model);
+    remove(TEST_GLTF);
+    return 1;
+}
+
+int main(void) {
+    const test_case_t tests[] = {
+        {"flat_grid_simplifies_exactly", test_flat_grid_simplifies_exactly},
+        {"seam_stays_closed", test_seam_stays_closed},
+        {"error_limit_stops_collapses", test_error_limit_stops_collapses},
+        {"export_emits_msft_lod", test_export_emits_msft_lod},
+        {"unskinned_lods_have_no_skin", test_unskinned_lods_have_no_skin}
+    };
+
+    return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
+}
@@ -0,0 +1,93 @@
+#include "test_framework.h"
+#include "model_config.h"
+
+#define TEST_CONFIG_JSON "test_model_config_tmp.json"
+#define TEST_CONFIG_JSON_B "test_model_config_tmp_b.json"
+
+static int write_text_file(const char *path, const char *text) {
+    FILE *f = fopen(path, "w");
+    if (!f) return 0;
+    fputs(text, f);
+    fclose(f);
+    return 1;
+}
+
+static int test_config_reads_skeleton_and_speeds(void) {
+    TEST_ASSERT(write_text_file(TEST_CONFIG_JSON,
+        "{\"skeleton\": {\"title\": \"horse\", \"bones\": [{\"name\": \"root\", \"parent_index\": -1},"
+        " {\"name\": \"tail\", \"parent_index\": 0}]},"
+        " \"animation_speeds\": {\"Walk\": 120, \"run\": 80.5, \"idle\": \"fast\", \"walk\": 10}}"),
+        "Failed to write config JSON");
+
+    SkeletonCache skeletons;
+    skeleton_cache_init(&skeletons);
+    ModelConfig *config = model_config_load(TEST_CONFIG_JSON, &skeletons);
+    remove(TEST_CONFIG_JSON);
+
+    TEST_ASSERT_NOT_NULL(config, "Config should load");
+    TEST_ASSERT_NOT_NULL(config->skeleton, "Skeleton should be read");
+    TEST_ASSERT_EQ(2, config->skeleton->bone_count, "Skeleton should have 2 bones");
+    TEST_ASSERT(model_config_anim_speed(config, "walk", 100.0f) == 120.0f, "Lookup should ignore case, first wins");
+    TEST_ASSERT(model_config_anim_speed(config, "run", 100.0f) == 80.5f, "Fractional speed should be kept");
+    TEST_ASSERT(model_config_anim_speed(config, "idle", 100.0f) == 100.0f, "Non-numeric speed should use fallback");
+    TEST_ASSERT(model_config_anim_speed(config, "missing", 100.0f) == 100.0f, "Missing speed should use fallback");
+
+    model_config_free(config);
+    skeleton_cache_free(&skeletons);
+    return 1;
+}
+
+static int test_config_without_speeds(void) {
+    TEST_ASSERT(write_text_file(TEST_CONFIG_JSON, "{\"skeleton\": {\"bones\": []}}"), "Failed to write config JSON");
+
+    SkeletonCache skeletons;
+    skeleton_cache_init(&skeletons);
+    ModelConfig *config = model_config_load(TEST_CONFIG_JSON, &skeletons);
+    remove(TEST_CONFIG_JSON);
+
+    TEST_ASSERT_NOT_NULL(config, "Config should load");
+    TEST_ASSERT_EQ(0, (int)config->speed_count, "No speeds should be read");
+    TEST_ASSERT(model_config_anim_speed(config, "walk", 100.0f) == 100.0f, "Fallback should be used");
+    TEST_ASSERT_NULL(model_config_load("does_not_exist.json", &skeletons), "Missing file should fail");
+
+    model_config_free(config);
+    skeleton_cache_free(&skeletons);
+    return 1;
+}
+
+static int test_config_cache_reuses_configs(void) {
+    const char *rig = "{\"skeleton\": {\"bones\": [{\"name\": \"root\", \"parent_index\": -1}]}";
+    char text[256];
+    snprintf(text, sizeof(text), "%s, \"animation_speeds\": {\"walk\": 50}}", rig);
+    TEST_ASSERT(write_text_file(TEST_CONFIG_JSON, text), "Failed to write config JSON");
+    snprintf(text, sizeof(text), "%s, \"animation_speeds\": {\"walk\": 75}}", rig);
+    TEST_ASSERT(write_text_file(TEST_CONFIG_JSON_B, text), "Failed to write config JSON");
+
+    ModelConfigCache cache;
+    model_config_cache_init(&cache);
+    const ModelConfig *a = model_config_cache_get(&cache, TEST_CONFIG_JSON);
+    const ModelConfig *again = model_config_cache_get(&cache, TEST_CONFIG_JSON);
+    const ModelConfig *b = model_config_cache_get(&cache, TEST_CONFIG_JSON_B);
+    remove(TEST_CONFIG_JSON);
+    remove(TEST_CONFIG_JSON_B);
+
+    TEST_ASSERT_NOT_NULL(a, "First config should load");
+    TEST_ASSERT_NOT_NULL(b, "Second config should load");
+    TEST_ASSERT(a == again, "Same path should return the cached config");
+    TEST_ASSERT(a->skeleton == b->skeleton, "Configs should share the skeleton");
+    TEST_ASSERT(model_config_anim_speed(b, "walk", 100.0f) == 75.0f, "Speeds should stay per model");
+    TEST_ASSERT_EQ(1, (int)cache.skeletons.count, "One skeleton should be interned");
+
+    model_config_cache_free(&cache);
+    return 1;
+}
+
+int main(void) {
+    const test_case_t tests[] = {
+        {"config_reads_skeleton_and_speeds", test_config_reads_skeleton_and_speeds},
+        {"config_without_speeds", test_config_without_speeds},
+        {"config_cache_reuses_configs", test_config_cache_reuses_configs}
+    };
+
+    return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
+}
@@ -0,0 +1,104 @@
+#include "test_framework.h"
+#include "output_writer.h"
+#include "filesystem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_OUTPUT "test_output_writer.out"
+
+// Read path whole into buf; returns its size, or -1 when it cannot be read
+static long read_output(const char *path, char *buf, size_t capacity) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return -1;
+    size_t size = fread(buf, 1, capacity, file);
+    fclose(file);
+    return (long)size;
+}
+
+static int file_exists(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return 0;
+    fclose(file);
+    return 1;
+}
+
+// Temporary files of TEST_OUTPUT (<path>.<pid>.tmp) still in the working
+// directory
+static uint32_t temp_files_left(void) {
+    FileList *list = find_files(".", TEST_OUTPUT "*.tmp");
+    uint32_t count = list ? list->count : 0;
+    free_file_list(list);
+    return count;
+}
+
+static int test_chunks_written_in_order(void) {
+    OutputChunk chunks[4] = {
+        {"glTF", 4}, {"", 0}, {"{\"asset\":{}}", 12}, {"  ", 2}
+    };
+    TEST_ASSERT(output_write_chunks(TEST_OUTPUT, chunks, 4, 0), "Chunks should be written");
+    char buf[64];
+    long size = read_output(TEST_OUTPUT, buf, sizeof(buf));
+    TEST_ASSERT_EQ(18, size, "File holds every chunk");
+    TEST_ASSERT(memcmp(buf, "glTF{\"asset\":{}}  ", 18) == 0, "Chunks appear in order");
+    remove(TEST_OUTPUT);
+    return 1;
+}
+
+static int test_many_chunks(void) {
+    // More chunks than one writev call takes
+    enum { COUNT = 1000 };
+    static unsigned char bytes[COUNT];
+    static OutputChunk chunks[COUNT];
+    for (int i = 0; i < COUNT; i++) {
+        bytes[i] = (unsigned char)(i * 7);
+        chunks[i].data = &bytes[i];
+        chunks[i].size = i % 3 == 0 ? 0 : 1;
+    }
+    TEST_ASSERT(output_write_chunks(TEST_OUTPUT, chunks, COUNT, 0), "Chunks should be written");
+    static char buf[COUNT];
+    long size = read_output(TEST_OUTPUT, buf, sizeof(buf));
+    int expected = 0, ok = 1;
+    for (int i = 0; i < COUNT; i++) {
+        if (chunks[i].size == 0) continue;
+        if (expected < size && (unsigned char)buf[expected] != bytes[i]) ok = 0;
+        expected++;
+    }
+    TEST_ASSERT_EQ(expected, size, "Every non-empty chunk is written");
+    TEST_ASSERT(ok, "Bytes keep their chunk order");
+    remove(TEST_OUTPUT);
+    return 1;
+}
+
+static int test_atomic_replaces_file(void) {
+    OutputChunk old_chunks[1] = {{"previous contents that are longer", 33}};
+    TEST_ASSERT(output_write_chunks(TEST_OUTPUT, old_chunks, 1, 0), "Old file should be written");
+    OutputChunk chunks[2] = {{"new", 3}, {"\n", 1}};
+    TEST_ASSERT(output_write_chunks(TEST_OUTPUT, chunks, 2, 1), "Atomic write should succeed");
+    char buf[64];
+    long size = read_output(TEST_OUTPUT, buf, sizeof(buf));
+    TEST_ASSERT_EQ(4, size, "Old contents are replaced, not overwritten in place");
+    TEST_ASSERT(memcmp(buf, "new\n", 4) == 0, "New contents are in place");
+    TEST_ASSERT_EQ(0, (int)temp_files_left(), "No temporary file is left");
+    remove(TEST_OUTPUT);
+    return 1;
+}
+
+static int test_failure_leaves_target(void) {
+    OutputChunk chunks[1] = {{"data", 4}};
+    TEST_ASSERT(!output_write_chunks("missing_dir/out.gltf", chunks, 1, 0), "Missing directory fails");
+    TEST_ASSERT(!output_write_chunks("missing_dir/out.gltf", chunks, 1, 1), "Atomic write fails too");
+    TEST_ASSERT(!file_exists("missing_dir/out.gltf"), "Nothing is created");
+    return 1;
+}
+
+int main(void) {
+    const test_case_t tests[] = {
+        {"chunks_written_in_order", test_chunks_written_in_order},
+        {"many_chunks", test_many_chunks},
+        {"atomic_replaces_file", test_atomic_replaces_file},
+        {"failure_leaves_target", test_failure_leaves_target}
+    };
+
+    return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
+}
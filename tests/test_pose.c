@@ -0,0 +1,127 @@
+#include "test_framework.h"
+#include "pose.h"
+#include "transform.h"
+#include <math.h>
+
+#define POSE_EPSILON 1e-5f
+
+static int near(float a, float b) {
+    return fabsf(a - b) < POSE_EPSILON;
+}
+
+static BoneState make_state(float tx, float ty, float tz, Quaternion q) {
+    BoneState s;
+    s.translation.x = tx;
+    s.translation.y = ty;
+    s.translation.z = tz;
+    s.rotation = q;
+    return s;
+}
+
+// 90 degrees around Z
+static Quaternion quat_z90(void) {
+    Quaternion q = {0.0f, 0.0f, 0.70710678f, 0.70710678f};
+    return q;
+}
+
+static Quaternion quat_identity(void) {
+    Quaternion q = {0.0f, 0.0f, 0.0f, 1.0f};
+    return q;
+}
+
+// Chain declared child-first: bone 0 is the child of bone 1
+static SkeletonDef* make_chain(void) {
+    SkeletonDef *skel = skeleton_create(NULL);
+    if (!skel) return NULL;
+    skeleton_add_bone(skel, "hand", 1);
+    skeleton_add_bone(skel, "root", -1);
+    if (!skeleton_build_index(skel)) {
+        free_skeleton(skel);
+        return NULL;
+    }
+    return skel;
+}
+
+static int test_world_to_local(void) {
+    SkeletonDef *skel = make_chain();
+    TEST_ASSERT_NOT_NULL(skel, "Skeleton should build");
+
+    SkeletonPose pose;
+    TEST_ASSERT(pose_init(&pose, skel, 2), "Pose should init");
+    TEST_ASSERT_EQ(1, (int)pose.order[0], "Parent should be evaluated first");
+
+    BoneState world[2];
+    world[0] = make_state(1.0f, 3.0f, 0.0f, quat_z90());
+    world[1] = make_state(1.0f, 2.0f, 0.0f, quat_z90());
+    pose_evaluate_world(&pose, world, 2, NULL, 0);
+
+    // Child is one unit along world +Y, i.e. along the parent's local +X
+    TEST_ASSERT(near(1.0f, pose.local[0].translation.x), "Local X should be 1");
+    TEST_ASSERT(near(0.0f, pose.local[0].translation.y), "Local Y should be 0");
+    TEST_ASSERT(near(1.0f, pose.local[0].rotation.w), "Local rotation should be identity");
+    TEST_ASSERT(near(1.0f, pose.local[1].translation.x), "Root local should equal world");
+
+    // Matrix translation column matches the world state
+    TEST_ASSERT(near(2.0f, pose.world_matrices[16 + 13]), "Root matrix translation Y should be 2");
+    TEST_ASSERT(near(3.0f, pose.world_matrices[13]), "Child matrix translation Y should be 3");
+
+    pose_free(&pose);
+    free_skeleton(skel);
+    return 1;
+}
+
+static int test_local_roundtrip(void) {
+    SkeletonDef *skel = make_chain();
+    TEST_ASSERT_NOT_NULL(skel, "Skeleton should build");
+
+    SkeletonPose pose;
+    TEST_ASSERT(pose_init(&pose, skel, 2), "Pose should init");
+
+    BoneState local[2];
+    local[0] = make_state(1.0f, 0.0f, 0.0f, quat_identity());
+    local[1] = make_state(0.0f, 0.0f, 5.0f, quat_z90());
+    pose_evaluate_local(&pose, local, 2);
+
+    TEST_ASSERT(near(0.0f, pose.world[0].translation.x), "World X should be rotated away");
+    TEST_ASSERT(near(1.0f, pose.world[0].translation.y), "World Y should be 1");
+    TEST_ASSERT(near(5.0f, pose.world[0].translation.z), "World Z should follow the parent");
+
+    pose_free(&pose);
+    free_skeleton(skel);
+    return 1;
+}
+
+static int test_fallback_and_extra_bones(void) {
+    SkeletonDef *skel = make_chain();
+    TEST_ASSERT_NOT_NULL(skel, "Skeleton should build");
+
+    // Third bone is not in the skeleton and becomes a root
+    SkeletonPose pose;
+    TEST_ASSERT(pose_init(&pose, skel, 3), "Pose should init");
+    TEST_ASSERT_EQ(-1, pose.parents[2], "Bone past the skeleton should be a root");
+
+    BoneState frame[1];
+    frame[0] = make_state(0.0f, 1.0f, 0.0f, quat_identity());
+    BoneState rest[2];
+    rest[0] = make_state(9.0f, 9.0f, 9.0f, quat_identity());
+    rest[1] = make_state(0.0f, 0.0f, 0.0f, quat_identity());
+    pose_evaluate_world(&pose, frame, 1, rest, 2);
+
+    TEST_ASSERT(near(1.0f, pose.world[0].translation.y), "Frame state should win");
+    TEST_ASSERT(near(0.0f, pose.world[1].translation.x), "Missing frame bone should use fallback");
+    TEST_ASSERT(near(1.0f, pose.world[2].rotation.w), "Bone missing everywhere should be identity");
+
+    pose_free(&pose);
+    free_skeleton(skel);
+    return 1;
+}
+
+int main(void) {
+    const test_case_t tests[] = {
+        {"world_to_local", test_world_to_local},
+        {"local_roundtrip", test_local_roundtrip},
+        {"fallback_and_extra_bones", test_fallback_and_extra_bones}
+    };
+
+    return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
+}
@@ -0,0 +1,258 @@
+#include "test_framework.h"
+#include "skeleton.h"
+#include "skeleton_cache.h"
+#include "json_span.h"
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#define TEST_SKELETON_JSON "test_skeleton_tmp.json"
+#define TEST_SKELETON_JSON_B "test_skeleton_tmp_b.json"
+
+// Write a skeleton JSON with a single chain of bone_count bones
+static int write_chain_skeleton(const char *path, int bone_count) {
+    FILE *f = fopen(path, "w");
+    if (!f) return 0;
+    fprintf(f, "{\"skeleton\": {\"title\": \"chain\", \"bones\": [");
+    for (int i = 0; i < bone_count; i++) {
+        fprintf(f, "%s{\"name\": \"bone_%d\", \"parent_index\": %d}", i ? ", " : "", i, i - 1);
+    }
+    fprintf(f, "]}}");
+    fclose(f);
+    return 1;
+}
+
+static int test_large_skeleton_not_truncated(void) {
+    TEST_ASSERT(write_chain_skeleton(TEST_SKELETON_JSON, 200), "Failed to write skeleton JSON");
+    SkeletonDef *skel = load_skeleton_json(TEST_SKELETON_JSON);
+    remove(TEST_SKELETON_JSON);
+
+    TEST_ASSERT_NOT_NULL(skel, "Skeleton should load");
+    TEST_ASSERT_EQ(200, skel->bone_count, "All 200 bones should be kept");
+    TEST_ASSERT_STR_EQ("bone_199", skel->bones[199].name, "Last bone name should be preserved");
+    TEST_ASSERT_EQ(198, skel->bones[199].parent_index, "Last bone parent should be preserved");
+
+    free_skeleton(skel);
+    return 1;
+}
+
+static int test_children_lists(void) {
+    SkeletonDef *skel = skeleton_create(NULL);
+    TEST_ASSERT_NOT_NULL(skel, "Skeleton should be created");
+    skeleton_add_bone(skel, "root", -1);
+    skeleton_add_bone(skel, "spine", 0);
+    skeleton_add_bone(skel, "leg_l", 0);
+    skeleton_add_bone(skel, "head", 1);
+    skeleton_add_bone(skel, "leg_r", 0);
+    TEST_ASSERT(skeleton_build_index(skel), "Index should build");
+
+    int count = 0;
+    const int *children = skeleton_children(skel, 0, &count);
+    TEST_ASSERT_EQ(3, count, "Root should have 3 children");
+    TEST_ASSERT_EQ(1, children[0], "Children should keep declaration order");
+    TEST_ASSERT_EQ(2, children[1], "Children should keep declaration order");
+    TEST_ASSERT_EQ(4, children[2], "Children should keep declaration order");
+
+    skeleton_children(skel, 3, &count);
+    TEST_ASSERT_EQ(0, count, "Leaf should have no children");
+
+    free_skeleton(skel);
+    return 1;
+}
+
+static int test_topological_order(void) {
+    // Children declared before their parents
+    SkeletonDef *skel = skeleton_create(NULL);
+    TEST_ASSERT_NOT_NULL(skel, "Skeleton should be created");
+    skeleton_add_bone(skel, "hand", 2);
+    skeleton_add_bone(skel, "root", -1);
+    skeleton_add_bone(skel, "arm", 1);
+    TEST_ASSERT(skeleton_build_index(skel), "Index should build");
+
+    TEST_ASSERT_EQ(1, skel->root_count, "Should have one root");
+    TEST_ASSERT_EQ(1, skel->topo_order[0], "Root should come first");
+    TEST_ASSERT_EQ(2, skel->topo_order[1], "Arm should follow root");
+    TEST_ASSERT_EQ(0, skel->topo_order[2], "Hand should follow arm");
+
+    free_skeleton(skel);
+    return 1;
+}
+
+static int test_invalid_parents_become_roots(void) {
+    SkeletonDef *skel = skeleton_create(NULL);
+    TEST_ASSERT_NOT_NULL(skel, "Skeleton should be created");
+    skeleton_add_bone(skel, "a", 1);
+    skeleton_add_bone(skel, "b", 0);
+    skeleton_add_bone(skel, "c", 42);
+    TEST_ASSERT(skeleton_build_index(skel), "Index should build");
+
+    TEST_ASSERT_EQ(-1, skel->bones[2].parent_index, "Out of range parent should be reset");
+    TEST_ASSERT_EQ(2, skel->root_count, "Cycle should be cut into one extra root");
+    int seen[3] = {0, 0, 0};
+    for (int i = 0; i < skel->bone_count; i++) seen[skel->topo_order[i]]++;
+    TEST_ASSERT(seen[0] == 1 && seen[1] == 1 && seen[2] == 1, "Every bone should appear once in order");
+
+    free_skeleton(skel);
+    return 1;
+}
+
+static int test_find_bone_by_name(void) {
+    SkeletonDef *skel = skeleton_create(NULL);
+    TEST_ASSERT_NOT_NULL(skel, "Skeleton should be created");
+    char name[32];
+    for (int i = 0; i < 100; i++) {
+        snprintf(name, sizeof(name), "bone_%d", i);
+        skeleton_add_bone(skel, name, i - 1);
+    }
+    TEST_ASSERT(skeleton_build_index(skel), "Index should build");
+
+    TEST_ASSERT_EQ(0, skeleton_find_bone(skel, "bone_0"), "Should find first bone");
+    TEST_ASSERT_EQ(57, skeleton_find_bone(skel, "bone_57"), "Should find middle bone");
+    TEST_ASSERT_EQ(-1, skeleton_find_bone(skel, "missing"), "Missing bone should return -1");
+
+    free_skeleton(skel);
+    return 1;
+}
+
+static int write_text_file(const char *path, const char *text) {
+    FILE *f = fopen(path, "w");
+    if (!f) return 0;
+    fputs(text, f);
+    fclose(f);
+    return 1;
+}
+
+static int test_json_find_member(void) {
+    const char *text = "{\"title\": \"a } tricky \\\" string\", \"nested\": {\"skeleton\": 1},"
+                       " \"Skeleton\": {\"bones\": [1, {\"x\": \"]\"}]}, \"n\": -2.5e3}";
+    JsonSpan span;
+
+    TEST_ASSERT(json_find_member(text, strlen(text), "skeleton", &span), "Top-level member should be found");
+    TEST_ASSERT(span.size == strlen("{\"bones\": [1, {\"x\": \"]\"}]}"), "Span should cover the whole object");
+    TEST_ASSERT(strncmp(span.data, "{\"bones\":", 9) == 0, "Span should start at the value");
+
+    TEST_ASSERT(json_find_member(text, strlen(text), "n", &span), "Number member should be found");
+    TEST_ASSERT(span.size == 6 && strncmp(span.data, "-2.5e3", 6) == 0, "Number span should be exact");
+
+    TEST_ASSERT(!json_find_member(text, strlen(text), "x", &span), "Nested keys should not match");
+    TEST_ASSERT(!json_find_member("[1, 2]", 6, "skeleton", &span), "Arrays have no members");
+    return 1;
+}
+
+static int test_cache_shares_identical_skeletons(void) {
+    // Same rig, different animation speeds
+    TEST_ASSERT(write_text_file(TEST_SKELETON_JSON,
+        "{\"skeleton\": {\"title\": \"biped\", \"bones\": [{\"name\": \"root\", \"parent_index\": -1}]},"
+        " \"animation_speeds\": {\"walk\": 120}}"), "Failed to write skeleton JSON");
+    TEST_ASSERT(write_text_file(TEST_SKELETON_JSON_B,
+        "{\"animation_speeds\": {\"run\": 80}, \"skeleton\": {\"title\": \"biped\","
+        " \"bones\": [{\"name\": \"root\", \"parent_index\": -1}]}}"), "Failed to write skeleton JSON");
+
+    SkeletonCache cache;
+    skeleton_cache_init(&cache);
+    const SkeletonDef *a = skeleton_cache_load(&cache, TEST_SKELETON_JSON);
+    const SkeletonDef *b = skeleton_cache_load(&cache, TEST_SKELETON_JSON_B);
+
+    TEST_ASSERT_NOT_NULL(a, "First skeleton should load");
+    TEST_ASSERT(a == b, "Identical skeletons should be shared");
+    TEST_ASSERT_EQ(1, (int)cache.count, "Only one skeleton should be interned");
+    TEST_ASSERT_EQ(1, (int)cache.misses, "Skeleton should be parsed once");
+    TEST_ASSERT_EQ(0, skeleton_find_bone(a, "root"), "Shared skeleton should keep its name index");
+
+    // A different rig gets its own entry
+    TEST_ASSERT(write_chain_skeleton(TEST_SKELETON_JSON_B, 3), "Failed to write skeleton JSON");
+    const SkeletonDef *c = skeleton_cache_load(&cache, TEST_SKELETON_JSON_B);
+    remove(TEST_SKELETON_JSON);
+    remove(TEST_SKELETON_JSON_B);
+
+    TEST_ASSERT_NOT_NULL(c, "Second rig should load");
+    TEST_ASSERT(a != c, "Different skeletons should not be shared");
+    TEST_ASSERT_EQ(3, c->bone_count, "Second rig should have its own bones");
+    TEST_ASSERT_EQ(2, (int)cache.count, "Two skeletons should be interned");
+
+    skeleton_cache_free(&cache);
+    return 1;
+}
+
+static const char *TEST_SKELETONS_XML =
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+    "<skeletons>\n"
+    "  <!-- <standard_skeleton id=\"commented\"><bone name=\"x\"/></standard_skeleton> -->\n"
+    "  <standard_skeleton title=\"Biped\" id=\"biped\">\n"
+    "    <bone name=\"root\">\n"
+    "      <bone name=\"spine\">\n"
+    "        <bone name=\"head\"/>\n"
+    "      </bone>\n"
+    "      <bone name=\"leg &amp; hip\"></bone>\n"
+    "    </bone>\n"
+    "  </standard_skeleton>\n"
+    "  <skeleton title=\"Mapping\" target=\"biped\">\n"
+    "    <bone name=\"ignored\"><target>root</target></bone>\n"
+    "  </skeleton>\n"
+    "  <standard_skeleton title=\"Horse\" id=\"horse\">\n"
+    "    <bone name=\"body\"><bone name=\"tail\"/></bone>\n"
+    "  </standard_skeleton>\n"
+    "</skeletons>\n";
+
+static int test_xml_index_all_skeletons(void) {
+    SkeletonXmlIndex *index = skeleton_xml_index_parse(TEST_SKELETONS_XML, strlen(TEST_SKELETONS_XML), "skeletons.xml");
+    TEST_ASSERT_NOT_NULL(index, "XML should be indexed");
+    TEST_ASSERT_EQ(2, index->skeleton_count, "Only standard skeletons should be indexed");
+    TEST_ASSERT_EQ(6, index->bone_count, "Mapping skeleton bones should be skipped");
+
+    SkeletonDef *horse = skeleton_xml_index_get(index, "horse");
+    TEST_ASSERT_NOT_NULL(horse, "Horse should be found");
+    TEST_ASSERT_STR_EQ("Horse", horse->title, "Title should be read");
+    TEST_ASSERT_EQ(2, horse->bone_count, "Horse should have its own bones only");
+    TEST_ASSERT_EQ(0, horse->bones[1].parent_index, "Parent should be relative to the skeleton");
+    free_skeleton(horse);
+
+    SkeletonDef *biped = skeleton_xml_index_get(index, "biped");
+    TEST_ASSERT_NOT_NULL(biped, "Biped should be found");
+    TEST_ASSERT_EQ(4, biped->bone_count, "Biped should have 4 bones");
+    TEST_ASSERT_EQ(1, biped->bones[skeleton_find_bone(biped, "head")].parent_index, "Head should hang off spine");
+    TEST_ASSERT_EQ(0, biped->bones[skeleton_find_bone(biped, "leg & hip")].parent_index, "Entities should be decoded");
+    free_skeleton(biped);
+
+    TEST_ASSERT_NULL(skeleton_xml_index_get(index, "commented"), "Commented skeletons should be ignored");
+    skeleton_xml_index_free(index);
+    return 1;
+}
+
+static int test_xml_file_helpers(void) {
+    const char *path = "test_skeleton_tmp.xml";
+    TEST_ASSERT(write_text_file(path, TEST_SKELETONS_XML), "Failed to write skeleton XML");
+
+    char *first = get_first_skeleton_id(path);
+    SkeletonDef *skel = load_skeleton_xml(path, "horse");
+    SkeletonDef *missing = load_skeleton_xml(path, "missing");
+    remove(path);
+
+    TEST_ASSERT_NOT_NULL(first, "First skeleton id should be found");
+    TEST_ASSERT_STR_EQ("biped", first, "First id should follow file order");
+    TEST_ASSERT_NOT_NULL(skel, "Skeleton should load by id");
+    TEST_ASSERT_STR_EQ("horse", skel->skeleton_id, "Skeleton id should be kept");
+    TEST_ASSERT_NULL(missing, "Unknown id should fail");
+
+    free(first);
+    free_skeleton(skel);
+    return 1;
+}
+
+int main(void) {
+    const test_case_t tests[] = {
+        {"large_skeleton_not_truncated", test_large_skeleton_not_truncated},
+        {"children_lists", test_children_lists},
+        {"topological_order", test_topological_order},
+        {"invalid_parents_become_roots", test_invalid_parents_become_roots},
+        {"find_bone_by_name", test_find_bone_by_name},
+        {"json_find_member", test_json_find_member},
+        {"cache_shares_identical_skeletons", test_cache_shares_identical_skeletons},
+        {"xml_index_all_skeletons", test_xml_index_all_skeletons},
+        {"xml_file_helpers", test_xml_file_helpers}
+    };
+
+    return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
+}
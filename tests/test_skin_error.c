@@ -0,0 +1,126 @@
+#include "test_framework.h"
+#include "skin_error.h"
+#include <math.h>
+#include <stdlib.h>
+
+// Two bones at the origin, one vertex bound to each, 1 unit along X
+static PMDModel* make_model(void) {
+    PMDModel *model = calloc(1, sizeof(PMDModel));
+    model->numVertices = 2;
+    model->vertices = calloc(2, sizeof(Vertex));
+    for (uint32_t i = 0; i < 2; i++) {
+        model->vertices[i].position = (Vector3D){1.0f, (float)i, 0.0f};
+        model->vertices[i].blend.bones[0] = (uint8_t)i;
+        model->vertices[i].blend.weights[0] = 1.0f;
+        model->vertices[i].blend.bones[1] = model->vertices[i].blend.bones[2] = model->vertices[i].blend.bones[3] = 0xFF;
+    }
+    model->numBones = 2;
+    model->restStates = calloc(2, sizeof(BoneState));
+    model->restStates[0].rotation.w = 1.0f;
+    model->restStates[1].rotation.w = 1.0f;
+    return model;
+}
+
+static void free_model(PMDModel *model) {
+    free(model->vertices);
+    free(model->restStates);
+    free(model);
+}
+
+// Bone 1 slides along Y by step units per frame
+static PSAAnimation* make_anim(uint32_t frames, float step) {
+    PSAAnimation *anim = calloc(1, sizeof(PSAAnimation));
+    anim->frameLength = 1.0f / 30.0f;
+    anim->numBones = 2;
+    anim->numFrames = frames;
+    anim->boneStates = calloc(frames * 2, sizeof(BoneState));
+    for (uint32_t f = 0; f < frames; f++) {
+        anim->boneStates[f * 2].rotation.w = 1.0f;
+        anim->boneStates[f * 2 + 1].rotation.w = 1.0f;
+        anim->boneStates[f * 2 + 1].translation.y = step * (float)f;
+    }
+    return anim;
+}
+
+static void free_anim(PSAAnimation *anim) {
+    free(anim->boneStates);
+    free(anim);
+}
+
+static int test_skins_by_world_states(void) {
+    PMDModel *model = make_model();
+    BoneState states[2] = {{{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.70710678f, 0.70710678f}},
+                           {{0.0f, 0.0f, 2.0f}, {0.0f, 0.0f, 0.0f, 1.0f}}};
+    float out[6];
+    TEST_ASSERT(skin_positions(model, states, 2, out), "Skinning should succeed");
+    TEST_ASSERT(fabsf(out[0]) < 1e-5f && fabsf(out[1] - 1.0f) < 1e-5f, "Bone 0 turns its vertex 90 degrees");
+    TEST_ASSERT(fabsf(out[5] - 2.0f) < 1e-6f, "Bone 1 lifts its vertex");
+
+    TEST_ASSERT(skin_positions(model, states, 1, out), "Skinning should succeed");
+    TEST_ASSERT(fabsf(out[3] - 1.0f) < 1e-6f && out[5] == 0.0f, "Bones past the states keep their rest pose");
+    free_model(model);
+    return 1;
+}
+
+static int test_identical_animations_have_no_error(void) {
+    PMDModel *model = make_model();
+    PSAAnimation *anim = make_anim(10, 0.1f);
+    SkinError error;
+    TEST_ASSERT(measure_skin_error(model, anim, 1.0f / 30.0f, model, anim, 1.0f / 30.0f, &error),
+                "Measure should succeed");
+    TEST_ASSERT_EQ(10, error.frames, "Every reference frame should be compared");
+    TEST_ASSERT(error.max_error == 0.0 && error.rms_error == 0.0, "Same tracks should not move any vertex");
+    free_anim(anim);
+    free_model(model);
+    return 1;
+}
+
+static int test_offset_gives_max_and_rms(void) {
+    PMDModel *model = make_model();
+    PSAAnimation *reference = make_anim(4, 0.0f);
+    PSAAnimation *candidate = make_anim(4, 0.0f);
+    // Frame 3 of the candidate is 0.5 units off on one of two vertices
+    candidate->boneStates[3 * 2 + 1].translation.x = 0.5f;
+    SkinError error;
+    TEST_ASSERT(measure_skin_error(model, reference, 1.0f / 30.0f, model, candidate, 1.0f / 30.0f, &error),
+                "Measure should succeed");
+    TEST_ASSERT(fabs(error.max_error - 0.5) < 1e-6, "Max is the largest displacement");
+    TEST_ASSERT(fabs(error.rms_error - 0.5 / sqrt(8.0)) < 1e-6, "RMS spreads over every vertex and frame");
+    free_anim(reference);
+    free_anim(candidate);
+    free_model(model);
+    return 1;
+}
+
+static int test_candidate_sampled_at_reference_times(void) {
+    PMDModel *model = make_model();
+    PSAAnimation *reference = make_anim(11, 0.1f);
+    // Half the keys, twice the distance per key: same motion
+    PSAAnimation *candidate = make_anim(6, 0.2f);
+    SkinError error;
+    TEST_ASSERT(measure_skin_error(model, reference, 1.0f / 30.0f, model, candidate, 1.0f / 15.0f, &error),
+                "Measure should succeed");
+    TEST_ASSERT(error.max_error < 1e-5, "Candidate should be interpolated between its keys");
+
+    PMDModel *other = make_model();
+    other->numVertices = 1;
+    TEST_ASSERT(!measure_skin_error(model, reference, 1.0f / 30.0f, other, candidate, 1.0f / 15.0f, &error),
+                "Different meshes cannot be compared");
+    other->numVertices = 2;
+    free_model(other);
+    free_anim(reference);
+    free_anim(candidate);
+    free_model(model);
+    return 1;
+}
+
+int main(void) {
+    const test_case_t tests[] = {
+        {"skins_by_world_states", test_skins_by_world_states},
+        {"identical_animations_have_no_error", test_identical_animations_have_no_error},
+        {"offset_gives_max_and_rms", test_offset_gives_max_and_rms},
+        {"candidate_sampled_at_reference_times", test_candidate_sampled_at_reference_times}
+    };
+
+    return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
+}
@@ -0,0 +1,188 @@
+#include "test_framework.h"
+#include "test_fixtures.h"
+#include "skin_optimize.h"
+#include "gltf_exporter.h"
+#include <math.h>
+
+#define TEST_GLTF "test_skin_optimize.gltf"
+
+static void set_vertex(uint32_t *joints, float *weights, uint32_t v,
+                       const uint32_t j[4], const float w[4]) {
+    for (int i = 0; i < 4; i++) {
+        joints[v * 4 + i] = j[i];
+        weights[v * 4 + i] = w[i];
+    }
+}
+
+static int test_limits_influences(void) {
+    uint32_t joints[4];
+    float weights[4];
+    set_vertex(joints, weights, 0, (uint32_t[]){8, 5, 7, 6}, (float[]){0.1f, 0.4f, 0.2f, 0.3f});
+
+    SkinOptimizeOptions opts;
+    skin_optimize_options_init(&opts);
+    opts.max_influences = 2;
+    SkinOptimizeStats stats;
+    optimize_skin_weights(joints, weights, 1, &opts, NULL, &stats);
+
+    TEST_ASSERT_EQ(5, joints[0], "Strongest joint should come first");
+    TEST_ASSERT_EQ(6, joints[1], "Second strongest joint should follow");
+    TEST_ASSERT(fabsf(weights[0] - 4.0f / 7.0f) < 1e-6f, "Kept weights should be renormalized");
+    TEST_ASSERT(weights[0] + weights[1] == 1.0f, "Float weights should sum to exactly one");
+    TEST_ASSERT(weights[2] == 0.0f && weights[3] == 0.0f, "Dropped slots should be cleared");
+    TEST_ASSERT_EQ(2, stats.pruned, "Two influences should be pruned");
+    return 1;
+}
+
+static int test_min_weight_prunes(void) {
+    uint32_t joints[8];
+    float weights[8];
+    uint8_t single[2];
+    set_vertex(joints, weights, 0, (uint32_t[]){1, 2, 3, 0}, (float[]){0.7f, 0.25f, 0.05f, 0.0f});
+    set_vertex(joints, weights, 1, (uint32_t[]){1, 2, 3, 4}, (float[]){0.25f, 0.25f, 0.26f, 0.24f});
+
+    SkinOptimizeOptions opts;
+    skin_optimize_options_init(&opts);
+    opts.min_weight = 0.3f;
+    SkinOptimizeStats stats;
+    optimize_skin_weights(joints, weights, 2, &opts, single, &stats);
+
+    TEST_ASSERT_EQ(1, single[0], "Only the dominant joint passes the threshold");
+    TEST_ASSERT_EQ(1, joints[0], "Dominant joint should be kept");
+    TEST_ASSERT(weights[0] == 1.0f, "Single influence should weigh one");
+    TEST_ASSERT_EQ(3, joints[4], "Strongest joint survives even below the threshold");
+    TEST_ASSERT_EQ(1, single[1], "Vertex left with one joint should be flagged");
+    TEST_ASSERT_EQ(2, stats.single_influence, "Both vertices should be single influence");
+    return 1;
+}
+
+static int test_repeated_joints_merge(void) {
+    uint32_t joints[4];
+    float weights[4];
+    uint8_t single = 0;
+    set_vertex(joints, weights, 0, (uint32_t[]){3, 3, 0, 0}, (float[]){0.5f, 0.5f, 0.0f, 0.0f});
+
+    optimize_skin_weights(joints, weights, 1, NULL, &single, NULL);
+    TEST_ASSERT_EQ(1, single, "Same joint twice is a single influence");
+    TEST_ASSERT_EQ(3, joints[0], "Merged joint should be kept");
+    TEST_ASSERT(weights[0] == 1.0f, "Merged weights should add up");
+    return 1;
+}
+
+static int test_quantized_weights_sum_exactly(void) {
+    const int bits[2] = {8, 16};
+    for (int b = 0; b < 2; b++) {
+        uint32_t joints[8];
+        float weights[8];
+        set_vertex(joints, weights, 0, (uint32_t[]){0, 1, 2, 3}, (float[]){1.0f, 1.0f, 1.0f, 0.0f});
+        set_vertex(joints, weights, 1, (uint32_t[]){0, 1, 2, 3}, (float[]){0.999f, 0.0005f, 0.0005f, 0.0f});
+
+        SkinOptimizeOptions opts;
+        skin_optimize_options_init(&opts);
+        opts.weight_bits = bits[b];
+        SkinOptimizeStats stats;
+        optimize_skin_weights(joints, weights, 2, &opts, NULL, &stats);
+
+        uint8_t *packed = quantize_weights(weights, 8, bits[b]);
+        TEST_ASSERT_NOT_NULL(packed, "Quantized weights should be allocated");
+        uint32_t scale = bits[b] == 8 ? 255u : 65535u;
+        for (int v = 0; v < 2; v++) {
+            uint32_t sum = 0;
+            for (int i = 0; i < 4; i++) {
+                if (bits[b] == 8) {
+                    sum += packed[v * 4 + i];
+                } else {
+                    uint16_t q;
+                    memcpy(&q, packed + (v * 4 + i) * 2, 2);
+                    sum += q;
+                }
+            }
+            TEST_ASSERT_EQ(scale, sum, "Quantized weights should sum to the full scale");
+        }
+        free(packed);
+        if (bits[b] == 8) {
+            TEST_ASSERT_EQ(1, stats.single_influence, "Weights rounding to zero should be pruned");
+        }
+    }
+    return 1;
+}
+
+// One triangle: vertex 0 rigid on bone 1, the others blended
+static PMDModel* make_model(void) {
+    PMDModel *model = fixture_model(3, 1, 3);
+    for (uint32_t i = 0; i < 3; i++) {
+        Vertex *v = &model->vertices[i];
+        v->position = (Vector3D){(float)(i & 1), (float)(i >> 1), 0.0f};
+        v->blend.bones[0] = 1;
+        v->blend.weights[0] = i == 0 ? 1.0f : 0.6f;
+        v->blend.bones[1] = i == 0 ? 0xFF : 2;
+        v->blend.weights[1] = i == 0 ? 0.0f : 0.4f;
+    }
+    model->faces[0] = (Face){{0, 1, 2}};
+    return model;
+}
+
+static int check_export(int interleaved) {
+    static const char *const names[] = {"root", "a", "b"};
+    static const int parents[] = {-1, 0, 1};
+    SkeletonDef *skel = fixture_skeleton(names, parents, 3);
+    PMDModel *model = make_model();
+
+    GltfExportOptions opts;
+    gltf_export_options_init(&opts);
+    opts.interleaved = interleaved;
+    opts.optimize_skin = 1;
+    opts.skin.weight_bits = 8;
+    opts.flag_single_influence = 1;
+    TEST_ASSERT(export_gltf_with_options(TEST_GLTF, model, NULL, 0, skel, "tri", NULL, NULL, &opts),
+                "Export should succeed");
+
+    cJSON *root = fixture_load_json(TEST_GLTF);
+    TEST_ASSERT_NOT_NULL(root, "Exported file should be valid JSON");
+
+    const cJSON *mesh = cJSON_GetArrayItem(cJSON_GetObjectItem(root, "meshes"), 0);
+    const cJSON *attributes = cJSON_GetObjectItem(cJSON_GetArrayItem(cJSON_GetObjectItem(mesh, "primitives"), 0), "attributes");
+    const cJSON *accessors = cJSON_GetObjectItem(root, "accessors");
+    const cJSON *weights = cJSON_GetArrayItem(accessors, cJSON_GetObjectItem(attributes, "WEIGHTS_0")->valueint);
+    TEST_ASSERT_EQ(5121, cJSON_GetObjectItem(weights, "componentType")->valueint, "Weights should be bytes");
+    TEST_ASSERT(cJSON_IsTrue(cJSON_GetObjectItem(weights, "normalized")), "Byte weights should be normalized");
+
+    const cJSON *flag_id = cJSON_GetObjectItem(attributes, "_SINGLE_INFLUENCE");
+    TEST_ASSERT_NOT_NULL(flag_id, "Single influence flag should be exported");
+    const cJSON *flag = cJSON_GetArrayItem(accessors, flag_id->valueint);
+    TEST_ASSERT_EQ(5121, cJSON_GetObjectItem(flag, "componentType")->valueint, "Flag should be a byte");
+    TEST_ASSERT_EQ(3, cJSON_GetObjectItem(flag, "count")->valueint, "One flag per vertex");
+    const cJSON *view = cJSON_GetArrayItem(cJSON_GetObjectItem(root, "bufferViews"),
+                                           cJSON_GetObjectItem(flag, "bufferView")->valueint);
+    int stride = cJSON_GetObjectItem(view, "byteStride")->valueint;
+    TEST_ASSERT_EQ(0, stride % 4, "Flag elements should stay 4-byte aligned");
+    TEST_ASSERT_EQ(0, (int)cJSON_GetNumberValue(cJSON_GetObjectItem(flag, "byteOffset")) % 4,
+                   "Flag offset should stay 4-byte aligned");
+
+    cJSON_Delete(root);
+    free_pmd(model);
+    free_skeleton(skel);
+    remove(TEST_GLTF);
+    return 1;
+}
+
+static int test_export_quantized_and_flagged(void) {
+    return check_export(0);
+}
+
+static int test_export_interleaved_flag(void) {
+    return check_export(1);
+}
+
+int main(void) {
+    const test_case_t tests[] = {
+        {"limits_influences", test_limits_influences},
+        {"min_weight_prunes", test_min_weight_prunes},
+        {"repeated_joints_merge", test_repeated_joints_merge},
+        {"quantized_weights_sum_exactly", test_quantized_weights_sum_exactly},
+        {"export_quantized_and_flagged", test_export_quantized_and_flagged},
+        {"export_interleaved_flag", test_export_interleaved_flag}
+    };
+
+    return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
+}
@@ -0,0 +1,120 @@
+#include "test_framework.h"
+#include "skinning.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Column-major translation matrix
+static void translation(float x, float y, float z, float *m) {
+    memset(m, 0, 16 * sizeof(float));
+    m[0] = m[5] = m[10] = m[15] = 1.0f;
+    m[12] = x;
+    m[13] = y;
+    m[14] = z;
+}
+
+static int test_palette_from_column_major(void) {
+    float m[16], inverse[16], palette[SKIN_PALETTE_STRIDE];
+    translation(1.0f, 2.0f, 3.0f, m);
+    // 90 degrees about Z
+    m[0] = 0.0f; m[1] = 1.0f; m[4] = -1.0f; m[5] = 0.0f;
+    skin_palette_build(m, NULL, 1, palette);
+    TEST_ASSERT(palette[0] == 0.0f && palette[1] == -1.0f && palette[3] == 1.0f, "First row holds x' and the X translation");
+    TEST_ASSERT(palette[4] == 1.0f && palette[7] == 2.0f && palette[11] == 3.0f, "Rows are transposed columns");
+
+    translation(-1.0f, -2.0f, -3.0f, inverse);
+    translation(1.0f, 2.0f, 3.0f, m);
+    skin_palette_build(m, inverse, 1, palette);
+    TEST_ASSERT(palette[3] == 0.0f && palette[7] == 0.0f && palette[11] == 0.0f, "Inverse bind cancels the translation");
+    return 1;
+}
+
+static int test_blends_normalized_weights(void) {
+    float matrices[32], palette[2 * SKIN_PALETTE_STRIDE];
+    translation(2.0f, 0.0f, 0.0f, &matrices[0]);
+    translation(0.0f, 4.0f, 0.0f, &matrices[16]);
+    skin_palette_build(matrices, NULL, 2, palette);
+
+    float px[3] = {1.0f, 1.0f, 1.0f}, py[3] = {0}, pz[3] = {0};
+    // Half/half, weights summing to 2, and only influences past the palette
+    uint8_t bones[12] = {0, 1, 0xFF, 0xFF, 0, 1, 0xFF, 0xFF, 7, 0xFF, 0xFF, 0xFF};
+    float weights[12] = {0.5f, 0.5f, 0, 0, 1.0f, 1.0f, 0, 0, 1.0f, 0, 0, 0};
+    SkinInput in = {3, px, py, pz, NULL, NULL, NULL, bones, weights};
+    float ox[3], oy[3], oz[3];
+    uint8_t weighted[3];
+    SkinOutput out = {ox, oy, oz, NULL, NULL, NULL, weighted};
+    skin_vertices(palette, 2, &in, &out, 1);
+
+    TEST_ASSERT(fabsf(ox[0] - 2.0f) < 1e-6f && fabsf(oy[0] - 2.0f) < 1e-6f, "Even weights average both bones");
+    TEST_ASSERT(fabsf(ox[1] - 2.0f) < 1e-6f && fabsf(oy[1] - 2.0f) < 1e-6f, "Weights are divided by their sum");
+    TEST_ASSERT(ox[2] == 1.0f && oy[2] == 0.0f && !weighted[2], "Unusable influences leave the vertex as is");
+    TEST_ASSERT(weighted[0] && weighted[1], "Skinned vertices are flagged");
+    return 1;
+}
+
+static int test_normals_skip_translation(void) {
+    float m[16], palette[SKIN_PALETTE_STRIDE];
+    translation(5.0f, 5.0f, 5.0f, m);
+    m[0] = 2.0f;
+    skin_palette_build(m, NULL, 1, palette);
+
+    float px[1] = {0}, py[1] = {0}, pz[1] = {0};
+    float nx[1] = {1.0f}, ny[1] = {0}, nz[1] = {0};
+    uint8_t bones[4] = {0, 0xFF, 0xFF, 0xFF};
+    float weights[4] = {1.0f, 0, 0, 0};
+    SkinInput in = {1, px, py, pz, nx, ny, nz, bones, weights};
+    float ox, oy, oz, mx, my, mz;
+    SkinOutput out = {&ox, &oy, &oz, &mx, &my, &mz, NULL};
+    skin_vertices(palette, 1, &in, &out, 1);
+    TEST_ASSERT(ox == 5.0f && oy == 5.0f && oz == 5.0f, "Positions take the translation");
+    TEST_ASSERT(mx == 2.0f && my == 0.0f && mz == 0.0f, "Normals are not translated nor renormalized");
+    return 1;
+}
+
+static int test_threads_match_serial(void) {
+    const uint32_t count = 50000;
+    const uint32_t bone_count = 8;
+    float matrices[8 * 16], palette[8 * SKIN_PALETTE_STRIDE];
+    for (uint32_t b = 0; b < bone_count; b++) {
+        translation((float)b, -(float)b, 0.5f * (float)b, &matrices[b * 16]);
+        matrices[b * 16] = 1.0f + 0.1f * (float)b;
+    }
+    skin_palette_build(matrices, NULL, bone_count, palette);
+
+    float *in_data = malloc((size_t)count * 7 * sizeof(float));
+    uint8_t *bones = malloc((size_t)count * 4);
+    float *out_data = malloc((size_t)count * 6 * sizeof(float));
+    TEST_ASSERT(in_data && bones && out_data, "Allocation should succeed");
+    float *weights = in_data + 3 * count;
+    for (uint32_t i = 0; i < count; i++) {
+        in_data[i] = (float)(i % 97);
+        in_data[count + i] = (float)(i % 31);
+        in_data[2 * count + i] = (float)(i % 13);
+        for (int j = 0; j < 4; j++) {
+            bones[i * 4 + j] = (uint8_t)((i + j * 3) % (bone_count + 1));
+            weights[i * 4 + j] = (float)((i + j) % 4);
+        }
+    }
+    SkinInput in = {count, in_data, in_data + count, in_data + 2 * count, NULL, NULL, NULL, bones, weights};
+    SkinOutput serial = {out_data, out_data + count, out_data + 2 * count, NULL, NULL, NULL, NULL};
+    SkinOutput threaded = {out_data + 3 * count, out_data + 4 * count, out_data + 5 * count, NULL, NULL, NULL, NULL};
+    skin_vertices(palette, bone_count, &in, &serial, 1);
+    skin_vertices(palette, bone_count, &in, &threaded, 4);
+    TEST_ASSERT(memcmp(out_data, out_data + 3 * count, (size_t)count * 3 * sizeof(float)) == 0,
+                "Threaded skinning should match the serial pass bit for bit");
+    free(in_data);
+    free(bones);
+    free(out_data);
+    return 1;
+}
+
+int main(void) {
+    const test_case_t tests[] = {
+        {"palette_from_column_major", test_palette_from_column_major},
+        {"blends_normalized_weights", test_blends_normalized_weights},
+        {"normals_skip_translation", test_normals_skip_translation},
+        {"threads_match_serial", test_threads_match_serial}
+    };
+
+    return run_tests(tests, sizeof(tests) / sizeof(tests[0]));
+}